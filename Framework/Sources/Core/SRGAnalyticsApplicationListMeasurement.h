@@ -0,0 +1,95 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Block called when an application list request ends. For a successful request, the HTTP response is provided (even
+ *  if its status code is not 200).
+ */
+typedef void (^SRGAnalyticsApplicationListFetchCompletionBlock)(NSData * _Nullable data, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error);
+
+/**
+ *  Block checking whether an URL scheme can be opened, i.e. whether an application supporting it is installed.
+ */
+typedef BOOL (^SRGAnalyticsApplicationListProbeBlock)(NSString *URLScheme);
+
+/**
+ *  Object retrieving the application list.
+ */
+@protocol SRGAnalyticsApplicationListFetcher <NSObject>
+
+/**
+ *  Perform the request. The completion block can be called on any thread.
+ */
+- (void)fetchApplicationListWithRequest:(NSURLRequest *)request completionBlock:(SRGAnalyticsApplicationListFetchCompletionBlock)completionBlock;
+
+@end
+
+/**
+ *  Fetcher retrieving the application list with an `NSURLSession`.
+ */
+@interface SRGAnalyticsURLSessionApplicationListFetcher : NSObject <SRGAnalyticsApplicationListFetcher>
+
+/**
+ *  Create a fetcher using the specified session.
+ */
+- (instancetype)initWithSession:(NSURLSession *)session;
+
+@end
+
+@interface SRGAnalyticsURLSessionApplicationListFetcher (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ *  Measurement of the SRG SSR applications installed on the user device.
+ *
+ *  The remote application list is cached on disk and only requested again once its `max-age` has expired, in which case
+ *  it is revalidated with its `ETag`. If the list cannot be retrieved, a previously cached list is used, even if stale.
+ *
+ *  Probing URL schemes must be made on the main thread. To avoid slowing down application startup, probing is scheduled
+ *  when the main run loop becomes idle (i.e. after the first frame has been rendered). Probe results are saved with
+ *  the list and reused until the list or the application version changes. Since applications can be installed or
+ *  removed at any time without notice, results are also probed again when older than the probe validity interval.
+ */
+@interface SRGAnalyticsApplicationListMeasurement : NSObject
+
+/**
+ *  Create a measurement.
+ *
+ *  @param URL                   The URL of the application list.
+ *  @param fetcher               The fetcher used to retrieve the list.
+ *  @param fileURL               The URL of the file where the list and probe results are cached. The file is created
+ *                               if it does not exist.
+ *  @param probeValidityInterval The time interval during which probe results are reused.
+ *  @param probeBlock            The block used to probe URL schemes, called on the main thread.
+ */
+- (instancetype)initWithURL:(NSURL *)URL
+                    fetcher:(id<SRGAnalyticsApplicationListFetcher>)fetcher
+                    fileURL:(NSURL *)fileURL
+      probeValidityInterval:(NSTimeInterval)probeValidityInterval
+                 probeBlock:(SRGAnalyticsApplicationListProbeBlock)probeBlock;
+
+/**
+ *  Perform the measurement. The completion block is called on the main thread with the sorted list of installed
+ *  application codes, or with `nil` if no application list is available.
+ */
+- (void)measureWithCompletionBlock:(void (^)(NSArray<NSString *> * _Nullable installedApplications))completionBlock;
+
+@end
+
+@interface SRGAnalyticsApplicationListMeasurement (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
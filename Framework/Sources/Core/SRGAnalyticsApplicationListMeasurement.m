@@ -0,0 +1,318 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsApplicationListMeasurement.h"
+
+#import "SRGAnalyticsLogger.h"
+
+static NSString * const SRGAnalyticsApplicationListDataKey = @"data";
+static NSString * const SRGAnalyticsApplicationListETagKey = @"ETag";
+static NSString * const SRGAnalyticsApplicationListExpirationDateKey = @"expirationDate";
+static NSString * const SRGAnalyticsApplicationListInstalledApplicationsKey = @"installedApplications";
+static NSString * const SRGAnalyticsApplicationListProbeDateKey = @"probeDate";
+static NSString * const SRGAnalyticsApplicationListProbeApplicationVersionKey = @"probeApplicationVersion";
+
+static NSString *SRGAnalyticsHeaderFieldValue(NSHTTPURLResponse *HTTPResponse, NSString *name)
+{
+    // Header field names are case-insensitive
+    __block NSString *value = nil;
+    [HTTPResponse.allHeaderFields enumerateKeysAndObjectsUsingBlock:^(id _Nonnull key, id _Nonnull object, BOOL * _Nonnull stop) {
+        if ([key isKindOfClass:NSString.class] && [key caseInsensitiveCompare:name] == NSOrderedSame) {
+            value = object;
+            *stop = YES;
+        }
+    }];
+    return value;
+}
+
+static NSTimeInterval SRGAnalyticsMaxAge(NSHTTPURLResponse *HTTPResponse)
+{
+    NSString *cacheControl = SRGAnalyticsHeaderFieldValue(HTTPResponse, @"Cache-Control");
+    for (NSString *directive in [cacheControl componentsSeparatedByString:@","]) {
+        NSString *trimmedDirective = [directive stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+        if ([trimmedDirective.lowercaseString hasPrefix:@"max-age="]) {
+            return MAX([trimmedDirective substringFromIndex:@"max-age=".length].doubleValue, 0.);
+        }
+    }
+    return 0.;
+}
+
+static void SRGAnalyticsPerformWhenMainRunLoopIsIdle(void (^block)(void))
+{
+    // Executed when the main run loop is about to wait for events, after Core Animation has committed pending changes
+    // (thus after the first frame has been rendered during startup). The default mode is used so that the block is not
+    // executed while the user is scrolling.
+    CFRunLoopObserverRef observer = CFRunLoopObserverCreateWithHandler(NULL, kCFRunLoopBeforeWaiting, false, LONG_MAX, ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+        block();
+    });
+    CFRunLoopAddObserver(CFRunLoopGetMain(), observer, kCFRunLoopDefaultMode);
+    CFRelease(observer);
+    CFRunLoopWakeUp(CFRunLoopGetMain());
+}
+
+@interface SRGAnalyticsURLSessionApplicationListFetcher ()
+
+@property (nonatomic) NSURLSession *session;
+
+@end
+
+@implementation SRGAnalyticsURLSessionApplicationListFetcher
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithSession:(NSURLSession *)session
+{
+    if (self = [super init]) {
+        self.session = session;
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithSession:NSURLSession.sharedSession];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark SRGAnalyticsApplicationListFetcher protocol
+
+- (void)fetchApplicationListWithRequest:(NSURLRequest *)request completionBlock:(SRGAnalyticsApplicationListFetchCompletionBlock)completionBlock
+{
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        NSHTTPURLResponse *HTTPResponse = [response isKindOfClass:NSHTTPURLResponse.class] ? (NSHTTPURLResponse *)response : nil;
+        completionBlock(data, HTTPResponse, error);
+    }] resume];
+}
+
+@end
+
+@interface SRGAnalyticsApplicationListMeasurement ()
+
+@property (nonatomic) NSURL *URL;
+@property (nonatomic) id<SRGAnalyticsApplicationListFetcher> fetcher;
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) NSTimeInterval probeValidityInterval;
+@property (nonatomic, copy) SRGAnalyticsApplicationListProbeBlock probeBlock;
+
+@property (nonatomic) dispatch_queue_t queue;
+
+@end
+
+@implementation SRGAnalyticsApplicationListMeasurement
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithURL:(NSURL *)URL
+                    fetcher:(id<SRGAnalyticsApplicationListFetcher>)fetcher
+                    fileURL:(NSURL *)fileURL
+      probeValidityInterval:(NSTimeInterval)probeValidityInterval
+                 probeBlock:(SRGAnalyticsApplicationListProbeBlock)probeBlock
+{
+    if (self = [super init]) {
+        self.URL = URL;
+        self.fetcher = fetcher;
+        self.fileURL = fileURL;
+        self.probeValidityInterval = probeValidityInterval;
+        self.probeBlock = probeBlock;
+        self.queue = dispatch_queue_create("ch.srgssr.analytics.applicationlist", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithURL:[NSURL new] fetcher:[[SRGAnalyticsURLSessionApplicationListFetcher alloc] initWithSession:NSURLSession.sharedSession] fileURL:[NSURL new] probeValidityInterval:0. probeBlock:^BOOL(NSString *URLScheme) {
+        return NO;
+    }];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Measurement
+
+- (void)measureWithCompletionBlock:(void (^)(NSArray<NSString *> * _Nullable))completionBlock
+{
+    dispatch_async(self.queue, ^{
+        NSMutableDictionary *cache = [[NSDictionary dictionaryWithContentsOfURL:self.fileURL] mutableCopy] ?: [NSMutableDictionary dictionary];
+        
+        NSDate *expirationDate = cache[SRGAnalyticsApplicationListExpirationDateKey];
+        if (cache[SRGAnalyticsApplicationListDataKey] && [expirationDate isKindOfClass:NSDate.class] && expirationDate.timeIntervalSinceNow > 0.) {
+            SRGAnalyticsLogDebug(@"tracker", @"Cached application list is fresh. Used without request");
+            [self measureWithCache:cache completionBlock:completionBlock];
+            return;
+        }
+        
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:self.URL];
+        request.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+        
+        NSString *ETag = cache[SRGAnalyticsApplicationListETagKey];
+        if (cache[SRGAnalyticsApplicationListDataKey] && ETag) {
+            [request setValue:ETag forHTTPHeaderField:@"If-None-Match"];
+        }
+        
+        [self.fetcher fetchApplicationListWithRequest:request completionBlock:^(NSData * _Nullable data, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+            dispatch_async(self.queue, ^{
+                [self updateCache:cache withData:data HTTPResponse:HTTPResponse error:error];
+                [self measureWithCache:cache completionBlock:completionBlock];
+            });
+        }];
+    });
+}
+
+// Must be called on the queue
+- (void)updateCache:(NSMutableDictionary *)cache withData:(NSData *)data HTTPResponse:(NSHTTPURLResponse *)HTTPResponse error:(NSError *)error
+{
+    if (error || ! HTTPResponse) {
+        SRGAnalyticsLogError(@"tracker", @"The application list could not be retrieved. Reason: %@", error);
+        return;
+    }
+    
+    NSInteger statusCode = HTTPResponse.statusCode;
+    if (statusCode == 304) {
+        SRGAnalyticsLogDebug(@"tracker", @"The application list has not changed");
+    }
+    else if (statusCode == 200) {
+        id JSONObject = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] : nil;
+        if (! [JSONObject isKindOfClass:NSArray.class]) {
+            SRGAnalyticsLogError(@"tracker", @"The application list format is incorrect");
+            return;
+        }
+        
+        // Probe results are only valid for the list they were obtained with
+        if (! [data isEqualToData:cache[SRGAnalyticsApplicationListDataKey]]) {
+            cache[SRGAnalyticsApplicationListDataKey] = data;
+            [cache removeObjectForKey:SRGAnalyticsApplicationListInstalledApplicationsKey];
+            [cache removeObjectForKey:SRGAnalyticsApplicationListProbeDateKey];
+            [cache removeObjectForKey:SRGAnalyticsApplicationListProbeApplicationVersionKey];
+        }
+        
+        NSString *ETag = SRGAnalyticsHeaderFieldValue(HTTPResponse, @"ETag");
+        if (ETag) {
+            cache[SRGAnalyticsApplicationListETagKey] = ETag;
+        }
+        else {
+            [cache removeObjectForKey:SRGAnalyticsApplicationListETagKey];
+        }
+    }
+    else {
+        SRGAnalyticsLogError(@"tracker", @"The application list could not be retrieved. Status code: %@", @(statusCode));
+        return;
+    }
+    
+    cache[SRGAnalyticsApplicationListExpirationDateKey] = [NSDate dateWithTimeIntervalSinceNow:SRGAnalyticsMaxAge(HTTPResponse)];
+    [self saveCache:cache];
+}
+
+// Must be called on the queue
+- (void)measureWithCache:(NSMutableDictionary *)cache completionBlock:(void (^)(NSArray<NSString *> * _Nullable))completionBlock
+{
+    NSData *data = cache[SRGAnalyticsApplicationListDataKey];
+    if (! data) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completionBlock(nil);
+        });
+        return;
+    }
+    
+    NSString *applicationVersion = [NSBundle.mainBundle objectForInfoDictionaryKey:@"CFBundleVersion"] ?: @"";
+    
+    NSArray<NSString *> *installedApplications = cache[SRGAnalyticsApplicationListInstalledApplicationsKey];
+    NSDate *probeDate = cache[SRGAnalyticsApplicationListProbeDateKey];
+    if (installedApplications && [cache[SRGAnalyticsApplicationListProbeApplicationVersionKey] isEqualToString:applicationVersion]
+            && [probeDate isKindOfClass:NSDate.class] && - probeDate.timeIntervalSinceNow < self.probeValidityInterval) {
+        SRGAnalyticsLogDebug(@"tracker", @"Installed applications found in cache");
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completionBlock(installedApplications);
+        });
+        return;
+    }
+    
+    // Extract URL schemes and installed applications
+    NSMutableDictionary<NSString *, NSString *> *applications = [NSMutableDictionary dictionary];
+    NSArray *applicationDictionaries = [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL];
+    for (NSDictionary *applicationDictionary in applicationDictionaries) {
+        if (! [applicationDictionary isKindOfClass:NSDictionary.class]) {
+            continue;
+        }
+        
+        NSString *application = applicationDictionary[@"code"];
+        NSString *URLScheme = applicationDictionary[@"ios"];
+        
+        if (! [URLScheme isKindOfClass:NSString.class] || URLScheme.length == 0 || ! [application isKindOfClass:NSString.class]) {
+            SRGAnalyticsLogInfo(@"tracker", @"URL scheme or application name missing in %@. Skipped", applicationDictionary);
+            continue;
+        }
+        
+        applications[URLScheme] = application;
+    }
+    
+    SRGAnalyticsPerformWhenMainRunLoopIsIdle(^{
+        NSMutableSet<NSString *> *probedApplications = [NSMutableSet set];
+        [applications enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull URLScheme, NSString * _Nonnull application, BOOL * _Nonnull stop) {
+            if (self.probeBlock(URLScheme)) {
+                [probedApplications addObject:application];
+            }
+        }];
+        
+        // Since iOS 9, to be able to open a URL in another application (and thus to be able to test for URL scheme
+        // support), the application must declare the schemes it supports via its Info.plist file (under the
+        // `LSApplicationQueriesSchemes` key). If we are running on iOS 9 or above, check that the app list is consistent
+        // with the remote list, and log an error if this is not the case
+        NSArray<NSString *> *declaredURLSchemesArray = NSBundle.mainBundle.infoDictionary[@"LSApplicationQueriesSchemes"];
+        NSSet<NSString *> *declaredURLSchemes = declaredURLSchemesArray ? [NSSet setWithArray:declaredURLSchemesArray] : [NSSet set];
+        if (! [[NSSet setWithArray:applications.allKeys] isSubsetOfSet:declaredURLSchemes]) {
+            SRGAnalyticsLogError(@"tracker", @"The URL schemes declared in your application Info.plist file under the "
+                                 "'LSApplicationQueriesSchemes' key must at least contain the scheme list available at "
+                                 "%@ (the schemes are found under the 'ios' key, or a script is available in the "
+                                 "SRGAnalytics repository to extract them). Please update your Info.plist file accordingly "
+                                 "to make this message disappear.", self.URL);
+        }
+        
+        NSArray<NSString *> *sortedInstalledApplications = [probedApplications.allObjects sortedArrayUsingSelector:@selector(localizedCaseInsensitiveCompare:)];
+        
+        dispatch_async(self.queue, ^{
+            cache[SRGAnalyticsApplicationListInstalledApplicationsKey] = sortedInstalledApplications;
+            cache[SRGAnalyticsApplicationListProbeDateKey] = NSDate.date;
+            cache[SRGAnalyticsApplicationListProbeApplicationVersionKey] = applicationVersion;
+            [self saveCache:cache];
+            
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionBlock(sortedInstalledApplications);
+            });
+        });
+    });
+}
+
+// Must be called on the queue
+- (void)saveCache:(NSDictionary *)cache
+{
+    [NSFileManager.defaultManager createDirectoryAtURL:self.fileURL.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:NULL];
+    if (! [cache writeToURL:self.fileURL atomically:YES]) {
+        SRGAnalyticsLogError(@"tracker", @"The application list could not be saved to %@", self.fileURL);
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; URL = %@; fileURL = %@>",
+            self.class,
+            self,
+            self.URL,
+            self.fileURL];
+}
+
+@end
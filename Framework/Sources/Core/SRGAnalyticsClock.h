@@ -0,0 +1,81 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Timer scheduled with a clock.
+ */
+@interface SRGAnalyticsClockTimer : NSObject
+
+/**
+ *  The time at which the timer is scheduled to fire.
+ */
+@property (nonatomic, readonly) NSTimeInterval fireTime;
+
+/**
+ *  Cancel the timer. Does nothing if the timer already fired.
+ */
+- (void)invalidate;
+
+@end
+
+/**
+ *  Time source. Time is measured in seconds, from an arbitrary origin.
+ */
+@protocol SRGAnalyticsClock <NSObject>
+
+/**
+ *  The current time.
+ */
+@property (nonatomic, readonly) NSTimeInterval currentTime;
+
+/**
+ *  Schedule a block to be executed once at the specified time (or immediately if the time is already past). The clock
+ *  is allowed to delay execution by at most the specified tolerance. Timers are kept alive until they fire or are
+ *  invalidated.
+ */
+- (SRGAnalyticsClockTimer *)scheduleTimerWithFireTime:(NSTimeInterval)fireTime
+                                            tolerance:(NSTimeInterval)tolerance
+                                                block:(void (^)(void))block;
+
+@end
+
+/**
+ *  System clock. Time is monotonic (not affected by system date changes), and timer blocks are executed on the
+ *  main thread.
+ */
+@interface SRGAnalyticsSystemClock : NSObject <SRGAnalyticsClock>
+
+/**
+ *  The shared system clock.
+ */
+@property (class, nonatomic, readonly) SRGAnalyticsSystemClock *sharedClock;
+
+@end
+
+/**
+ *  Clock whose time only changes when explicitly advanced, for deterministic testing purposes. Timer blocks are
+ *  executed synchronously, in fire time order, when time is advanced past their fire time.
+ */
+@interface SRGAnalyticsManualClock : NSObject <SRGAnalyticsClock>
+
+/**
+ *  Advance the clock by the specified time interval.
+ */
+- (void)advanceBy:(NSTimeInterval)timeInterval;
+
+/**
+ *  Advance the clock by the specified time interval at once, as when the process is suspended. Timers due in the
+ *  meantime fire late, at the new time.
+ */
+- (void)jumpBy:(NSTimeInterval)timeInterval;
+
+@end
+
+NS_ASSUME_NONNULL_END
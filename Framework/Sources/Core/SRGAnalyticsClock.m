@@ -0,0 +1,169 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsClock.h"
+
+@interface SRGAnalyticsClockTimer ()
+
+@property (nonatomic) NSTimeInterval fireTime;
+@property (nonatomic, copy) void (^block)(void);
+@property (nonatomic, copy) void (^invalidationBlock)(void);
+
+@end
+
+@implementation SRGAnalyticsClockTimer
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithFireTime:(NSTimeInterval)fireTime block:(void (^)(void))block invalidationBlock:(void (^)(void))invalidationBlock
+{
+    if (self = [super init]) {
+        self.fireTime = fireTime;
+        self.block = block;
+        self.invalidationBlock = invalidationBlock;
+    }
+    return self;
+}
+
+#pragma mark Timer
+
+- (void)fire
+{
+    void (^block)(void) = self.block;
+    [self invalidate];
+    
+    if (block) {
+        block();
+    }
+}
+
+- (void)invalidate
+{
+    void (^invalidationBlock)(void) = self.invalidationBlock;
+    
+    self.block = nil;
+    self.invalidationBlock = nil;
+    
+    if (invalidationBlock) {
+        invalidationBlock();
+    }
+}
+
+@end
+
+@implementation SRGAnalyticsSystemClock
+
+#pragma mark Class methods
+
++ (SRGAnalyticsSystemClock *)sharedClock
+{
+    static SRGAnalyticsSystemClock *s_sharedClock;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_sharedClock = [[SRGAnalyticsSystemClock alloc] init];
+    });
+    return s_sharedClock;
+}
+
+#pragma mark SRGAnalyticsClock protocol
+
+- (NSTimeInterval)currentTime
+{
+    return NSProcessInfo.processInfo.systemUptime;
+}
+
+- (SRGAnalyticsClockTimer *)scheduleTimerWithFireTime:(NSTimeInterval)fireTime tolerance:(NSTimeInterval)tolerance block:(void (^)(void))block
+{
+    dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    SRGAnalyticsClockTimer *timer = [[SRGAnalyticsClockTimer alloc] initWithFireTime:fireTime block:block invalidationBlock:^{
+        dispatch_source_cancel(source);
+    }];
+    
+    NSTimeInterval delay = MAX(fireTime - self.currentTime, 0.);
+    dispatch_source_set_timer(source, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, (uint64_t)(tolerance * NSEC_PER_SEC));
+    
+    // The timer and its source retain each other until the timer fires or is invalidated
+    dispatch_source_set_event_handler(source, ^{
+        [timer fire];
+    });
+    dispatch_resume(source);
+    return timer;
+}
+
+@end
+
+@interface SRGAnalyticsManualClock ()
+
+@property (nonatomic) NSTimeInterval currentTime;
+@property (nonatomic) NSMutableArray<SRGAnalyticsClockTimer *> *timers;
+
+@end
+
+@implementation SRGAnalyticsManualClock
+
+#pragma mark Object lifecycle
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.timers = [NSMutableArray array];
+    }
+    return self;
+}
+
+#pragma mark Time
+
+- (void)advanceBy:(NSTimeInterval)timeInterval
+{
+    NSAssert(timeInterval >= 0., @"Time can only be advanced forward");
+    
+    NSTimeInterval targetTime = self.currentTime + timeInterval;
+    
+    // Timers scheduled by fired timers are themselves fired if due
+    SRGAnalyticsClockTimer *timer = nil;
+    while ((timer = self.timers.firstObject) && timer.fireTime <= targetTime) {
+        self.currentTime = MAX(timer.fireTime, self.currentTime);
+        [timer fire];
+    }
+    self.currentTime = targetTime;
+}
+
+- (void)jumpBy:(NSTimeInterval)timeInterval
+{
+    NSAssert(timeInterval >= 0., @"Time can only be advanced forward");
+    
+    self.currentTime += timeInterval;
+    
+    // Timers scheduled by fired timers are themselves fired if due
+    SRGAnalyticsClockTimer *timer = nil;
+    while ((timer = self.timers.firstObject) && timer.fireTime <= self.currentTime) {
+        [timer fire];
+    }
+}
+
+#pragma mark SRGAnalyticsClock protocol
+
+- (SRGAnalyticsClockTimer *)scheduleTimerWithFireTime:(NSTimeInterval)fireTime tolerance:(NSTimeInterval)tolerance block:(void (^)(void))block
+{
+    __weak __typeof(self) weakSelf = self;
+    __block __weak SRGAnalyticsClockTimer *weakTimer = nil;
+    SRGAnalyticsClockTimer *timer = [[SRGAnalyticsClockTimer alloc] initWithFireTime:fireTime block:block invalidationBlock:^{
+        [weakSelf.timers removeObjectIdenticalTo:weakTimer];
+    }];
+    weakTimer = timer;
+    
+    // Keep timers sorted by fire time. Timers with the same fire time fire in the order they were scheduled
+    NSUInteger index = [self.timers indexOfObject:timer
+                                    inSortedRange:NSMakeRange(0, self.timers.count)
+                                          options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual
+                                  usingComparator:^NSComparisonResult(SRGAnalyticsClockTimer * _Nonnull timer1, SRGAnalyticsClockTimer * _Nonnull timer2) {
+        return [@(timer1.fireTime) compare:@(timer2.fireTime)];
+    }];
+    [self.timers insertObject:timer atIndex:index];
+    return timer;
+}
+
+@end
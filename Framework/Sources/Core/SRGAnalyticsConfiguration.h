@@ -57,6 +57,42 @@ OBJC_EXPORT SRGAnalyticsBusinessUnitIdentifier const SRGAnalyticsBusinessUnitIde
  */
 @property (nonatomic, getter=isUnitTesting) BOOL unitTesting;
 
+/**
+ *  The number of TagCommander events to accumulate before sending them together. Accumulated events are stored on disk
+ *  so that they are not lost if the application is terminated, and are sent at the latest after `tagCommanderBatchInterval`
+ *  or when the application enters the background.
+ *
+ *  Default value is 1 (events are sent immediately).
+ *
+ *  @discussion The TagCommander SDK sends each event with a separate request, even when events are sent together. Batching
+ *              therefore does not save any request. It only delays events, trading event latency (up to
+ *              `tagCommanderBatchInterval`) for fewer radio wake-ups and less work while the user interacts with the
+ *              application. Event timestamps are those at which events are sent, not those at which they occurred. The
+ *              journal file is protected until the device is unlocked for the first time after a restart.
+ */
+@property (nonatomic) NSUInteger tagCommanderBatchSize;
+
+/**
+ *  The maximum time interval during which TagCommander events can be accumulated before being sent, @see `tagCommanderBatchSize`.
+ *
+ *  Default value is 30 seconds.
+ *
+ *  @discussion This is the maximum additional latency of TagCommander events when batching is enabled.
+ */
+@property (nonatomic) NSTimeInterval tagCommanderBatchInterval;
+
+/**
+ *  Set to `YES` to start analytics services in stages, so that starting the tracker does not slow down application
+ *  launch. Only the configuration is captured when the tracker is started. Analytics services are then started in
+ *  the background, one after the other, and events received in the meantime are processed in order once services
+ *  are ready.
+ *
+ *  Default value is `NO`.
+ *
+ *  @discussion The time spent in each startup stage can be obtained with instrumentation (see `SRGAnalyticsInstrumentationStage`).
+ */
+@property (nonatomic, getter=isStartupStaged) BOOL startupStaged;
+
 /**
  *  The SRG SSR business unit which measurements are associated with.
  */
@@ -37,6 +37,8 @@ SRGAnalyticsBusinessUnitIdentifier const SRGAnalyticsBusinessUnitIdentifierSWI =
         self.comScoreVirtualSite = comScoreVirtualSite;
         self.netMetrixIdentifier = netMetrixIdentifier;
         self.centralized = YES;
+        self.tagCommanderBatchSize = 1;
+        self.tagCommanderBatchInterval = 30.;
     }
     return self;
 }
@@ -86,6 +88,9 @@ SRGAnalyticsBusinessUnitIdentifier const SRGAnalyticsBusinessUnitIdentifierSWI =
     configuration.netMetrixIdentifier = self.netMetrixIdentifier;
     configuration.centralized = self.centralized;
     configuration.unitTesting = self.unitTesting;
+    configuration.tagCommanderBatchSize = self.tagCommanderBatchSize;
+    configuration.tagCommanderBatchInterval = self.tagCommanderBatchInterval;
+    configuration.startupStaged = self.startupStaged;
     return configuration;
 }
 
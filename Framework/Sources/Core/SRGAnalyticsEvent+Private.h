@@ -0,0 +1,49 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsEvent.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Return the current monotonic timestamp, @see `SRGAnalyticsEvent.timestamp`.
+ */
+OBJC_EXPORT NSTimeInterval SRGAnalyticsEventCurrentTimestamp(void);
+
+/**
+ *  Return the type of the TagCommander event with the specified labels.
+ */
+OBJC_EXPORT SRGAnalyticsEventTypes SRGAnalyticsEventTypeForTagCommanderLabels(NSDictionary<NSString *, NSString *> *labels);
+
+/**
+ *  Return the type of the comScore event with the specified labels.
+ */
+OBJC_EXPORT SRGAnalyticsEventTypes SRGAnalyticsEventTypeForComScoreLabels(NSDictionary<NSString *, NSString *> *labels);
+
+@interface SRGAnalyticsEvent (Private)
+
+/**
+ *  Create an event record. Use `SRGAnalyticsEventCurrentTimestamp()` for events sent now.
+ */
+- (instancetype)initWithType:(SRGAnalyticsEventTypes)type
+                        name:(nullable NSString *)name
+                      labels:(nullable NSDictionary<NSString *, NSString *> *)labels
+                         URL:(nullable NSURL *)URL
+                       input:(nullable NSDictionary<NSString *, id> *)input
+                   timestamp:(NSTimeInterval)timestamp;
+
+/**
+ *  Same as above, without input.
+ */
+- (instancetype)initWithType:(SRGAnalyticsEventTypes)type
+                        name:(nullable NSString *)name
+                      labels:(nullable NSDictionary<NSString *, NSString *> *)labels
+                         URL:(nullable NSURL *)URL
+                   timestamp:(NSTimeInterval)timestamp;
+
+@end
+
+NS_ASSUME_NONNULL_END
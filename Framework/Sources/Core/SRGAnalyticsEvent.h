@@ -0,0 +1,121 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SRGAnalyticsTracker;
+
+/**
+ *  Event types, which can be combined to subscribe to several types at once.
+ */
+typedef NS_OPTIONS(NSUInteger, SRGAnalyticsEventTypes) {
+    /**
+     *  TagCommander page view.
+     */
+    SRGAnalyticsEventTypePageView = (1 << 0),
+    /**
+     *  TagCommander hidden event.
+     */
+    SRGAnalyticsEventTypeHiddenEvent = (1 << 1),
+    /**
+     *  TagCommander stream event (play, pause, seek, stop, eof, as well as heartbeats).
+     */
+    SRGAnalyticsEventTypeStreamEvent = (1 << 2),
+    /**
+     *  comScore page view.
+     */
+    SRGAnalyticsEventTypeComScorePageView = (1 << 3),
+    /**
+     *  comScore hidden event.
+     */
+    SRGAnalyticsEventTypeComScoreHiddenEvent = (1 << 4),
+    /**
+     *  comScore stream event (stream sense events, including heartbeats).
+     */
+    SRGAnalyticsEventTypeComScoreStreamEvent = (1 << 5),
+    /**
+     *  NetMetrix view.
+     */
+    SRGAnalyticsEventTypeNetMetrixView = (1 << 6),
+    /**
+     *  All TagCommander events.
+     */
+    SRGAnalyticsEventTypeTagCommander = SRGAnalyticsEventTypePageView | SRGAnalyticsEventTypeHiddenEvent | SRGAnalyticsEventTypeStreamEvent,
+    /**
+     *  All comScore events.
+     */
+    SRGAnalyticsEventTypeComScore = SRGAnalyticsEventTypeComScorePageView | SRGAnalyticsEventTypeComScoreHiddenEvent | SRGAnalyticsEventTypeComScoreStreamEvent,
+    /**
+     *  All events.
+     */
+    SRGAnalyticsEventTypeAll = SRGAnalyticsEventTypeTagCommander | SRGAnalyticsEventTypeComScore | SRGAnalyticsEventTypeNetMetrixView
+};
+
+/**
+ *  Record of an event sent to an analytics service.
+ */
+@interface SRGAnalyticsEvent : NSObject
+
+/**
+ *  The event type (a single type).
+ */
+@property (nonatomic, readonly) SRGAnalyticsEventTypes type;
+
+/**
+ *  The event name, as sent to the service (`event_id` for TagCommander, `ns_st_ev` for comScore stream events, `name`
+ *  for other comScore events). `nil` for NetMetrix views.
+ */
+@property (nonatomic, readonly, copy, nullable) NSString *name;
+
+/**
+ *  The labels sent to the service. Internal labels added by the TagCommander SDK and comScore global labels are not
+ *  available. Empty for NetMetrix views.
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *labels;
+
+/**
+ *  The URL which the event is sent to, if relevant (NetMetrix views only).
+ */
+@property (nonatomic, readonly, nullable) NSURL *URL;
+
+/**
+ *  The tracker call the event was built from, as a property list dictionary, so that the event can be built again (e.g.
+ *  when replaying a recording). Available for TagCommander page views and hidden events, except when TagCommander
+ *  batching is enabled (events are then sent from a journal which only keeps labels). `nil` for other events.
+ */
+@property (nonatomic, readonly, nullable) NSDictionary<NSString *, id> *input;
+
+/**
+ *  The time at which the event was sent, in seconds. Time is monotonic and measured from an arbitrary origin, so that
+ *  only differences between timestamps are meaningful.
+ */
+@property (nonatomic, readonly) NSTimeInterval timestamp;
+
+@end
+
+@interface SRGAnalyticsEvent (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ *  Objects receiving events as they are sent by an analytics tracker, @see `-[SRGAnalyticsTracker addEventSink:forEventTypes:]`.
+ */
+@protocol SRGAnalyticsEventSink <NSObject>
+
+/**
+ *  Called when an event has been sent. Events of a given service are received in the order in which they are sent,
+ *  but this method can be called from any thread, without any synchronization between services. Implementations must
+ *  therefore be thread-safe, and should return quickly since they delay the delivery of subsequent events.
+ */
+- (void)tracker:(SRGAnalyticsTracker *)tracker didSendEvent:(SRGAnalyticsEvent *)event;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,102 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsEvent+Private.h"
+
+#import "SRGAnalyticsClock.h"
+
+NSTimeInterval SRGAnalyticsEventCurrentTimestamp(void)
+{
+    return SRGAnalyticsSystemClock.sharedClock.currentTime;
+}
+
+SRGAnalyticsEventTypes SRGAnalyticsEventTypeForTagCommanderLabels(NSDictionary<NSString *, NSString *> *labels)
+{
+    NSString *eventId = labels[@"event_id"];
+    if ([eventId isEqualToString:@"screen"]) {
+        return SRGAnalyticsEventTypePageView;
+    }
+    else if ([eventId isEqualToString:@"hidden_event"]) {
+        return SRGAnalyticsEventTypeHiddenEvent;
+    }
+    else {
+        return SRGAnalyticsEventTypeStreamEvent;
+    }
+}
+
+SRGAnalyticsEventTypes SRGAnalyticsEventTypeForComScoreLabels(NSDictionary<NSString *, NSString *> *labels)
+{
+    if ([labels[@"ns_type"] isEqualToString:@"view"]) {
+        return SRGAnalyticsEventTypeComScorePageView;
+    }
+    else if (labels[@"ns_st_ev"]) {
+        return SRGAnalyticsEventTypeComScoreStreamEvent;
+    }
+    else {
+        return SRGAnalyticsEventTypeComScoreHiddenEvent;
+    }
+}
+
+@interface SRGAnalyticsEvent ()
+
+@property (nonatomic) SRGAnalyticsEventTypes type;
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) NSDictionary<NSString *, NSString *> *labels;
+@property (nonatomic) NSURL *URL;
+@property (nonatomic, copy) NSDictionary<NSString *, id> *input;
+@property (nonatomic) NSTimeInterval timestamp;
+
+@end
+
+@implementation SRGAnalyticsEvent
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithType:(SRGAnalyticsEventTypes)type name:(NSString *)name labels:(NSDictionary<NSString *,NSString *> *)labels URL:(NSURL *)URL input:(NSDictionary<NSString *,id> *)input timestamp:(NSTimeInterval)timestamp
+{
+    if (self = [super init]) {
+        self.type = type;
+        self.name = name;
+        self.labels = labels ?: @{};
+        self.URL = URL;
+        self.input = input;
+        self.timestamp = timestamp;
+    }
+    return self;
+}
+
+- (instancetype)initWithType:(SRGAnalyticsEventTypes)type name:(NSString *)name labels:(NSDictionary<NSString *,NSString *> *)labels URL:(NSURL *)URL timestamp:(NSTimeInterval)timestamp
+{
+    return [self initWithType:type name:name labels:labels URL:URL input:nil timestamp:timestamp];
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithType:0 name:nil labels:nil URL:nil input:nil timestamp:0.];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; type = %@; name = %@; labels = %@; URL = %@; input = %@; timestamp = %@>",
+            self.class,
+            self,
+            @(self.type),
+            self.name,
+            self.labels,
+            self.URL,
+            self.input,
+            @(self.timestamp)];
+}
+
+@end
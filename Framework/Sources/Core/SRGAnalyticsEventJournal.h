@@ -0,0 +1,67 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Block called when journal entries must be sent.
+ */
+typedef void (^SRGAnalyticsEventJournalFlushBlock)(NSArray<NSDictionary<NSString *, NSString *> *> *labelsArray);
+
+/**
+ *  Append-only on-disk journal of event labels, flushed in batches. Each entry is written to the journal file as soon
+ *  as it is received, so that entries not flushed yet are not lost if the application is terminated. Entries found
+ *  in the journal file when the journal is created are read and flushed as soon as possible on the journal queue. Other
+ *  entries are also kept in memory, so that the file is never read back while the journal is running.
+ *
+ *  Entries are flushed when the batch size is reached, when the flush interval has elapsed since the first entry of
+ *  the current batch was received, or when the application enters the background.
+ *
+ *  The journal is not thread-safe. Except for its creation, it must only be used from the queue it was created with.
+ */
+@interface SRGAnalyticsEventJournal : NSObject
+
+/**
+ *  Create a journal.
+ *
+ *  @param fileURL       The URL of the journal file. The file is created if it does not exist.
+ *  @param queue         The serial queue from which the journal is used, and on which the flush block is called.
+ *  @param batchSize     The number of entries triggering a flush.
+ *  @param flushInterval The maximum time interval entries can be kept in the journal before being flushed.
+ *  @param flushBlock    The block called to send entries. Entries are removed from the journal afterwards.
+ */
+- (instancetype)initWithFileURL:(NSURL *)fileURL
+                          queue:(dispatch_queue_t)queue
+                      batchSize:(NSUInteger)batchSize
+                  flushInterval:(NSTimeInterval)flushInterval
+                     flushBlock:(SRGAnalyticsEventJournalFlushBlock)flushBlock;
+
+/**
+ *  Append labels to the journal.
+ */
+- (void)appendLabels:(NSDictionary<NSString *, NSString *> *)labels;
+
+/**
+ *  Send all entries currently in the journal.
+ */
+- (void)flush;
+
+/**
+ *  The number of entries currently in the journal.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+@end
+
+@interface SRGAnalyticsEventJournal (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
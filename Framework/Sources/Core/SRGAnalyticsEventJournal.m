@@ -0,0 +1,246 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsEventJournal.h"
+
+#import "SRGAnalyticsLogger.h"
+
+#import <fcntl.h>
+#import <libextobjc/libextobjc.h>
+#import <sys/stat.h>
+#import <UIKit/UIKit.h>
+#import <unistd.h>
+
+@interface SRGAnalyticsEventJournal ()
+
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) NSUInteger batchSize;
+@property (nonatomic) NSTimeInterval flushInterval;
+@property (nonatomic, copy) SRGAnalyticsEventJournalFlushBlock flushBlock;
+
+@property (nonatomic) int fileDescriptor;
+
+// Entries currently in the journal, kept in memory so that the file is only read for entries left from a previous
+// session. Those are read on the queue, the first time the journal is used
+@property (nonatomic) NSMutableArray<NSDictionary<NSString *, NSString *> *> *entries;
+@property (nonatomic) off_t leftoverLength;
+@property (nonatomic, getter=areLeftoverEntriesLoaded) BOOL leftoverEntriesLoaded;
+
+@property (nonatomic) dispatch_source_t flushTimer;
+
+@end
+
+@implementation SRGAnalyticsEventJournal
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithFileURL:(NSURL *)fileURL
+                          queue:(dispatch_queue_t)queue
+                      batchSize:(NSUInteger)batchSize
+                  flushInterval:(NSTimeInterval)flushInterval
+                     flushBlock:(SRGAnalyticsEventJournalFlushBlock)flushBlock
+{
+    if (self = [super init]) {
+        self.fileURL = fileURL;
+        self.queue = queue;
+        self.batchSize = MAX(batchSize, 1);
+        self.flushInterval = flushInterval;
+        self.flushBlock = flushBlock;
+        self.entries = [NSMutableArray array];
+        
+        [NSFileManager.defaultManager createDirectoryAtURL:fileURL.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:NULL];
+        
+        // Each entry is appended with a single write. An entry interrupted by a crash is therefore the last one in the
+        // file, and is simply discarded when the file is read
+        self.fileDescriptor = open(fileURL.fileSystemRepresentation, O_RDWR | O_CREAT | O_APPEND, 0600);
+        if (self.fileDescriptor < 0) {
+            SRGAnalyticsLogError(@"journal", @"The journal file %@ could not be opened. Events will be sent without journaling", fileURL);
+        }
+        else {
+            // Entries contain user-related labels. Keep them encrypted until the device has been unlocked once, but
+            // available afterwards, as events are also appended while the application runs in the background
+            NSDictionary<NSFileAttributeKey, id> *attributes = @{ NSFileProtectionKey : NSFileProtectionCompleteUntilFirstUserAuthentication };
+            if (! [NSFileManager.defaultManager setAttributes:attributes ofItemAtPath:fileURL.path error:NULL]) {
+                SRGAnalyticsLogWarning(@"journal", @"The protection of the journal file %@ could not be set", fileURL);
+            }
+            
+            // Entries left from a previous session are read and flushed on the queue, so that creating the journal
+            // stays cheap. Only their length is recorded, entries appended in the meantime being written after them
+            struct stat fileStatus;
+            if (fstat(self.fileDescriptor, &fileStatus) == 0 && fileStatus.st_size != 0) {
+                self.leftoverLength = fileStatus.st_size;
+                
+                @weakify(self)
+                dispatch_async(queue, ^{
+                    @strongify(self)
+                    [self flush];
+                });
+            }
+        }
+        
+        [NSNotificationCenter.defaultCenter addObserver:self
+                                               selector:@selector(applicationDidEnterBackground:)
+                                                   name:UIApplicationDidEnterBackgroundNotification
+                                                 object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    self.flushTimer = nil;          // Cancel timer
+    
+    if (_fileDescriptor >= 0) {
+        close(_fileDescriptor);
+    }
+}
+
+#pragma mark Getters and setters
+
+- (void)setFlushTimer:(dispatch_source_t)flushTimer
+{
+    if (_flushTimer) {
+        dispatch_source_cancel(_flushTimer);
+    }
+    _flushTimer = flushTimer;
+}
+
+#pragma mark Journal
+
+- (void)appendLabels:(NSDictionary<NSString *, NSString *> *)labels
+{
+    if (self.fileDescriptor < 0) {
+        self.flushBlock(@[ labels ]);
+        return;
+    }
+    
+    NSData *data = [NSJSONSerialization dataWithJSONObject:labels options:0 error:NULL];
+    if (! data) {
+        SRGAnalyticsLogError(@"journal", @"Labels %@ could not be serialized. Skipped", labels);
+        return;
+    }
+    
+    // Entries are written as a 32-bit big-endian length, followed by the JSON data
+    uint32_t length = CFSwapInt32HostToBig((uint32_t)data.length);
+    NSMutableData *entryData = [NSMutableData dataWithBytes:&length length:sizeof(length)];
+    [entryData appendData:data];
+    
+    if (write(self.fileDescriptor, entryData.bytes, entryData.length) != (ssize_t)entryData.length) {
+        SRGAnalyticsLogError(@"journal", @"Labels could not be written to the journal. Sent immediately");
+        self.flushBlock(@[ labels ]);
+        return;
+    }
+    
+    [self.entries addObject:[labels copy]];
+    
+    if (self.count >= self.batchSize) {
+        [self flush];
+    }
+    else if (! self.flushTimer) {
+        dispatch_source_t flushTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.queue);
+        dispatch_source_set_timer(flushTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.flushInterval * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, (uint64_t)(0.1 * self.flushInterval * NSEC_PER_SEC));
+        
+        @weakify(self)
+        dispatch_source_set_event_handler(flushTimer, ^{
+            @strongify(self)
+            [self flush];
+        });
+        dispatch_resume(flushTimer);
+        self.flushTimer = flushTimer;
+    }
+}
+
+- (void)flush
+{
+    self.flushTimer = nil;
+    
+    [self loadLeftoverEntriesIfNeeded];
+    
+    NSArray<NSDictionary<NSString *, NSString *> *> *entries = [self.entries copy];
+    if (entries.count != 0) {
+        self.flushBlock(entries);
+    }
+    
+    if (self.fileDescriptor >= 0) {
+        ftruncate(self.fileDescriptor, 0);
+    }
+    [self.entries removeAllObjects];
+}
+
+- (NSUInteger)count
+{
+    [self loadLeftoverEntriesIfNeeded];
+    return self.entries.count;
+}
+
+- (void)loadLeftoverEntriesIfNeeded
+{
+    if (self.leftoverEntriesLoaded) {
+        return;
+    }
+    
+    self.leftoverEntriesLoaded = YES;
+    
+    if (self.leftoverLength == 0) {
+        return;
+    }
+    
+    // Leftover entries precede entries appended since the journal was created
+    NSArray<NSDictionary<NSString *, NSString *> *> *leftoverEntries = [self leftoverEntries];
+    [self.entries insertObjects:leftoverEntries atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, leftoverEntries.count)]];
+}
+
+- (NSArray<NSDictionary<NSString *, NSString *> *> *)leftoverEntries
+{
+    NSData *data = [NSData dataWithContentsOfURL:self.fileURL options:NSDataReadingMappedIfSafe error:NULL];
+    const uint8_t *bytes = data.bytes;
+    NSUInteger dataLength = MIN(data.length, (NSUInteger)self.leftoverLength);
+    NSUInteger offset = 0;
+    
+    NSMutableArray<NSDictionary<NSString *, NSString *> *> *entries = [NSMutableArray array];
+    while (offset + sizeof(uint32_t) <= dataLength) {
+        uint32_t length = 0;
+        memcpy(&length, bytes + offset, sizeof(length));
+        length = CFSwapInt32BigToHost(length);
+        offset += sizeof(length);
+        
+        // Truncated entry
+        if (offset + length > dataLength) {
+            break;
+        }
+        
+        id JSONObject = [NSJSONSerialization JSONObjectWithData:[data subdataWithRange:NSMakeRange(offset, length)] options:0 error:NULL];
+        if ([JSONObject isKindOfClass:NSDictionary.class]) {
+            [entries addObject:JSONObject];
+        }
+        offset += length;
+    }
+    return [entries copy];
+}
+
+#pragma mark Notifications
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+    UIApplication *application = UIApplication.sharedApplication;
+    __block UIBackgroundTaskIdentifier backgroundTaskIdentifier = [application beginBackgroundTaskWithExpirationHandler:^{
+        [application endBackgroundTask:backgroundTaskIdentifier];
+        backgroundTaskIdentifier = UIBackgroundTaskInvalid;
+    }];
+    
+    @weakify(self)
+    dispatch_async(self.queue, ^{
+        @strongify(self)
+        [self flush];
+        
+        if (backgroundTaskIdentifier != UIBackgroundTaskInvalid) {
+            [application endBackgroundTask:backgroundTaskIdentifier];
+        }
+    });
+}
+
+@end
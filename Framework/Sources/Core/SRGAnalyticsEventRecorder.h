@@ -0,0 +1,54 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsEvent.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Event sink recording events to a file, as newline-delimited JSON. Each line describes an event with its type, name,
+ *  labels, URL and input, as well as its time (in seconds) relative to the recorder creation, e.g.
+ *
+ *    {"time":1.25,"type":"hidden_event","name":"hidden_event","labels":{"event_id":"hidden_event"},"input":{"name":"Hidden event"}}
+ *
+ *  Events are written in the background, in the order in which they are received.
+ */
+@interface SRGAnalyticsEventRecorder : NSObject <SRGAnalyticsEventSink>
+
+/**
+ *  Read events from a recording. Event timestamps are times relative to the start of the recording. Lines which cannot
+ *  be read are skipped.
+ *
+ *  @return The events, `nil` if the file cannot be read.
+ */
++ (nullable NSArray<SRGAnalyticsEvent *> *)eventsWithContentsOfFileURL:(NSURL *)fileURL;
+
+/**
+ *  Create a recorder writing to the specified file, replacing any existing file.
+ */
+- (instancetype)initWithFileURL:(NSURL *)fileURL;
+
+/**
+ *  The file events are recorded to.
+ */
+@property (nonatomic, readonly) NSURL *fileURL;
+
+/**
+ *  Write pending events and close the file. Events received afterwards are discarded.
+ */
+- (void)close;
+
+@end
+
+@interface SRGAnalyticsEventRecorder (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
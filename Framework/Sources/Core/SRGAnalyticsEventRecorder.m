@@ -0,0 +1,211 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsEventRecorder.h"
+
+#import "SRGAnalyticsEvent+Private.h"
+#import "SRGAnalyticsLogger.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+
+static NSDictionary<NSNumber *, NSString *> *SRGAnalyticsEventTypeNames(void)
+{
+    static NSDictionary<NSNumber *, NSString *> *s_names;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_names = @{ @(SRGAnalyticsEventTypePageView) : @"page_view",
+                     @(SRGAnalyticsEventTypeHiddenEvent) : @"hidden_event",
+                     @(SRGAnalyticsEventTypeStreamEvent) : @"stream_event",
+                     @(SRGAnalyticsEventTypeComScorePageView) : @"comscore_page_view",
+                     @(SRGAnalyticsEventTypeComScoreHiddenEvent) : @"comscore_hidden_event",
+                     @(SRGAnalyticsEventTypeComScoreStreamEvent) : @"comscore_stream_event",
+                     @(SRGAnalyticsEventTypeNetMetrixView) : @"netmetrix_view" };
+    });
+    return s_names;
+}
+
+static NSDictionary<NSString *, NSNumber *> *SRGAnalyticsEventTypesByName(void)
+{
+    static NSDictionary<NSString *, NSNumber *> *s_types;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        NSDictionary<NSNumber *, NSString *> *names = SRGAnalyticsEventTypeNames();
+        s_types = [NSDictionary dictionaryWithObjects:names.allKeys forKeys:names.allValues];
+    });
+    return s_types;
+}
+
+@interface SRGAnalyticsEventRecorder ()
+
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) NSTimeInterval startTimestamp;
+
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) int fileDescriptor;                   // Only accessed from the queue after initialization
+
+@end
+
+@implementation SRGAnalyticsEventRecorder
+
+#pragma mark Class methods
+
++ (NSArray<SRGAnalyticsEvent *> *)eventsWithContentsOfFileURL:(NSURL *)fileURL
+{
+    NSString *contents = [NSString stringWithContentsOfURL:fileURL encoding:NSUTF8StringEncoding error:NULL];
+    if (! contents) {
+        SRGAnalyticsLogError(@"recorder", @"The recording %@ could not be read", fileURL);
+        return nil;
+    }
+    
+    NSMutableArray<SRGAnalyticsEvent *> *events = [NSMutableArray array];
+    [contents enumerateLinesUsingBlock:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
+        if (line.length == 0) {
+            return;
+        }
+        
+        SRGAnalyticsEvent *event = [self eventFromLine:line];
+        if (event) {
+            [events addObject:event];
+        }
+        else {
+            SRGAnalyticsLogWarning(@"recorder", @"Invalid line %@. Skipped", line);
+        }
+    }];
+    return [events copy];
+}
+
++ (SRGAnalyticsEvent *)eventFromLine:(NSString *)line
+{
+    id JSONObject = [NSJSONSerialization JSONObjectWithData:[line dataUsingEncoding:NSUTF8StringEncoding] options:0 error:NULL];
+    if (! [JSONObject isKindOfClass:NSDictionary.class]) {
+        return nil;
+    }
+    
+    NSDictionary *dictionary = JSONObject;
+    
+    NSNumber *type = SRGAnalyticsEventTypesByName()[dictionary[@"type"]];
+    NSNumber *time = dictionary[@"time"];
+    if (! type || ! [time isKindOfClass:NSNumber.class]) {
+        return nil;
+    }
+    
+    NSString *name = dictionary[@"name"];
+    if (name && ! [name isKindOfClass:NSString.class]) {
+        return nil;
+    }
+    
+    NSDictionary<NSString *, NSString *> *labels = dictionary[@"labels"];
+    if (labels && ! [labels isKindOfClass:NSDictionary.class]) {
+        return nil;
+    }
+    
+    NSString *URLString = dictionary[@"url"];
+    NSURL *URL = [URLString isKindOfClass:NSString.class] ? [NSURL URLWithString:URLString] : nil;
+    
+    NSDictionary<NSString *, id> *input = dictionary[@"input"];
+    if (input && ! [input isKindOfClass:NSDictionary.class]) {
+        return nil;
+    }
+    
+    return [[SRGAnalyticsEvent alloc] initWithType:type.unsignedIntegerValue name:name labels:labels URL:URL input:input timestamp:time.doubleValue];
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithFileURL:(NSURL *)fileURL
+{
+    if (self = [super init]) {
+        self.fileURL = fileURL;
+        self.startTimestamp = SRGAnalyticsEventCurrentTimestamp();
+        self.queue = dispatch_queue_create("ch.srgssr.analytics.recorder", DISPATCH_QUEUE_SERIAL);
+        
+        [NSFileManager.defaultManager createDirectoryAtURL:fileURL.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:NULL];
+        
+        self.fileDescriptor = open(fileURL.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0600);
+        if (self.fileDescriptor < 0) {
+            SRGAnalyticsLogError(@"recorder", @"The recording file %@ could not be opened. No events will be recorded", fileURL);
+        }
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithFileURL:[NSURL fileURLWithPath:@"/dev/null"]];
+}
+
+#pragma clang diagnostic pop
+
+- (void)dealloc
+{
+    if (_fileDescriptor >= 0) {
+        close(_fileDescriptor);
+    }
+}
+
+#pragma mark Recording
+
+- (void)close
+{
+    dispatch_sync(self.queue, ^{
+        if (self.fileDescriptor >= 0) {
+            close(self.fileDescriptor);
+            self.fileDescriptor = -1;
+        }
+    });
+}
+
+#pragma mark SRGAnalyticsEventSink protocol
+
+- (void)tracker:(SRGAnalyticsTracker *)tracker didSendEvent:(SRGAnalyticsEvent *)event
+{
+    // Serialize on the calling thread, so that only writes are serialized on the recorder queue
+    NSMutableDictionary<NSString *, id> *dictionary = [NSMutableDictionary dictionary];
+    dictionary[@"time"] = @(event.timestamp - self.startTimestamp);
+    dictionary[@"type"] = SRGAnalyticsEventTypeNames()[@(event.type)];
+    dictionary[@"name"] = event.name;
+    if (event.labels.count != 0) {
+        dictionary[@"labels"] = event.labels;
+    }
+    dictionary[@"url"] = event.URL.absoluteString;
+    dictionary[@"input"] = event.input;
+    
+    NSMutableData *lineData = [[NSJSONSerialization dataWithJSONObject:dictionary options:0 error:NULL] mutableCopy];
+    if (! lineData) {
+        SRGAnalyticsLogError(@"recorder", @"Event %@ could not be serialized. Skipped", event);
+        return;
+    }
+    [lineData appendBytes:"\n" length:1];
+    
+    dispatch_async(self.queue, ^{
+        if (self.fileDescriptor < 0) {
+            return;
+        }
+        
+        // Each line is appended with a single write. A line interrupted by a crash is therefore the last one in the file,
+        // and is simply skipped when the file is read
+        if (write(self.fileDescriptor, lineData.bytes, lineData.length) != (ssize_t)lineData.length) {
+            SRGAnalyticsLogError(@"recorder", @"Event could not be written to %@", self.fileURL);
+        }
+    });
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; fileURL = %@>",
+            self.class,
+            self,
+            self.fileURL];
+}
+
+@end
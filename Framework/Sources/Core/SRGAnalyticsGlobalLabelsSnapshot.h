@@ -0,0 +1,46 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsLabelSet.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Immutable snapshot of the labels sent with every TagCommander event. A snapshot is never modified. Global labels
+ *  are updated by replacing the current snapshot with a new one, with a greater version number.
+ */
+@interface SRGAnalyticsGlobalLabelsSnapshot : NSObject
+
+/**
+ *  Create a snapshot with the specified labels and version.
+ */
+- (instancetype)initWithLabels:(nullable NSDictionary<NSString *, NSString *> *)labels version:(NSUInteger)version;
+
+/**
+ *  The snapshot version.
+ */
+@property (nonatomic, readonly) NSUInteger version;
+
+/**
+ *  The global labels.
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *labels;
+
+/**
+ *  Label set referencing the global labels, which event label sets can use as parent. The label set is shared and
+ *  must not be mutated.
+ */
+@property (nonatomic, readonly) SRGAnalyticsLabelSet *labelSet;
+
+@end
+
+@interface SRGAnalyticsGlobalLabelsSnapshot (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,53 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsGlobalLabelsSnapshot.h"
+
+@interface SRGAnalyticsGlobalLabelsSnapshot ()
+
+@property (nonatomic) NSUInteger version;
+@property (nonatomic, copy) NSDictionary<NSString *, NSString *> *labels;
+@property (nonatomic) SRGAnalyticsLabelSet *labelSet;
+
+@end
+
+@implementation SRGAnalyticsGlobalLabelsSnapshot
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithLabels:(NSDictionary<NSString *,NSString *> *)labels version:(NSUInteger)version
+{
+    if (self = [super init]) {
+        self.version = version;
+        self.labels = labels ?: @{};
+        self.labelSet = [SRGAnalyticsLabelSet labelSetWithDictionary:self.labels parent:nil];
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithLabels:nil version:0];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; version = %@; labels = %@>",
+            self.class,
+            self,
+            @(self.version),
+            self.labels];
+}
+
+@end
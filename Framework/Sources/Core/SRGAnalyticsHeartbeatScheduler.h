@@ -0,0 +1,105 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsClock.h"
+#import "SRGAnalyticsLabelSet.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Forward declarations
+@class SRGAnalyticsHeartbeatScheduler;
+
+/**
+ *  Block called with the labels of the heartbeat events produced at a common tick.
+ */
+typedef void (^SRGAnalyticsHeartbeatSchedulerSendBlock)(NSArray<SRGAnalyticsLabelSet *> *labelSets);
+
+/**
+ *  Heartbeat scheduler client.
+ */
+@protocol SRGAnalyticsHeartbeatSchedulerClient <NSObject>
+
+/**
+ *  Return the labels of the heartbeat events to send for the current tick (if any).
+ */
+- (NSArray<SRGAnalyticsLabelSet *> *)heartbeatLabelSetsForScheduler:(SRGAnalyticsHeartbeatScheduler *)scheduler;
+
+@end
+
+/**
+ *  Heartbeat scheduler shared by all clients needing periodic heartbeats. Clients are aligned onto common ticks: a client
+ *  whose next heartbeat is due within the scheduler tolerance of a tick is served at this tick, so that heartbeats of
+ *  concurrent clients are sent together, with a single wake-up. The scheduler is suspended when it has no clients.
+ *
+ *  Clients are weakly referenced. The scheduler must be used from the thread on which its clock executes timers.
+ */
+@interface SRGAnalyticsHeartbeatScheduler : NSObject
+
+/**
+ *  The scheduler used by stream trackers. Its interval is set when the tracker is started, according to its configuration.
+ */
+@property (class, nonatomic, readonly) SRGAnalyticsHeartbeatScheduler *sharedScheduler;
+
+/**
+ *  Create a scheduler.
+ *
+ *  @param clock     The clock to use.
+ *  @param interval  The heartbeat interval.
+ *  @param tolerance The maximum time interval by which a heartbeat can be sent earlier or later to be aligned with
+ *                   other heartbeats.
+ *  @param sendBlock The block called with the heartbeat events produced at each tick.
+ */
+- (instancetype)initWithClock:(id<SRGAnalyticsClock>)clock
+                     interval:(NSTimeInterval)interval
+                    tolerance:(NSTimeInterval)tolerance
+                    sendBlock:(SRGAnalyticsHeartbeatSchedulerSendBlock)sendBlock;
+
+/**
+ *  The clock used by the scheduler.
+ */
+@property (nonatomic, readonly) id<SRGAnalyticsClock> clock;
+
+/**
+ *  The heartbeat interval and tolerance.
+ */
+@property (nonatomic, readonly) NSTimeInterval interval;
+@property (nonatomic, readonly) NSTimeInterval tolerance;
+
+/**
+ *  Change the heartbeat interval and tolerance. Subsequent heartbeats are sent with the new interval. Heartbeats which
+ *  were due later than one new interval from now are brought forward.
+ */
+- (void)setInterval:(NSTimeInterval)interval tolerance:(NSTimeInterval)tolerance;
+
+/**
+ *  Add a client. Its first heartbeat is due after one interval. Does nothing if the client was already added.
+ */
+- (void)addClient:(id<SRGAnalyticsHeartbeatSchedulerClient>)client;
+
+/**
+ *  Remove a client.
+ */
+- (void)removeClient:(id<SRGAnalyticsHeartbeatSchedulerClient>)client;
+
+/**
+ *  Return `YES` iff the specified client has been added.
+ */
+- (BOOL)containsClient:(id<SRGAnalyticsHeartbeatSchedulerClient>)client;
+
+/**
+ *  Return `YES` iff the scheduler is suspended (no tick is scheduled).
+ */
+@property (nonatomic, readonly, getter=isSuspended) BOOL suspended;
+
+@end
+
+@interface SRGAnalyticsHeartbeatScheduler (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,217 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsHeartbeatScheduler.h"
+
+#import "SRGAnalyticsTracker+Private.h"
+
+#import <libextobjc/libextobjc.h>
+
+@interface SRGAnalyticsHeartbeatScheduler ()
+
+@property (nonatomic) id<SRGAnalyticsClock> clock;
+@property (nonatomic) NSTimeInterval interval;
+@property (nonatomic) NSTimeInterval tolerance;
+@property (nonatomic, copy) SRGAnalyticsHeartbeatSchedulerSendBlock sendBlock;
+
+// Next heartbeat time for each client
+@property (nonatomic) NSMapTable<id<SRGAnalyticsHeartbeatSchedulerClient>, NSNumber *> *dueTimes;
+
+@property (nonatomic) SRGAnalyticsClockTimer *timer;
+
+@end
+
+@implementation SRGAnalyticsHeartbeatScheduler
+
+#pragma mark Class methods
+
++ (SRGAnalyticsHeartbeatScheduler *)sharedScheduler
+{
+    static SRGAnalyticsHeartbeatScheduler *s_sharedScheduler;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        SRGAnalyticsTracker *tracker = SRGAnalyticsTracker.sharedTracker;
+        s_sharedScheduler = [[SRGAnalyticsHeartbeatScheduler alloc] initWithClock:SRGAnalyticsSystemClock.sharedClock
+                                                                          interval:30.
+                                                                         tolerance:3.
+                                                                         sendBlock:^(NSArray<SRGAnalyticsLabelSet *> *labelSets) {
+            [tracker trackTagCommanderEventsWithLabelSets:labelSets];
+        }];
+    });
+    return s_sharedScheduler;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithClock:(id<SRGAnalyticsClock>)clock
+                     interval:(NSTimeInterval)interval
+                    tolerance:(NSTimeInterval)tolerance
+                    sendBlock:(SRGAnalyticsHeartbeatSchedulerSendBlock)sendBlock
+{
+    if (self = [super init]) {
+        self.clock = clock;
+        self.interval = interval;
+        self.tolerance = tolerance;
+        self.sendBlock = sendBlock;
+        self.dueTimes = [NSMapTable weakToStrongObjectsMapTable];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    self.timer = nil;               // Invalidate timer
+}
+
+#pragma mark Getters and setters
+
+- (void)setTimer:(SRGAnalyticsClockTimer *)timer
+{
+    [_timer invalidate];
+    _timer = timer;
+}
+
+- (BOOL)isSuspended
+{
+    return self.timer == nil;
+}
+
+- (void)setInterval:(NSTimeInterval)interval tolerance:(NSTimeInterval)tolerance
+{
+    if (interval == self.interval && tolerance == self.tolerance) {
+        return;
+    }
+    
+    self.interval = interval;
+    self.tolerance = tolerance;
+    
+    NSTimeInterval latestDueTime = self.clock.currentTime + interval;
+    for (id<SRGAnalyticsHeartbeatSchedulerClient> client in self.dueTimes.keyEnumerator.allObjects) {
+        if ([self.dueTimes objectForKey:client].doubleValue > latestDueTime) {
+            [self.dueTimes setObject:@(latestDueTime) forKey:client];
+        }
+    }
+    
+    // Reschedule, as the timer tolerance might have changed as well
+    self.timer = nil;
+    [self scheduleTick];
+}
+
+#pragma mark Clients
+
+- (void)addClient:(id<SRGAnalyticsHeartbeatSchedulerClient>)client
+{
+    if ([self containsClient:client]) {
+        return;
+    }
+    
+    NSTimeInterval dueTime = [self alignedTime:self.clock.currentTime + self.interval withReferenceTime:[self earliestDueTime]];
+    [self.dueTimes setObject:@(dueTime) forKey:client];
+    [self scheduleTick];
+}
+
+- (void)removeClient:(id<SRGAnalyticsHeartbeatSchedulerClient>)client
+{
+    if (! [self containsClient:client]) {
+        return;
+    }
+    
+    [self.dueTimes removeObjectForKey:client];
+    [self scheduleTick];
+}
+
+- (BOOL)containsClient:(id<SRGAnalyticsHeartbeatSchedulerClient>)client
+{
+    return [self.dueTimes objectForKey:client] != nil;
+}
+
+#pragma mark Ticks
+
+// Return the earliest due time, or `DBL_MAX` if there is no client
+- (NSTimeInterval)earliestDueTime
+{
+    // Deallocated clients are automatically removed from the map table, and therefore not enumerated
+    NSTimeInterval earliestDueTime = DBL_MAX;
+    for (id<SRGAnalyticsHeartbeatSchedulerClient> client in self.dueTimes.keyEnumerator) {
+        earliestDueTime = MIN(earliestDueTime, [self.dueTimes objectForKey:client].doubleValue);
+    }
+    return earliestDueTime;
+}
+
+// Shift the specified time toward the closest tick of the reference time grid, by at most the tolerance. Clients
+// whose heartbeats cannot be aligned immediately are therefore progressively aligned over the next ticks
+- (NSTimeInterval)alignedTime:(NSTimeInterval)time withReferenceTime:(NSTimeInterval)referenceTime
+{
+    if (referenceTime == DBL_MAX) {
+        return time;
+    }
+    
+    NSTimeInterval offset = remainder(referenceTime - time, self.interval);
+    return time + fmax(-self.tolerance, fmin(offset, self.tolerance));
+}
+
+- (void)scheduleTick
+{
+    NSTimeInterval tickTime = [self earliestDueTime];
+    if (tickTime == DBL_MAX) {
+        self.timer = nil;
+        return;
+    }
+    
+    if (self.timer && self.timer.fireTime == tickTime) {
+        return;
+    }
+    
+    @weakify(self)
+    self.timer = [self.clock scheduleTimerWithFireTime:tickTime tolerance:self.tolerance block:^{
+        @strongify(self)
+        [self tickAtTime:tickTime];
+    }];
+}
+
+- (void)tickAtTime:(NSTimeInterval)tickTime
+{
+    _timer = nil;                   // Already fired
+    
+    // If the timer fired late (e.g. because the application was suspended), missed ticks are skipped and the tick is
+    // made at the current time. Catching up would otherwise send a burst of heartbeats
+    NSTimeInterval currentTime = self.clock.currentTime;
+    if (currentTime > tickTime + self.tolerance) {
+        tickTime = currentTime;
+    }
+    
+    // Serve all clients due within the tolerance
+    NSMutableArray<id<SRGAnalyticsHeartbeatSchedulerClient>> *servedClients = [NSMutableArray array];
+    NSMutableArray<SRGAnalyticsLabelSet *> *labelSets = [NSMutableArray array];
+    for (id<SRGAnalyticsHeartbeatSchedulerClient> client in self.dueTimes.keyEnumerator.allObjects) {
+        if ([self.dueTimes objectForKey:client].doubleValue > tickTime + self.tolerance) {
+            continue;
+        }
+        
+        [labelSets addObjectsFromArray:[client heartbeatLabelSetsForScheduler:self]];
+        
+        // The client might have been removed in the meantime
+        if ([self containsClient:client]) {
+            [servedClients addObject:client];
+            [self.dueTimes removeObjectForKey:client];
+        }
+    }
+    
+    // Served clients now share the same next tick, computed from the tick time so that the delay with which timers
+    // actually fire (within tolerance) does not accumulate. Remaining clients are used as reference for alignment
+    NSTimeInterval nextTickTime = [self alignedTime:tickTime + self.interval withReferenceTime:[self earliestDueTime]];
+    for (id<SRGAnalyticsHeartbeatSchedulerClient> client in servedClients) {
+        [self.dueTimes setObject:@(nextTickTime) forKey:client];
+    }
+    
+    if (labelSets.count != 0) {
+        self.sendBlock([labelSets copy]);
+    }
+    
+    [self scheduleTick];
+}
+
+@end
@@ -6,40 +6,34 @@
 
 #import "SRGAnalyticsHiddenEventLabels.h"
 
-#import "NSMutableDictionary+SRGAnalytics.h"
+#import "SRGAnalyticsLabels+Private.h"
 
 @implementation SRGAnalyticsHiddenEventLabels
 
-#pragma mark Getters and setters
+#pragma mark Label sets
 
-- (NSDictionary<NSString *, NSString *> *)labelsDictionary
+- (void)fillLabelSet:(SRGAnalyticsLabelSet *)labelSet
 {
-    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
+    [labelSet setString:self.type forKey:@"event_type"];
+    [labelSet setString:self.value forKey:@"event_value"];
+    [labelSet setString:self.source forKey:@"event_source"];
     
-    [dictionary srg_safelySetString:self.type forKey:@"event_type"];
-    [dictionary srg_safelySetString:self.value forKey:@"event_value"];
-    [dictionary srg_safelySetString:self.source forKey:@"event_source"];
+    [labelSet setString:self.extraValue1 forKey:@"event_value_1"];
+    [labelSet setString:self.extraValue2 forKey:@"event_value_2"];
+    [labelSet setString:self.extraValue3 forKey:@"event_value_3"];
+    [labelSet setString:self.extraValue4 forKey:@"event_value_4"];
+    [labelSet setString:self.extraValue5 forKey:@"event_value_5"];
     
-    [dictionary srg_safelySetString:self.extraValue1 forKey:@"event_value_1"];
-    [dictionary srg_safelySetString:self.extraValue2 forKey:@"event_value_2"];
-    [dictionary srg_safelySetString:self.extraValue3 forKey:@"event_value_3"];
-    [dictionary srg_safelySetString:self.extraValue4 forKey:@"event_value_4"];
-    [dictionary srg_safelySetString:self.extraValue5 forKey:@"event_value_5"];
-    
-    [dictionary addEntriesFromDictionary:[super labelsDictionary]];
-    return [dictionary copy];
+    [super fillLabelSet:labelSet];
 }
 
-- (NSDictionary<NSString *, NSString *> *)comScoreLabelsDictionary
+- (void)fillComScoreLabelSet:(SRGAnalyticsLabelSet *)labelSet
 {
-    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
-    
-    [dictionary srg_safelySetString:self.type forKey:@"srg_evgroup"];
-    [dictionary srg_safelySetString:self.value forKey:@"srg_evvalue"];
-    [dictionary srg_safelySetString:self.source forKey:@"srg_evsource"];
+    [labelSet setString:self.type forKey:@"srg_evgroup"];
+    [labelSet setString:self.value forKey:@"srg_evvalue"];
+    [labelSet setString:self.source forKey:@"srg_evsource"];
     
-    [dictionary addEntriesFromDictionary:[super comScoreLabelsDictionary]];
-    return [dictionary copy];
+    [super fillComScoreLabelSet:labelSet];
 }
 
 #pragma mark NSCopying protocol
@@ -0,0 +1,69 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsInstrumentation.h"
+
+/**
+ *  Instrumentation is enabled for debug builds. For other builds, it can be enabled by defining the
+ *  `SRG_ANALYTICS_INSTRUMENTATION=1` preprocessor macro. When disabled, recording macros expand to nothing and
+ *  snapshots are not available.
+ */
+#ifndef SRG_ANALYTICS_INSTRUMENTATION
+#if DEBUG
+#define SRG_ANALYTICS_INSTRUMENTATION 1
+#else
+#define SRG_ANALYTICS_INSTRUMENTATION 0
+#endif
+#endif
+
+NS_ASSUME_NONNULL_BEGIN
+
+#define SRGAnalyticsInstrumentationStageCount (SRGAnalyticsInstrumentationStageApplicationListStartup + 1)
+#define SRGAnalyticsInstrumentationCounterCount (SRGAnalyticsInstrumentationCounterStreamSenseAllocations + 1)
+
+#if SRG_ANALYTICS_INSTRUMENTATION
+
+/**
+ *  Current time in nanoseconds, from an arbitrary origin.
+ */
+OBJC_EXPORT uint64_t SRGAnalyticsInstrumentationTime(void);
+
+/**
+ *  Record a duration (in nanoseconds) for a stage, or increment a counter, from any thread. Values are accumulated
+ *  per thread, without locking.
+ */
+OBJC_EXPORT void SRGAnalyticsInstrumentationRecordDuration(SRGAnalyticsInstrumentationStage stage, uint64_t duration);
+OBJC_EXPORT void SRGAnalyticsInstrumentationAddToCounter(SRGAnalyticsInstrumentationCounter counter, uint64_t value);
+
+/**
+ *  Return a snapshot of the values accumulated by all threads. If `reset` is `YES`, values are reset at the same time,
+ *  so that each recorded value is reflected in exactly one snapshot taken with reset.
+ */
+OBJC_EXPORT SRGAnalyticsInstrumentationSnapshot *SRGAnalyticsInstrumentationTakeSnapshot(BOOL reset);
+
+#define SRGAnalyticsInstrumentationTimestamp() SRGAnalyticsInstrumentationTime()
+#define SRGAnalyticsInstrumentationRecordStage(stage, timestamp) SRGAnalyticsInstrumentationRecordDuration(stage, SRGAnalyticsInstrumentationTime() - (timestamp))
+#define SRGAnalyticsInstrumentationCount(counter, value) SRGAnalyticsInstrumentationAddToCounter(counter, value)
+
+#else
+
+#define SRGAnalyticsInstrumentationTimestamp() ((uint64_t)0)
+#define SRGAnalyticsInstrumentationRecordStage(stage, timestamp) ((void)(timestamp))
+#define SRGAnalyticsInstrumentationCount(counter, value)
+
+#endif
+
+/**
+ *  Measure the duration of the specified statements for a stage.
+ */
+#define SRGAnalyticsInstrumentationMeasure(stage, ...) \
+    do { \
+        uint64_t srg_instrumentationTimestamp = SRGAnalyticsInstrumentationTimestamp(); \
+        __VA_ARGS__; \
+        SRGAnalyticsInstrumentationRecordStage(stage, srg_instrumentationTimestamp); \
+    } while (0)
+
+NS_ASSUME_NONNULL_END
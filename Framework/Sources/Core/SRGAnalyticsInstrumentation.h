@@ -0,0 +1,147 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Stages whose latencies are measured.
+ */
+typedef NS_ENUM(NSInteger, SRGAnalyticsInstrumentationStage) {
+    /**
+     *  Label assembly for all analytics services.
+     */
+    SRGAnalyticsInstrumentationStageLabelBuilding = 0,
+    /**
+     *  comScore SDK calls (views, hidden events and stream sense notifications).
+     */
+    SRGAnalyticsInstrumentationStageComScore,
+    /**
+     *  TagCommander SDK calls (labels added and sent).
+     */
+    SRGAnalyticsInstrumentationStageTagCommander,
+    /**
+     *  NetMetrix request creation, until the request is started.
+     */
+    SRGAnalyticsInstrumentationStageNetMetrix,
+    /**
+     *  NetMetrix request round-trips, from start to completion.
+     */
+    SRGAnalyticsInstrumentationStageNetMetrixRequest,
+    /**
+     *  Time spent by the caller of `-[SRGAnalyticsTracker startWithConfiguration:]`.
+     */
+    SRGAnalyticsInstrumentationStageStartup,
+    /**
+     *  TagCommander startup.
+     */
+    SRGAnalyticsInstrumentationStageTagCommanderStartup,
+    /**
+     *  comScore startup.
+     */
+    SRGAnalyticsInstrumentationStageComScoreStartup,
+    /**
+     *  NetMetrix startup.
+     */
+    SRGAnalyticsInstrumentationStageNetMetrixStartup,
+    /**
+     *  Installed application measurement startup.
+     */
+    SRGAnalyticsInstrumentationStageApplicationListStartup
+};
+
+/**
+ *  Counted occurrences.
+ */
+typedef NS_ENUM(NSInteger, SRGAnalyticsInstrumentationCounter) {
+    /**
+     *  Page views emitted.
+     */
+    SRGAnalyticsInstrumentationCounterPageViews = 0,
+    /**
+     *  Hidden events emitted.
+     */
+    SRGAnalyticsInstrumentationCounterHiddenEvents,
+    /**
+     *  Stream events emitted (play, pause, seek, stop, eof).
+     */
+    SRGAnalyticsInstrumentationCounterStreamEvents,
+    /**
+     *  Stream heartbeats emitted.
+     */
+    SRGAnalyticsInstrumentationCounterHeartbeats,
+    /**
+     *  Page views and hidden events dropped because of a missing title or name, and events dropped because too many
+     *  events were waiting to be processed.
+     */
+    SRGAnalyticsInstrumentationCounterDroppedEvents,
+    /**
+     *  Stream state updates rejected by TagCommander because the transition is not allowed.
+     */
+    SRGAnalyticsInstrumentationCounterRejectedStreamTransitions,
+    /**
+     *  comScore StreamSense objects created, rather than reused between playback sessions.
+     */
+    SRGAnalyticsInstrumentationCounterStreamSenseAllocations
+};
+
+/**
+ *  Instrumentation values accumulated by the library, process-wide.
+ *
+ *  Latencies are recorded in histograms with exponential buckets: the first bucket counts durations below 1 µs, then
+ *  each bucket counts durations up to twice those of the previous one. The last bucket counts all remaining durations.
+ *
+ *  Each value is read atomically, but a snapshot is not taken atomically as a whole. Values recorded while a snapshot
+ *  is being taken might therefore be partially reflected.
+ */
+@interface SRGAnalyticsInstrumentationSnapshot : NSObject
+
+/**
+ *  The number of buckets in each histogram.
+ */
+@property (class, nonatomic, readonly) NSUInteger histogramBucketCount;
+
+/**
+ *  The upper bound (exclusive) of the durations counted by the specified bucket, `INFINITY` for the last one.
+ */
++ (NSTimeInterval)upperBoundForHistogramBucketAtIndex:(NSUInteger)index;
+
+/**
+ *  The value of a counter.
+ */
+- (uint64_t)valueForCounter:(SRGAnalyticsInstrumentationCounter)counter;
+
+/**
+ *  The number of durations recorded for a stage.
+ */
+- (uint64_t)sampleCountForStage:(SRGAnalyticsInstrumentationStage)stage;
+
+/**
+ *  The sum of the durations recorded for a stage.
+ */
+- (NSTimeInterval)totalDurationForStage:(SRGAnalyticsInstrumentationStage)stage;
+
+/**
+ *  The number of durations recorded in each histogram bucket for a stage.
+ */
+- (NSArray<NSNumber *> *)histogramForStage:(SRGAnalyticsInstrumentationStage)stage;
+
+/**
+ *  Estimate of the duration below which the specified fraction (between 0 and 1) of the durations recorded for a stage
+ *  lies, i.e. the upper bound of the bucket in which the percentile is found. Returns 0 if no duration was recorded.
+ */
+- (NSTimeInterval)durationAtPercentile:(double)percentile forStage:(SRGAnalyticsInstrumentationStage)stage;
+
+@end
+
+@interface SRGAnalyticsInstrumentationSnapshot (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
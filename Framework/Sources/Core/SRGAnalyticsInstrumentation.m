@@ -0,0 +1,270 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsInstrumentation+Private.h"
+
+#import <mach/mach_time.h>
+#import <pthread.h>
+#import <stdatomic.h>
+
+// Bucket 0 counts durations below 1 µs, bucket i durations below 2^i µs. The last bucket counts all remaining durations
+#define SRGAnalyticsInstrumentationBucketCount 24
+
+typedef struct {
+    uint64_t counters[SRGAnalyticsInstrumentationCounterCount];
+    uint64_t sampleCounts[SRGAnalyticsInstrumentationStageCount];
+    uint64_t durations[SRGAnalyticsInstrumentationStageCount];
+    uint64_t buckets[SRGAnalyticsInstrumentationStageCount][SRGAnalyticsInstrumentationBucketCount];
+} SRGAnalyticsInstrumentationValues;
+
+static NSUInteger SRGAnalyticsInstrumentationBucketIndex(uint64_t duration)
+{
+    uint64_t microseconds = duration / 1000;
+    if (microseconds == 0) {
+        return 0;
+    }
+    
+    // Index of the highest bit set, plus one
+    NSUInteger index = 64 - __builtin_clzll(microseconds);
+    return MIN(index, (NSUInteger)SRGAnalyticsInstrumentationBucketCount - 1);
+}
+
+@interface SRGAnalyticsInstrumentationSnapshot () {
+@private
+    SRGAnalyticsInstrumentationValues _values;
+}
+
+@end
+
+@implementation SRGAnalyticsInstrumentationSnapshot
+
+#pragma mark Class methods
+
++ (NSUInteger)histogramBucketCount
+{
+    return SRGAnalyticsInstrumentationBucketCount;
+}
+
++ (NSTimeInterval)upperBoundForHistogramBucketAtIndex:(NSUInteger)index
+{
+    NSParameterAssert(index < SRGAnalyticsInstrumentationBucketCount);
+    return (index < SRGAnalyticsInstrumentationBucketCount - 1) ? ldexp(1e-6, (int)index) : INFINITY;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithValues:(const SRGAnalyticsInstrumentationValues *)values
+{
+    if (self = [super init]) {
+        _values = *values;
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    SRGAnalyticsInstrumentationValues values = { 0 };
+    return [self initWithValues:&values];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Getters
+
+- (uint64_t)valueForCounter:(SRGAnalyticsInstrumentationCounter)counter
+{
+    NSParameterAssert(counter >= 0 && counter < SRGAnalyticsInstrumentationCounterCount);
+    return _values.counters[counter];
+}
+
+- (uint64_t)sampleCountForStage:(SRGAnalyticsInstrumentationStage)stage
+{
+    NSParameterAssert(stage >= 0 && stage < SRGAnalyticsInstrumentationStageCount);
+    return _values.sampleCounts[stage];
+}
+
+- (NSTimeInterval)totalDurationForStage:(SRGAnalyticsInstrumentationStage)stage
+{
+    NSParameterAssert(stage >= 0 && stage < SRGAnalyticsInstrumentationStageCount);
+    return _values.durations[stage] / 1e9;
+}
+
+- (NSArray<NSNumber *> *)histogramForStage:(SRGAnalyticsInstrumentationStage)stage
+{
+    NSParameterAssert(stage >= 0 && stage < SRGAnalyticsInstrumentationStageCount);
+    
+    NSMutableArray<NSNumber *> *histogram = [NSMutableArray arrayWithCapacity:SRGAnalyticsInstrumentationBucketCount];
+    for (NSUInteger i = 0; i < SRGAnalyticsInstrumentationBucketCount; ++i) {
+        [histogram addObject:@(_values.buckets[stage][i])];
+    }
+    return [histogram copy];
+}
+
+- (NSTimeInterval)durationAtPercentile:(double)percentile forStage:(SRGAnalyticsInstrumentationStage)stage
+{
+    NSParameterAssert(stage >= 0 && stage < SRGAnalyticsInstrumentationStageCount);
+    
+    // Bucket values are not read at the same time as the sample count. Use their sum
+    uint64_t sampleCount = 0;
+    for (NSUInteger i = 0; i < SRGAnalyticsInstrumentationBucketCount; ++i) {
+        sampleCount += _values.buckets[stage][i];
+    }
+    if (sampleCount == 0) {
+        return 0.;
+    }
+    
+    uint64_t rank = MAX(ceil(fmin(fmax(percentile, 0.), 1.) * sampleCount), 1);
+    uint64_t cumulatedCount = 0;
+    for (NSUInteger i = 0; i < SRGAnalyticsInstrumentationBucketCount; ++i) {
+        cumulatedCount += _values.buckets[stage][i];
+        if (cumulatedCount >= rank) {
+            return [SRGAnalyticsInstrumentationSnapshot upperBoundForHistogramBucketAtIndex:i];
+        }
+    }
+    return INFINITY;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    NSMutableArray<NSString *> *stageDescriptions = [NSMutableArray array];
+    for (NSInteger stage = 0; stage < SRGAnalyticsInstrumentationStageCount; ++stage) {
+        [stageDescriptions addObject:[NSString stringWithFormat:@"%@ samples, %.6fs total, p50 < %.6fs, p99 < %.6fs",
+                                      @(_values.sampleCounts[stage]),
+                                      [self totalDurationForStage:stage],
+                                      [self durationAtPercentile:0.5 forStage:stage],
+                                      [self durationAtPercentile:0.99 forStage:stage]]];
+    }
+    
+    NSMutableArray<NSNumber *> *counters = [NSMutableArray array];
+    for (NSInteger counter = 0; counter < SRGAnalyticsInstrumentationCounterCount; ++counter) {
+        [counters addObject:@(_values.counters[counter])];
+    }
+    
+    return [NSString stringWithFormat:@"<%@: %p; stages = %@; counters = %@>",
+            self.class,
+            self,
+            stageDescriptions,
+            counters];
+}
+
+@end
+
+#if SRG_ANALYTICS_INSTRUMENTATION
+
+// Values accumulated by a thread. Only the owner thread adds to them, so that atomic additions never contend except
+// with snapshots taken with reset. Accumulators are never freed, and are reused by new threads when their owner exits
+// (keeping their values, which must still be reported).
+typedef struct SRGAnalyticsInstrumentationAccumulator {
+    _Atomic(uint64_t) counters[SRGAnalyticsInstrumentationCounterCount];
+    _Atomic(uint64_t) sampleCounts[SRGAnalyticsInstrumentationStageCount];
+    _Atomic(uint64_t) durations[SRGAnalyticsInstrumentationStageCount];
+    _Atomic(uint64_t) buckets[SRGAnalyticsInstrumentationStageCount][SRGAnalyticsInstrumentationBucketCount];
+    atomic_bool owned;
+    struct SRGAnalyticsInstrumentationAccumulator *next;                // Immutable once the accumulator is published
+} SRGAnalyticsInstrumentationAccumulator;
+
+static _Atomic(SRGAnalyticsInstrumentationAccumulator *) s_accumulators;
+static pthread_key_t s_accumulatorKey;
+
+static void SRGAnalyticsInstrumentationReleaseAccumulator(void *accumulator)
+{
+    atomic_store_explicit(&((SRGAnalyticsInstrumentationAccumulator *)accumulator)->owned, false, memory_order_release);
+}
+
+static SRGAnalyticsInstrumentationAccumulator *SRGAnalyticsInstrumentationCurrentAccumulator(void)
+{
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        pthread_key_create(&s_accumulatorKey, SRGAnalyticsInstrumentationReleaseAccumulator);
+    });
+    
+    SRGAnalyticsInstrumentationAccumulator *accumulator = pthread_getspecific(s_accumulatorKey);
+    if (accumulator) {
+        return accumulator;
+    }
+    
+    // Reuse an accumulator released by an exited thread, if any
+    for (SRGAnalyticsInstrumentationAccumulator *candidate = atomic_load_explicit(&s_accumulators, memory_order_acquire); candidate; candidate = candidate->next) {
+        bool owned = false;
+        if (atomic_compare_exchange_strong_explicit(&candidate->owned, &owned, true, memory_order_acquire, memory_order_relaxed)) {
+            accumulator = candidate;
+            break;
+        }
+    }
+    
+    if (! accumulator) {
+        // Zero-filled memory is a valid initial state for atomic values
+        accumulator = calloc(1, sizeof(SRGAnalyticsInstrumentationAccumulator));
+        atomic_init(&accumulator->owned, true);
+        
+        SRGAnalyticsInstrumentationAccumulator *head = atomic_load_explicit(&s_accumulators, memory_order_relaxed);
+        do {
+            accumulator->next = head;
+        } while (! atomic_compare_exchange_weak_explicit(&s_accumulators, &head, accumulator, memory_order_release, memory_order_relaxed));
+    }
+    
+    pthread_setspecific(s_accumulatorKey, accumulator);
+    return accumulator;
+}
+
+static uint64_t SRGAnalyticsInstrumentationRead(_Atomic(uint64_t) *value, BOOL reset)
+{
+    return reset ? atomic_exchange_explicit(value, 0, memory_order_relaxed) : atomic_load_explicit(value, memory_order_relaxed);
+}
+
+uint64_t SRGAnalyticsInstrumentationTime(void)
+{
+    static mach_timebase_info_data_t s_timebaseInfo;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        mach_timebase_info(&s_timebaseInfo);
+    });
+    return mach_absolute_time() * s_timebaseInfo.numer / s_timebaseInfo.denom;
+}
+
+void SRGAnalyticsInstrumentationRecordDuration(SRGAnalyticsInstrumentationStage stage, uint64_t duration)
+{
+    NSCParameterAssert(stage >= 0 && stage < SRGAnalyticsInstrumentationStageCount);
+    
+    SRGAnalyticsInstrumentationAccumulator *accumulator = SRGAnalyticsInstrumentationCurrentAccumulator();
+    atomic_fetch_add_explicit(&accumulator->sampleCounts[stage], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&accumulator->durations[stage], duration, memory_order_relaxed);
+    atomic_fetch_add_explicit(&accumulator->buckets[stage][SRGAnalyticsInstrumentationBucketIndex(duration)], 1, memory_order_relaxed);
+}
+
+void SRGAnalyticsInstrumentationAddToCounter(SRGAnalyticsInstrumentationCounter counter, uint64_t value)
+{
+    NSCParameterAssert(counter >= 0 && counter < SRGAnalyticsInstrumentationCounterCount);
+    
+    SRGAnalyticsInstrumentationAccumulator *accumulator = SRGAnalyticsInstrumentationCurrentAccumulator();
+    atomic_fetch_add_explicit(&accumulator->counters[counter], value, memory_order_relaxed);
+}
+
+SRGAnalyticsInstrumentationSnapshot *SRGAnalyticsInstrumentationTakeSnapshot(BOOL reset)
+{
+    SRGAnalyticsInstrumentationValues values = { 0 };
+    for (SRGAnalyticsInstrumentationAccumulator *accumulator = atomic_load_explicit(&s_accumulators, memory_order_acquire); accumulator; accumulator = accumulator->next) {
+        for (NSInteger counter = 0; counter < SRGAnalyticsInstrumentationCounterCount; ++counter) {
+            values.counters[counter] += SRGAnalyticsInstrumentationRead(&accumulator->counters[counter], reset);
+        }
+        for (NSInteger stage = 0; stage < SRGAnalyticsInstrumentationStageCount; ++stage) {
+            values.sampleCounts[stage] += SRGAnalyticsInstrumentationRead(&accumulator->sampleCounts[stage], reset);
+            values.durations[stage] += SRGAnalyticsInstrumentationRead(&accumulator->durations[stage], reset);
+            for (NSUInteger i = 0; i < SRGAnalyticsInstrumentationBucketCount; ++i) {
+                values.buckets[stage][i] += SRGAnalyticsInstrumentationRead(&accumulator->buckets[stage][i], reset);
+            }
+        }
+    }
+    return [[SRGAnalyticsInstrumentationSnapshot alloc] initWithValues:&values];
+}
+
+#endif
@@ -0,0 +1,88 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Compact set of string labels, used to assemble event labels without creating intermediate dictionaries.
+ *
+ *  Entries are stored in a flat array, in the order in which they were set, and indexed by a hash table stored in the
+ *  same allocation, so that lookups are made in constant time. Keys are usually constant string literals, which are
+ *  unique within a binary and can therefore be compared by pointer. Other keys are only compared as strings when their
+ *  hashes match.
+ *
+ *  A label set can be stacked onto a parent label set, and can be initialized with a dictionary it references
+ *  without copying it. Entries of a label set hide entries with the same key in the dictionary it was initialized
+ *  with, which themselves hide entries with the same key in the parent label set. Layers can therefore be chained
+ *  (e.g. global, media and event labels) without any copy being made.
+ *
+ *  A label set is not thread-safe, and must not be mutated once it has been handed over for tracking, or used
+ *  as parent for another label set.
+ */
+@interface SRGAnalyticsLabelSet : NSObject
+
+/**
+ *  Create an empty label set on top of the specified parent (if any).
+ */
++ (SRGAnalyticsLabelSet *)labelSetWithParent:(nullable SRGAnalyticsLabelSet *)parent;
+
+/**
+ *  Create a label set referencing the specified dictionary (if any), on top of the specified parent (if any).
+ */
++ (SRGAnalyticsLabelSet *)labelSetWithDictionary:(nullable NSDictionary<NSString *, NSString *> *)dictionary parent:(nullable SRGAnalyticsLabelSet *)parent;
+
+/**
+ *  The parent label set, if any.
+ */
+@property (nonatomic, readonly, nullable) SRGAnalyticsLabelSet *parent;
+
+/**
+ *  Set a string for the specified key. If the string is `nil`, any entry previously set for the key is removed
+ *  from the receiver (entries from the referenced dictionary or from the parent are not affected).
+ */
+- (void)setString:(nullable NSString *)string forKey:(NSString *)key;
+
+/**
+ *  Set all entries from the specified dictionary.
+ */
+- (void)addEntriesFromDictionary:(nullable NSDictionary<NSString *, NSString *> *)dictionary;
+
+/**
+ *  Return the string for the specified key, looked up in the receiver, then in its dictionary, then in its parent.
+ */
+- (nullable NSString *)objectForKeyedSubscript:(NSString *)key;
+
+/**
+ *  The number of distinct keys in the label set (including those of its dictionary and parent).
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ *  Enumerate distinct keys with their associated strings. Each key is enumerated once, with the string that
+ *  `-objectForKeyedSubscript:` would return for it.
+ */
+- (void)enumerateKeysAndObjectsUsingBlock:(void (NS_NOESCAPE ^)(NSString *key, NSString *object, BOOL *stop))block;
+
+/**
+ *  Enumerate the changes needed to turn the specified dictionary (e.g. labels previously applied to an SDK object) into
+ *  the receiver contents. Removed keys are enumerated first with a `nil` object, followed by keys which are new or whose
+ *  string changed. Unchanged keys are not enumerated.
+ *
+ *  @discussion The block can safely mutate the dictionary if it is mutable.
+ */
+- (void)enumerateChangesFromDictionary:(nullable NSDictionary<NSString *, NSString *> *)dictionary
+                            usingBlock:(void (NS_NOESCAPE ^)(NSString *key, NSString * _Nullable object))block;
+
+/**
+ *  Dictionary representation of the label set.
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *dictionary;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,292 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsLabelSet.h"
+
+static const NSUInteger SRGAnalyticsLabelSetInitialCapacity = 16;
+
+// Number of hash table slots per entry. Keeping the table at most half full keeps probe sequences short
+static const NSUInteger SRGAnalyticsLabelSetSlotsPerEntry = 2;
+
+typedef struct {
+    CFStringRef key;
+    CFStringRef value;
+    CFHashCode hash;
+} SRGAnalyticsLabelEntry;
+
+// Hash table slots store entry indices plus one, zero marking an empty slot
+typedef uint32_t SRGAnalyticsLabelSlot;
+
+static BOOL SRGAnalyticsLabelKeysAreEqual(CFStringRef key1, CFHashCode hash1, CFStringRef key2, CFHashCode hash2)
+{
+    // Constant keys are unique, comparing pointers first avoids most string comparisons. Different hashes rule out
+    // string comparisons for distinct keys
+    return key1 == key2 || (hash1 == hash2 && CFEqual(key1, key2));
+}
+
+static NSUInteger SRGAnalyticsLabelSlotIndex(CFHashCode hash, NSUInteger slotCount)
+{
+    // Mix high bits into the low bits used for indexing (slot counts are powers of two)
+    return (hash ^ (hash >> 16)) & (slotCount - 1);
+}
+
+@interface SRGAnalyticsLabelSet () {
+@private
+    SRGAnalyticsLabelEntry *_entries;                   // Entries followed by hash table slots, in a single allocation
+    SRGAnalyticsLabelSlot *_slots;
+    NSUInteger _entryCount;
+    NSUInteger _capacity;
+}
+
+@property (nonatomic) SRGAnalyticsLabelSet *parent;
+@property (nonatomic, copy) NSDictionary<NSString *, NSString *> *referencedDictionary;
+
+@end
+
+@implementation SRGAnalyticsLabelSet
+
+#pragma mark Class methods
+
++ (SRGAnalyticsLabelSet *)labelSetWithParent:(SRGAnalyticsLabelSet *)parent
+{
+    return [self labelSetWithDictionary:nil parent:parent];
+}
+
++ (SRGAnalyticsLabelSet *)labelSetWithDictionary:(NSDictionary<NSString *, NSString *> *)dictionary parent:(SRGAnalyticsLabelSet *)parent
+{
+    SRGAnalyticsLabelSet *labelSet = [[self alloc] init];
+    labelSet.referencedDictionary = (dictionary.count != 0) ? dictionary : nil;
+    labelSet.parent = parent;
+    return labelSet;
+}
+
+#pragma mark Object lifecycle
+
+- (void)dealloc
+{
+    for (NSUInteger i = 0; i < _entryCount; ++i) {
+        CFRelease(_entries[i].key);
+        CFRelease(_entries[i].value);
+    }
+    free(_entries);
+}
+
+#pragma mark Hash table
+
+- (NSUInteger)indexOfKey:(CFStringRef)key hash:(CFHashCode)hash
+{
+    if (_entryCount == 0) {
+        return NSNotFound;
+    }
+    
+    // The table is never full, an empty slot is always eventually found
+    NSUInteger slotCount = SRGAnalyticsLabelSetSlotsPerEntry * _capacity;
+    for (NSUInteger slotIndex = SRGAnalyticsLabelSlotIndex(hash, slotCount); ; slotIndex = (slotIndex + 1) & (slotCount - 1)) {
+        SRGAnalyticsLabelSlot slot = _slots[slotIndex];
+        if (slot == 0) {
+            return NSNotFound;
+        }
+        
+        SRGAnalyticsLabelEntry *entry = &_entries[slot - 1];
+        if (SRGAnalyticsLabelKeysAreEqual(entry->key, entry->hash, key, hash)) {
+            return slot - 1;
+        }
+    }
+}
+
+- (void)insertSlotForEntryAtIndex:(NSUInteger)index
+{
+    NSUInteger slotCount = SRGAnalyticsLabelSetSlotsPerEntry * _capacity;
+    NSUInteger slotIndex = SRGAnalyticsLabelSlotIndex(_entries[index].hash, slotCount);
+    while (_slots[slotIndex] != 0) {
+        slotIndex = (slotIndex + 1) & (slotCount - 1);
+    }
+    _slots[slotIndex] = (SRGAnalyticsLabelSlot)(index + 1);
+}
+
+- (void)rebuildSlots
+{
+    memset(_slots, 0, SRGAnalyticsLabelSetSlotsPerEntry * _capacity * sizeof(SRGAnalyticsLabelSlot));
+    for (NSUInteger i = 0; i < _entryCount; ++i) {
+        [self insertSlotForEntryAtIndex:i];
+    }
+}
+
+#pragma mark Entries
+
+- (NSString *)localObjectForKey:(NSString *)key hash:(CFHashCode)hash
+{
+    NSUInteger index = [self indexOfKey:(__bridge CFStringRef)key hash:hash];
+    if (index != NSNotFound) {
+        return (__bridge NSString *)_entries[index].value;
+    }
+    else {
+        return self.referencedDictionary[key];
+    }
+}
+
+// Return `YES` iff the key is found in a label set located above the specified layer
+- (BOOL)isKey:(NSString *)key hash:(CFHashCode)hash hiddenAboveLayer:(SRGAnalyticsLabelSet *)layer
+{
+    for (SRGAnalyticsLabelSet *labelSet = self; labelSet != layer; labelSet = labelSet.parent) {
+        if ([labelSet localObjectForKey:key hash:hash]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (void)setString:(NSString *)string forKey:(NSString *)key
+{
+    NSParameterAssert(key);
+    
+    CFHashCode hash = CFHash((__bridge CFStringRef)key);
+    NSUInteger index = [self indexOfKey:(__bridge CFStringRef)key hash:hash];
+    if (string) {
+        CFStringRef value = (CFStringRef)CFBridgingRetain([string copy]);
+        if (index != NSNotFound) {
+            CFRelease(_entries[index].value);
+            _entries[index].value = value;
+        }
+        else {
+            if (_entryCount == _capacity) {
+                _capacity = (_capacity != 0) ? 2 * _capacity : SRGAnalyticsLabelSetInitialCapacity;
+                _entries = reallocf(_entries, _capacity * (sizeof(SRGAnalyticsLabelEntry) + SRGAnalyticsLabelSetSlotsPerEntry * sizeof(SRGAnalyticsLabelSlot)));
+                NSAssert(_entries, @"Label set storage could not be allocated");
+                _slots = (SRGAnalyticsLabelSlot *)(_entries + _capacity);
+                [self rebuildSlots];
+            }
+            _entries[_entryCount].key = (CFStringRef)CFBridgingRetain([key copy]);
+            _entries[_entryCount].value = value;
+            _entries[_entryCount].hash = hash;
+            [self insertSlotForEntryAtIndex:_entryCount];
+            ++_entryCount;
+        }
+    }
+    else if (index != NSNotFound) {
+        CFRelease(_entries[index].key);
+        CFRelease(_entries[index].value);
+        memmove(&_entries[index], &_entries[index + 1], (_entryCount - index - 1) * sizeof(SRGAnalyticsLabelEntry));
+        --_entryCount;
+        
+        // Entry indices changed. Removals are rare, simply rebuild the table
+        [self rebuildSlots];
+    }
+}
+
+- (void)addEntriesFromDictionary:(NSDictionary<NSString *, NSString *> *)dictionary
+{
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
+        [self setString:object forKey:key];
+    }];
+}
+
+- (NSString *)objectForKeyedSubscript:(NSString *)key
+{
+    CFHashCode hash = CFHash((__bridge CFStringRef)key);
+    for (SRGAnalyticsLabelSet *labelSet = self; labelSet; labelSet = labelSet.parent) {
+        NSString *object = [labelSet localObjectForKey:key hash:hash];
+        if (object) {
+            return object;
+        }
+    }
+    return nil;
+}
+
+- (NSUInteger)count
+{
+    __block NSUInteger count = 0;
+    [self enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
+        ++count;
+    }];
+    return count;
+}
+
+- (void)enumerateKeysAndObjectsUsingBlock:(void (NS_NOESCAPE ^)(NSString * _Nonnull, NSString * _Nonnull, BOOL * _Nonnull))block
+{
+    __block BOOL stop = NO;
+    for (SRGAnalyticsLabelSet *layer = self; layer; layer = layer.parent) {
+        for (NSUInteger i = 0; i < layer->_entryCount; ++i) {
+            NSString *key = (__bridge NSString *)layer->_entries[i].key;
+            if (layer != self && [self isKey:key hash:layer->_entries[i].hash hiddenAboveLayer:layer]) {
+                continue;
+            }
+            
+            block(key, (__bridge NSString *)layer->_entries[i].value, &stop);
+            if (stop) {
+                return;
+            }
+        }
+        
+        [layer.referencedDictionary enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull dictionaryStop) {
+            // Hash each key once for all lookups. Lookups are only needed if some entries can hide the key
+            if (layer->_entryCount != 0 || layer != self) {
+                CFHashCode hash = CFHash((__bridge CFStringRef)key);
+                if ([layer indexOfKey:(__bridge CFStringRef)key hash:hash] != NSNotFound || [self isKey:key hash:hash hiddenAboveLayer:layer]) {
+                    return;
+                }
+            }
+            
+            block(key, object, &stop);
+            *dictionaryStop = stop;
+        }];
+        if (stop) {
+            return;
+        }
+    }
+}
+
+- (void)enumerateChangesFromDictionary:(NSDictionary<NSString *, NSString *> *)dictionary
+                            usingBlock:(void (NS_NOESCAPE ^)(NSString * _Nonnull, NSString * _Nullable))block
+{
+    // Collect removed keys before calling the block, which might mutate the dictionary
+    NSMutableArray<NSString *> *removedKeys = nil;
+    for (NSString *key in dictionary) {
+        if (! self[key]) {
+            if (! removedKeys) {
+                removedKeys = [NSMutableArray array];
+            }
+            [removedKeys addObject:key];
+        }
+    }
+    
+    for (NSString *key in removedKeys) {
+        block(key, nil);
+    }
+    
+    [self enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
+        NSString *previousObject = dictionary[key];
+        if (! previousObject || ! [previousObject isEqual:object]) {
+            block(key, object);
+        }
+    }];
+}
+
+- (NSDictionary<NSString *, NSString *> *)dictionary
+{
+    // Only a dictionary is referenced. No need to build another one
+    if (_entryCount == 0 && ! self.parent) {
+        return self.referencedDictionary ?: @{};
+    }
+    
+    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionaryWithCapacity:_entryCount + self.referencedDictionary.count];
+    [self enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
+        dictionary[key] = object;
+    }];
+    return [dictionary copy];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; dictionary = %@>",
+            self.class,
+            self,
+            self.dictionary];
+}
+
+@end
@@ -0,0 +1,28 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsLabels.h"
+#import "SRGAnalyticsLabelSet.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SRGAnalyticsLabels (Private)
+
+/**
+ *  Set the values which will be sent to TagCommander into the specified label set. Subclasses must call the parent
+ *  implementation last, so that custom information can override official labels.
+ */
+- (void)fillLabelSet:(SRGAnalyticsLabelSet *)labelSet;
+
+/**
+ *  Set the values which will be sent to comScore into the specified label set. Same rules as for `-fillLabelSet:`
+ *  apply.
+ */
+- (void)fillComScoreLabelSet:(SRGAnalyticsLabelSet *)labelSet;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -6,28 +6,36 @@
 
 #import "SRGAnalyticsLabels.h"
 
+#import "SRGAnalyticsLabels+Private.h"
+
 @implementation SRGAnalyticsLabels
 
+#pragma mark Getters and setters
+
 - (NSDictionary<NSString *, NSString *> *)labelsDictionary
 {
-    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
-    
-    if (self.customInfo) {
-        [dictionary addEntriesFromDictionary:self.customInfo];
-    }
-    
-    return [dictionary copy];
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [self fillLabelSet:labelSet];
+    return labelSet.dictionary;
 }
 
 - (NSDictionary<NSString *, NSString *> *)comScoreLabelsDictionary
 {
-    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
-    
-    if (self.comScoreCustomInfo) {
-        [dictionary addEntriesFromDictionary:self.comScoreCustomInfo];
-    }
-    
-    return [dictionary copy];
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [self fillComScoreLabelSet:labelSet];
+    return labelSet.dictionary;
+}
+
+#pragma mark Label sets
+
+- (void)fillLabelSet:(SRGAnalyticsLabelSet *)labelSet
+{
+    [labelSet addEntriesFromDictionary:self.customInfo];
+}
+
+- (void)fillComScoreLabelSet:(SRGAnalyticsLabelSet *)labelSet
+{
+    [labelSet addEntriesFromDictionary:self.comScoreCustomInfo];
 }
 
 #pragma mark NSCopying protocol
@@ -0,0 +1,63 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Dispatcher sending NetMetrix hits through a dedicated session, one at a time.
+ *
+ *  Hits are sent with a copy of a request template, to which a random cache-busting parameter is added. Hits received
+ *  within the coalescing interval following a hit are collapsed with it (e.g. during rapid tab switching).
+ *
+ *  Hits which could not be sent because of a network or server error are kept in a bounded queue and retried with an
+ *  exponential backoff. The queue is saved to disk, so that pending hits are sent when a dispatcher is later created
+ *  with the same file. If the queue is full, new hits are discarded.
+ *
+ *  The dispatcher is thread-safe.
+ */
+@interface SRGAnalyticsNetMetrixDispatcher : NSObject
+
+/**
+ *  Create a dispatcher.
+ *
+ *  @param requestTemplate        The request sent for each hit.
+ *  @param fileURL                The URL of the file where pending hits are saved. The file is created if it does not exist.
+ *  @param sessionConfiguration   The configuration of the session used to send hits.
+ *  @param coalescingInterval     The time interval during which hits following a hit are collapsed with it.
+ *  @param minimumRetryInterval   The delay before a failed hit is sent again for the first time. The delay is doubled
+ *                                after each failure, up to `maximumRetryInterval`.
+ *  @param maximumRetryInterval   The maximum delay between two attempts.
+ *  @param maximumPendingHitCount The maximum number of hits waiting to be sent.
+ */
+- (instancetype)initWithRequestTemplate:(NSURLRequest *)requestTemplate
+                                fileURL:(NSURL *)fileURL
+                   sessionConfiguration:(NSURLSessionConfiguration *)sessionConfiguration
+                     coalescingInterval:(NSTimeInterval)coalescingInterval
+                   minimumRetryInterval:(NSTimeInterval)minimumRetryInterval
+                   maximumRetryInterval:(NSTimeInterval)maximumRetryInterval
+                 maximumPendingHitCount:(NSUInteger)maximumPendingHitCount;
+
+/**
+ *  Send a hit.
+ */
+- (void)sendHit;
+
+/**
+ *  The number of hits waiting to be sent (including the one currently being sent, if any).
+ */
+@property (nonatomic, readonly) NSUInteger pendingHitCount;
+
+@end
+
+@interface SRGAnalyticsNetMetrixDispatcher (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
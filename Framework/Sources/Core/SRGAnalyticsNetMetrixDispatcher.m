@@ -0,0 +1,231 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsNetMetrixDispatcher.h"
+
+#import "SRGAnalyticsInstrumentation+Private.h"
+#import "SRGAnalyticsLogger.h"
+
+#import <libextobjc/libextobjc.h>
+
+static NSString * const SRGAnalyticsNetMetrixPendingHitCountKey = @"pendingHitCount";
+
+@interface SRGAnalyticsNetMetrixDispatcher ()
+
+@property (nonatomic) NSURLRequest *requestTemplate;
+@property (nonatomic, copy) NSString *URLPrefix;
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) NSURLSession *session;
+@property (nonatomic) NSTimeInterval coalescingInterval;
+@property (nonatomic) NSTimeInterval minimumRetryInterval;
+@property (nonatomic) NSTimeInterval maximumRetryInterval;
+@property (nonatomic) NSUInteger maximumPendingHitCount;
+
+@property (nonatomic) dispatch_queue_t queue;
+
+// Only accessed from the queue
+@property (nonatomic) NSUInteger queuedHitCount;
+@property (nonatomic) NSTimeInterval lastHitTime;
+@property (nonatomic) NSUInteger failureCount;
+@property (nonatomic, getter=isSending) BOOL sending;
+@property (nonatomic, getter=isWaitingForRetry) BOOL waitingForRetry;
+
+@end
+
+@implementation SRGAnalyticsNetMetrixDispatcher
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithRequestTemplate:(NSURLRequest *)requestTemplate
+                                fileURL:(NSURL *)fileURL
+                   sessionConfiguration:(NSURLSessionConfiguration *)sessionConfiguration
+                     coalescingInterval:(NSTimeInterval)coalescingInterval
+                   minimumRetryInterval:(NSTimeInterval)minimumRetryInterval
+                   maximumRetryInterval:(NSTimeInterval)maximumRetryInterval
+                 maximumPendingHitCount:(NSUInteger)maximumPendingHitCount
+{
+    if (self = [super init]) {
+        self.requestTemplate = [requestTemplate copy];
+        self.fileURL = fileURL;
+        self.coalescingInterval = coalescingInterval;
+        self.minimumRetryInterval = minimumRetryInterval;
+        self.maximumRetryInterval = MAX(maximumRetryInterval, minimumRetryInterval);
+        self.maximumPendingHitCount = MAX(maximumPendingHitCount, 1);
+        self.lastHitTime = NAN;
+        
+        // Only the cache-busting parameter changes between hits
+        NSString *URLString = requestTemplate.URL.absoluteString;
+        self.URLPrefix = [URLString stringByAppendingString:[URLString containsString:@"?"] ? @"&d=" : @"?d="];
+        
+        // Responses are not needed, and hits are sent one at a time through a single connection, kept alive between hits
+        NSURLSessionConfiguration *configuration = [sessionConfiguration copy];
+        configuration.HTTPMaximumConnectionsPerHost = 1;
+        configuration.URLCache = nil;
+        configuration.requestCachePolicy = NSURLRequestReloadIgnoringLocalAndRemoteCacheData;
+        self.session = [NSURLSession sessionWithConfiguration:configuration];
+        
+        self.queue = dispatch_queue_create("ch.srgssr.analytics.netmetrix", DISPATCH_QUEUE_SERIAL);
+        
+        [NSFileManager.defaultManager createDirectoryAtURL:fileURL.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:NULL];
+        NSDictionary *state = [NSDictionary dictionaryWithContentsOfURL:fileURL];
+        id pendingHitCount = state[SRGAnalyticsNetMetrixPendingHitCountKey];
+        self.queuedHitCount = [pendingHitCount isKindOfClass:NSNumber.class] ? MIN([pendingHitCount unsignedIntegerValue], self.maximumPendingHitCount) : 0;
+        
+        // Send hits left from a previous session
+        if (self.queuedHitCount != 0) {
+            SRGAnalyticsLogInfo(@"NetMetrix", @"%@ pending hit(s) found. Sending them", @(self.queuedHitCount));
+            
+            @weakify(self)
+            dispatch_async(self.queue, ^{
+                @strongify(self)
+                [self sendNextHit];
+            });
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_session finishTasksAndInvalidate];
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithRequestTemplate:[NSURLRequest new] fileURL:[NSURL new] sessionConfiguration:NSURLSessionConfiguration.ephemeralSessionConfiguration coalescingInterval:0. minimumRetryInterval:0. maximumRetryInterval:0. maximumPendingHitCount:0];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Getters and setters
+
+- (NSUInteger)pendingHitCount
+{
+    __block NSUInteger pendingHitCount = 0;
+    dispatch_sync(self.queue, ^{
+        pendingHitCount = self.queuedHitCount;
+    });
+    return pendingHitCount;
+}
+
+#pragma mark Dispatch
+
+- (void)sendHit
+{
+    @weakify(self)
+    dispatch_async(self.queue, ^{
+        @strongify(self)
+        
+        NSTimeInterval currentTime = NSProcessInfo.processInfo.systemUptime;
+        if (! isnan(self.lastHitTime) && currentTime - self.lastHitTime < self.coalescingInterval) {
+            SRGAnalyticsLogDebug(@"NetMetrix", @"Hit collapsed with the previous one");
+            return;
+        }
+        self.lastHitTime = currentTime;
+        
+        if (self.queuedHitCount == self.maximumPendingHitCount) {
+            SRGAnalyticsLogWarning(@"NetMetrix", @"Too many pending hits. The hit is discarded");
+            return;
+        }
+        
+        self.queuedHitCount += 1;
+        [self saveState];
+        [self sendNextHit];
+    });
+}
+
+- (void)sendNextHit
+{
+    if (self.sending || self.waitingForRetry || self.queuedHitCount == 0) {
+        return;
+    }
+    
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+    
+    NSMutableURLRequest *request = [self.requestTemplate mutableCopy];
+    request.URL = [NSURL URLWithString:[self.URLPrefix stringByAppendingFormat:@"%u", arc4random()]];
+    
+    SRGAnalyticsLogDebug(@"NetMetrix", @"Request %@ started", request.URL);
+    self.sending = YES;
+    
+    uint64_t requestTimestamp = SRGAnalyticsInstrumentationTimestamp();
+    
+    @weakify(self)
+    [[self.session dataTaskWithRequest:request completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageNetMetrixRequest, requestTimestamp);
+        SRGAnalyticsLogDebug(@"NetMetrix", @"Request %@ ended with error %@", request.URL, error);
+        
+        @strongify(self)
+        if (! self) {
+            return;
+        }
+        
+        dispatch_async(self.queue, ^{
+            self.sending = NO;
+            [self processResponse:response error:error];
+        });
+    }] resume];
+    
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageNetMetrix, timestamp);
+}
+
+- (void)processResponse:(NSURLResponse *)response error:(NSError *)error
+{
+    NSInteger statusCode = [response isKindOfClass:NSHTTPURLResponse.class] ? ((NSHTTPURLResponse *)response).statusCode : 0;
+    
+    // Network and server errors are transient. Retry later
+    if (error || statusCode >= 500) {
+        self.failureCount += 1;
+        
+        NSTimeInterval retryInterval = MIN(ldexp(self.minimumRetryInterval, (int)MIN(self.failureCount - 1, 30)), self.maximumRetryInterval);
+        SRGAnalyticsLogInfo(@"NetMetrix", @"Hit could not be sent. Retrying in %@ seconds", @(retryInterval));
+        
+        self.waitingForRetry = YES;
+        
+        @weakify(self)
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(retryInterval * NSEC_PER_SEC)), self.queue, ^{
+            @strongify(self)
+            self.waitingForRetry = NO;
+            [self sendNextHit];
+        });
+        return;
+    }
+    
+    // Client errors are not transient. The hit is lost
+    if (statusCode >= 400) {
+        SRGAnalyticsLogError(@"NetMetrix", @"Hit rejected with status code %@. Discarded", @(statusCode));
+    }
+    
+    self.failureCount = 0;
+    self.queuedHitCount -= 1;
+    [self saveState];
+    [self sendNextHit];
+}
+
+- (void)saveState
+{
+    NSDictionary *state = @{ SRGAnalyticsNetMetrixPendingHitCountKey : @(self.queuedHitCount) };
+    if (! [state writeToURL:self.fileURL atomically:YES]) {
+        SRGAnalyticsLogError(@"NetMetrix", @"Pending hits could not be saved to %@", self.fileURL);
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; URL = %@; fileURL = %@>",
+            self.class,
+            self,
+            self.requestTemplate.URL,
+            self.fileURL];
+}
+
+@end
@@ -24,6 +24,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (instancetype)initWithConfiguration:(SRGAnalyticsConfiguration *)configuration;
 
+/**
+ *  The URL views are sent to, `nil` if no NetMetrix domain is defined by the configuration.
+ */
+@property (nonatomic, readonly, nullable) NSURL *URL;
+
 /**
  *  Send a view event.
  */
@@ -7,6 +7,7 @@
 #import "SRGAnalyticsNetMetrixTracker.h"
 
 #import "SRGAnalyticsLogger.h"
+#import "SRGAnalyticsNetMetrixDispatcher.h"
 #import "SRGAnalyticsNotifications.h"
 #import "SRGAnalyticsTracker.h"
 
@@ -16,6 +17,9 @@
 
 @property (nonatomic, copy) SRGAnalyticsConfiguration *configuration;
 
+@property (nonatomic) NSURL *URL;
+@property (nonatomic) SRGAnalyticsNetMetrixDispatcher *dispatcher;
+
 @end
 
 @implementation SRGAnalyticsNetMetrixTracker
@@ -26,48 +30,69 @@
 {
     if (self = [super init]) {
         self.configuration = configuration;
+        
+        NSString *netMetrixDomain = configuration.netMetrixDomain;
+        if (netMetrixDomain) {
+            NSString *URLString = [NSString stringWithFormat:@"https://%@.wemfbox.ch/cgi-bin/ivw/CP/apps/%@/ios/%@", netMetrixDomain, configuration.netMetrixIdentifier, self.device];
+            self.URL = [NSURL URLWithString:URLString];
+            
+            if (! configuration.unitTesting) {
+                NSString *cachesDirectory = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+                NSString *filePath = [[cachesDirectory stringByAppendingPathComponent:@"SRGAnalytics"] stringByAppendingPathComponent:@"NetMetrixPendingHits.plist"];
+                
+                // Hits for views appearing in rapid succession (e.g. when switching tabs) are collapsed
+                self.dispatcher = [[SRGAnalyticsNetMetrixDispatcher alloc] initWithRequestTemplate:[self requestTemplateWithURL:self.URL]
+                                                                                           fileURL:[NSURL fileURLWithPath:filePath]
+                                                                              sessionConfiguration:NSURLSessionConfiguration.ephemeralSessionConfiguration
+                                                                                coalescingInterval:1.
+                                                                              minimumRetryInterval:5.
+                                                                              maximumRetryInterval:10. * 60.
+                                                                            maximumPendingHitCount:100];
+            }
+        }
     }
     return self;
 }
 
+#pragma mark Request
+
+- (NSURLRequest *)requestTemplateWithURL:(NSURL *)URL
+{
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:URL cachePolicy:NSURLRequestReloadIgnoringLocalAndRemoteCacheData timeoutInterval:30.];
+    [request setHTTPMethod:@"GET"];
+    [request setValue:@"image/gif" forHTTPHeaderField:@"Accept"];
+    
+    // Which User-Agent MUST be used is defined at https://www.net-metrix.ch/fr/service/directives/directives-supplementaires-pour-les-applications
+    NSString *userAgent = [NSString stringWithFormat:@"Mozilla/5.0 (iOS-%@; U; CPU %@ like Mac OS X)", self.device, self.operatingSystem];
+    [request setValue:userAgent forHTTPHeaderField:@"User-Agent"];
+    
+    // The app language must be sent, not the device language. This is sadly not documented in https://www.net-metrix.ch/fr/service/directives/directives-supplementaires-pour-les-applications,
+    // but this information was obtained from a NetMetrix technician.
+    [request setValue:NSBundle.mainBundle.preferredLocalizations.firstObject forHTTPHeaderField:@"Accept-Language"];
+    
+    return [request copy];
+}
+
 #pragma mark View tracking
 
 - (void)trackView
 {
-    SRGAnalyticsConfiguration *configuration = self.configuration;
-    NSString *netMetrixDomain = configuration.netMetrixDomain;
-    if (! netMetrixDomain) {
+    NSURL *URL = self.URL;
+    if (! URL) {
         SRGAnalyticsLogInfo(@"NetMetrix", @"No NetMetrix domain is defined for this configuration. No event will be recorded");
         return;
     }
     
-    NSString *netMetrixURLString = [NSString stringWithFormat:@"https://%@.wemfbox.ch/cgi-bin/ivw/CP/apps/%@/ios/%@", netMetrixDomain, configuration.netMetrixIdentifier, self.device];
-    NSURL *netMetrixURL = [NSURL URLWithString:netMetrixURLString];
-    
-    if (! configuration.unitTesting) {
-        NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:netMetrixURL resolvingAgainstBaseURL:NO];
-        URLComponents.queryItems = @[ [NSURLQueryItem queryItemWithName:@"d" value:@(arc4random()).stringValue] ];
-        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:URLComponents.URL cachePolicy:NSURLRequestReloadIgnoringLocalAndRemoteCacheData timeoutInterval:30.];
-        [request setHTTPMethod:@"GET"];
-        [request setValue:@"image/gif" forHTTPHeaderField:@"Accept"];
-        
-        // Which User-Agent MUST be used is defined at https://www.net-metrix.ch/fr/service/directives/directives-supplementaires-pour-les-applications
-        NSString *userAgent = [NSString stringWithFormat:@"Mozilla/5.0 (iOS-%@; U; CPU %@ like Mac OS X)", self.device, self.operatingSystem];
-        [request setValue:userAgent forHTTPHeaderField:@"User-Agent"];
-        
-        // The app language must be sent, not the device language. This is sadly not documented in https://www.net-metrix.ch/fr/service/directives/directives-supplementaires-pour-les-applications,
-        // but this information was obtained from a NetMetrix technician.
-        [request setValue:NSBundle.mainBundle.preferredLocalizations.firstObject forHTTPHeaderField:@"Accept-Language"];
-        
-        SRGAnalyticsLogDebug(@"NetMetrix", @"Request %@ started", request.URL);
-        [[[NSURLSession sharedSession] dataTaskWithRequest:request completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-            SRGAnalyticsLogDebug(@"NetMetrix", @"Request %@ ended with error %@", request.URL, error);
-        }] resume];
+    if (! self.configuration.unitTesting) {
+        [self.dispatcher sendHit];
     }
     else {
-        [NSNotificationCenter.defaultCenter postNotificationName:SRGAnalyticsNetmetrixRequestNotification
-                                                          object:nil
-                                                        userInfo:@{ SRGAnalyticsNetmetrixURLKey : netMetrixURL }];
+        // Views are tracked from the tracker event queue. Notify on the main thread, as for other unit testing notifications
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [NSNotificationCenter.defaultCenter postNotificationName:SRGAnalyticsNetmetrixRequestNotification
+                                                              object:nil
+                                                            userInfo:@{ SRGAnalyticsNetmetrixURLKey : URL }];
+        });
     }
 }
 
@@ -0,0 +1,50 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Keep track of visible view controllers conforming to `SRGAnalyticsViewTracking`, and send page views for them when
+ *  the application returns to the foreground. Only leaf-most view controllers (those without a visible tracked child
+ *  or presented view controller) are tracked, so that a single page view is sent for each visible page, whatever the
+ *  container hierarchy.
+ *
+ *  @discussion Must be used from the main thread only.
+ */
+@interface SRGAnalyticsPageViewCoordinator : NSObject
+
+/**
+ *  The coordinator used for automatic view controller tracking.
+ */
+@property (class, nonatomic, readonly) SRGAnalyticsPageViewCoordinator *sharedCoordinator;
+
+/**
+ *  Register a view controller which has appeared. View controllers not conforming to `SRGAnalyticsViewTracking` are
+ *  ignored. View controllers are not retained.
+ */
+- (void)viewControllerDidAppear:(UIViewController *)viewController;
+
+/**
+ *  Unregister a view controller which will disappear.
+ */
+- (void)viewControllerWillDisappear:(UIViewController *)viewController;
+
+/**
+ *  The visible view controllers which would be tracked when the application returns to the foreground, in the order in
+ *  which they appeared.
+ */
+@property (nonatomic, readonly) NSArray<UIViewController *> *trackedViewControllers;
+
+/**
+ *  Send page views for `trackedViewControllers`. Automatically called when the application returns to the foreground.
+ */
+- (void)trackPageViews;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,139 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsPageViewCoordinator.h"
+
+#import "SRGAnalyticsViewTrackingCapabilities.h"
+#import "UIViewController+SRGAnalytics.h"
+
+#import <objc/runtime.h>
+
+// Return the view controller a view controller is displayed in (container or presenting view controller), if any.
+static UIViewController *SRGAnalyticsHostViewController(UIViewController *viewController)
+{
+    return viewController.parentViewController ?: viewController.presentingViewController;
+}
+
+@interface SRGAnalyticsPageViewCoordinator ()
+
+@property (nonatomic) NSMapTable<UIViewController *, NSNumber *> *visibleViewControllers;        // Values: appearance order
+@property (nonatomic) NSUInteger appearanceCount;
+
+@end
+
+@implementation SRGAnalyticsPageViewCoordinator
+
+#pragma mark Class methods
+
++ (SRGAnalyticsPageViewCoordinator *)sharedCoordinator
+{
+    static SRGAnalyticsPageViewCoordinator *s_sharedCoordinator = nil;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_sharedCoordinator = [SRGAnalyticsPageViewCoordinator new];
+    });
+    return s_sharedCoordinator;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.visibleViewControllers = [NSMapTable weakToStrongObjectsMapTable];
+        
+        // A single registration for all view controllers
+        [NSNotificationCenter.defaultCenter addObserver:self
+                                               selector:@selector(applicationWillEnterForeground:)
+                                                   name:UIApplicationWillEnterForegroundNotification
+                                                 object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [NSNotificationCenter.defaultCenter removeObserver:self];
+}
+
+#pragma mark Getters and setters
+
+- (NSArray<UIViewController *> *)trackedViewControllers
+{
+    NSMutableArray<UIViewController *> *viewControllers = [NSMutableArray array];
+    for (UIViewController *viewController in self.visibleViewControllers.keyEnumerator) {
+        id<SRGAnalyticsViewTracking> trackedViewController = (id<SRGAnalyticsViewTracking>)viewController;
+        SRGAnalyticsViewTrackingCapabilities capabilities = SRGAnalyticsViewTrackingCapabilitiesForClass(object_getClass(viewController));
+        if (! (capabilities & SRGAnalyticsViewTrackingCapabilityTrackedAutomatically) || [trackedViewController srg_isTrackedAutomatically]) {
+            [viewControllers addObject:viewController];
+        }
+    }
+    
+    // Discard view controllers hosting another tracked one, at any depth
+    NSHashTable<UIViewController *> *hostViewControllers = [NSHashTable hashTableWithOptions:NSPointerFunctionsObjectPointerPersonality];
+    for (UIViewController *viewController in viewControllers) {
+        UIViewController *hostViewController = SRGAnalyticsHostViewController(viewController);
+        while (hostViewController && ! [hostViewControllers containsObject:hostViewController]) {
+            [hostViewControllers addObject:hostViewController];
+            hostViewController = SRGAnalyticsHostViewController(hostViewController);
+        }
+    }
+    
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(UIViewController * _Nullable viewController, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return ! [hostViewControllers containsObject:viewController];
+    }];
+    [viewControllers filterUsingPredicate:predicate];
+    
+    [viewControllers sortUsingComparator:^NSComparisonResult(UIViewController * _Nonnull viewController1, UIViewController * _Nonnull viewController2) {
+        return [[self.visibleViewControllers objectForKey:viewController1] compare:[self.visibleViewControllers objectForKey:viewController2]];
+    }];
+    return [viewControllers copy];
+}
+
+#pragma mark Registration
+
+- (void)viewControllerDidAppear:(UIViewController *)viewController
+{
+    if (! (SRGAnalyticsViewTrackingCapabilitiesForClass(object_getClass(viewController)) & SRGAnalyticsViewTrackingCapabilityTracked)) {
+        return;
+    }
+    
+    self.appearanceCount += 1;
+    [self.visibleViewControllers setObject:@(self.appearanceCount) forKey:viewController];
+}
+
+- (void)viewControllerWillDisappear:(UIViewController *)viewController
+{
+    [self.visibleViewControllers removeObjectForKey:viewController];
+}
+
+#pragma mark Tracking
+
+- (void)trackPageViews
+{
+    for (UIViewController *viewController in self.trackedViewControllers) {
+        [viewController srg_trackPageView];
+    }
+}
+
+#pragma mark Notifications
+
+- (void)applicationWillEnterForeground:(NSNotification *)notification
+{
+    [self trackPageViews];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; trackedViewControllers = %@>",
+            self.class,
+            self,
+            self.trackedViewControllers];
+}
+
+@end
@@ -0,0 +1,21 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsLabelSet.h"
+#import "SRGAnalyticsStreamLabels.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SRGAnalyticsStreamLabels (Private)
+
+/**
+ *  Set the segment-related values which will be sent to comScore into the specified label set.
+ */
+- (void)fillComScoreSegmentLabelSet:(SRGAnalyticsLabelSet *)labelSet;
+
+@end
+
+NS_ASSUME_NONNULL_END
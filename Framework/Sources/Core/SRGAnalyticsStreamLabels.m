@@ -7,58 +7,55 @@
 #import "SRGAnalyticsStreamLabels.h"
 
 #import "NSBundle+SRGAnalytics.h"
-#import "NSMutableDictionary+SRGAnalytics.h"
+#import "SRGAnalyticsLabels+Private.h"
+#import "SRGAnalyticsStreamLabels+Private.h"
 
 @implementation SRGAnalyticsStreamLabels
 
 #pragma mark Getters and setters
 
-- (NSDictionary<NSString *, NSString *> *)labelsDictionary
+- (NSDictionary<NSString *, NSString *> *)comScoreSegmentLabelsDictionary
 {
-    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
-    
-    [dictionary srg_safelySetString:NSBundle.srg_isProductionVersion ? @"prod" : @"preprod" forKey:@"media_embedding_environment"];
-    
-    [dictionary srg_safelySetString:self.playerName forKey:@"media_player_display"];
-    [dictionary srg_safelySetString:self.playerVersion forKey:@"media_player_version"];
-    [dictionary srg_safelySetString:self.playerVolumeInPercent.stringValue ?: @"0" forKey:@"media_volume"];
-    
-    [dictionary srg_safelySetString:self.subtitlesEnabled.boolValue ? @"true" : @"false" forKey:@"media_subtitles_on"];
-    [dictionary srg_safelySetString:self.timeshiftInMilliseconds ? @(self.timeshiftInMilliseconds.integerValue / 1000).stringValue : nil forKey:@"media_timeshift"];
-    [dictionary srg_safelySetString:self.bandwidthInBitsPerSecond.stringValue forKey:@"media_bandwidth"];
-    
-    [dictionary addEntriesFromDictionary:[super labelsDictionary]];
-    return [dictionary copy];
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [self fillComScoreSegmentLabelSet:labelSet];
+    return labelSet.dictionary;
 }
 
-- (NSDictionary<NSString *, NSString *> *)comScoreLabelsDictionary
+#pragma mark Label sets
+
+- (void)fillLabelSet:(SRGAnalyticsLabelSet *)labelSet
 {
-    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
+    [labelSet setString:NSBundle.srg_isProductionVersion ? @"prod" : @"preprod" forKey:@"media_embedding_environment"];
     
-    [dictionary srg_safelySetString:@"c" forKey:@"ns_st_it"];
-    [dictionary srg_safelySetString:@"p_app_ios" forKey:@"srg_ptype"];
+    [labelSet setString:self.playerName forKey:@"media_player_display"];
+    [labelSet setString:self.playerVersion forKey:@"media_player_version"];
+    [labelSet setString:self.playerVolumeInPercent.stringValue ?: @"0" forKey:@"media_volume"];
     
-    [dictionary srg_safelySetString:self.playerName forKey:@"ns_st_mp"];
-    [dictionary srg_safelySetString:self.playerVersion forKey:@"ns_st_mv"];
-    [dictionary srg_safelySetString:self.playerVolumeInPercent.stringValue ?: @"0" forKey:@"ns_st_vo"];
+    [labelSet setString:self.subtitlesEnabled.boolValue ? @"true" : @"false" forKey:@"media_subtitles_on"];
+    [labelSet setString:self.timeshiftInMilliseconds ? @(self.timeshiftInMilliseconds.integerValue / 1000).stringValue : nil forKey:@"media_timeshift"];
+    [labelSet setString:self.bandwidthInBitsPerSecond.stringValue forKey:@"media_bandwidth"];
     
-    [dictionary srg_safelySetString:self.bandwidthInBitsPerSecond.stringValue forKey:@"ns_st_br"];
-    
-    [dictionary addEntriesFromDictionary:[super comScoreLabelsDictionary]];
-    return [dictionary copy];
+    [super fillLabelSet:labelSet];
 }
 
-- (NSDictionary<NSString *, NSString *> *)comScoreSegmentLabelsDictionary
+- (void)fillComScoreLabelSet:(SRGAnalyticsLabelSet *)labelSet
 {
-    NSMutableDictionary <NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
+    [labelSet setString:@"c" forKey:@"ns_st_it"];
+    [labelSet setString:@"p_app_ios" forKey:@"srg_ptype"];
     
-    [dictionary srg_safelySetString:self.timeshiftInMilliseconds.stringValue forKey:@"srg_timeshift"];
+    [labelSet setString:self.playerName forKey:@"ns_st_mp"];
+    [labelSet setString:self.playerVersion forKey:@"ns_st_mv"];
+    [labelSet setString:self.playerVolumeInPercent.stringValue ?: @"0" forKey:@"ns_st_vo"];
     
-    if (self.comScoreCustomSegmentInfo) {
-        [dictionary addEntriesFromDictionary:self.comScoreCustomSegmentInfo];
-    }
+    [labelSet setString:self.bandwidthInBitsPerSecond.stringValue forKey:@"ns_st_br"];
     
-    return [dictionary copy];
+    [super fillComScoreLabelSet:labelSet];
+}
+
+- (void)fillComScoreSegmentLabelSet:(SRGAnalyticsLabelSet *)labelSet
+{
+    [labelSet setString:self.timeshiftInMilliseconds.stringValue forKey:@"srg_timeshift"];
+    [labelSet addEntriesFromDictionary:self.comScoreCustomSegmentInfo];
 }
 
 #pragma mark Merging
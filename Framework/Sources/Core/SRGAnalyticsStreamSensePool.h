@@ -0,0 +1,79 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <ComScore/ComScore.h>
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Pool of configured comScore `CSStreamSense` objects. StreamSense objects are costly to create, and stream trackers
+ *  are created for each playback session, which might be short-lived (e.g. autoplayed previews). Objects recycled into
+ *  the pool are reset and made available to the next session.
+ *
+ *  @discussion Pools are thread-safe, but `CSStreamSense` objects are not. Methods making StreamSense calls (dequeuing,
+ *              recycling and preparing objects) must be called where other StreamSense calls are made, i.e. from comScore
+ *              blocks (see `-[SRGAnalyticsTracker performComScoreBlock:]`).
+ */
+@interface SRGAnalyticsStreamSensePool : NSObject
+
+/**
+ *  The pool used by stream trackers.
+ */
+@property (class, nonatomic, readonly) SRGAnalyticsStreamSensePool *sharedPool;
+
+/**
+ *  Create a pool keeping at most the specified number of idle objects. Objects recycled when the pool is full are
+ *  discarded.
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  The maximum number of idle objects kept by the pool.
+ */
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/**
+ *  Return an idle object from the pool, or a new one if the pool is empty. The object is configured, has no labels, and
+ *  a new playback session is started for reused objects.
+ */
+- (CSStreamSense *)dequeueStreamSense;
+
+/**
+ *  Reset an object which is not used anymore and return it to the pool.
+ */
+- (void)recycleStreamSense:(CSStreamSense *)streamSense;
+
+/**
+ *  Fill the pool with new objects, up to the specified count (or the pool capacity if smaller), so that playback
+ *  sessions can later start without creating any.
+ */
+- (void)prepareStreamSensesWithCount:(NSUInteger)count;
+
+/**
+ *  The number of idle objects currently available from the pool.
+ */
+@property (nonatomic, readonly) NSUInteger idleCount;
+
+/**
+ *  The total number of objects created by the pool.
+ */
+@property (nonatomic, readonly) NSUInteger allocationCount;
+
+/**
+ *  The total number of objects returned by `-dequeueStreamSense` without being created.
+ */
+@property (nonatomic, readonly) NSUInteger reuseCount;
+
+@end
+
+@interface SRGAnalyticsStreamSensePool (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,170 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsStreamSensePool.h"
+
+#import "SRGAnalyticsInstrumentation+Private.h"
+
+// The default keep-alive time interval of 20 minutes is too big. Set it to 9 minutes
+static const NSInteger SRGAnalyticsStreamSenseKeepAliveInterval = 9 * 60;
+
+// Enough for a main player and a few concurrent previews
+static const NSUInteger SRGAnalyticsStreamSensePoolDefaultCapacity = 4;
+
+@interface SRGAnalyticsStreamSensePool ()
+
+@property (nonatomic) NSUInteger capacity;
+
+@property (nonatomic) NSMutableArray<CSStreamSense *> *idleStreamSenses;
+@property (nonatomic) NSUInteger allocationCount;
+@property (nonatomic) NSUInteger reuseCount;
+
+@end
+
+@implementation SRGAnalyticsStreamSensePool
+
+#pragma mark Class methods
+
++ (SRGAnalyticsStreamSensePool *)sharedPool
+{
+    static SRGAnalyticsStreamSensePool *s_sharedPool = nil;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_sharedPool = [[SRGAnalyticsStreamSensePool alloc] initWithCapacity:SRGAnalyticsStreamSensePoolDefaultCapacity];
+    });
+    return s_sharedPool;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+    if (self = [super init]) {
+        self.capacity = capacity;
+        self.idleStreamSenses = [NSMutableArray arrayWithCapacity:capacity];
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithCapacity:0];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Getters and setters
+
+- (NSUInteger)idleCount
+{
+    @synchronized(self) {
+        return self.idleStreamSenses.count;
+    }
+}
+
+- (NSUInteger)allocationCount
+{
+    @synchronized(self) {
+        return _allocationCount;
+    }
+}
+
+- (NSUInteger)reuseCount
+{
+    @synchronized(self) {
+        return _reuseCount;
+    }
+}
+
+#pragma mark Pooling
+
+- (CSStreamSense *)newStreamSense
+{
+    CSStreamSense *streamSense = [[CSStreamSense alloc] init];
+    [streamSense setKeepAliveInterval:SRGAnalyticsStreamSenseKeepAliveInterval];
+    
+    @synchronized(self) {
+        _allocationCount += 1;
+    }
+    SRGAnalyticsInstrumentationCount(SRGAnalyticsInstrumentationCounterStreamSenseAllocations, 1);
+    return streamSense;
+}
+
+- (CSStreamSense *)dequeueStreamSense
+{
+    CSStreamSense *streamSense = nil;
+    @synchronized(self) {
+        streamSense = self.idleStreamSenses.lastObject;
+        if (streamSense) {
+            [self.idleStreamSenses removeLastObject];
+            _reuseCount += 1;
+        }
+    }
+    
+    // Create objects or make StreamSense calls outside the lock. Reused objects start a new playback session, so that
+    // consecutive sessions are never reported with the same identifier
+    if (streamSense) {
+        [streamSense createPlaybackSession];
+        return streamSense;
+    }
+    else {
+        return [self newStreamSense];
+    }
+}
+
+- (void)recycleStreamSense:(CSStreamSense *)streamSense
+{
+    @synchronized(self) {
+        if (self.idleStreamSenses.count >= self.capacity || [self.idleStreamSenses indexOfObjectIdenticalTo:streamSense] != NSNotFound) {
+            return;
+        }
+    }
+    
+    // Start the next session from scratch. Labels are removed explicitly so that none can be inherited by the next session,
+    // and the keep-alive interval applied again in case it was restored to its default value.
+    [streamSense reset];
+    [[streamSense labels] removeAllObjects];
+    [[[streamSense clip] labels] removeAllObjects];
+    [streamSense setKeepAliveInterval:SRGAnalyticsStreamSenseKeepAliveInterval];
+    
+    @synchronized(self) {
+        if (self.idleStreamSenses.count < self.capacity) {
+            [self.idleStreamSenses addObject:streamSense];
+        }
+    }
+}
+
+- (void)prepareStreamSensesWithCount:(NSUInteger)count
+{
+    NSUInteger targetCount = MIN(count, self.capacity);
+    while (self.idleCount < targetCount) {
+        CSStreamSense *streamSense = [self newStreamSense];
+        @synchronized(self) {
+            if (self.idleStreamSenses.count >= targetCount) {
+                break;
+            }
+            [self.idleStreamSenses addObject:streamSense];
+        }
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; idleCount = %@; allocationCount = %@; reuseCount = %@>",
+            self.class,
+            self,
+            @(self.idleCount),
+            @(self.allocationCount),
+            @(self.reuseCount)];
+}
+
+@end
@@ -0,0 +1,57 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsHeartbeatScheduler.h"
+#import "SRGAnalyticsStreamTracker.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A stream tracker update, as a step of a transition.
+ */
+@interface SRGAnalyticsStreamUpdate : NSObject
+
+/**
+ *  Create an update. Parameters have the same meaning as for `-[SRGAnalyticsStreamTracker updateWithStreamState:position:labels:]`.
+ */
++ (SRGAnalyticsStreamUpdate *)updateWithStreamState:(SRGAnalyticsStreamState)state
+                                           position:(NSTimeInterval)position
+                                             labels:(nullable SRGAnalyticsStreamLabels *)labels;
+
+- (instancetype)initWithStreamState:(SRGAnalyticsStreamState)state
+                           position:(NSTimeInterval)position
+                             labels:(nullable SRGAnalyticsStreamLabels *)labels NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) SRGAnalyticsStreamState state;
+@property (nonatomic, readonly) NSTimeInterval position;
+@property (nonatomic, readonly, nullable) SRGAnalyticsStreamLabels *labels;
+
+@end
+
+@interface SRGAnalyticsStreamUpdate (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+@interface SRGAnalyticsStreamTracker (Private)
+
+/**
+ *  Create a tracker instance sending heartbeats with the specified scheduler. Livestream playback durations are
+ *  measured with the scheduler clock.
+ */
+- (instancetype)initForLivestream:(BOOL)livestream heartbeatScheduler:(SRGAnalyticsHeartbeatScheduler *)heartbeatScheduler;
+
+/**
+ *  Update the tracker with a sequence of states in a single call (e.g. end and play when switching segments). Updates
+ *  are applied in order, as with successive calls to `-updateWithStreamState:position:labels:`, but resulting
+ *  TagCommander events are sent together.
+ */
+- (void)updateWithStreamUpdates:(NSArray<SRGAnalyticsStreamUpdate *> *)updates;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -6,47 +6,134 @@
 
 #import "SRGAnalyticsStreamTracker.h"
 
-#import "NSMutableDictionary+SRGAnalytics.h"
+#import "SRGAnalyticsInstrumentation+Private.h"
+#import "SRGAnalyticsLabels+Private.h"
+#import "SRGAnalyticsStreamLabels+Private.h"
+#import "SRGAnalyticsStreamSensePool.h"
+#import "SRGAnalyticsStreamStateMachine.h"
+#import "SRGAnalyticsStreamTracker+Private.h"
 #import "SRGAnalyticsTracker+Private.h"
 
 #import <ComScore/ComScore.h>
 #import <SRGAnalytics/SRGAnalytics.h>
 
-@interface SRGAnalyticsStreamTracker ()
+_Static_assert(SRGAnalyticsStreamMachineStatePlaying == SRGAnalyticsStreamStatePlaying
+               && SRGAnalyticsStreamMachineStatePaused == SRGAnalyticsStreamStatePaused
+               && SRGAnalyticsStreamMachineStateSeeking == SRGAnalyticsStreamStateSeeking
+               && SRGAnalyticsStreamMachineStateStopped == SRGAnalyticsStreamStateStopped
+               && SRGAnalyticsStreamMachineStateEnded == SRGAnalyticsStreamStateEnded, "Stream state values must match");
+
+static NSString * const SRGAnalyticsStreamTagCommanderEventUids[] = {
+    [SRGAnalyticsStreamMachineTagCommanderEventPlay] = @"play",
+    [SRGAnalyticsStreamMachineTagCommanderEventPause] = @"pause",
+    [SRGAnalyticsStreamMachineTagCommanderEventSeek] = @"seek",
+    [SRGAnalyticsStreamMachineTagCommanderEventStop] = @"stop",
+    [SRGAnalyticsStreamMachineTagCommanderEventEof] = @"eof"
+};
+
+static const CSStreamSenseEventType SRGAnalyticsStreamSenseEventTypes[] = {
+    [SRGAnalyticsStreamMachineComScoreEventPlay] = CSStreamSensePlay,
+    [SRGAnalyticsStreamMachineComScoreEventPause] = CSStreamSensePause,
+    [SRGAnalyticsStreamMachineComScoreEventEnd] = CSStreamSenseEnd
+};
+
+// comScore events emitted for an update (wrapped so that they can be captured by blocks)
+typedef struct {
+    SRGAnalyticsStreamMachineComScoreEvent events[SRGAnalyticsStreamMachineEventCountMax];
+    size_t count;
+} SRGAnalyticsStreamComScoreEvents;
+
+@interface SRGAnalyticsStreamTracker () <SRGAnalyticsHeartbeatSchedulerClient> {
+@private
+    SRGAnalyticsStreamMachine _stateMachine;
+}
 
 @property (nonatomic, getter=isLivestream) BOOL livestream;
 
+// Only accessed from comScore blocks (see `-[SRGAnalyticsTracker performRequiredComScoreBlock:]`)
 @property (nonatomic) CSStreamSense *streamSense;
 
-@property (nonatomic, getter=isComScoreSessionAlive) BOOL comScoreSessionAlive;
-@property (nonatomic) SRGAnalyticsStreamState previousPlayerState;
-
 @property (nonatomic) NSTimeInterval playbackDuration;
-@property (nonatomic) NSDate *previousPlaybackDurationUpdateDate;
+@property (nonatomic) NSTimeInterval previousPlaybackDurationUpdateTime;
 
-@property (nonatomic) NSTimer *heartbeatTimer;
+@property (nonatomic) SRGAnalyticsHeartbeatScheduler *heartbeatScheduler;
+@property (nonatomic, getter=isSendingHeartbeats) BOOL sendingHeartbeats;
 @property (nonatomic) NSUInteger heartbeatCount;
 
 @end
 
+@implementation SRGAnalyticsStreamUpdate
+
+#pragma mark Class methods
+
++ (SRGAnalyticsStreamUpdate *)updateWithStreamState:(SRGAnalyticsStreamState)state position:(NSTimeInterval)position labels:(SRGAnalyticsStreamLabels *)labels
+{
+    return [[self alloc] initWithStreamState:state position:position labels:labels];
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithStreamState:(SRGAnalyticsStreamState)state position:(NSTimeInterval)position labels:(SRGAnalyticsStreamLabels *)labels
+{
+    if (self = [super init]) {
+        _state = state;
+        _position = position;
+        _labels = labels;
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithStreamState:SRGAnalyticsStreamStateStopped position:0. labels:nil];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; state = %@; position = %@>",
+            self.class,
+            self,
+            @(self.state),
+            @(self.position)];
+}
+
+@end
+
 @implementation SRGAnalyticsStreamTracker
 
 #pragma mark Object lifecycle
 
-- (instancetype)initForLivestream:(BOOL)livestream
+- (instancetype)initForLivestream:(BOOL)livestream heartbeatScheduler:(SRGAnalyticsHeartbeatScheduler *)heartbeatScheduler
 {
     if (self = [super init]) {
         self.livestream = livestream;
+        self.heartbeatScheduler = heartbeatScheduler;
         
-        // The default keep-alive time interval of 20 minutes is too big. Set it to 9 minutes
-        self.streamSense = [[CSStreamSense alloc] init];
-        [self.streamSense setKeepAliveInterval:9 * 60];
+        // StreamSense calls are made in order with other comScore calls, once the comScore SDK has been configured
+        [SRGAnalyticsTracker.sharedTracker performRequiredComScoreBlock:^{
+            self.streamSense = [SRGAnalyticsStreamSensePool.sharedPool dequeueStreamSense];
+        }];
         
-        self.previousPlayerState = SRGAnalyticsStreamStateEnded;
+        SRGAnalyticsStreamMachineInit(&_stateMachine);
+        self.previousPlaybackDurationUpdateTime = NAN;
     }
     return self;
 }
 
+- (instancetype)initForLivestream:(BOOL)livestream
+{
+    // Heartbeats of all trackers are sent by a shared scheduler, so that concurrent trackers send them together
+    return [self initForLivestream:livestream heartbeatScheduler:SRGAnalyticsHeartbeatScheduler.sharedScheduler];
+}
+
 - (instancetype)init
 {
     return [self initForLivestream:NO];
@@ -54,16 +141,33 @@
 
 - (void)dealloc
 {
-    self.heartbeatTimer = nil;      // Invalidate timer
+    // StreamSense objects are costly to create. Make them available to the next playback session, recycling them where
+    // other StreamSense calls are made since they are not thread-safe
+    CSStreamSense *streamSense = _streamSense;
+    if (streamSense) {
+        [SRGAnalyticsTracker.sharedTracker performRequiredComScoreBlock:^{
+            [SRGAnalyticsStreamSensePool.sharedPool recycleStreamSense:streamSense];
+        }];
+    }
 }
 
 #pragma mark Getters and setters
 
-- (void)setHeartbeatTimer:(NSTimer *)heartbeatTimer
+- (void)setSendingHeartbeats:(BOOL)sendingHeartbeats
 {
-    [_heartbeatTimer invalidate];
-    _heartbeatTimer = heartbeatTimer;
+    if (sendingHeartbeats == _sendingHeartbeats) {
+        return;
+    }
+    
+    _sendingHeartbeats = sendingHeartbeats;
     self.heartbeatCount = 0;
+    
+    if (sendingHeartbeats) {
+        [self.heartbeatScheduler addClient:self];
+    }
+    else {
+        [self.heartbeatScheduler removeClient:self];
+    }
 }
 
 #pragma mark Tracking
@@ -72,141 +176,139 @@
                      position:(NSTimeInterval)position
                        labels:(SRGAnalyticsStreamLabels *)labels
 {
-    [self updateTagCommanderWithStreamState:state position:position labels:labels];
+    NSMutableArray<SRGAnalyticsLabelSet *> *tagCommanderLabelSets = [NSMutableArray arrayWithCapacity:SRGAnalyticsStreamMachineEventCountMax];
+    [self updateTagCommanderWithStreamState:state position:position labels:labels labelSets:tagCommanderLabelSets];
+    [self trackTagCommanderEventsWithLabelSets:tagCommanderLabelSets];
     [self updateComScoreWithStreamState:state position:position labels:labels];
 }
 
+- (void)updateWithStreamUpdates:(NSArray<SRGAnalyticsStreamUpdate *> *)updates
+{
+    // Run the whole sequence through the state machine first, so that TagCommander events are sent together
+    NSMutableArray<SRGAnalyticsLabelSet *> *tagCommanderLabelSets = [NSMutableArray arrayWithCapacity:SRGAnalyticsStreamMachineEventCountMax * updates.count];
+    for (SRGAnalyticsStreamUpdate *update in updates) {
+        [self updateTagCommanderWithStreamState:update.state position:update.position labels:update.labels labelSets:tagCommanderLabelSets];
+        [self updateComScoreWithStreamState:update.state position:update.position labels:update.labels];
+    }
+    [self trackTagCommanderEventsWithLabelSets:tagCommanderLabelSets];
+}
+
+- (void)trackTagCommanderEventsWithLabelSets:(NSArray<SRGAnalyticsLabelSet *> *)labelSets
+{
+    if (labelSets.count == 0) {
+        return;
+    }
+    
+    // The state machine has already advanced. Events must therefore not be dropped, otherwise the session would be
+    // reported inconsistently
+    [SRGAnalyticsTracker.sharedTracker trackRequiredTagCommanderEventsWithLabelSets:labelSets];
+}
+
 - (void)updateComScoreWithStreamState:(SRGAnalyticsStreamState)state
                              position:(NSTimeInterval)position
                                labels:(SRGAnalyticsStreamLabels *)labels
 {
-    // Ensure a play is emitted before events requiring a session to be opened (the comScore SDK does not open sessions
-    // automatically)
-    if (! self.comScoreSessionAlive && (state == SRGAnalyticsStreamStatePaused || state == SRGAnalyticsStreamStateSeeking)) {
-        [self updateComScoreWithStreamState:SRGAnalyticsStreamStatePlaying position:position labels:labels];
+    SRGAnalyticsStreamComScoreEvents events;
+    events.count = SRGAnalyticsStreamMachineUpdateComScore(&_stateMachine, (SRGAnalyticsStreamMachineState)state, events.events);
+    if (events.count == 0) {
+        return;
     }
     
-    static dispatch_once_t s_onceToken;
-    static NSDictionary<NSNumber *, NSNumber *> *s_streamSenseEvents;
-    dispatch_once(&s_onceToken, ^{
-        s_streamSenseEvents = @{ @(SRGAnalyticsStreamStatePlaying) : @(CSStreamSensePlay),
-                                 @(SRGAnalyticsStreamStatePaused) : @(CSStreamSensePause),
-                                 @(SRGAnalyticsStreamStateSeeking) : @(CSStreamSensePause),
-                                 @(SRGAnalyticsStreamStateStopped) : @(CSStreamSenseEnd),
-                                 @(SRGAnalyticsStreamStateEnded) : @(CSStreamSenseEnd) };
-    });
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
     
-    NSNumber *eventTypeValue = s_streamSenseEvents[@(state)];
-    if (! eventTypeValue) {
-        return;
-    }
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [labels fillComScoreLabelSet:labelSet];
     
-    [[self.streamSense labels] removeAllObjects];
-    [[labels comScoreLabelsDictionary] enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
-        [self.streamSense setLabel:key value:object];
-    }];
+    SRGAnalyticsLabelSet *segmentLabelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [labels fillComScoreSegmentLabelSet:segmentLabelSet];
     
-    // Reset clip labels to avoid inheriting from a previous segment. This does not reset internal hidden comScore labels
-    // (e.g. ns_st_pa), which would otherwise be incorrect
-    [[[self.streamSense clip] labels] removeAllObjects];
-    [[labels comScoreSegmentLabelsDictionary] enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
-        [[self.streamSense clip] setLabel:key value:object];
-    }];
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageLabelBuilding, timestamp);
     
     if (self.livestream) {
         position = 0;
     }
     
-    CSStreamSenseEventType eventType = eventTypeValue.intValue;
-    [self.streamSense notify:eventType position:position labels:nil /* already set on the stream and clip objects */];
-    
-    if (eventType == CSStreamSensePlay) {
-        self.comScoreSessionAlive = YES;
-    }
-    else if (eventType == CSStreamSenseEnd) {
-        self.comScoreSessionAlive = NO;
-    }
+    // Same as for TagCommander events, StreamSense must follow the state machine
+    [SRGAnalyticsTracker.sharedTracker performRequiredComScoreBlock:^{
+        CSStreamSense *streamSense = self.streamSense;
+        
+        // Labels are kept by the stream and clip objects between events. Only apply changes, as most labels are the same
+        // from one event to the next
+        [self applyLabelSet:labelSet toStreamSenseLabels:[streamSense labels] setter:^(NSString *key, NSString *object) {
+            [streamSense setLabel:key value:object];
+        }];
+        
+        // Obsolete clip labels are removed as well to avoid inheriting from a previous segment. This does not reset internal
+        // hidden comScore labels (e.g. ns_st_pa), which would otherwise be incorrect
+        CSStreamSenseClip *clip = [streamSense clip];
+        [self applyLabelSet:segmentLabelSet toStreamSenseLabels:[clip labels] setter:^(NSString *key, NSString *object) {
+            [clip setLabel:key value:object];
+        }];
+        
+        // A play might be emitted first to open the session
+        for (size_t i = 0; i < events.count; ++i) {
+            SRGAnalyticsInstrumentationMeasure(SRGAnalyticsInstrumentationStageComScore,
+                                               [streamSense notify:SRGAnalyticsStreamSenseEventTypes[events.events[i]] position:position labels:nil /* already set on the stream and clip objects */]);
+        }
+    }];
+}
+
+// Make the labels of a stream or clip object match the specified label set
+- (void)applyLabelSet:(SRGAnalyticsLabelSet *)labelSet
+  toStreamSenseLabels:(NSMutableDictionary *)streamSenseLabels
+               setter:(void (NS_NOESCAPE ^)(NSString *key, NSString *object))setter
+{
+    [labelSet enumerateChangesFromDictionary:streamSenseLabels usingBlock:^(NSString * _Nonnull key, NSString * _Nullable object) {
+        if (object) {
+            setter(key, object);
+        }
+        else {
+            [streamSenseLabels removeObjectForKey:key];
+        }
+    }];
 }
 
+// Append the labels of the TagCommander events to send, if any, to the specified array
 - (void)updateTagCommanderWithStreamState:(SRGAnalyticsStreamState)state
                                  position:(NSTimeInterval)position
                                    labels:(SRGAnalyticsStreamLabels *)labels
+                                labelSets:(NSMutableArray<SRGAnalyticsLabelSet *> *)labelSets
 {
-    // Ensure a play is emitted before events requiring a session to be opened (the TagCommander SDK does not open sessions
-    // automatically)
-    if (self.previousPlayerState == SRGAnalyticsStreamStateEnded && (state == SRGAnalyticsStreamStatePaused || state == SRGAnalyticsStreamStateSeeking)) {
-        [self updateTagCommanderWithStreamState:SRGAnalyticsStreamStatePlaying position:position labels:labels];
+    // A play might be accepted first to open the session. Unknown and unallowed states are not accepted
+    SRGAnalyticsStreamMachineState acceptedStates[SRGAnalyticsStreamMachineEventCountMax];
+    size_t count = SRGAnalyticsStreamMachineUpdateTagCommander(&_stateMachine, (SRGAnalyticsStreamMachineState)state, acceptedStates);
+    if (count == 0 || acceptedStates[count - 1] != (SRGAnalyticsStreamMachineState)state) {
+        SRGAnalyticsInstrumentationCount(SRGAnalyticsInstrumentationCounterRejectedStreamTransitions, 1);
     }
+    SRGAnalyticsInstrumentationCount(SRGAnalyticsInstrumentationCounterStreamEvents, count);
     
-    static dispatch_once_t s_onceToken;
-    static NSDictionary<NSNumber *, NSString *> *s_eventUids;
-    static NSDictionary<NSNumber *, NSArray<NSNumber *> *> *s_transitions;
-    dispatch_once(&s_onceToken, ^{
-        s_eventUids = @{ @(SRGAnalyticsStreamStatePlaying) : @"play",
-                         @(SRGAnalyticsStreamStatePaused) : @"pause",
-                         @(SRGAnalyticsStreamStateSeeking) : @"seek",
-                         @(SRGAnalyticsStreamStateStopped) : @"stop",
-                         @(SRGAnalyticsStreamStateEnded) : @"eof" };
-        s_transitions = @{ @(SRGAnalyticsStreamStatePlaying) : @[ @(SRGAnalyticsStreamStatePaused), @(SRGAnalyticsStreamStateSeeking), @(SRGAnalyticsStreamStateStopped), @(SRGAnalyticsStreamStateEnded) ],
-                           @(SRGAnalyticsStreamStatePaused) : @[ @(SRGAnalyticsStreamStatePlaying), @(SRGAnalyticsStreamStateSeeking), @(SRGAnalyticsStreamStateStopped), @(SRGAnalyticsStreamStateEnded) ],
-                           @(SRGAnalyticsStreamStateSeeking) : @[ @(SRGAnalyticsStreamStatePlaying), @(SRGAnalyticsStreamStatePaused), @(SRGAnalyticsStreamStateStopped), @(SRGAnalyticsStreamStateEnded) ],
-                           @(SRGAnalyticsStreamStateStopped) : @[ @(SRGAnalyticsStreamStatePlaying) ],
-                           @(SRGAnalyticsStreamStateEnded) : @[ @(SRGAnalyticsStreamStatePlaying) ] };
-    });
-    
-    // Don't send an unknown action
-    NSString *action = s_eventUids[@(state)];
-    if (! action) {
-        return;
-    }
-    
-    // Don't send an unallowed action
-    if (! [s_transitions[@(self.previousPlayerState)] containsObject:@(state)]) {
-        return;
-    }
-    
-    self.previousPlayerState = state;
-    
-    // Restore the heartbeat timer when transitioning to play again.
-    if (state == SRGAnalyticsStreamStatePlaying) {
-        if (! self.heartbeatTimer) {
-            SRGAnalyticsConfiguration *configuration = SRGAnalyticsTracker.sharedTracker.configuration;
-            NSTimeInterval heartbeatInterval = configuration.unitTesting ? 3. : 30.;
-            self.heartbeatTimer = [NSTimer scheduledTimerWithTimeInterval:heartbeatInterval
-                                                                   target:self
-                                                                 selector:@selector(heartbeat:)
-                                                                 userInfo:nil
-                                                                  repeats:YES];
-        }
-    }
-    // Remove the heartbeat when not playing
-    else {
-        self.heartbeatTimer = nil;
-    }
-    
-    // Override position if it is a livestream
-    if (self.livestream) {
-        position = [self updatedPlaybackDurationWithState:state];
+    for (size_t i = 0; i < count; ++i) {
+        SRGAnalyticsStreamState acceptedState = (SRGAnalyticsStreamState)acceptedStates[i];
+        
+        // Heartbeats are only sent while playing
+        self.sendingHeartbeats = (acceptedState == SRGAnalyticsStreamStatePlaying);
+        
+        // Override position if it is a livestream
+        NSTimeInterval eventPosition = self.livestream ? [self updatedPlaybackDurationWithState:acceptedState] : position;
+        
+        SRGAnalyticsStreamMachineTagCommanderEvent event = SRGAnalyticsStreamMachineTagCommanderEventForState(acceptedStates[i]);
+        [labelSets addObject:[self tagCommanderLabelSetForMediaPlayerEventWithUid:SRGAnalyticsStreamTagCommanderEventUids[event] withPosition:eventPosition labels:labels]];
     }
-    
-    // Send the event
-    [self trackTagCommanderMediaPlayerEventWithUid:action withPosition:position labels:labels];
 }
 
-- (void)trackTagCommanderMediaPlayerEventWithUid:(NSString *)eventUid withPosition:(NSTimeInterval)position labels:(SRGAnalyticsStreamLabels *)labels
+- (SRGAnalyticsLabelSet *)tagCommanderLabelSetForMediaPlayerEventWithUid:(NSString *)eventUid withPosition:(NSTimeInterval)position labels:(SRGAnalyticsStreamLabels *)labels
 {
     NSAssert(eventUid.length != 0, @"An event uid is required");
     
-    NSMutableDictionary<NSString *, NSString *> *fullLabelsDictionary = [NSMutableDictionary dictionary];
-    [fullLabelsDictionary srg_safelySetString:eventUid forKey:@"event_id"];
-    [fullLabelsDictionary srg_safelySetString:@(round(position / 1000)).stringValue forKey:@"media_position"];
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
     
-    NSDictionary<NSString *, NSString *> *labelsDictionary = [labels labelsDictionary];
-    if (labelsDictionary) {
-        [fullLabelsDictionary addEntriesFromDictionary:labelsDictionary];
-    }
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsTracker.sharedTracker tagCommanderEventLabelSet];
+    [labelSet setString:eventUid forKey:@"event_id"];
+    [labelSet setString:@(round(position / 1000)).stringValue forKey:@"media_position"];
+    [labels fillLabelSet:labelSet];
     
-    [SRGAnalyticsTracker.sharedTracker trackTagCommanderEventWithLabels:[fullLabelsDictionary copy]];
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageLabelBuilding, timestamp);
+    return labelSet;
 }
 
 #pragma mark Playback duration
@@ -215,16 +317,13 @@
 {
     NSAssert(self.livestream, @"Duration calculated for livestreams only");
     
-    if (self.previousPlaybackDurationUpdateDate) {
-        self.playbackDuration -= [self.previousPlaybackDurationUpdateDate timeIntervalSinceNow] * 1000;
+    // Use the heartbeat clock, so that durations and heartbeat positions are measured consistently
+    NSTimeInterval currentTime = self.heartbeatScheduler.clock.currentTime;
+    if (! isnan(self.previousPlaybackDurationUpdateTime)) {
+        self.playbackDuration += (currentTime - self.previousPlaybackDurationUpdateTime) * 1000;
     }
     
-    if (state == SRGAnalyticsStreamStatePlaying) {
-        self.previousPlaybackDurationUpdateDate = NSDate.date;
-    }
-    else {
-        self.previousPlaybackDurationUpdateDate = nil;
-    }
+    self.previousPlaybackDurationUpdateTime = (state == SRGAnalyticsStreamStatePlaying) ? currentTime : NAN;
     
     NSTimeInterval playbackDuration = self.playbackDuration;
     
@@ -235,11 +334,13 @@
     return playbackDuration;
 }
 
-#pragma mark Timers
+#pragma mark SRGAnalyticsHeartbeatSchedulerClient protocol
 
-- (void)heartbeat:(NSTimer *)timer
+- (NSArray<SRGAnalyticsLabelSet *> *)heartbeatLabelSetsForScheduler:(SRGAnalyticsHeartbeatScheduler *)scheduler
 {
-    NSAssert(self.previousPlayerState == SRGAnalyticsStreamStatePlaying, @"Heartbeat timer is only active when playing by construction");
+    NSAssert(_stateMachine.tagCommanderState == SRGAnalyticsStreamMachineStatePlaying, @"Heartbeats are only sent when playing by construction");
+    
+    NSMutableArray<SRGAnalyticsLabelSet *> *labelSets = [NSMutableArray array];
     
     if (self.delegate) {
         NSTimeInterval position = [self.delegate positionForStreamTracker:self];
@@ -250,15 +351,18 @@
         }
         
         SRGAnalyticsStreamLabels *labels = [self.delegate labelsForStreamTracker:self];
-        [self trackTagCommanderMediaPlayerEventWithUid:@"pos" withPosition:position labels:labels];
+        [labelSets addObject:[self tagCommanderLabelSetForMediaPlayerEventWithUid:@"pos" withPosition:position labels:labels]];
         
         // Send a live heartbeat each minute
         if ([self.delegate streamTrackerIsPlayingLive:self] && self.heartbeatCount % 2 != 0) {
-            [self trackTagCommanderMediaPlayerEventWithUid:@"uptime" withPosition:position labels:labels];
+            [labelSets addObject:[self tagCommanderLabelSetForMediaPlayerEventWithUid:@"uptime" withPosition:position labels:labels]];
         }
     }
     
     self.heartbeatCount += 1;
+    SRGAnalyticsInstrumentationCount(SRGAnalyticsInstrumentationCounterHeartbeats, labelSets.count);
+    
+    return [labelSets copy];
 }
 
 @end
@@ -4,15 +4,99 @@
 //  License information is available from the LICENSE file.
 //
 
+#import "SRGAnalyticsEvent+Private.h"
+#import "SRGAnalyticsGlobalLabelsSnapshot.h"
+#import "SRGAnalyticsLabelSet.h"
 #import "SRGAnalyticsTracker.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 @interface SRGAnalyticsTracker (Private)
 
-@property (nonatomic, nullable) NSDictionary<NSString *, NSString *> *globalLabels;
+/**
+ *  The current global labels snapshot. Can be read from any thread.
+ */
+@property (nonatomic, readonly) SRGAnalyticsGlobalLabelsSnapshot *globalLabelsSnapshot;
 
-- (void)trackTagCommanderEventWithLabels:(nullable NSDictionary<NSString *, NSString *> *)labels;
+/**
+ *  Replace global labels with those returned by the block, which is called with the current global labels. Updates
+ *  are serialized and can be made from any thread. Events created afterwards use the new labels, while events already
+ *  created keep the labels they were created with.
+ */
+- (void)updateGlobalLabelsWithBlock:(NSDictionary<NSString *, NSString *> * _Nullable (NS_NOESCAPE ^)(NSDictionary<NSString *, NSString *> *globalLabels))block;
+
+/**
+ *  Perform a block asynchronously on the tracker event queue, in the order in which blocks are submitted. Blocks submitted
+ *  from the event queue itself are performed immediately. The caller is never blocked: if too many blocks are pending, the
+ *  block is dropped (and counted as dropped event).
+ */
+- (void)performEventBlock:(void (^)(void))block;
+
+/**
+ *  Same as `-performEventBlock:`, but the block is never dropped. Use for events which must be balanced (e.g. stream
+ *  events, whose state is tracked by the caller).
+ */
+- (void)performRequiredEventBlock:(void (^)(void))block;
+
+/**
+ *  Perform a block making comScore SDK calls. The block is performed asynchronously on the main thread, in the order in
+ *  which blocks are submitted, and after the comScore SDK has been configured. Same dropping rules as for `-performEventBlock:`
+ *  apply.
+ */
+- (void)performComScoreBlock:(void (^)(void))block;
+
+/**
+ *  Same as `-performComScoreBlock:`, but the block is never dropped. Use for calls which must be balanced (e.g. objects
+ *  taken from a pool and returned to it, or StreamSense events).
+ */
+- (void)performRequiredComScoreBlock:(void (^)(void))block;
+
+/**
+ *  Create an empty label set for a TagCommander event, on top of the current global labels. Labels set on the returned
+ *  label set override global labels.
+ */
+- (SRGAnalyticsLabelSet *)tagCommanderEventLabelSet;
+
+/**
+ *  Send a TagCommander event with the specified labels, which must have been created with `-tagCommanderEventLabelSet`
+ *  and must not be mutated afterwards. The event is processed asynchronously on the tracker event queue, in the order
+ *  in which it was received.
+ */
+- (void)trackTagCommanderEventWithLabelSet:(SRGAnalyticsLabelSet *)labelSet;
+
+/**
+ *  Send several TagCommander events at once, in order. Same rules as for `-trackTagCommanderEventWithLabelSet:` apply.
+ */
+- (void)trackTagCommanderEventsWithLabelSets:(NSArray<SRGAnalyticsLabelSet *> *)labelSets;
+
+/**
+ *  Same as `-trackTagCommanderEventsWithLabelSets:`, but events are never dropped.
+ */
+- (void)trackRequiredTagCommanderEventsWithLabelSets:(NSArray<SRGAnalyticsLabelSet *> *)labelSets;
+
+/**
+ *  Page view label assembly, without sending any event.
+ */
+- (SRGAnalyticsLabelSet *)comScorePageViewLabelSetWithTitle:(NSString *)title
+                                                     levels:(nullable NSArray<NSString *> *)levels
+                                                     labels:(nullable SRGAnalyticsPageViewLabels *)labels
+                                       fromPushNotification:(BOOL)fromPushNotification;
+- (void)fillTagCommanderPageViewLabelSet:(SRGAnalyticsLabelSet *)labelSet
+                               withTitle:(NSString *)title
+                                  levels:(nullable NSArray<NSString *> *)levels
+                                  labels:(nullable SRGAnalyticsPageViewLabels *)labels
+                    fromPushNotification:(BOOL)fromPushNotification;
+
+/**
+ *  Return `YES` iff some event sink is subscribed to at least one of the specified event types. Cheap enough to be
+ *  called for each event before creating its record.
+ */
+- (BOOL)hasEventSinkForEventTypes:(SRGAnalyticsEventTypes)eventTypes;
+
+/**
+ *  Deliver an event to the sinks subscribed to its type, on the calling thread.
+ */
+- (void)sendEventToSinks:(SRGAnalyticsEvent *)event;
 
 @end
 
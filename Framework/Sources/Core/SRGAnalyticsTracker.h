@@ -5,7 +5,10 @@
 //
 
 #import "SRGAnalyticsConfiguration.h"
+#import "SRGAnalyticsEvent.h"
+#import "SRGAnalyticsEventRecorder.h"
 #import "SRGAnalyticsHiddenEventLabels.h"
+#import "SRGAnalyticsInstrumentation.h"
 #import "SRGAnalyticsPageViewLabels.h"
 
 #import <Foundation/Foundation.h>
@@ -31,6 +34,15 @@ NS_ASSUME_NONNULL_BEGIN
  *  labels can be provided through an optional labels object. In all cases, mandatory and optional information is
  *  transparently routed to the analytics services.
  *
+ *  Measurements are processed asynchronously on a dedicated serial queue, in the order in which they were made. Tracking
+ *  methods therefore return immediately, without waiting for labels to be assembled and sent.
+ *
+ *  Callers are never blocked. If too many measurements are waiting to be processed (e.g. page views or hidden events
+ *  tracked in a tight loop), new page views, hidden events and stream heartbeats are dropped until the backlog has been
+ *  processed. Dropped events are logged and counted by instrumentation (see `SRGAnalyticsInstrumentationCounterDroppedEvents`). Stream
+ *  playback events (play, pause, seek, stop, end) are never dropped, so that playback sessions are always reported
+ *  consistently.
+ *
  *  ## Usage
  *
  *  Using SRGAnalytics in your application is intended to be as easy as possible. Note that since the analytics tracker is
@@ -150,6 +162,90 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/**
+ *  @name Instrumentation
+ */
+@interface SRGAnalyticsTracker (Instrumentation)
+
+/**
+ *  Snapshot of the latencies and counters accumulated since the last reset, `nil` if instrumentation is not available.
+ *
+ *  @discussion Instrumentation is available in debug builds. For other builds, the library must be compiled with the
+ *              `SRG_ANALYTICS_INSTRUMENTATION=1` preprocessor macro, otherwise it is compiled out entirely.
+ */
+@property (nonatomic, readonly, nullable) SRGAnalyticsInstrumentationSnapshot *instrumentationSnapshot;
+
+/**
+ *  Reset latencies and counters, returning a snapshot of their values before the reset (`nil` if instrumentation is
+ *  not available). Each recorded value is reflected in exactly one snapshot returned by this method.
+ */
+- (nullable SRGAnalyticsInstrumentationSnapshot *)resetInstrumentation;
+
+@end
+
+/**
+ *  @name Event sinks
+ */
+@interface SRGAnalyticsTracker (EventSinks)
+
+/**
+ *  Add a sink receiving events of the specified types as they are sent. If the `unitTesting` configuration flag is set,
+ *  sinks receive the same events as unit testing notifications. Subscriptions are evaluated before event records are
+ *  created, so that events no sink is interested in incur no additional cost.
+ *
+ *  @param sink       The sink to add. Sinks are not retained. Adding a sink again replaces its subscription.
+ *  @param eventTypes The types of the events to receive.
+ *
+ *  @discussion Unlike unit testing notifications, sinks are called directly, @see `SRGAnalyticsEventSink`. comScore
+ *              events are only available from the shared tracker.
+ */
+- (void)addEventSink:(id<SRGAnalyticsEventSink>)sink forEventTypes:(SRGAnalyticsEventTypes)eventTypes;
+
+/**
+ *  Remove a sink. Events already being delivered might still be received after this method returns.
+ */
+- (void)removeEventSink:(id<SRGAnalyticsEventSink>)sink;
+
+@end
+
+/**
+ *  @name Recording and replay
+ */
+@interface SRGAnalyticsTracker (Recording)
+
+/**
+ *  Start recording all events sent by the tracker to the specified file, @see `SRGAnalyticsEventRecorder`. A recording
+ *  in progress is stopped first.
+ */
+- (void)startRecordingToFileURL:(NSURL *)fileURL;
+
+/**
+ *  Stop recording. Once this method returns, all events recorded so far have been written.
+ */
+- (void)stopRecording;
+
+/**
+ *  Return `YES` iff a recording is in progress.
+ */
+@property (nonatomic, readonly, getter=isRecording) BOOL recording;
+
+/**
+ *  Replay recorded events, in order and as fast as possible. Replayed events are only delivered to event sinks. No
+ *  analytics SDK is ever called and no request is made.
+ *
+ *  TagCommander page views and hidden events recorded with their input (@see `SRGAnalyticsEvent.input`) are built
+ *  again from it, with the current global labels, and result in TagCommander and comScore events. Recorded comScore
+ *  page views and hidden events are therefore skipped. Replayed comScore events only contain the labels the tracker
+ *  provides to the comScore SDK, not those the SDK adds itself. Other events (including stream events, whose input is
+ *  not recorded) are delivered as they were recorded.
+ *
+ *  @param events          The events to replay, e.g. read with `+[SRGAnalyticsEventRecorder eventsWithContentsOfFileURL:]`.
+ *  @param completionBlock Block called on a background thread once all events have been delivered.
+ */
+- (void)replayEvents:(NSArray<SRGAnalyticsEvent *> *)events withCompletionBlock:(nullable void (^)(void))completionBlock;
+
+@end
+
 @interface SRGAnalyticsTracker (Unavailable)
 
 - (instancetype)init NS_UNAVAILABLE;
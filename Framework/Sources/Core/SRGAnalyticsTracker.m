@@ -7,33 +7,102 @@
 #import "SRGAnalyticsTracker.h"
 
 #import "NSBundle+SRGAnalytics.h"
-#import "NSMutableDictionary+SRGAnalytics.h"
 #import "NSString+SRGAnalytics.h"
 #import "SRGAnalytics.h"
+#import "SRGAnalyticsApplicationListMeasurement.h"
+#import "SRGAnalyticsEventJournal.h"
+#import "SRGAnalyticsGlobalLabelsSnapshot.h"
+#import "SRGAnalyticsHeartbeatScheduler.h"
+#import "SRGAnalyticsInstrumentation+Private.h"
+#import "SRGAnalyticsLabels+Private.h"
 #import "SRGAnalyticsLogger.h"
 #import "SRGAnalyticsNetMetrixTracker.h"
 #import "SRGAnalyticsNotifications.h"
+#import "SRGAnalyticsStreamSensePool.h"
+#import "SRGAnalyticsTracker+Private.h"
 #import "UIViewController+SRGAnalytics.h"
 
 #import <ComScore/ComScore.h>
 #import <ComScore/CSTaskExecutor.h>
+#import <libextobjc/libextobjc.h>
+#import <pthread.h>
+#import <stdatomic.h>
 #import <TCCore/TCCore.h>
 #import <TCSDK/TCSDK.h>
 
+// Maximum number of events which can be pending on the event queue. When reached, new events are dropped so that
+// callers (usually on the main thread) are never blocked
+static const long SRGAnalyticsMaximumPendingEventCount = 128;
+
+static void *s_eventQueueKey = &s_eventQueueKey;
+
+// Keys of the tracker inputs attached to TagCommander page views and hidden events, @see `SRGAnalyticsEvent.input`
+static NSString * const SRGAnalyticsInputTitleKey = @"title";
+static NSString * const SRGAnalyticsInputLevelsKey = @"levels";
+static NSString * const SRGAnalyticsInputFromPushNotificationKey = @"push";
+static NSString * const SRGAnalyticsInputNameKey = @"name";
+static NSString * const SRGAnalyticsInputLabelsKey = @"labels";
+static NSString * const SRGAnalyticsInputComScoreLabelsKey = @"comscore_labels";
+
+static BOOL SRGAnalyticsIsStringArray(id object)
+{
+    if (! [object isKindOfClass:NSArray.class]) {
+        return NO;
+    }
+    
+    for (id item in object) {
+        if (! [item isKindOfClass:NSString.class]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+static BOOL SRGAnalyticsIsStringDictionary(id object)
+{
+    if (! [object isKindOfClass:NSDictionary.class]) {
+        return NO;
+    }
+    
+    __block BOOL valid = YES;
+    [object enumerateKeysAndObjectsUsingBlock:^(id _Nonnull key, id _Nonnull value, BOOL * _Nonnull stop) {
+        if (! [key isKindOfClass:NSString.class] || ! [value isKindOfClass:NSString.class]) {
+            valid = NO;
+            *stop = YES;
+        }
+    }];
+    return valid;
+}
+
 __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
 {
     [TCDebug setDebugLevel:TCLogLevel_None];
 }
 
-@interface SRGAnalyticsTracker ()
+@interface SRGAnalyticsTracker () {
+@private
+    // Readers retain the snapshot under the lock, so that it cannot be released by a concurrent update before they do
+    pthread_mutex_t _globalLabelsSnapshotMutex;
+    SRGAnalyticsGlobalLabelsSnapshot *_globalLabelsSnapshot;
+    
+    // Union of the event types sinks are subscribed to, read without lock
+    _Atomic(SRGAnalyticsEventTypes) _eventSinkTypes;
+}
 
 @property (nonatomic, copy) SRGAnalyticsConfiguration *configuration;
 
 @property (nonatomic) TagCommander *tagCommander;
+@property (nonatomic) SRGAnalyticsEventJournal *tagCommanderJournal;
 @property (nonatomic) SRGAnalyticsNetMetrixTracker *netmetrixTracker;
-@property (nonatomic) CSStreamSense *streamSense;
+@property (nonatomic) SRGAnalyticsApplicationListMeasurement *applicationListMeasurement;
+
+@property (nonatomic) NSMapTable<id<SRGAnalyticsEventSink>, NSNumber *> *eventSinks;          // Event types, as `SRGAnalyticsEventTypes`
+@property (nonatomic) SRGAnalyticsEventRecorder *eventRecorder;
 
-@property (nonatomic) NSDictionary<NSString *, NSString *> *globalLabels;
+@property (nonatomic) dispatch_queue_t eventQueue;
+@property (nonatomic) dispatch_semaphore_t pendingEventsSemaphore;
+
+@property (nonatomic) dispatch_queue_t replayQueue;
 
 @end
 
@@ -51,20 +120,87 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
     return s_sharedInstance;
 }
 
+#pragma mark Object lifecycle
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        // Labels are assembled and sent to the analytics SDKs on a serial background queue, so that callers (most
+        // notably view controllers reaching the tracker during transitions) are never blocked by event processing
+        self.eventQueue = dispatch_queue_create("ch.srgssr.analytics.events", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(self.eventQueue, s_eventQueueKey, s_eventQueueKey, NULL);
+        self.pendingEventsSemaphore = dispatch_semaphore_create(SRGAnalyticsMaximumPendingEventCount);
+        self.replayQueue = dispatch_queue_create("ch.srgssr.analytics.replay", DISPATCH_QUEUE_SERIAL);
+        
+        pthread_mutex_init(&_globalLabelsSnapshotMutex, NULL);
+        _globalLabelsSnapshot = [[SRGAnalyticsGlobalLabelsSnapshot alloc] initWithLabels:nil version:0];
+        
+        self.eventSinks = [NSMapTable weakToStrongObjectsMapTable];
+        atomic_init(&_eventSinkTypes, 0);
+    }
+    return self;
+}
+
+#pragma clang diagnostic pop
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_globalLabelsSnapshotMutex);
+}
+
 #pragma mark Startup
 
 - (void)startWithConfiguration:(SRGAnalyticsConfiguration *)configuration
 {
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+    
     self.configuration = configuration;
     
-    [self startTagCommanderTrackerWithConfiguration:configuration];
-    [self startComscoreTrackerWithConfiguration:configuration];
-    [self startNetmetrixTrackerWithConfiguration:configuration];
+    // UIKit information is captured on the calling thread
+    NSString *device = [self device];
+    
+    // Heartbeats are sent more often when unit testing, so that tests do not last too long
+    NSTimeInterval heartbeatInterval = configuration.unitTesting ? 3. : 30.;
+    [SRGAnalyticsHeartbeatScheduler.sharedScheduler setInterval:heartbeatInterval tolerance:0.1 * heartbeatInterval];
     
-    [self sendApplicationList];
+    [self performStartupStage:SRGAnalyticsInstrumentationStageTagCommanderStartup withBlock:^{
+        [self startTagCommanderTrackerWithConfiguration:configuration device:device];
+    }];
+    [self performStartupStage:SRGAnalyticsInstrumentationStageComScoreStartup withBlock:^{
+        [self startComscoreTrackerWithConfiguration:configuration];
+    }];
+    [self performStartupStage:SRGAnalyticsInstrumentationStageNetMetrixStartup withBlock:^{
+        [self startNetmetrixTrackerWithConfiguration:configuration];
+    }];
+    [self performStartupStage:SRGAnalyticsInstrumentationStageApplicationListStartup withBlock:^{
+        [self sendApplicationList];
+    }];
+    
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageStartup, timestamp);
+}
+
+- (void)performStartupStage:(SRGAnalyticsInstrumentationStage)stage withBlock:(void (^)(void))block
+{
+    void (^stageBlock)(void) = ^{
+        uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+        block();
+        SRGAnalyticsInstrumentationRecordStage(stage, timestamp);
+    };
+    
+    // Stages are performed in order on the event queue. Events received in the meantime are enqueued after them, and
+    // are therefore processed in order once all services have been started
+    if (self.configuration.startupStaged) {
+        dispatch_async(self.eventQueue, stageBlock);
+    }
+    else {
+        stageBlock();
+    }
 }
 
-- (void)startTagCommanderTrackerWithConfiguration:(SRGAnalyticsConfiguration *)configuration
+- (void)startTagCommanderTrackerWithConfiguration:(SRGAnalyticsConfiguration *)configuration device:(NSString *)device
 {
     if (! configuration.unitTesting) {
         self.tagCommander = [[TagCommander alloc] initWithSiteID:(int)configuration.site andContainerID:(int)configuration.container];
@@ -72,32 +208,52 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
         [self.tagCommander addPermanentData:@"app_library_version" withValue:SRGAnalyticsMarketingVersion()];
         [self.tagCommander addPermanentData:@"navigation_app_site_name" withValue:configuration.comScoreVirtualSite];
         [self.tagCommander addPermanentData:@"navigation_environment" withValue:NSBundle.srg_isProductionVersion ? @"prod" : @"preprod"];
-        [self.tagCommander addPermanentData:@"navigation_device" withValue:[self device]];
+        [self.tagCommander addPermanentData:@"navigation_device" withValue:device];
+    }
+    
+    if (configuration.tagCommanderBatchSize > 1) {
+        NSString *cachesDirectory = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+        NSString *journalFilePath = [[cachesDirectory stringByAppendingPathComponent:@"SRGAnalytics"] stringByAppendingPathComponent:@"TagCommanderJournal"];
+        
+        @weakify(self)
+        self.tagCommanderJournal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:[NSURL fileURLWithPath:journalFilePath]
+                                                                               queue:self.eventQueue
+                                                                           batchSize:configuration.tagCommanderBatchSize
+                                                                       flushInterval:configuration.tagCommanderBatchInterval
+                                                                          flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> *labelsArray) {
+            @strongify(self)
+            for (NSDictionary<NSString *, NSString *> *labels in labelsArray) {
+                [self sendTagCommanderLabelSet:[SRGAnalyticsLabelSet labelSetWithDictionary:labels parent:nil] input:nil];
+            }
+        }];
     }
 }
 
 - (void)startComscoreTrackerWithConfiguration:(SRGAnalyticsConfiguration *)configuration
 {
-    if (self.configuration.unitTesting) {
+    if (configuration.unitTesting) {
         return;
     }
     
-    [CSComScore setAppContext];
-    [CSComScore setSecure:YES];
-    [CSComScore setCustomerC2:@"6036016"];
-    [CSComScore setPublisherSecret:@"b19346c7cb5e521845fb032be24b0154"];
-    [CSComScore enableAutoUpdate:60 foregroundOnly:NO];     //60 is the Comscore default interval value
-    
-    NSString *applicationName = [NSBundle.mainBundle objectForInfoDictionaryKey:@"CFBundleDisplayName"] ?: [NSBundle.mainBundle objectForInfoDictionaryKey:@"CFBundleName"];
-    if (applicationName) {
-        [CSComScore setAutoStartLabels:@{ @"name": applicationName }];
-    }
-    
-    [CSComScore setLabels:[self comscoreGlobalLabelsWithConfiguration:configuration]];
-    
-    // The default keep-alive time interval of 20 minutes is too big. Set it to 9 minutes
-    self.streamSense = [[CSStreamSense alloc] init];
-    [self.streamSense setKeepAliveInterval:9 * 60];
+    // The SDK must be configured before any other comScore call is made. This must never be dropped
+    NSDictionary<NSString *, NSString *> *globalLabels = [self comscoreGlobalLabelsWithConfiguration:configuration];
+    [self performRequiredComScoreBlock:^{
+        [CSComScore setAppContext];
+        [CSComScore setSecure:YES];
+        [CSComScore setCustomerC2:@"6036016"];
+        [CSComScore setPublisherSecret:@"b19346c7cb5e521845fb032be24b0154"];
+        [CSComScore enableAutoUpdate:60 foregroundOnly:NO];     //60 is the Comscore default interval value
+        
+        NSString *applicationName = [NSBundle.mainBundle objectForInfoDictionaryKey:@"CFBundleDisplayName"] ?: [NSBundle.mainBundle objectForInfoDictionaryKey:@"CFBundleName"];
+        if (applicationName) {
+            [CSComScore setAutoStartLabels:@{ @"name": applicationName }];
+        }
+        
+        [CSComScore setLabels:globalLabels];
+        
+        // Prepare a StreamSense object for the first playback session
+        [SRGAnalyticsStreamSensePool.sharedPool prepareStreamSensesWithCount:1];
+    }];
 }
 
 - (void)startNetmetrixTrackerWithConfiguration:(SRGAnalyticsConfiguration *)configuration
@@ -137,22 +293,20 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
     return [globalLabels copy];
 }
 
-- (NSString *)pageIdWithTitle:(NSString *)title levels:(NSArray<NSString *> *)levels
+- (NSString *)comScoreCategoryWithLevels:(NSArray<NSString *> *)levels
 {
-    NSString *category = @"app";
-    
-    if (levels.count > 0) {
-        __block NSMutableString *levelsComScoreFormattedString = [NSMutableString new];
-        [levels enumerateObjectsUsingBlock:^(NSString * _Nonnull level, NSUInteger idx, BOOL * _Nonnull stop) {
-            if (levelsComScoreFormattedString.length > 0) {
-                [levelsComScoreFormattedString appendString:@"."];
-            }
-            [levelsComScoreFormattedString appendString:level.srg_comScoreFormattedString];
-        }];
-        category = [levelsComScoreFormattedString copy];
+    if (levels.count == 0) {
+        return @"app";
     }
     
-    return [NSString stringWithFormat:@"%@.%@", category, title.srg_comScoreFormattedString];
+    NSMutableString *levelsComScoreFormattedString = [NSMutableString new];
+    [levels enumerateObjectsUsingBlock:^(NSString * _Nonnull level, NSUInteger idx, BOOL * _Nonnull stop) {
+        if (levelsComScoreFormattedString.length > 0) {
+            [levelsComScoreFormattedString appendString:@"."];
+        }
+        [levelsComScoreFormattedString appendString:level.description.srg_comScoreFormattedString];
+    }];
+    return [levelsComScoreFormattedString copy];
 }
 
 - (NSString *)device
@@ -171,6 +325,87 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
     }
 }
 
+#pragma mark Global labels
+
+- (SRGAnalyticsGlobalLabelsSnapshot *)globalLabelsSnapshot
+{
+    pthread_mutex_lock(&_globalLabelsSnapshotMutex);
+    SRGAnalyticsGlobalLabelsSnapshot *globalLabelsSnapshot = _globalLabelsSnapshot;
+    pthread_mutex_unlock(&_globalLabelsSnapshotMutex);
+    return globalLabelsSnapshot;
+}
+
+- (void)updateGlobalLabelsWithBlock:(NSDictionary<NSString *, NSString *> * _Nullable (NS_NOESCAPE ^)(NSDictionary<NSString *, NSString *> *))block
+{
+    // Updates are serialized. The block is called outside the snapshot lock, as it might read global labels as well
+    @synchronized(self) {
+        SRGAnalyticsGlobalLabelsSnapshot *globalLabelsSnapshot = self.globalLabelsSnapshot;
+        NSDictionary<NSString *, NSString *> *globalLabels = block(globalLabelsSnapshot.labels) ?: @{};
+        if ([globalLabels isEqualToDictionary:globalLabelsSnapshot.labels]) {
+            return;
+        }
+        
+        SRGAnalyticsGlobalLabelsSnapshot *updatedGlobalLabelsSnapshot = [[SRGAnalyticsGlobalLabelsSnapshot alloc] initWithLabels:globalLabels
+                                                                                                                          version:globalLabelsSnapshot.version + 1];
+        
+        // The previous snapshot is released when readers are done with it, outside the lock
+        pthread_mutex_lock(&_globalLabelsSnapshotMutex);
+        _globalLabelsSnapshot = updatedGlobalLabelsSnapshot;
+        pthread_mutex_unlock(&_globalLabelsSnapshotMutex);
+    }
+}
+
+#pragma mark Event queue
+
+- (void)performEventBlock:(void (^)(void))block
+{
+    // Already on the event queue. Process the event in order with the one currently being processed
+    if (dispatch_get_specific(s_eventQueueKey)) {
+        block();
+        return;
+    }
+    
+    // Never block the caller. If too many events are pending, the event is dropped
+    if (dispatch_semaphore_wait(self.pendingEventsSemaphore, DISPATCH_TIME_NOW) != 0) {
+        SRGAnalyticsLogWarning(@"tracker", @"Too many pending events. The event has been dropped");
+        SRGAnalyticsInstrumentationCount(SRGAnalyticsInstrumentationCounterDroppedEvents, 1);
+        return;
+    }
+    
+    dispatch_async(self.eventQueue, ^{
+        block();
+        dispatch_semaphore_signal(self.pendingEventsSemaphore);
+    });
+}
+
+- (void)performComScoreBlock:(void (^)(void))block
+{
+    // The comScore SDK is not documented as thread-safe, and its classes are not guaranteed to be usable from a background
+    // queue. Calls are therefore made on the main thread, but issued from the event queue so that they are made in order,
+    // after the comScore startup stage.
+    [self performEventBlock:^{
+        dispatch_async(dispatch_get_main_queue(), block);
+    }];
+}
+
+- (void)performRequiredEventBlock:(void (^)(void))block
+{
+    // Bypass the pending event limit, as startup stages do
+    if (dispatch_get_specific(s_eventQueueKey)) {
+        block();
+    }
+    else {
+        dispatch_async(self.eventQueue, block);
+    }
+}
+
+- (void)performRequiredComScoreBlock:(void (^)(void))block
+{
+    [self performRequiredEventBlock:^{
+        dispatch_async(dispatch_get_main_queue(), block);
+    }];
+}
+
 #pragma mark General event tracking (internal use only)
 
 - (void)trackComScoreEventWithLabels:(NSDictionary<NSString *, NSString *> *)labels
@@ -179,28 +414,87 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
         return;
     }
     
-    [CSComScore hiddenWithLabels:labels];
+    [self performComScoreBlock:^{
+        SRGAnalyticsInstrumentationMeasure(SRGAnalyticsInstrumentationStageComScore, [CSComScore hiddenWithLabels:labels]);
+    }];
 }
 
-- (void)trackTagCommanderEventWithLabels:(NSDictionary<NSString *, NSString *> *)labels
+- (SRGAnalyticsLabelSet *)tagCommanderEventLabelSet
+{
+    // Global labels are captured when the event is created, not when it is processed. The label set of the current
+    // snapshot is shared by all events, not copied
+    return [SRGAnalyticsLabelSet labelSetWithParent:self.globalLabelsSnapshot.labelSet];
+}
+
+- (void)trackTagCommanderEventWithLabelSet:(SRGAnalyticsLabelSet *)labelSet
+{
+    [self performEventBlock:^{
+        [self sendTagCommanderEventWithLabelSet:labelSet];
+    }];
+}
+
+- (void)trackTagCommanderEventsWithLabelSets:(NSArray<SRGAnalyticsLabelSet *> *)labelSets
+{
+    [self performEventBlock:^{
+        [self sendTagCommanderEventsWithLabelSets:labelSets];
+    }];
+}
+
+- (void)trackRequiredTagCommanderEventsWithLabelSets:(NSArray<SRGAnalyticsLabelSet *> *)labelSets
+{
+    [self performRequiredEventBlock:^{
+        [self sendTagCommanderEventsWithLabelSets:labelSets];
+    }];
+}
+
+- (void)sendTagCommanderEventsWithLabelSets:(NSArray<SRGAnalyticsLabelSet *> *)labelSets
+{
+    for (SRGAnalyticsLabelSet *labelSet in labelSets) {
+        [self sendTagCommanderEventWithLabelSet:labelSet];
+    }
+}
+
+- (void)sendTagCommanderEventWithLabelSet:(SRGAnalyticsLabelSet *)labelSet
+{
+    [self sendTagCommanderEventWithLabelSet:labelSet input:nil];
+}
+
+- (void)sendTagCommanderEventWithLabelSet:(SRGAnalyticsLabelSet *)labelSet input:(NSDictionary<NSString *, id> *)input
+{
+    // The journal only keeps labels. Inputs are therefore not available to sinks when events are batched
+    if (self.tagCommanderJournal) {
+        [self.tagCommanderJournal appendLabels:labelSet.dictionary];
+    }
+    else {
+        [self sendTagCommanderLabelSet:labelSet input:input];
+    }
+}
+
+- (void)sendTagCommanderLabelSet:(SRGAnalyticsLabelSet *)labelSet input:(NSDictionary<NSString *, id> *)input
 {
-    NSMutableDictionary<NSString *, NSString *> *allLabels = [self.globalLabels mutableCopy] ?: [NSMutableDictionary dictionary];
-    [allLabels addEntriesFromDictionary:labels];
-    
     // TagCommander might not be initialized (for the test business unit)
     if (self.tagCommander) {
-        [allLabels enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
+        uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+        [labelSet enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
             [self.tagCommander addData:key withValue:object];
         }];
         [self.tagCommander sendData];
+        SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageTagCommander, timestamp);
     }
     else {
         // Only custom labels are sent in the notification userInfo. Internal predefined TagCommander variables are not sent,
         // as they are not needed for tests (they are part of what is guaranteed by the TagCommander SDK). For a complete list of
         // predefined variables, see https://github.com/TagCommander/pods/blob/master/TCSDK/PredefinedVariables.md
-        [NSNotificationCenter.defaultCenter postNotificationName:SRGAnalyticsRequestNotification
-                                                          object:self
-                                                        userInfo:@{ SRGAnalyticsLabelsKey : [allLabels copy] }];
+        NSDictionary *userInfo = @{ SRGAnalyticsLabelsKey : labelSet.dictionary };
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [NSNotificationCenter.defaultCenter postNotificationName:SRGAnalyticsRequestNotification
+                                                              object:self
+                                                            userInfo:userInfo];
+        });
+    }
+    
+    if ([self hasEventSinkForEventTypes:SRGAnalyticsEventTypeTagCommander]) {
+        [self sendTagCommanderEventToSinksWithLabels:labelSet.dictionary input:input];
     }
 }
 
@@ -218,13 +512,25 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
 {
     if (title.length == 0) {
         SRGAnalyticsLogWarning(@"tracker", @"Missing title. No event will be sent");
+        SRGAnalyticsInstrumentationCount(SRGAnalyticsInstrumentationCounterDroppedEvents, 1);
         return;
     }
     
-    [self trackTagCommanderPageViewWithTitle:title levels:levels labels:labels fromPushNotification:fromPushNotification];
-    [self trackComScorePageViewWithTitle:title levels:levels labels:labels fromPushNotification:fromPushNotification];
+    // Capture immutable copies of the event information, then return immediately. Labels are built on the event queue
+    NSString *eventTitle = [title copy];
+    NSArray<NSString *> *eventLevels = [levels copy];
+    SRGAnalyticsPageViewLabels *eventLabels = [labels copy];
+    SRGAnalyticsLabelSet *labelSet = [self tagCommanderEventLabelSet];
     
-    [self.netmetrixTracker trackView];
+    [self performEventBlock:^{
+        SRGAnalyticsInstrumentationCount(SRGAnalyticsInstrumentationCounterPageViews, 1);
+        
+        [self trackTagCommanderPageViewWithTitle:eventTitle levels:eventLevels labels:eventLabels fromPushNotification:fromPushNotification labelSet:labelSet];
+        [self trackComScorePageViewWithTitle:eventTitle levels:eventLevels labels:eventLabels fromPushNotification:fromPushNotification];
+        
+        [self.netmetrixTracker trackView];
+        [self sendNetMetrixViewToSinks];
+    }];
 }
 
 - (void)trackComScorePageViewWithTitle:(NSString *)title
@@ -236,60 +542,88 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
         return;
     }
     
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+    NSDictionary<NSString *, NSString *> *comScoreLabels = [self comScorePageViewLabelSetWithTitle:title levels:levels labels:labels fromPushNotification:fromPushNotification].dictionary;
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageLabelBuilding, timestamp);
+    
+    [self performComScoreBlock:^{
+        SRGAnalyticsInstrumentationMeasure(SRGAnalyticsInstrumentationStageComScore, [CSComScore viewWithLabels:comScoreLabels]);
+    }];
+}
+
+- (SRGAnalyticsLabelSet *)comScorePageViewLabelSetWithTitle:(NSString *)title
+                                                     levels:(NSArray<NSString *> *)levels
+                                                     labels:(SRGAnalyticsPageViewLabels *)labels
+                                       fromPushNotification:(BOOL)fromPushNotification
+{
     NSAssert(title.length != 0, @"A title is required");
     
-    NSMutableDictionary *pageViewLabelsDictionary = [NSMutableDictionary dictionary];
-    [pageViewLabelsDictionary srg_safelySetString:title forKey:@"srg_title"];
-    [pageViewLabelsDictionary srg_safelySetString:@(fromPushNotification).stringValue forKey:@"srg_ap_push"];
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [labelSet setString:title forKey:@"srg_title"];
+    [labelSet setString:@(fromPushNotification).stringValue forKey:@"srg_ap_push"];
     
-    NSString *category = @"app";
+    // Formatted levels are computed once, and used both for the category and the page identifier
+    NSString *category = [self comScoreCategoryWithLevels:levels];
     
     if (! levels) {
-        [pageViewLabelsDictionary srg_safelySetString:category forKey:@"srg_n1"];
+        [labelSet setString:category forKey:@"srg_n1"];
     }
-    else if (levels.count > 0) {
-        __block NSMutableString *levelsComScoreFormattedString = [NSMutableString new];
+    else {
         [levels enumerateObjectsUsingBlock:^(NSString * _Nonnull object, NSUInteger idx, BOOL * _Nonnull stop) {
-            NSString *levelKey = [NSString stringWithFormat:@"srg_n%@", @(idx + 1)];
-            NSString *levelValue = [object description];
-            
-            if (idx < 10) {
-                [pageViewLabelsDictionary srg_safelySetString:levelValue forKey:levelKey];
+            if (idx >= 10) {
+                *stop = YES;
+                return;
             }
             
-            if (levelsComScoreFormattedString.length > 0) {
-                [levelsComScoreFormattedString appendString:@"."];
-            }
-            [levelsComScoreFormattedString appendString:levelValue.srg_comScoreFormattedString];
+            NSString *levelKey = [NSString stringWithFormat:@"srg_n%@", @(idx + 1)];
+            [labelSet setString:[object description] forKey:levelKey];
         }];
-        
-        category = [levelsComScoreFormattedString copy];
     }
     
-    [pageViewLabelsDictionary srg_safelySetString:category forKey:@"category"];
-    [pageViewLabelsDictionary srg_safelySetString:[self pageIdWithTitle:title levels:levels] forKey:@"name"];
-    
-    NSDictionary<NSString *, NSString *> *comScoreLabelsDictionary = [labels comScoreLabelsDictionary];
-    if (comScoreLabelsDictionary) {
-        [pageViewLabelsDictionary addEntriesFromDictionary:comScoreLabelsDictionary];
-    }
-    
-    [CSComScore viewWithLabels:pageViewLabelsDictionary];
+    [labelSet setString:category forKey:@"category"];
+    [labelSet setString:[NSString stringWithFormat:@"%@.%@", category, title.srg_comScoreFormattedString] forKey:@"name"];
+    [labels fillComScoreLabelSet:labelSet];
+    return labelSet;
 }
 
 - (void)trackTagCommanderPageViewWithTitle:(NSString *)title
                                     levels:(NSArray<NSString *> *)levels
                                     labels:(SRGAnalyticsPageViewLabels *)labels
                       fromPushNotification:(BOOL)fromPushNotification
+                                  labelSet:(SRGAnalyticsLabelSet *)labelSet
+{
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+    [self fillTagCommanderPageViewLabelSet:labelSet withTitle:title levels:levels labels:labels fromPushNotification:fromPushNotification];
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageLabelBuilding, timestamp);
+    
+    // Inputs are only needed by sinks (e.g. to replay recordings)
+    NSDictionary<NSString *, id> *input = nil;
+    if ([self hasEventSinkForEventTypes:SRGAnalyticsEventTypePageView]) {
+        NSMutableDictionary<NSString *, id> *pageViewInput = [NSMutableDictionary dictionary];
+        pageViewInput[SRGAnalyticsInputTitleKey] = title;
+        pageViewInput[SRGAnalyticsInputLevelsKey] = levels;
+        pageViewInput[SRGAnalyticsInputFromPushNotificationKey] = @(fromPushNotification);
+        pageViewInput[SRGAnalyticsInputLabelsKey] = labels.labelsDictionary;
+        pageViewInput[SRGAnalyticsInputComScoreLabelsKey] = labels.comScoreLabelsDictionary;
+        input = [pageViewInput copy];
+    }
+    
+    [self sendTagCommanderEventWithLabelSet:labelSet input:input];
+}
+
+- (void)fillTagCommanderPageViewLabelSet:(SRGAnalyticsLabelSet *)labelSet
+                               withTitle:(NSString *)title
+                                  levels:(NSArray<NSString *> *)levels
+                                  labels:(SRGAnalyticsPageViewLabels *)labels
+                    fromPushNotification:(BOOL)fromPushNotification
 {
     NSAssert(title.length != 0, @"A title is required");
     
-    NSMutableDictionary<NSString *, NSString *> *fullLabelsDictionary = [NSMutableDictionary dictionary];
-    [fullLabelsDictionary srg_safelySetString:@"screen" forKey:@"event_id"];
-    [fullLabelsDictionary srg_safelySetString:@"app" forKey:@"navigation_property_type"];
-    [fullLabelsDictionary srg_safelySetString:title forKey:@"content_title"];
-    [fullLabelsDictionary srg_safelySetString:self.configuration.businessUnitIdentifier.uppercaseString forKey:@"navigation_bu_distributer"];
-    [fullLabelsDictionary srg_safelySetString:fromPushNotification ? @"true" : @"false" forKey:@"accessed_after_push_notification"];
+    [labelSet setString:@"screen" forKey:@"event_id"];
+    [labelSet setString:@"app" forKey:@"navigation_property_type"];
+    [labelSet setString:title forKey:@"content_title"];
+    [labelSet setString:self.configuration.businessUnitIdentifier.uppercaseString forKey:@"navigation_bu_distributer"];
+    [labelSet setString:fromPushNotification ? @"true" : @"false" forKey:@"accessed_after_push_notification"];
     
     [levels enumerateObjectsUsingBlock:^(NSString * _Nonnull object, NSUInteger idx, BOOL * _Nonnull stop) {
         if (idx > 7) {
@@ -298,15 +632,10 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
         }
         
         NSString *levelKey = [NSString stringWithFormat:@"navigation_level_%@", @(idx + 1)];
-        [fullLabelsDictionary srg_safelySetString:object forKey:levelKey];
+        [labelSet setString:object forKey:levelKey];
     }];
     
-    NSDictionary<NSString *, NSString *> *labelsDictionary = [labels labelsDictionary];
-    if (labelsDictionary) {
-        [fullLabelsDictionary addEntriesFromDictionary:labelsDictionary];
-    }
-    
-    [self trackTagCommanderEventWithLabels:[fullLabelsDictionary copy]];
+    [labels fillLabelSet:labelSet];
 }
 
 #pragma mark Hidden event tracking
@@ -321,11 +650,21 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
 {
     if (name.length == 0) {
         SRGAnalyticsLogWarning(@"tracker", @"Missing name. No event will be sent");
+        SRGAnalyticsInstrumentationCount(SRGAnalyticsInstrumentationCounterDroppedEvents, 1);
         return;
     }
     
-    [self trackTagCommanderHiddenEventWithName:name labels:labels];
-    [self trackComScoreHiddenEventWithName:name labels:labels];
+    // Capture immutable copies of the event information, then return immediately. Labels are built on the event queue
+    NSString *eventName = [name copy];
+    SRGAnalyticsHiddenEventLabels *eventLabels = [labels copy];
+    SRGAnalyticsLabelSet *labelSet = [self tagCommanderEventLabelSet];
+    
+    [self performEventBlock:^{
+        SRGAnalyticsInstrumentationCount(SRGAnalyticsInstrumentationCounterHiddenEvents, 1);
+        
+        [self trackTagCommanderHiddenEventWithName:eventName labels:eventLabels labelSet:labelSet];
+        [self trackComScoreHiddenEventWithName:eventName labels:eventLabels];
+    }];
 }
 
 - (void)trackComScoreHiddenEventWithName:(NSString *)name labels:(SRGAnalyticsHiddenEventLabels *)labels
@@ -336,33 +675,57 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
     
     NSAssert(name.length != 0, @"A name is required");
     
-    NSMutableDictionary *hiddenEventLabelsDictionary = [NSMutableDictionary dictionary];
-    [hiddenEventLabelsDictionary srg_safelySetString:name forKey:@"srg_title"];
-    [hiddenEventLabelsDictionary srg_safelySetString:@"app" forKey:@"category"];
-    [hiddenEventLabelsDictionary srg_safelySetString:[NSString stringWithFormat:@"app.%@", name.srg_comScoreFormattedString] forKey:@"name"];
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+    NSDictionary<NSString *, NSString *> *comScoreLabels = [self comScoreHiddenEventLabelSetWithName:name labels:labels].dictionary;
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageLabelBuilding, timestamp);
     
-    NSDictionary<NSString *, NSString *> *comScoreLabelsDictionary = [labels comScoreLabelsDictionary];
-    if (comScoreLabelsDictionary) {
-        [hiddenEventLabelsDictionary addEntriesFromDictionary:comScoreLabelsDictionary];
-    }
-    
-    [CSComScore hiddenWithLabels:hiddenEventLabelsDictionary];
+    [self performComScoreBlock:^{
+        SRGAnalyticsInstrumentationMeasure(SRGAnalyticsInstrumentationStageComScore, [CSComScore hiddenWithLabels:comScoreLabels]);
+    }];
 }
 
-- (void)trackTagCommanderHiddenEventWithName:(NSString *)name labels:(SRGAnalyticsHiddenEventLabels *)labels
+- (SRGAnalyticsLabelSet *)comScoreHiddenEventLabelSetWithName:(NSString *)name labels:(SRGAnalyticsHiddenEventLabels *)labels
 {
     NSAssert(name.length != 0, @"A name is required");
     
-    NSMutableDictionary<NSString *, NSString *> *fullLabelsDictionary = [NSMutableDictionary dictionary];
-    [fullLabelsDictionary srg_safelySetString:@"hidden_event" forKey:@"event_id"];
-    [fullLabelsDictionary srg_safelySetString:name forKey:@"event_name"];
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [labelSet setString:name forKey:@"srg_title"];
+    [labelSet setString:@"app" forKey:@"category"];
+    [labelSet setString:[NSString stringWithFormat:@"app.%@", name.srg_comScoreFormattedString] forKey:@"name"];
+    [labels fillComScoreLabelSet:labelSet];
+    return labelSet;
+}
+
+- (void)trackTagCommanderHiddenEventWithName:(NSString *)name
+                                      labels:(SRGAnalyticsHiddenEventLabels *)labels
+                                    labelSet:(SRGAnalyticsLabelSet *)labelSet
+{
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+    [self fillTagCommanderHiddenEventLabelSet:labelSet withName:name labels:labels];
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageLabelBuilding, timestamp);
     
-    NSDictionary<NSString *, NSString *> *labelsDictionary = [labels labelsDictionary];
-    if (labelsDictionary) {
-        [fullLabelsDictionary addEntriesFromDictionary:labelsDictionary];
+    // Inputs are only needed by sinks (e.g. to replay recordings)
+    NSDictionary<NSString *, id> *input = nil;
+    if ([self hasEventSinkForEventTypes:SRGAnalyticsEventTypeHiddenEvent]) {
+        NSMutableDictionary<NSString *, id> *hiddenEventInput = [NSMutableDictionary dictionary];
+        hiddenEventInput[SRGAnalyticsInputNameKey] = name;
+        hiddenEventInput[SRGAnalyticsInputLabelsKey] = labels.labelsDictionary;
+        hiddenEventInput[SRGAnalyticsInputComScoreLabelsKey] = labels.comScoreLabelsDictionary;
+        input = [hiddenEventInput copy];
     }
     
-    [self trackTagCommanderEventWithLabels:[fullLabelsDictionary copy]];
+    [self sendTagCommanderEventWithLabelSet:labelSet input:input];
+}
+
+- (void)fillTagCommanderHiddenEventLabelSet:(SRGAnalyticsLabelSet *)labelSet
+                                   withName:(NSString *)name
+                                     labels:(SRGAnalyticsHiddenEventLabels *)labels
+{
+    NSAssert(name.length != 0, @"A name is required");
+    
+    [labelSet setString:@"hidden_event" forKey:@"event_id"];
+    [labelSet setString:name forKey:@"event_name"];
+    [labels fillLabelSet:labelSet];
 }
 
 #pragma mark Application list measurement
@@ -373,73 +736,287 @@ __attribute__((constructor)) static void SRGAnalyticsTrackerInit(void)
     //
     // Specifications are available at: https://srfmmz.atlassian.net/wiki/display/INTFORSCHUNG/App+Overlapping+Measurement
     //
-    // This measurement is not critical and is therefore performed only once the tracker starts. If it fails for some reason
-    // (no network, for example), the measurement will be attempted again the next time the application is started
-    NSURL *applicationListURL = [NSURL URLWithString:@"https://pastebin.com/raw/RnZYEWCA"];
-    [[[NSURLSession sharedSession] dataTaskWithURL:applicationListURL completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-        if (error) {
-            SRGAnalyticsLogError(@"tracker", @"The application list could not be retrieved. Reason: %@", error);
+    // This measurement is not critical and is therefore performed only once the tracker starts. The list is cached and
+    // probing is deferred until the application is idle, see `SRGAnalyticsApplicationListMeasurement`. If no list is
+    // available for some reason (no network, for example), the measurement will be attempted again the next time the
+    // application is started
+    NSString *cachesDirectory = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+    NSString *filePath = [[cachesDirectory stringByAppendingPathComponent:@"SRGAnalytics"] stringByAppendingPathComponent:@"ApplicationList.plist"];
+    
+    SRGAnalyticsURLSessionApplicationListFetcher *fetcher = [[SRGAnalyticsURLSessionApplicationListFetcher alloc] initWithSession:NSURLSession.sharedSession];
+    self.applicationListMeasurement = [[SRGAnalyticsApplicationListMeasurement alloc] initWithURL:[NSURL URLWithString:@"https://pastebin.com/raw/RnZYEWCA"]
+                                                                                          fetcher:fetcher
+                                                                                          fileURL:[NSURL fileURLWithPath:filePath]
+                                                                            probeValidityInterval:24. * 60. * 60.
+                                                                                       probeBlock:^BOOL(NSString *URLScheme) {
+        NSString *URLString = [NSString stringWithFormat:@"%@://probe-for-srganalytics", URLScheme];
+        return [UIApplication.sharedApplication canOpenURL:[NSURL URLWithString:URLString]];
+    }];
+    
+    @weakify(self)
+    [self.applicationListMeasurement measureWithCompletionBlock:^(NSArray<NSString *> * _Nullable installedApplications) {
+        @strongify(self)
+        
+        if (! installedApplications) {
             return;
         }
         
-        NSError *parseError = nil;
-        id JSONObject = [NSJSONSerialization JSONObjectWithData:data options:0 error:&parseError];
-        if (! JSONObject || ! [JSONObject isKindOfClass:NSArray.class]) {
-            SRGAnalyticsLogError(@"tracker", @"The application list format is incorrect");
-            return;
+        SRGAnalyticsHiddenEventLabels *labels = [[SRGAnalyticsHiddenEventLabels alloc] init];
+        labels.type = @"hidden";
+        labels.source = @"SRGAnalytics";
+        labels.value = [installedApplications componentsJoinedByString:@";"];
+        labels.comScoreCustomInfo = @{ @"srg_evgroup": @"Installed Apps",
+                                       @"srg_evname": [installedApplications componentsJoinedByString:@","] };
+        
+        [self trackHiddenEventWithName:@"Installed Apps" labels:labels];
+    }];
+}
+
+#pragma mark Instrumentation
+
+- (SRGAnalyticsInstrumentationSnapshot *)instrumentationSnapshot
+{
+#if SRG_ANALYTICS_INSTRUMENTATION
+    return SRGAnalyticsInstrumentationTakeSnapshot(NO);
+#else
+    return nil;
+#endif
+}
+
+- (SRGAnalyticsInstrumentationSnapshot *)resetInstrumentation
+{
+#if SRG_ANALYTICS_INSTRUMENTATION
+    return SRGAnalyticsInstrumentationTakeSnapshot(YES);
+#else
+    return nil;
+#endif
+}
+
+#pragma mark Event sinks
+
+- (void)addEventSink:(id<SRGAnalyticsEventSink>)sink forEventTypes:(SRGAnalyticsEventTypes)eventTypes
+{
+    @synchronized(self.eventSinks) {
+        [self.eventSinks setObject:@(eventTypes) forKey:sink];
+        [self updateEventSinkTypes];
+    }
+}
+
+- (void)removeEventSink:(id<SRGAnalyticsEventSink>)sink
+{
+    @synchronized(self.eventSinks) {
+        [self.eventSinks removeObjectForKey:sink];
+        [self updateEventSinkTypes];
+    }
+}
+
+// Must be called with the event sink lock held
+- (void)updateEventSinkTypes
+{
+    SRGAnalyticsEventTypes eventSinkTypes = 0;
+    for (NSNumber *eventTypes in self.eventSinks.objectEnumerator) {
+        eventSinkTypes |= eventTypes.unsignedIntegerValue;
+    }
+    atomic_store_explicit(&_eventSinkTypes, eventSinkTypes, memory_order_release);
+}
+
+- (BOOL)hasEventSinkForEventTypes:(SRGAnalyticsEventTypes)eventTypes
+{
+    return (atomic_load_explicit(&_eventSinkTypes, memory_order_acquire) & eventTypes) != 0;
+}
+
+- (void)sendEventToSinks:(SRGAnalyticsEvent *)event
+{
+    // Sinks are called outside the lock, so that they can add or remove sinks
+    NSMutableArray<id<SRGAnalyticsEventSink>> *sinks = [NSMutableArray array];
+    @synchronized(self.eventSinks) {
+        for (id<SRGAnalyticsEventSink> sink in self.eventSinks.keyEnumerator) {
+            if ([self.eventSinks objectForKey:sink].unsignedIntegerValue & event.type) {
+                [sinks addObject:sink];
+            }
+        }
+    }
+    
+    for (id<SRGAnalyticsEventSink> sink in sinks) {
+        [sink tracker:self didSendEvent:event];
+    }
+}
+
+- (void)sendTagCommanderEventToSinksWithLabels:(NSDictionary<NSString *, NSString *> *)labels input:(NSDictionary<NSString *, id> *)input
+{
+    SRGAnalyticsEventTypes type = SRGAnalyticsEventTypeForTagCommanderLabels(labels);
+    if ([self hasEventSinkForEventTypes:type]) {
+        SRGAnalyticsEvent *event = [[SRGAnalyticsEvent alloc] initWithType:type name:labels[@"event_id"] labels:labels URL:nil input:input timestamp:SRGAnalyticsEventCurrentTimestamp()];
+        [self sendEventToSinks:event];
+    }
+}
+
+- (void)sendNetMetrixViewToSinks
+{
+    NSURL *URL = self.netmetrixTracker.URL;
+    if (URL && [self hasEventSinkForEventTypes:SRGAnalyticsEventTypeNetMetrixView]) {
+        SRGAnalyticsEvent *event = [[SRGAnalyticsEvent alloc] initWithType:SRGAnalyticsEventTypeNetMetrixView name:nil labels:nil URL:URL timestamp:SRGAnalyticsEventCurrentTimestamp()];
+        [self sendEventToSinks:event];
+    }
+}
+
+#pragma mark Recording and replay
+
+- (void)startRecordingToFileURL:(NSURL *)fileURL
+{
+    [self stopRecording];
+    
+    self.eventRecorder = [[SRGAnalyticsEventRecorder alloc] initWithFileURL:fileURL];
+    [self addEventSink:self.eventRecorder forEventTypes:SRGAnalyticsEventTypeAll];
+}
+
+- (void)stopRecording
+{
+    if (! self.eventRecorder) {
+        return;
+    }
+    
+    [self removeEventSink:self.eventRecorder];
+    [self.eventRecorder close];
+    self.eventRecorder = nil;
+}
+
+- (BOOL)isRecording
+{
+    return self.eventRecorder != nil;
+}
+
+- (void)replayEvents:(NSArray<SRGAnalyticsEvent *> *)events withCompletionBlock:(void (^)(void))completionBlock
+{
+    // Replayed events are only delivered to sinks, never to the analytics SDKs or over the network. They are replayed
+    // on a separate queue, so that live events are neither delayed nor dropped because of the pending event limit
+    NSArray<SRGAnalyticsEvent *> *replayedEvents = [events copy];
+    dispatch_async(self.replayQueue, ^{
+        for (SRGAnalyticsEvent *event in replayedEvents) {
+            @autoreleasepool {
+                [self replayEvent:event];
+            }
         }
-        NSArray<NSDictionary *> *applicationDictionaries = JSONObject;
         
-        // -canOpenURL: should only be called from the main thread
-        dispatch_async(dispatch_get_main_queue(), ^{
-            // Extract URL schemes and installed applications
-            NSMutableSet<NSString *> *URLSchemes = [NSMutableSet set];
-            NSMutableSet<NSString *> *installedApplications = [NSMutableSet set];
-            for (NSDictionary *applicationDictionary in applicationDictionaries) {
-                NSString *application = applicationDictionary[@"code"];
-                NSString *URLScheme = applicationDictionary[@"ios"];
-                
-                if (URLScheme.length == 0 || ! application) {
-                    SRGAnalyticsLogInfo(@"tracker", @"URL scheme or application name missing in %@. Skipped", applicationDictionary);
-                    continue;
-                }
-                
-                [URLSchemes addObject:URLScheme];
-                
-                NSString *URLString = [NSString stringWithFormat:@"%@://probe-for-srganalytics", URLScheme];
-                if (! [[UIApplication sharedApplication] canOpenURL:[NSURL URLWithString:URLString]]) {
-                    continue;
-                }
-                
-                [installedApplications addObject:application];
+        if (completionBlock) {
+            completionBlock();
+        }
+    });
+}
+
+// Must be called on the replay queue
+- (void)replayEvent:(SRGAnalyticsEvent *)event
+{
+    switch (event.type) {
+        case SRGAnalyticsEventTypePageView:
+            if (event.input) {
+                [self replayPageViewWithInput:event.input];
             }
-            
-            // Since iOS 9, to be able to open a URL in another application (and thus to be able to test for URL scheme
-            // support), the application must declare the schemes it supports via its Info.plist file (under the
-            // `LSApplicationQueriesSchemes` key). If we are running on iOS 9 or above, check that the app list is consistent
-            // with the remote list, and log an error if this is not the case
-            NSArray<NSString *> *declaredURLSchemesArray = NSBundle.mainBundle.infoDictionary[@"LSApplicationQueriesSchemes"];
-            NSSet<NSString *> *declaredURLSchemes = declaredURLSchemesArray ? [NSSet setWithArray:declaredURLSchemesArray] : [NSSet set];
-            if (! [URLSchemes isSubsetOfSet:declaredURLSchemes]) {
-                SRGAnalyticsLogError(@"tracker", @"The URL schemes declared in your application Info.plist file under the "
-                                     "'LSApplicationQueriesSchemes' key must at least contain the scheme list available at "
-                                     "https://pastebin.com/raw/RnZYEWCA (the schemes are found under the 'ios' key, or "
-                                     "a script is available in the SRGAnalytics repository to extract them). Please "
-                                     "update your Info.plist file accordingly to make this message disappear.");
+            else {
+                [self sendReplayedEventToSinks:event];
             }
-            
-            NSArray<NSString *> *sortedInstalledApplications = [installedApplications.allObjects sortedArrayUsingSelector:@selector(localizedCaseInsensitiveCompare:)];
-            
-            SRGAnalyticsHiddenEventLabels *labels = [[SRGAnalyticsHiddenEventLabels alloc] init];
-            labels.type = @"hidden";
-            labels.source = @"SRGAnalytics";
-            labels.value = [sortedInstalledApplications componentsJoinedByString:@";"];
-            labels.comScoreCustomInfo = @{ @"srg_evgroup": @"Installed Apps",
-                                           @"srg_evname": [sortedInstalledApplications componentsJoinedByString:@","] };
-            
-            [self trackHiddenEventWithName:@"Installed Apps" labels:labels];
-        });
-    }] resume];
+            break;
+        case SRGAnalyticsEventTypeHiddenEvent:
+            if (event.input) {
+                [self replayHiddenEventWithInput:event.input];
+            }
+            else {
+                [self sendReplayedEventToSinks:event];
+            }
+            break;
+        case SRGAnalyticsEventTypeComScorePageView:
+        case SRGAnalyticsEventTypeComScoreHiddenEvent:
+            // Built again when replaying the TagCommander event with the same input
+            break;
+        case SRGAnalyticsEventTypeStreamEvent:
+        case SRGAnalyticsEventTypeComScoreStreamEvent:
+        case SRGAnalyticsEventTypeNetMetrixView:
+            [self sendReplayedEventToSinks:event];
+            break;
+        default:
+            SRGAnalyticsLogWarning(@"tracker", @"Event %@ cannot be replayed. Skipped", event);
+            break;
+    }
+}
+
+- (void)replayPageViewWithInput:(NSDictionary<NSString *, id> *)input
+{
+    NSString *title = input[SRGAnalyticsInputTitleKey];
+    NSArray<NSString *> *levels = input[SRGAnalyticsInputLevelsKey];
+    NSNumber *fromPushNotification = input[SRGAnalyticsInputFromPushNotificationKey];
+    NSDictionary<NSString *, NSString *> *customInfo = input[SRGAnalyticsInputLabelsKey];
+    NSDictionary<NSString *, NSString *> *comScoreCustomInfo = input[SRGAnalyticsInputComScoreLabelsKey];
+    if (! [title isKindOfClass:NSString.class] || title.length == 0
+            || (levels && ! SRGAnalyticsIsStringArray(levels))
+            || ! [fromPushNotification isKindOfClass:NSNumber.class]
+            || (customInfo && ! SRGAnalyticsIsStringDictionary(customInfo))
+            || (comScoreCustomInfo && ! SRGAnalyticsIsStringDictionary(comScoreCustomInfo))) {
+        SRGAnalyticsLogWarning(@"tracker", @"Invalid page view input %@. Skipped", input);
+        return;
+    }
+    
+    // Labels have already been converted to raw values when recorded
+    SRGAnalyticsPageViewLabels *labels = [[SRGAnalyticsPageViewLabels alloc] init];
+    labels.customInfo = customInfo;
+    labels.comScoreCustomInfo = comScoreCustomInfo;
+    
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+    SRGAnalyticsLabelSet *labelSet = [self tagCommanderEventLabelSet];
+    [self fillTagCommanderPageViewLabelSet:labelSet withTitle:title levels:levels labels:labels fromPushNotification:fromPushNotification.boolValue];
+    SRGAnalyticsLabelSet *comScoreLabelSet = [self comScorePageViewLabelSetWithTitle:title levels:levels labels:labels fromPushNotification:fromPushNotification.boolValue];
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageLabelBuilding, timestamp);
+    
+    [self sendTagCommanderEventToSinksWithLabels:labelSet.dictionary input:input];
+    [self sendReplayedComScoreEventToSinksWithType:SRGAnalyticsEventTypeComScorePageView labels:comScoreLabelSet.dictionary];
+}
+
+- (void)replayHiddenEventWithInput:(NSDictionary<NSString *, id> *)input
+{
+    NSString *name = input[SRGAnalyticsInputNameKey];
+    NSDictionary<NSString *, NSString *> *customInfo = input[SRGAnalyticsInputLabelsKey];
+    NSDictionary<NSString *, NSString *> *comScoreCustomInfo = input[SRGAnalyticsInputComScoreLabelsKey];
+    if (! [name isKindOfClass:NSString.class] || name.length == 0
+            || (customInfo && ! SRGAnalyticsIsStringDictionary(customInfo))
+            || (comScoreCustomInfo && ! SRGAnalyticsIsStringDictionary(comScoreCustomInfo))) {
+        SRGAnalyticsLogWarning(@"tracker", @"Invalid hidden event input %@. Skipped", input);
+        return;
+    }
+    
+    // Labels have already been converted to raw values when recorded
+    SRGAnalyticsHiddenEventLabels *labels = [[SRGAnalyticsHiddenEventLabels alloc] init];
+    labels.customInfo = customInfo;
+    labels.comScoreCustomInfo = comScoreCustomInfo;
+    
+    uint64_t timestamp = SRGAnalyticsInstrumentationTimestamp();
+    SRGAnalyticsLabelSet *labelSet = [self tagCommanderEventLabelSet];
+    [self fillTagCommanderHiddenEventLabelSet:labelSet withName:name labels:labels];
+    SRGAnalyticsLabelSet *comScoreLabelSet = [self comScoreHiddenEventLabelSetWithName:name labels:labels];
+    SRGAnalyticsInstrumentationRecordStage(SRGAnalyticsInstrumentationStageLabelBuilding, timestamp);
+    
+    [self sendTagCommanderEventToSinksWithLabels:labelSet.dictionary input:input];
+    [self sendReplayedComScoreEventToSinksWithType:SRGAnalyticsEventTypeComScoreHiddenEvent labels:comScoreLabelSet.dictionary];
+}
+
+// Labels are those the tracker provides to the comScore SDK, without the labels the SDK adds itself
+- (void)sendReplayedComScoreEventToSinksWithType:(SRGAnalyticsEventTypes)type labels:(NSDictionary<NSString *, NSString *> *)labels
+{
+    if ([self hasEventSinkForEventTypes:type]) {
+        SRGAnalyticsEvent *event = [[SRGAnalyticsEvent alloc] initWithType:type name:labels[@"name"] labels:labels URL:nil timestamp:SRGAnalyticsEventCurrentTimestamp()];
+        [self sendEventToSinks:event];
+    }
+}
+
+- (void)sendReplayedEventToSinks:(SRGAnalyticsEvent *)event
+{
+    if ([self hasEventSinkForEventTypes:event.type]) {
+        SRGAnalyticsEvent *replayedEvent = [[SRGAnalyticsEvent alloc] initWithType:event.type
+                                                                              name:event.name
+                                                                            labels:event.labels
+                                                                               URL:event.URL
+                                                                             input:event.input
+                                                                         timestamp:SRGAnalyticsEventCurrentTimestamp()];
+        [self sendEventToSinks:replayedEvent];
+    }
 }
 
 #pragma mark Description
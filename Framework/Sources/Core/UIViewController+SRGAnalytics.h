@@ -18,7 +18,8 @@ NS_ASSUME_NONNULL_BEGIN
  *  By default, if a view controller conforms to the `SRGAnalyticsViewTracking` protocol, a page view event will
  *  automatically be sent when it is presented for the first time (i.e. when `-viewDidAppear:` is called for
  *  the first time). In addition, a page view event will be automatically sent every time the application returns
- *  from background while the view controller is visible.
+ *  from background while the view controller is visible. If several nested tracked view controllers are visible (e.g.
+ *  a tracked page displayed within a tracked container), only the innermost ones are tracked in this case.
  *
  *  If you want to control when page view events are sent, however, you can implement the optional `srg_isTrackedAutomatically`
  *  method to return `NO`, disabling the mechanisms described above. In this case you are responsible of calling the
@@ -6,13 +6,13 @@
 
 #import "UIViewController+SRGAnalytics.h"
 
+#import "SRGAnalyticsPageViewCoordinator.h"
 #import "SRGAnalyticsTracker.h"
+#import "SRGAnalyticsViewTrackingCapabilities.h"
 
-#import <libextobjc/libextobjc.h>
 #import <objc/runtime.h>
 
 // Associated object keys
-static void *s_observerKey = &s_observerKey;
 static void *s_appearedOnce = &s_appearedOnce;
 
 // Swizzled method original implementations
@@ -47,35 +47,38 @@ static void swizzled_viewWillDisappear(UIViewController *self, SEL _cmd, BOOL an
 
 - (void)srg_trackPageViewAutomatic:(BOOL)automatic
 {
-    if ([self conformsToProtocol:@protocol(SRGAnalyticsViewTracking)]) {
-        id<SRGAnalyticsViewTracking> trackedSelf = (id<SRGAnalyticsViewTracking>)self;
-        
-        if (automatic && [trackedSelf respondsToSelector:@selector(srg_isTrackedAutomatically)] && ! [trackedSelf srg_isTrackedAutomatically]) {
-            return;
-        }
-        
-        NSString *title = [trackedSelf srg_pageViewTitle];
-        
-        NSArray<NSString *> *levels = nil;
-        if ([trackedSelf respondsToSelector:@selector(srg_pageViewLevels)]) {
-            levels = [trackedSelf srg_pageViewLevels];
-        }
-        
-        SRGAnalyticsPageViewLabels *labels = nil;
-        if ([trackedSelf respondsToSelector:@selector(srg_pageViewLabels)]) {
-            labels = [trackedSelf srg_pageViewLabels];
-        }
-        
-        BOOL fromPushNotification = NO;
-        if ([trackedSelf respondsToSelector:@selector(srg_isOpenedFromPushNotification)]) {
-            fromPushNotification = [trackedSelf srg_isOpenedFromPushNotification];
-        }
-        
-        [SRGAnalyticsTracker.sharedTracker trackPageViewWithTitle:title
-                                                           levels:levels
-                                                           labels:labels
-                                             fromPushNotification:fromPushNotification];
+    SRGAnalyticsViewTrackingCapabilities capabilities = SRGAnalyticsViewTrackingCapabilitiesForClass(object_getClass(self));
+    if (! (capabilities & SRGAnalyticsViewTrackingCapabilityTracked)) {
+        return;
     }
+    
+    id<SRGAnalyticsViewTracking> trackedSelf = (id<SRGAnalyticsViewTracking>)self;
+    
+    if (automatic && (capabilities & SRGAnalyticsViewTrackingCapabilityTrackedAutomatically) && ! [trackedSelf srg_isTrackedAutomatically]) {
+        return;
+    }
+    
+    NSString *title = [trackedSelf srg_pageViewTitle];
+    
+    NSArray<NSString *> *levels = nil;
+    if (capabilities & SRGAnalyticsViewTrackingCapabilityPageViewLevels) {
+        levels = [trackedSelf srg_pageViewLevels];
+    }
+    
+    SRGAnalyticsPageViewLabels *labels = nil;
+    if (capabilities & SRGAnalyticsViewTrackingCapabilityPageViewLabels) {
+        labels = [trackedSelf srg_pageViewLabels];
+    }
+    
+    BOOL fromPushNotification = NO;
+    if (capabilities & SRGAnalyticsViewTrackingCapabilityOpenedFromPushNotification) {
+        fromPushNotification = [trackedSelf srg_isOpenedFromPushNotification];
+    }
+    
+    [SRGAnalyticsTracker.sharedTracker trackPageViewWithTitle:title
+                                                       levels:levels
+                                                       labels:labels
+                                         fromPushNotification:fromPushNotification];
 }
 
 @end
@@ -86,6 +89,11 @@ static void swizzled_viewDidAppear(UIViewController *self, SEL _cmd, BOOL animat
 {
     s_viewDidAppear(self, _cmd, animated);
     
+    // Most view controllers are not tracked. Skip any further work for them.
+    if (! (SRGAnalyticsViewTrackingCapabilitiesForClass(object_getClass(self)) & SRGAnalyticsViewTrackingCapabilityTracked)) {
+        return;
+    }
+    
     // Track a view controller at most once automatically when appearing. This covers all possible appearance scenarios,
     // e.g.
     //    - Moving to a parent view controller
@@ -96,23 +104,17 @@ static void swizzled_viewDidAppear(UIViewController *self, SEL _cmd, BOOL animat
         objc_setAssociatedObject(self, s_appearedOnce, @YES, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
     }
     
-    // An anonymous observer (conveniently created with the notification center registration method taking a block as
-    // parameter) is required. If we simply registered `self` as observer, removal in `-viewWillDisappear:` would also
-    // remove all other registrations of the view controller for the same notifications!
-    @weakify(self)
-    id observer = [NSNotificationCenter.defaultCenter addObserverForName:UIApplicationWillEnterForegroundNotification object:nil queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
-        @strongify(self)
-        
-        [self srg_trackPageViewAutomatic:YES];
-    }];
-    objc_setAssociatedObject(self, s_observerKey, observer, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    // Page views are sent again when the application returns to the foreground, for leaf-most visible view controllers only
+    [SRGAnalyticsPageViewCoordinator.sharedCoordinator viewControllerDidAppear:self];
 }
 
 static void swizzled_viewWillDisappear(UIViewController *self, SEL _cmd, BOOL animated)
 {
     s_viewWillDisappear(self, _cmd, animated);
     
-    id observer = objc_getAssociatedObject(self, s_observerKey);
-    [NSNotificationCenter.defaultCenter removeObserver:observer];
-    objc_setAssociatedObject(self, s_observerKey, nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    if (! (SRGAnalyticsViewTrackingCapabilitiesForClass(object_getClass(self)) & SRGAnalyticsViewTrackingCapabilityTracked)) {
+        return;
+    }
+    
+    [SRGAnalyticsPageViewCoordinator.sharedCoordinator viewControllerWillDisappear:self];
 }
@@ -8,7 +8,7 @@
 
 #import "SRGAnalyticsLogger.h"
 #import "SRGAnalyticsNotifications.h"
-#import "SRGAnalyticsTracker.h"
+#import "SRGAnalyticsTracker+Private.h"
 
 #import <objc/runtime.h>
 
@@ -42,8 +42,11 @@ __attribute__((constructor)) static void CSMeasurementDispatcherInit(void)
 
 - (void)swizzled_send:(CSApplicationEventType)eventType labels:(NSDictionary *)labels cache:(BOOL)cache background:(BOOL)background
 {
-    SRGAnalyticsConfiguration *configuration = SRGAnalyticsTracker.sharedTracker.configuration;
-    if (configuration.unitTesting) {
+    SRGAnalyticsTracker *tracker = SRGAnalyticsTracker.sharedTracker;
+    BOOL unitTesting = tracker.configuration.unitTesting;
+    
+    // Labels are only assembled if needed, i.e. for unit testing or if some sink is interested in comScore events
+    if (unitTesting || [tracker hasEventSinkForEventTypes:SRGAnalyticsEventTypeComScore]) {
         // Labels are not complete. To get (almost) all labels we mimic the comScore SDK by creating the measurement object. The
         // timestamp will not be identical to the timestamp of the real event which is sent afterwards, and global labels will
         // be missing.
@@ -57,23 +60,32 @@ __attribute__((constructor)) static void CSMeasurementDispatcherInit(void)
             fullLabels[name] = value;
         }
         
-        NSDictionary *userInfo = @{ SRGAnalyticsComScoreLabelsKey : [fullLabels copy] };
-        
-        void (^notificationBlock)(void) = ^{
-            [NSNotificationCenter.defaultCenter postNotificationName:SRGAnalyticsComScoreRequestNotification object:self userInfo:userInfo];
-        };
-        
-        if (! [NSThread isMainThread]) {
-            dispatch_async(dispatch_get_main_queue(), notificationBlock);
+        SRGAnalyticsEventTypes type = SRGAnalyticsEventTypeForComScoreLabels(fullLabels);
+        if ([tracker hasEventSinkForEventTypes:type]) {
+            NSString *name = (type == SRGAnalyticsEventTypeComScoreStreamEvent) ? fullLabels[@"ns_st_ev"] : fullLabels[@"name"];
+            SRGAnalyticsEvent *event = [[SRGAnalyticsEvent alloc] initWithType:type name:name labels:fullLabels URL:nil timestamp:SRGAnalyticsEventCurrentTimestamp()];
+            [tracker sendEventToSinks:event];
         }
-        else {
-            notificationBlock();
+        
+        if (unitTesting) {
+            NSDictionary *userInfo = @{ SRGAnalyticsComScoreLabelsKey : [fullLabels copy] };
+            
+            void (^notificationBlock)(void) = ^{
+                [NSNotificationCenter.defaultCenter postNotificationName:SRGAnalyticsComScoreRequestNotification object:self userInfo:userInfo];
+            };
+            
+            if (! [NSThread isMainThread]) {
+                dispatch_async(dispatch_get_main_queue(), notificationBlock);
+            }
+            else {
+                notificationBlock();
+            }
+            return;
         }
     }
-    else {
-        // Call the original implementation
-        [self swizzled_send:eventType labels:labels cache:cache background:background];
-    }
+    
+    // Call the original implementation
+    [self swizzled_send:eventType labels:labels cache:cache background:background];
 }
 
 @end
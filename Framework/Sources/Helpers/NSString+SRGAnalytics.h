@@ -11,10 +11,16 @@ NS_ASSUME_NONNULL_BEGIN
 @interface NSString (SRGAnalytics)
 
 /**
- *  Format the receiver in a standard way.
+ *  Format the receiver in a standard way. Results are kept in a bounded cache, as the same titles and levels are
+ *  usually formatted over and over.
  */
 @property (nonatomic, readonly, copy, nullable) NSString *srg_comScoreFormattedString;
 
+/**
+ *  Same as `srg_comScoreFormattedString`, but without cache lookup.
+ */
+@property (nonatomic, readonly, copy, nullable) NSString *srg_uncachedComScoreFormattedString;
+
 @end
 
 NS_ASSUME_NONNULL_END
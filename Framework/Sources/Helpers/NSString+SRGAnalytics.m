@@ -6,24 +6,115 @@
 
 #import "NSString+SRGAnalytics.h"
 
+#import "SRGAnalyticsComScoreFormatting.h"
+#import "SRGAnalyticsStringCache.h"
+
+// Maximum number of formatted strings kept in cache. Least recently used strings are discarded first
+static const NSUInteger SRGAnalyticsComScoreFormattedStringCacheCapacity = 256;
+
+// Strings up to this length are formatted without heap allocation
+static const NSUInteger SRGAnalyticsComScoreFormattingStackLength = 128;
+
+static void SRGAnalyticsComScoreFormattedStringRelease(void *formattedString)
+{
+    CFRelease(formattedString);
+}
+
+static NSString *SRGAnalyticsComScoreFormattedString(const char *bytes, size_t length)
+{
+    char stackBuffer[SRGAnalyticsComScoreFormattedLengthMax(SRGAnalyticsComScoreFormattingStackLength)];
+    size_t bufferLength = SRGAnalyticsComScoreFormattedLengthMax(length);
+    char *buffer = (bufferLength <= sizeof(stackBuffer)) ? stackBuffer : malloc(bufferLength);
+    
+    size_t formattedLength = SRGAnalyticsComScoreFormatBytes(bytes, length, buffer);
+    NSString *formattedString = [[NSString alloc] initWithBytes:buffer length:formattedLength encoding:NSASCIIStringEncoding];
+    
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+    return formattedString;
+}
+
 @implementation NSString (SRGAnalytics)
 
 - (NSString *)srg_comScoreFormattedString
 {
-    // Remove accentuated characters
-    NSLocale *posixLocale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
-    NSString *normalizedString = [self.lowercaseString stringByFoldingWithOptions:NSDiacriticInsensitiveSearch locale:posixLocale];
+    static SRGAnalyticsStringCache *s_formattedStrings;
+    static NSObject *s_formattedStringsLock;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_formattedStrings = SRGAnalyticsStringCacheCreate(SRGAnalyticsComScoreFormattedStringCacheCapacity, SRGAnalyticsComScoreFormattedStringRelease);
+        s_formattedStringsLock = [[NSObject alloc] init];
+    });
     
+    // Strings are identified by their UTF-8 bytes, directly available for pure ASCII strings
+    NSUInteger length = self.length;
+    const char *key = CFStringGetCStringPtr((__bridge CFStringRef)self, kCFStringEncodingASCII);
+    size_t keyLength = length;
+    
+    char keyBuffer[3 * SRGAnalyticsComScoreFormattingStackLength];
+    NSData *keyData = nil;
+    if (! key) {
+        CFIndex usedLength = 0;
+        if (length <= SRGAnalyticsComScoreFormattingStackLength
+                && CFStringGetBytes((__bridge CFStringRef)self, CFRangeMake(0, length), kCFStringEncodingUTF8, 0, false, (UInt8 *)keyBuffer, sizeof(keyBuffer), &usedLength) == length) {
+            key = keyBuffer;
+            keyLength = usedLength;
+        }
+        else {
+            keyData = [self dataUsingEncoding:NSUTF8StringEncoding];
+            if (! keyData) {
+                return self.srg_uncachedComScoreFormattedString;
+            }
+            key = keyData.bytes;
+            keyLength = keyData.length;
+        }
+    }
+    
+    @synchronized(s_formattedStringsLock) {
+        NSString *formattedString = (__bridge NSString *)SRGAnalyticsStringCacheGet(s_formattedStrings, key, keyLength);
+        if (formattedString) {
+            return formattedString;
+        }
+    }
+    
+    NSString *formattedString = self.srg_uncachedComScoreFormattedString;
+    
+    @synchronized(s_formattedStringsLock) {
+        SRGAnalyticsStringCacheSet(s_formattedStrings, key, keyLength, (void *)CFBridgingRetain(formattedString));
+    }
+    
+    return formattedString;
+}
+
+- (NSString *)srg_uncachedComScoreFormattedString
+{
     // See rules at https://srfmmz.atlassian.net/wiki/display/SRGPLAY/Measurement+of+SRG+Player+Apps
-    NSCharacterSet *andSet = [NSCharacterSet characterSetWithCharactersInString:@"+&"];
-    normalizedString = [[normalizedString componentsSeparatedByCharactersInSet:andSet] componentsJoinedByString:@"and"];
     
-    // Squash all non-alphanumeric characters as a single hyphen
-    NSRegularExpression *regularExpression = [NSRegularExpression regularExpressionWithPattern:@"[^a-z0-9]+" options:0 error:NULL];
-    normalizedString = [regularExpression stringByReplacingMatchesInString:normalizedString options:0 range:NSMakeRange(0, normalizedString.length) withTemplate:@"-"];
+    // Pure ASCII strings (the most common case) have no accentuated characters and are directly formatted from
+    // their bytes
+    NSUInteger length = self.length;
+    const char *ASCIIString = CFStringGetCStringPtr((__bridge CFStringRef)self, kCFStringEncodingASCII);
+    if (ASCIIString) {
+        return SRGAnalyticsComScoreFormattedString(ASCIIString, length);
+    }
+    
+    char ASCIIBuffer[SRGAnalyticsComScoreFormattingStackLength + 1];
+    if (length <= SRGAnalyticsComScoreFormattingStackLength && [self getCString:ASCIIBuffer maxLength:sizeof(ASCIIBuffer) encoding:NSASCIIStringEncoding]) {
+        return SRGAnalyticsComScoreFormattedString(ASCIIBuffer, length);
+    }
+    
+    // Remove accentuated characters
+    static NSLocale *s_posixLocale;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_posixLocale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    });
+    NSString *normalizedString = [self.lowercaseString stringByFoldingWithOptions:NSDiacriticInsensitiveSearch locale:s_posixLocale];
     
-    // Trim hyphens at both ends, if any
-    return [normalizedString stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"-"]];
+    // Remaining non-ASCII characters are encoded as bytes outside the ASCII range, considered as separators
+    NSData *UTF8Data = [normalizedString dataUsingEncoding:NSUTF8StringEncoding];
+    return SRGAnalyticsComScoreFormattedString(UTF8Data.bytes, UTF8Data.length);
 }
 
 @end
@@ -0,0 +1,47 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#include "SRGAnalyticsComScoreFormatting.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+size_t SRGAnalyticsComScoreFormatBytes(const char *input, size_t length, char *output)
+{
+    size_t outputLength = 0;
+    bool separatorPending = false;
+    
+    for (size_t i = 0; i < length; ++i) {
+        char c = input[i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        
+        bool alphanumeric = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+        bool conjunction = (c == '+' || c == '&');
+        if (! alphanumeric && ! conjunction) {
+            separatorPending = true;
+            continue;
+        }
+        
+        // Separators are only emitted between retained characters, which trims them at both ends
+        if (separatorPending && outputLength != 0) {
+            output[outputLength++] = '-';
+        }
+        separatorPending = false;
+        
+        if (alphanumeric) {
+            output[outputLength++] = c;
+        }
+        else {
+            memcpy(&output[outputLength], "and", 3);
+            outputLength += 3;
+        }
+    }
+    
+    output[outputLength] = '\0';
+    return outputLength;
+}
@@ -0,0 +1,45 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#ifndef SRGAnalyticsComScoreFormatting_h
+#define SRGAnalyticsComScoreFormatting_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Minimum output buffer size required to format an input of the specified length (`+` and `&` are expanded to `and`,
+ *  plus room for a terminating NUL).
+ */
+#define SRGAnalyticsComScoreFormattedLengthMax(length) (3 * (length) + 1)
+
+/**
+ *  Format a byte string according to comScore rules, in a single pass:
+ *    - ASCII letters are lowercased.
+ *    - `+` and `&` are replaced with `and`.
+ *    - Runs of characters other than `a-z` and `0-9` are replaced with a single hyphen.
+ *    - Hyphens are trimmed at both ends.
+ *
+ *  Bytes outside the ASCII range are treated like any other non-alphanumeric character. This matches the comScore
+ *  rules for UTF-8 input once diacritics have been removed, which is the responsibility of the caller.
+ *
+ *  @param input        The bytes to format.
+ *  @param length       The number of bytes to format.
+ *  @param output       The output buffer, which must be at least `SRGAnalyticsComScoreFormattedLengthMax(length)` bytes
+ *                      long. The result is NUL-terminated.
+ *
+ *  @return The length of the result (not including the terminating NUL).
+ */
+size_t SRGAnalyticsComScoreFormatBytes(const char *input, size_t length, char *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRGAnalyticsComScoreFormatting_h */
@@ -0,0 +1,157 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#include "SRGAnalyticsStreamStateMachine.h"
+
+#include <stdint.h>
+
+#define SRGAnalyticsStreamMachineStateBit(state) (1u << (state))
+
+static const uint32_t SRGAnalyticsStreamMachineSessionOpeningStates = SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStatePaused)
+    | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStateSeeking);
+
+// Target states allowed from each state, as bit masks
+static const uint32_t SRGAnalyticsStreamMachineTagCommanderTransitions[SRGAnalyticsStreamMachineStateCount] = {
+    [SRGAnalyticsStreamMachineStatePlaying] = SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStatePaused)
+        | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStateSeeking)
+        | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStateStopped)
+        | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStateEnded),
+    [SRGAnalyticsStreamMachineStatePaused] = SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStatePlaying)
+        | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStateSeeking)
+        | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStateStopped)
+        | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStateEnded),
+    [SRGAnalyticsStreamMachineStateSeeking] = SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStatePlaying)
+        | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStatePaused)
+        | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStateStopped)
+        | SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStateEnded),
+    [SRGAnalyticsStreamMachineStateStopped] = SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStatePlaying),
+    [SRGAnalyticsStreamMachineStateEnded] = SRGAnalyticsStreamMachineStateBit(SRGAnalyticsStreamMachineStatePlaying)
+};
+
+static const SRGAnalyticsStreamMachineTagCommanderEvent SRGAnalyticsStreamMachineTagCommanderEvents[SRGAnalyticsStreamMachineStateCount] = {
+    [SRGAnalyticsStreamMachineStatePlaying] = SRGAnalyticsStreamMachineTagCommanderEventPlay,
+    [SRGAnalyticsStreamMachineStatePaused] = SRGAnalyticsStreamMachineTagCommanderEventPause,
+    [SRGAnalyticsStreamMachineStateSeeking] = SRGAnalyticsStreamMachineTagCommanderEventSeek,
+    [SRGAnalyticsStreamMachineStateStopped] = SRGAnalyticsStreamMachineTagCommanderEventStop,
+    [SRGAnalyticsStreamMachineStateEnded] = SRGAnalyticsStreamMachineTagCommanderEventEof
+};
+
+static const char * const SRGAnalyticsStreamMachineTagCommanderEventNames[] = {
+    [SRGAnalyticsStreamMachineTagCommanderEventPlay] = "play",
+    [SRGAnalyticsStreamMachineTagCommanderEventPause] = "pause",
+    [SRGAnalyticsStreamMachineTagCommanderEventSeek] = "seek",
+    [SRGAnalyticsStreamMachineTagCommanderEventStop] = "stop",
+    [SRGAnalyticsStreamMachineTagCommanderEventEof] = "eof"
+};
+
+static const SRGAnalyticsStreamMachineComScoreEvent SRGAnalyticsStreamMachineComScoreEvents[SRGAnalyticsStreamMachineStateCount] = {
+    [SRGAnalyticsStreamMachineStatePlaying] = SRGAnalyticsStreamMachineComScoreEventPlay,
+    [SRGAnalyticsStreamMachineStatePaused] = SRGAnalyticsStreamMachineComScoreEventPause,
+    [SRGAnalyticsStreamMachineStateSeeking] = SRGAnalyticsStreamMachineComScoreEventPause,
+    [SRGAnalyticsStreamMachineStateStopped] = SRGAnalyticsStreamMachineComScoreEventEnd,
+    [SRGAnalyticsStreamMachineStateEnded] = SRGAnalyticsStreamMachineComScoreEventEnd
+};
+
+static bool SRGAnalyticsStreamMachineStateIsValid(SRGAnalyticsStreamMachineState state)
+{
+    return state > SRGAnalyticsStreamMachineStateNone && state < SRGAnalyticsStreamMachineStateCount;
+}
+
+void SRGAnalyticsStreamMachineInit(SRGAnalyticsStreamMachine *machine)
+{
+    machine->tagCommanderState = SRGAnalyticsStreamMachineStateEnded;
+    machine->comScoreSessionAlive = false;
+}
+
+size_t SRGAnalyticsStreamMachineUpdateTagCommander(SRGAnalyticsStreamMachine *machine,
+                                                   SRGAnalyticsStreamMachineState state,
+                                                   SRGAnalyticsStreamMachineState states[SRGAnalyticsStreamMachineEventCountMax])
+{
+    if (! SRGAnalyticsStreamMachineStateIsValid(state)) {
+        return 0;
+    }
+    
+    size_t count = 0;
+    
+    // Ensure a play is emitted before events requiring a session to be opened (the TagCommander SDK does not open sessions
+    // automatically)
+    if (machine->tagCommanderState == SRGAnalyticsStreamMachineStateEnded && (SRGAnalyticsStreamMachineSessionOpeningStates & SRGAnalyticsStreamMachineStateBit(state))) {
+        machine->tagCommanderState = SRGAnalyticsStreamMachineStatePlaying;
+        states[count++] = SRGAnalyticsStreamMachineStatePlaying;
+    }
+    
+    // Discard transitions which are not allowed
+    if (! (SRGAnalyticsStreamMachineTagCommanderTransitions[machine->tagCommanderState] & SRGAnalyticsStreamMachineStateBit(state))) {
+        return count;
+    }
+    
+    machine->tagCommanderState = state;
+    states[count++] = state;
+    return count;
+}
+
+size_t SRGAnalyticsStreamMachineUpdateComScore(SRGAnalyticsStreamMachine *machine,
+                                               SRGAnalyticsStreamMachineState state,
+                                               SRGAnalyticsStreamMachineComScoreEvent events[SRGAnalyticsStreamMachineEventCountMax])
+{
+    if (! SRGAnalyticsStreamMachineStateIsValid(state)) {
+        return 0;
+    }
+    
+    size_t count = 0;
+    
+    // Ensure a play is emitted before events requiring a session to be opened (the comScore SDK does not open sessions
+    // automatically)
+    if (! machine->comScoreSessionAlive && (SRGAnalyticsStreamMachineSessionOpeningStates & SRGAnalyticsStreamMachineStateBit(state))) {
+        events[count++] = SRGAnalyticsStreamMachineComScoreEventPlay;
+        machine->comScoreSessionAlive = true;
+    }
+    
+    SRGAnalyticsStreamMachineComScoreEvent event = SRGAnalyticsStreamMachineComScoreEvents[state];
+    events[count++] = event;
+    
+    if (event == SRGAnalyticsStreamMachineComScoreEventPlay) {
+        machine->comScoreSessionAlive = true;
+    }
+    else if (event == SRGAnalyticsStreamMachineComScoreEventEnd) {
+        machine->comScoreSessionAlive = false;
+    }
+    return count;
+}
+
+SRGAnalyticsStreamMachineTagCommanderEvent SRGAnalyticsStreamMachineTagCommanderEventForState(SRGAnalyticsStreamMachineState state)
+{
+    return SRGAnalyticsStreamMachineTagCommanderEvents[state];
+}
+
+const char *SRGAnalyticsStreamMachineTagCommanderEventName(SRGAnalyticsStreamMachineTagCommanderEvent event)
+{
+    return SRGAnalyticsStreamMachineTagCommanderEventNames[event];
+}
+
+void SRGAnalyticsStreamMachineReplay(const SRGAnalyticsStreamMachineState *states,
+                                     size_t count,
+                                     SRGAnalyticsStreamMachineTagCommanderEvent *tagCommanderEvents,
+                                     size_t *tagCommanderCount,
+                                     SRGAnalyticsStreamMachineComScoreEvent *comScoreEvents,
+                                     size_t *comScoreCount)
+{
+    SRGAnalyticsStreamMachine machine;
+    SRGAnalyticsStreamMachineInit(&machine);
+    
+    *tagCommanderCount = 0;
+    *comScoreCount = 0;
+    
+    for (size_t i = 0; i < count; ++i) {
+        SRGAnalyticsStreamMachineState acceptedStates[SRGAnalyticsStreamMachineEventCountMax];
+        size_t acceptedCount = SRGAnalyticsStreamMachineUpdateTagCommander(&machine, states[i], acceptedStates);
+        for (size_t j = 0; j < acceptedCount; ++j) {
+            tagCommanderEvents[(*tagCommanderCount)++] = SRGAnalyticsStreamMachineTagCommanderEventForState(acceptedStates[j]);
+        }
+        
+        *comScoreCount += SRGAnalyticsStreamMachineUpdateComScore(&machine, states[i], &comScoreEvents[*comScoreCount]);
+    }
+}
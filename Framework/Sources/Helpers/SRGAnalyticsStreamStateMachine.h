@@ -0,0 +1,129 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#ifndef SRGAnalyticsStreamStateMachine_h
+#define SRGAnalyticsStreamStateMachine_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Stream states. Values match those of `SRGAnalyticsStreamState`.
+ */
+typedef enum {
+    SRGAnalyticsStreamMachineStateNone = 0,
+    SRGAnalyticsStreamMachineStatePlaying,
+    SRGAnalyticsStreamMachineStatePaused,
+    SRGAnalyticsStreamMachineStateSeeking,
+    SRGAnalyticsStreamMachineStateStopped,
+    SRGAnalyticsStreamMachineStateEnded,
+    SRGAnalyticsStreamMachineStateCount
+} SRGAnalyticsStreamMachineState;
+
+/**
+ *  Events emitted by the TagCommander backend.
+ */
+typedef enum {
+    SRGAnalyticsStreamMachineTagCommanderEventPlay = 0,
+    SRGAnalyticsStreamMachineTagCommanderEventPause,
+    SRGAnalyticsStreamMachineTagCommanderEventSeek,
+    SRGAnalyticsStreamMachineTagCommanderEventStop,
+    SRGAnalyticsStreamMachineTagCommanderEventEof
+} SRGAnalyticsStreamMachineTagCommanderEvent;
+
+/**
+ *  Events emitted by the comScore backend.
+ */
+typedef enum {
+    SRGAnalyticsStreamMachineComScoreEventPlay = 0,
+    SRGAnalyticsStreamMachineComScoreEventPause,
+    SRGAnalyticsStreamMachineComScoreEventEnd
+} SRGAnalyticsStreamMachineComScoreEvent;
+
+/**
+ *  Maximum number of events a backend emits for a single update (an implicit play opening the session, followed by
+ *  the event for the update itself).
+ */
+#define SRGAnalyticsStreamMachineEventCountMax 2
+
+/**
+ *  State machine deciding which events are emitted by each backend when a stream changes state. Transitions and events
+ *  are looked up in constant tables indexed by state, no allocation is ever made.
+ *
+ *  Both backends require a play event to open a session before pause or seek events can be emitted. TagCommander
+ *  additionally discards transitions which are not allowed from the last state it accepted.
+ */
+typedef struct {
+    SRGAnalyticsStreamMachineState tagCommanderState;
+    bool comScoreSessionAlive;
+} SRGAnalyticsStreamMachine;
+
+/**
+ *  Initialize a state machine (no session opened).
+ */
+void SRGAnalyticsStreamMachineInit(SRGAnalyticsStreamMachine *machine);
+
+/**
+ *  Update the TagCommander backend with a new state.
+ *
+ *  @param states Buffer in which the states for which events must be emitted are written, in order. Apply the
+ *                side effects of each state (if any) before emitting the corresponding event.
+ *
+ *  @return The number of states written (at most `SRGAnalyticsStreamMachineEventCountMax`).
+ */
+size_t SRGAnalyticsStreamMachineUpdateTagCommander(SRGAnalyticsStreamMachine *machine,
+                                                   SRGAnalyticsStreamMachineState state,
+                                                   SRGAnalyticsStreamMachineState states[SRGAnalyticsStreamMachineEventCountMax]);
+
+/**
+ *  Update the comScore backend with a new state.
+ *
+ *  @param events Buffer in which the events to emit are written, in order.
+ *
+ *  @return The number of events written (at most `SRGAnalyticsStreamMachineEventCountMax`).
+ */
+size_t SRGAnalyticsStreamMachineUpdateComScore(SRGAnalyticsStreamMachine *machine,
+                                               SRGAnalyticsStreamMachineState state,
+                                               SRGAnalyticsStreamMachineComScoreEvent events[SRGAnalyticsStreamMachineEventCountMax]);
+
+/**
+ *  Return the TagCommander event emitted when the specified state has been accepted.
+ */
+SRGAnalyticsStreamMachineTagCommanderEvent SRGAnalyticsStreamMachineTagCommanderEventForState(SRGAnalyticsStreamMachineState state);
+
+/**
+ *  Return the name of a TagCommander event (e.g. `play`).
+ */
+const char *SRGAnalyticsStreamMachineTagCommanderEventName(SRGAnalyticsStreamMachineTagCommanderEvent event);
+
+/**
+ *  Replay a sequence of states from a freshly initialized machine, updating both backends with each state.
+ *
+ *  @param states               The states to replay.
+ *  @param count                The number of states to replay.
+ *  @param tagCommanderEvents   Buffer receiving TagCommander events, at least `SRGAnalyticsStreamMachineEventCountMax * count`
+ *                              long.
+ *  @param tagCommanderCount    The number of TagCommander events written.
+ *  @param comScoreEvents       Buffer receiving comScore events, at least `SRGAnalyticsStreamMachineEventCountMax * count`
+ *                              long.
+ *  @param comScoreCount        The number of comScore events written.
+ */
+void SRGAnalyticsStreamMachineReplay(const SRGAnalyticsStreamMachineState *states,
+                                     size_t count,
+                                     SRGAnalyticsStreamMachineTagCommanderEvent *tagCommanderEvents,
+                                     size_t *tagCommanderCount,
+                                     SRGAnalyticsStreamMachineComScoreEvent *comScoreEvents,
+                                     size_t *comScoreCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRGAnalyticsStreamStateMachine_h */
@@ -0,0 +1,244 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#include "SRGAnalyticsStringCache.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SRGAnalyticsStringCacheNoIndex SIZE_MAX
+
+typedef struct {
+    char *key;
+    size_t length;
+    uint64_t hash;
+    void *value;
+    size_t previous;                    // More recently used entry
+    size_t next;                        // Less recently used entry
+} SRGAnalyticsStringCacheEntry;
+
+struct SRGAnalyticsStringCache {
+    size_t capacity;
+    size_t count;
+    SRGAnalyticsStringCacheReleaseFunction releaseFunction;
+    
+    SRGAnalyticsStringCacheEntry *entries;
+    size_t head;                        // Most recently used entry
+    size_t tail;                        // Least recently used entry
+    
+    // Entry indices, stored with linear probing. The table is kept at most half full so that probe sequences are short
+    size_t *slots;
+    size_t slotMask;
+};
+
+// FNV-1a
+static uint64_t SRGAnalyticsStringCacheHash(const char *key, size_t length)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (unsigned char)key[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Return the slot containing the key, or the empty slot where it can be inserted
+static size_t SRGAnalyticsStringCacheFindSlot(const SRGAnalyticsStringCache *cache, const char *key, size_t length, uint64_t hash)
+{
+    size_t slot = (size_t)hash & cache->slotMask;
+    while (cache->slots[slot] != SRGAnalyticsStringCacheNoIndex) {
+        const SRGAnalyticsStringCacheEntry *entry = &cache->entries[cache->slots[slot]];
+        if (entry->hash == hash && entry->length == length && memcmp(entry->key, key, length) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & cache->slotMask;
+    }
+    return slot;
+}
+
+// Empty a slot, moving subsequent entries of the probe sequence back so that no lookup is interrupted by the hole
+static void SRGAnalyticsStringCacheRemoveSlot(SRGAnalyticsStringCache *cache, size_t slot)
+{
+    size_t hole = slot;
+    size_t current = (slot + 1) & cache->slotMask;
+    while (cache->slots[current] != SRGAnalyticsStringCacheNoIndex) {
+        size_t home = (size_t)cache->entries[cache->slots[current]].hash & cache->slotMask;
+        if (((current - home) & cache->slotMask) >= ((current - hole) & cache->slotMask)) {
+            cache->slots[hole] = cache->slots[current];
+            hole = current;
+        }
+        current = (current + 1) & cache->slotMask;
+    }
+    cache->slots[hole] = SRGAnalyticsStringCacheNoIndex;
+}
+
+static void SRGAnalyticsStringCacheUnlink(SRGAnalyticsStringCache *cache, size_t index)
+{
+    SRGAnalyticsStringCacheEntry *entry = &cache->entries[index];
+    if (entry->previous != SRGAnalyticsStringCacheNoIndex) {
+        cache->entries[entry->previous].next = entry->next;
+    }
+    else {
+        cache->head = entry->next;
+    }
+    
+    if (entry->next != SRGAnalyticsStringCacheNoIndex) {
+        cache->entries[entry->next].previous = entry->previous;
+    }
+    else {
+        cache->tail = entry->previous;
+    }
+}
+
+static void SRGAnalyticsStringCachePushFront(SRGAnalyticsStringCache *cache, size_t index)
+{
+    SRGAnalyticsStringCacheEntry *entry = &cache->entries[index];
+    entry->previous = SRGAnalyticsStringCacheNoIndex;
+    entry->next = cache->head;
+    
+    if (cache->head != SRGAnalyticsStringCacheNoIndex) {
+        cache->entries[cache->head].previous = index;
+    }
+    else {
+        cache->tail = index;
+    }
+    cache->head = index;
+}
+
+static void SRGAnalyticsStringCacheReleaseValue(const SRGAnalyticsStringCache *cache, void *value)
+{
+    if (cache->releaseFunction && value) {
+        cache->releaseFunction(value);
+    }
+}
+
+SRGAnalyticsStringCache *SRGAnalyticsStringCacheCreate(size_t capacity, SRGAnalyticsStringCacheReleaseFunction releaseFunction)
+{
+    if (capacity == 0 || capacity > SIZE_MAX / 4) {
+        return NULL;
+    }
+    
+    size_t slotCount = 1;
+    while (slotCount < 2 * capacity) {
+        slotCount <<= 1;
+    }
+    
+    SRGAnalyticsStringCache *cache = calloc(1, sizeof(SRGAnalyticsStringCache));
+    if (! cache) {
+        return NULL;
+    }
+    
+    cache->entries = calloc(capacity, sizeof(SRGAnalyticsStringCacheEntry));
+    cache->slots = malloc(slotCount * sizeof(size_t));
+    if (! cache->entries || ! cache->slots) {
+        free(cache->entries);
+        free(cache->slots);
+        free(cache);
+        return NULL;
+    }
+    
+    for (size_t i = 0; i < slotCount; ++i) {
+        cache->slots[i] = SRGAnalyticsStringCacheNoIndex;
+    }
+    
+    cache->capacity = capacity;
+    cache->releaseFunction = releaseFunction;
+    cache->head = SRGAnalyticsStringCacheNoIndex;
+    cache->tail = SRGAnalyticsStringCacheNoIndex;
+    cache->slotMask = slotCount - 1;
+    return cache;
+}
+
+void SRGAnalyticsStringCacheDestroy(SRGAnalyticsStringCache *cache)
+{
+    if (! cache) {
+        return;
+    }
+    
+    for (size_t i = 0; i < cache->count; ++i) {
+        free(cache->entries[i].key);
+        SRGAnalyticsStringCacheReleaseValue(cache, cache->entries[i].value);
+    }
+    free(cache->entries);
+    free(cache->slots);
+    free(cache);
+}
+
+void *SRGAnalyticsStringCacheGet(SRGAnalyticsStringCache *cache, const char *key, size_t length)
+{
+    uint64_t hash = SRGAnalyticsStringCacheHash(key, length);
+    size_t index = cache->slots[SRGAnalyticsStringCacheFindSlot(cache, key, length, hash)];
+    if (index == SRGAnalyticsStringCacheNoIndex) {
+        return NULL;
+    }
+    
+    if (index != cache->head) {
+        SRGAnalyticsStringCacheUnlink(cache, index);
+        SRGAnalyticsStringCachePushFront(cache, index);
+    }
+    return cache->entries[index].value;
+}
+
+void SRGAnalyticsStringCacheSet(SRGAnalyticsStringCache *cache, const char *key, size_t length, void *value)
+{
+    uint64_t hash = SRGAnalyticsStringCacheHash(key, length);
+    size_t slot = SRGAnalyticsStringCacheFindSlot(cache, key, length, hash);
+    size_t index = cache->slots[slot];
+    
+    // Existing key: replace the value
+    if (index != SRGAnalyticsStringCacheNoIndex) {
+        SRGAnalyticsStringCacheEntry *entry = &cache->entries[index];
+        if (entry->value != value) {
+            SRGAnalyticsStringCacheReleaseValue(cache, entry->value);
+            entry->value = value;
+        }
+        
+        if (index != cache->head) {
+            SRGAnalyticsStringCacheUnlink(cache, index);
+            SRGAnalyticsStringCachePushFront(cache, index);
+        }
+        return;
+    }
+    
+    char *keyCopy = malloc(length != 0 ? length : 1);
+    if (! keyCopy) {
+        SRGAnalyticsStringCacheReleaseValue(cache, value);
+        return;
+    }
+    memcpy(keyCopy, key, length);
+    
+    // Full cache: evict the least recently used entry and reuse it. Removing its slot moves other slots, the slot for the
+    // new key must therefore be found again
+    if (cache->count == cache->capacity) {
+        index = cache->tail;
+        SRGAnalyticsStringCacheEntry *evictedEntry = &cache->entries[index];
+        SRGAnalyticsStringCacheRemoveSlot(cache, SRGAnalyticsStringCacheFindSlot(cache, evictedEntry->key, evictedEntry->length, evictedEntry->hash));
+        SRGAnalyticsStringCacheUnlink(cache, index);
+        
+        free(evictedEntry->key);
+        SRGAnalyticsStringCacheReleaseValue(cache, evictedEntry->value);
+        
+        slot = SRGAnalyticsStringCacheFindSlot(cache, key, length, hash);
+    }
+    else {
+        index = cache->count++;
+    }
+    
+    SRGAnalyticsStringCacheEntry *entry = &cache->entries[index];
+    entry->key = keyCopy;
+    entry->length = length;
+    entry->hash = hash;
+    entry->value = value;
+    
+    cache->slots[slot] = index;
+    SRGAnalyticsStringCachePushFront(cache, index);
+}
+
+size_t SRGAnalyticsStringCacheCount(const SRGAnalyticsStringCache *cache)
+{
+    return cache->count;
+}
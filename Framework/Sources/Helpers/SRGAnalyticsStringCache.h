@@ -0,0 +1,63 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#ifndef SRGAnalyticsStringCache_h
+#define SRGAnalyticsStringCache_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Function releasing a value stored in a cache, called when the value is evicted or replaced, or when the cache is
+ *  destroyed.
+ */
+typedef void (*SRGAnalyticsStringCacheReleaseFunction)(void *value);
+
+/**
+ *  Cache associating values with byte string keys, discarding least recently used entries when full. Lookups, insertions
+ *  and evictions are made in constant time, and no allocation is made except for copying keys.
+ *
+ *  Caches are not thread-safe. Callers must synchronize accesses.
+ */
+typedef struct SRGAnalyticsStringCache SRGAnalyticsStringCache;
+
+/**
+ *  Create a cache with the specified capacity (at least 1). Values are released with the specified function, if any.
+ *
+ *  @return The cache, or `NULL` if it could not be created.
+ */
+SRGAnalyticsStringCache *SRGAnalyticsStringCacheCreate(size_t capacity, SRGAnalyticsStringCacheReleaseFunction releaseFunction);
+
+/**
+ *  Destroy a cache, releasing all values it contains.
+ */
+void SRGAnalyticsStringCacheDestroy(SRGAnalyticsStringCache *cache);
+
+/**
+ *  Return the value associated with a key, or `NULL` if none. A value found becomes the most recently used one. The
+ *  value is owned by the cache and remains valid until it is evicted.
+ */
+void *SRGAnalyticsStringCacheGet(SRGAnalyticsStringCache *cache, const char *key, size_t length);
+
+/**
+ *  Associate a value with a key, replacing any existing value. If the cache is full, the least recently used entry is
+ *  evicted first. The cache takes ownership of the value.
+ */
+void SRGAnalyticsStringCacheSet(SRGAnalyticsStringCache *cache, const char *key, size_t length, void *value);
+
+/**
+ *  The number of entries in the cache.
+ */
+size_t SRGAnalyticsStringCacheCount(const SRGAnalyticsStringCache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRGAnalyticsStringCache_h */
@@ -0,0 +1,53 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  `SRGAnalyticsViewTracking` capabilities of a class.
+ */
+typedef NS_OPTIONS(uint8_t, SRGAnalyticsViewTrackingCapabilities) {
+    /**
+     *  The class conforms to `SRGAnalyticsViewTracking`.
+     */
+    SRGAnalyticsViewTrackingCapabilityTracked = (1 << 0),
+    /**
+     *  The class implements `srg_isTrackedAutomatically`.
+     */
+    SRGAnalyticsViewTrackingCapabilityTrackedAutomatically = (1 << 1),
+    /**
+     *  The class implements `srg_pageViewLevels`.
+     */
+    SRGAnalyticsViewTrackingCapabilityPageViewLevels = (1 << 2),
+    /**
+     *  The class implements `srg_pageViewLabels`.
+     */
+    SRGAnalyticsViewTrackingCapabilityPageViewLabels = (1 << 3),
+    /**
+     *  The class implements `srg_isOpenedFromPushNotification`.
+     */
+    SRGAnalyticsViewTrackingCapabilityOpenedFromPushNotification = (1 << 4)
+};
+
+/**
+ *  Return the `SRGAnalyticsViewTracking` capabilities of a class. Capabilities are determined once per class and cached,
+ *  and can be read from any thread without locking.
+ *
+ *  @discussion The cache is keyed by class pointer, and only classes loaded from an image (binary or framework) are cached,
+ *              since classes created at runtime (e.g. by KVO or `objc_allocateClassPair`) can be disposed of and their
+ *              address reused. For cached classes, methods and protocols added at runtime (`class_addMethod`,
+ *              `class_addProtocol`) after the first call are not taken into account.
+ */
+OBJC_EXPORT SRGAnalyticsViewTrackingCapabilities SRGAnalyticsViewTrackingCapabilitiesForClass(Class cls);
+
+/**
+ *  Same as `SRGAnalyticsViewTrackingCapabilitiesForClass()`, but without cache lookup.
+ */
+OBJC_EXPORT SRGAnalyticsViewTrackingCapabilities SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(Class cls);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,86 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsViewTrackingCapabilities.h"
+
+#import "UIViewController+SRGAnalytics.h"
+
+#import <objc/runtime.h>
+#import <stdatomic.h>
+
+// Cache entries are immutable once published, and never freed since classes loaded from images are never unloaded.
+typedef struct {
+    __unsafe_unretained Class cls;
+    SRGAnalyticsViewTrackingCapabilities capabilities;
+} SRGAnalyticsViewTrackingCapabilitiesEntry;
+
+// Open addressing table (power of 2 size). Only a few probes are made, classes not found within these slots are simply not
+// cached.
+static const size_t SRGAnalyticsViewTrackingCapabilitiesTableSize = 1024;
+static const size_t SRGAnalyticsViewTrackingCapabilitiesMaximumProbes = 16;
+
+static _Atomic(SRGAnalyticsViewTrackingCapabilitiesEntry *) s_capabilitiesEntries[SRGAnalyticsViewTrackingCapabilitiesTableSize];
+
+SRGAnalyticsViewTrackingCapabilities SRGAnalyticsViewTrackingCapabilitiesForClass(Class cls)
+{
+    // Class pointers are aligned, discard the low bits before mixing
+    uintptr_t hash = (uintptr_t)(__bridge void *)cls >> 4;
+    hash ^= hash >> 10;
+    
+    SRGAnalyticsViewTrackingCapabilitiesEntry *newEntry = NULL;
+    for (size_t probe = 0; probe < SRGAnalyticsViewTrackingCapabilitiesMaximumProbes; ++probe) {
+        size_t index = (hash + probe) & (SRGAnalyticsViewTrackingCapabilitiesTableSize - 1);
+        SRGAnalyticsViewTrackingCapabilitiesEntry *entry = atomic_load_explicit(&s_capabilitiesEntries[index], memory_order_acquire);
+        if (! entry) {
+            if (! newEntry) {
+                // Classes created at runtime can be disposed of and their address reused by another class. Do not cache them
+                if (! class_getImageName(cls)) {
+                    return SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(cls);
+                }
+                
+                newEntry = malloc(sizeof(SRGAnalyticsViewTrackingCapabilitiesEntry));
+                newEntry->cls = cls;
+                newEntry->capabilities = SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(cls);
+            }
+            
+            // If another thread published an entry in the meantime, check it instead
+            if (atomic_compare_exchange_strong_explicit(&s_capabilitiesEntries[index], &entry, newEntry, memory_order_acq_rel, memory_order_acquire)) {
+                return newEntry->capabilities;
+            }
+        }
+        
+        if (entry->cls == cls) {
+            free(newEntry);
+            return entry->capabilities;
+        }
+    }
+    
+    SRGAnalyticsViewTrackingCapabilities capabilities = newEntry ? newEntry->capabilities : SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(cls);
+    free(newEntry);
+    return capabilities;
+}
+
+SRGAnalyticsViewTrackingCapabilities SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(Class cls)
+{
+    if (! [cls conformsToProtocol:@protocol(SRGAnalyticsViewTracking)]) {
+        return 0;
+    }
+    
+    SRGAnalyticsViewTrackingCapabilities capabilities = SRGAnalyticsViewTrackingCapabilityTracked;
+    if ([cls instancesRespondToSelector:@selector(srg_isTrackedAutomatically)]) {
+        capabilities |= SRGAnalyticsViewTrackingCapabilityTrackedAutomatically;
+    }
+    if ([cls instancesRespondToSelector:@selector(srg_pageViewLevels)]) {
+        capabilities |= SRGAnalyticsViewTrackingCapabilityPageViewLevels;
+    }
+    if ([cls instancesRespondToSelector:@selector(srg_pageViewLabels)]) {
+        capabilities |= SRGAnalyticsViewTrackingCapabilityPageViewLabels;
+    }
+    if ([cls instancesRespondToSelector:@selector(srg_isOpenedFromPushNotification)]) {
+        capabilities |= SRGAnalyticsViewTrackingCapabilityOpenedFromPushNotification;
+    }
+    return capabilities;
+}
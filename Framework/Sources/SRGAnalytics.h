@@ -11,7 +11,10 @@ FOUNDATION_EXPORT NSString * SRGAnalyticsMarketingVersion(void);
 
 // Public headers.
 #import "SRGAnalyticsConfiguration.h"
+#import "SRGAnalyticsEvent.h"
+#import "SRGAnalyticsEventRecorder.h"
 #import "SRGAnalyticsHiddenEventLabels.h"
+#import "SRGAnalyticsInstrumentation.h"
 #import "SRGAnalyticsLabels.h"
 #import "SRGAnalyticsNotifications.h"
 #import "SRGAnalyticsPageViewLabels.h"
@@ -0,0 +1,54 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoreMedia/CoreMedia.h>
+#import <SRGDataProvider/SRGDataProvider.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Immutable cache of values derived from a segment, which players query for all segments of a media each time the
+ *  playback position is updated. The time range is computed once, and the blocking status is computed once for each
+ *  period delimited by the segment start and end dates, which are the only dates at which it can change.
+ *
+ *  @discussion Caches are thread-safe.
+ */
+@interface SRGAnalyticsSegmentCache : NSObject
+
+/**
+ *  Return the cache associated with a segment, creating it if needed.
+ */
++ (SRGAnalyticsSegmentCache *)cacheForSegment:(SRGSegment *)segment;
+
+/**
+ *  Create a cache for the specified segment.
+ */
+- (instancetype)initWithSegment:(SRGSegment *)segment NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  The segment time range.
+ */
+@property (nonatomic, readonly) CMTimeRange timeRange;
+
+/**
+ *  Return `YES` iff the segment is blocked at the specified date.
+ */
+- (BOOL)isBlockedAtDate:(NSDate *)date;
+
+/**
+ *  Same as `-isBlockedAtDate:`, for an absolute time (see `CFAbsoluteTimeGetCurrent()`).
+ */
+- (BOOL)isBlockedAtTime:(CFAbsoluteTime)time;
+
+@end
+
+@interface SRGAnalyticsSegmentCache (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
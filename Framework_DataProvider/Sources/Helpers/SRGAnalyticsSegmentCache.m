@@ -0,0 +1,131 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsSegmentCache.h"
+
+#import <objc/runtime.h>
+
+static void *s_segmentCacheKey = &s_segmentCacheKey;
+
+// At most two boundaries (start and end dates), delimiting at most three periods
+static const NSUInteger SRGAnalyticsSegmentCacheBoundaryCountMax = 2;
+
+@interface SRGAnalyticsSegmentCache () {
+@private
+    NSUInteger _boundaryCount;
+    CFAbsoluteTime _boundaries[SRGAnalyticsSegmentCacheBoundaryCountMax];           // Sorted
+    BOOL _blocked[SRGAnalyticsSegmentCacheBoundaryCountMax + 1];                    // Status for each period
+}
+
+@property (nonatomic, weak) SRGSegment *segment;
+@property (nonatomic) CMTimeRange timeRange;
+
+@end
+
+@implementation SRGAnalyticsSegmentCache
+
+#pragma mark Class methods
+
++ (SRGAnalyticsSegmentCache *)cacheForSegment:(SRGSegment *)segment
+{
+    // Segments are immutable. If several threads create a cache at the same time, caches are identical anyway
+    SRGAnalyticsSegmentCache *cache = objc_getAssociatedObject(segment, s_segmentCacheKey);
+    if (! cache) {
+        cache = [[SRGAnalyticsSegmentCache alloc] initWithSegment:segment];
+        objc_setAssociatedObject(segment, s_segmentCacheKey, cache, OBJC_ASSOCIATION_RETAIN);
+    }
+    return cache;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithSegment:(SRGSegment *)segment
+{
+    if (self = [super init]) {
+        self.segment = segment;
+        self.timeRange = CMTimeRangeMake(CMTimeMakeWithSeconds(segment.markIn / 1000., NSEC_PER_SEC),
+                                         CMTimeMakeWithSeconds(segment.duration / 1000., NSEC_PER_SEC));
+        
+        NSDate *boundaryDates[] = { segment.startDate, segment.endDate };
+        for (NSUInteger i = 0; i < SRGAnalyticsSegmentCacheBoundaryCountMax; ++i) {
+            if (boundaryDates[i]) {
+                _boundaries[_boundaryCount++] = boundaryDates[i].timeIntervalSinceReferenceDate;
+            }
+        }
+        if (_boundaryCount == 2 && _boundaries[0] > _boundaries[1]) {
+            CFAbsoluteTime boundary = _boundaries[0];
+            _boundaries[0] = _boundaries[1];
+            _boundaries[1] = boundary;
+        }
+        
+        // Evaluate the status once within each period
+        for (NSUInteger i = 0; i <= _boundaryCount; ++i) {
+            CFAbsoluteTime time = 0.;
+            if (_boundaryCount == 0) {
+                time = CFAbsoluteTimeGetCurrent();
+            }
+            else if (i == 0) {
+                time = _boundaries[0] - 1.;
+            }
+            else if (i == _boundaryCount) {
+                time = _boundaries[_boundaryCount - 1] + 1.;
+            }
+            else {
+                time = (_boundaries[i - 1] + _boundaries[i]) / 2.;
+            }
+            _blocked[i] = [segment blockingReasonAtDate:[NSDate dateWithTimeIntervalSinceReferenceDate:time]] != SRGBlockingReasonNone;
+        }
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithSegment:[SRGSegment new]];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Blocking
+
+- (BOOL)isBlockedAtDate:(NSDate *)date
+{
+    return [self isBlockedAtTime:date.timeIntervalSinceReferenceDate];
+}
+
+- (BOOL)isBlockedAtTime:(CFAbsoluteTime)time
+{
+    NSUInteger period = 0;
+    while (period < _boundaryCount && _boundaries[period] < time) {
+        ++period;
+    }
+    
+    // Exactly at a boundary, let the segment decide
+    if (period < _boundaryCount && _boundaries[period] == time) {
+        SRGSegment *segment = self.segment;
+        if (segment) {
+            return [segment blockingReasonAtDate:[NSDate dateWithTimeIntervalSinceReferenceDate:time]] != SRGBlockingReasonNone;
+        }
+    }
+    return _blocked[period];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; timeRange = %@; boundaryCount = %@>",
+            self.class,
+            self,
+            [NSValue valueWithCMTimeRange:self.timeRange],
+            @(_boundaryCount)];
+}
+
+@end
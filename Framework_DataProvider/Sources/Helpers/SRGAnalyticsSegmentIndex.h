@@ -0,0 +1,60 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoreMedia/CoreMedia.h>
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Immutable index over a list of segments, so that refreshed segment lists can be compared cheaply. Time ranges and
+ *  visibility are computed once for a quick comparison, and full segment contents are only extracted when needed.
+ *
+ *  @discussion Indexes are thread-safe.
+ */
+@interface SRGAnalyticsSegmentIndex : NSObject
+
+/**
+ *  Return the index for the specified segments. Indexes of immutable arrays are built once and cached.
+ */
++ (SRGAnalyticsSegmentIndex *)indexForSegments:(NSArray<id<SRGSegment>> *)segments;
+
+/**
+ *  Create an index for the specified segments.
+ */
+- (instancetype)initWithSegments:(NSArray<id<SRGSegment>> *)segments NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  The indexed segments, in their original order.
+ */
+@property (nonatomic, readonly) NSArray<id<SRGSegment>> *segments;
+
+/**
+ *  Return the time range of the segment at the specified index.
+ */
+- (CMTimeRange)timeRangeAtIndex:(NSUInteger)index;
+
+/**
+ *  Return `YES` iff the segment at the specified index is hidden.
+ */
+- (BOOL)isHiddenAtIndex:(NSUInteger)index;
+
+/**
+ *  Return `YES` iff both indexes have the same segments, in the same order and with the same contents. Model segments
+ *  (e.g. `SRGSegment`) are compared with all their properties (analytics labels, dates, blocking reason, etc.), other
+ *  segments must be identical.
+ */
+- (BOOL)isEquivalentToIndex:(SRGAnalyticsSegmentIndex *)index;
+
+@end
+
+@interface SRGAnalyticsSegmentIndex (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,151 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsSegmentIndex.h"
+
+#import <Mantle/Mantle.h>
+#import <objc/runtime.h>
+
+static void *s_segmentIndexKey = &s_segmentIndexKey;
+
+// Values computed once per segment, for a quick comparison before full contents are compared
+typedef struct {
+    CMTimeRange timeRange;
+    BOOL hidden;
+} SRGAnalyticsSegmentEntry;
+
+@interface SRGAnalyticsSegmentIndex () {
+@private
+    NSUInteger _count;
+    SRGAnalyticsSegmentEntry *_entries;             // Original order
+}
+
+@property (nonatomic) NSArray<id<SRGSegment>> *segments;
+@property (nonatomic) NSArray<id> *segmentContents;                     // Lazily built, protected by `self`
+@property (nonatomic, readonly) NSArray<id> *contents;
+
+@end
+
+@implementation SRGAnalyticsSegmentIndex
+
+#pragma mark Class methods
+
++ (SRGAnalyticsSegmentIndex *)indexForSegments:(NSArray<id<SRGSegment>> *)segments
+{
+    if ([segments isKindOfClass:NSMutableArray.class]) {
+        return [[SRGAnalyticsSegmentIndex alloc] initWithSegments:segments];
+    }
+    
+    SRGAnalyticsSegmentIndex *index = objc_getAssociatedObject(segments, s_segmentIndexKey);
+    if (! index) {
+        index = [[SRGAnalyticsSegmentIndex alloc] initWithSegments:segments];
+        objc_setAssociatedObject(segments, s_segmentIndexKey, index, OBJC_ASSOCIATION_RETAIN);
+    }
+    return index;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithSegments:(NSArray<id<SRGSegment>> *)segments
+{
+    if (self = [super init]) {
+        // Cached indexes are attached to the segment array. Keep a distinct array so that the index does not retain it
+        self.segments = [[NSArray alloc] initWithArray:segments];
+        
+        _count = segments.count;
+        _entries = calloc(_count, sizeof(SRGAnalyticsSegmentEntry));
+        for (NSUInteger i = 0; i < _count; ++i) {
+            id<SRGSegment> segment = segments[i];
+            _entries[i].timeRange = segment.srg_timeRange;
+            _entries[i].hidden = segment.srg_hidden;
+        }
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithSegments:@[]];
+}
+
+#pragma clang diagnostic pop
+
+- (void)dealloc
+{
+    free(_entries);
+}
+
+#pragma mark Accessors
+
+- (CMTimeRange)timeRangeAtIndex:(NSUInteger)index
+{
+    NSParameterAssert(index < _count);
+    return _entries[index].timeRange;
+}
+
+- (BOOL)isHiddenAtIndex:(NSUInteger)index
+{
+    NSParameterAssert(index < _count);
+    return _entries[index].hidden;
+}
+
+#pragma mark Comparison
+
+// Full model contents (labels, dates, blocking reason, etc.). Segments which are not models are only compared by identity
+- (NSArray<id> *)contents
+{
+    @synchronized(self) {
+        if (! self.segmentContents) {
+            NSMutableArray<id> *segmentContents = [NSMutableArray arrayWithCapacity:_count];
+            for (id<SRGSegment> segment in self.segments) {
+                if ([segment isKindOfClass:MTLModel.class]) {
+                    [segmentContents addObject:((MTLModel *)segment).dictionaryValue];
+                }
+                else {
+                    [segmentContents addObject:[NSValue valueWithNonretainedObject:segment]];
+                }
+            }
+            self.segmentContents = [segmentContents copy];
+        }
+        return self.segmentContents;
+    }
+}
+
+- (BOOL)isEquivalentToIndex:(SRGAnalyticsSegmentIndex *)index
+{
+    if (self == index) {
+        return YES;
+    }
+    
+    if (_count != index->_count) {
+        return NO;
+    }
+    
+    for (NSUInteger i = 0; i < _count; ++i) {
+        if (! CMTimeRangeEqual(_entries[i].timeRange, index->_entries[i].timeRange)
+                || _entries[i].hidden != index->_entries[i].hidden
+                || ! [self.segments[i] isEqual:index.segments[i]]) {
+            return NO;
+        }
+    }
+    return [self.contents isEqualToArray:index.contents];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; segments = %@>",
+            self.class,
+            self,
+            @(_count)];
+}
+
+@end
@@ -0,0 +1,34 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPlaybackSettings.h"
+
+#import <SRGDataProvider/SRGDataProvider.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Return the resource best matching the specified settings among a list of resources, `nil` if the list is empty.
+ *  Resources are ranked by URL scheme (HTTPS first), stream type, quality and DRM (if favored by the settings), in
+ *  this order. Among equally ranked resources, the first one is returned.
+ *
+ *  @discussion The streaming method of the settings is ignored.
+ */
+OBJC_EXPORT SRGResource * _Nullable SRGPreferredResource(NSArray<SRGResource *> *resources, SRGPlaybackSettings * _Nullable settings);
+
+@interface SRGChapter (SRGAnalytics_DataProvider)
+
+/**
+ *  Return the resource best matching the specified settings (`nil` for default settings), `nil` if none. If no resource
+ *  is available for the preferred streaming method, resources for the recommended streaming method are used instead.
+ *
+ *  @discussion Results are cached per chapter and settings. This method is thread-safe.
+ */
+- (nullable SRGResource *)srg_preferredResourceWithSettings:(nullable SRGPlaybackSettings *)settings;
+
+@end
+
+NS_ASSUME_NONNULL_END
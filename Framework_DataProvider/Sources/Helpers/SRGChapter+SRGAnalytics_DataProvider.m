@@ -0,0 +1,160 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGChapter+SRGAnalytics_DataProvider.h"
+
+#import "SRGResource+SRGAnalytics_DataProvider.h"
+
+#import <objc/runtime.h>
+
+static void *s_preferredResourcesKey = &s_preferredResourcesKey;
+
+static const NSUInteger SRGResourceRankingOrderCount = 3;
+
+// Stream type and quality orders (by increasing preference), with the preferred value moved last.
+typedef struct {
+    NSInteger streamTypes[SRGResourceRankingOrderCount];
+    NSInteger qualities[SRGResourceRankingOrderCount];
+    BOOL DRM;
+} SRGResourceRanking;
+
+static void SRGResourceRankingOrderFill(NSInteger *order, const NSInteger *defaultOrder, NSInteger preferredValue)
+{
+    NSUInteger count = 0;
+    BOOL found = NO;
+    for (NSUInteger i = 0; i < SRGResourceRankingOrderCount; ++i) {
+        if (defaultOrder[i] == preferredValue) {
+            found = YES;
+        }
+        else {
+            order[count++] = defaultOrder[i];
+        }
+    }
+    if (found) {
+        order[count] = preferredValue;
+    }
+}
+
+static SRGResourceRanking SRGResourceRankingMake(SRGPlaybackSettings *settings)
+{
+    static const NSInteger s_defaultStreamTypes[SRGResourceRankingOrderCount] = { SRGStreamTypeOnDemand, SRGStreamTypeLive, SRGStreamTypeDVR };
+    static const NSInteger s_defaultQualities[SRGResourceRankingOrderCount] = { SRGQualitySD, SRGQualityHD, SRGQualityHQ };
+    
+    SRGResourceRanking ranking;
+    SRGResourceRankingOrderFill(ranking.streamTypes, s_defaultStreamTypes, settings.streamType);
+    SRGResourceRankingOrderFill(ranking.qualities, s_defaultQualities, settings.quality);
+    ranking.DRM = settings.DRM;
+    return ranking;
+}
+
+// Values which are not part of the order (e.g. `SRGStreamTypeNone`) rank highest.
+static NSUInteger SRGResourceRankInOrder(NSInteger value, const NSInteger *order)
+{
+    for (NSUInteger i = 0; i < SRGResourceRankingOrderCount; ++i) {
+        if (order[i] == value) {
+            return i;
+        }
+    }
+    return SRGResourceRankingOrderCount;
+}
+
+// Only declare ordering for important URL schemes. Other schemes rank lowest.
+static NSUInteger SRGResourceURLSchemeRank(NSURL *URL)
+{
+    NSString *scheme = URL.scheme;
+    if ([scheme isEqualToString:@"https"]) {
+        return 2;
+    }
+    else if ([scheme isEqualToString:@"http"]) {
+        return 1;
+    }
+    else {
+        return 0;
+    }
+}
+
+// Pack all criteria into a single integer (2 bits per criterium except DRM, most important one first), so that resources
+// can be compared with a single integer comparison. Higher is better.
+static NSUInteger SRGResourceRankKey(SRGResource *resource, const SRGResourceRanking *ranking)
+{
+    NSUInteger rankKey = SRGResourceURLSchemeRank(resource.URL) << 5;
+    rankKey |= SRGResourceRankInOrder(resource.streamType, ranking->streamTypes) << 3;
+    rankKey |= SRGResourceRankInOrder(resource.quality, ranking->qualities) << 1;
+    if (ranking->DRM && resource.srg_requiresDRM) {
+        rankKey |= 1;
+    }
+    return rankKey;
+}
+
+// Settings values which resource selection depends on.
+static NSNumber *SRGPreferredResourceCacheKey(SRGPlaybackSettings *settings)
+{
+    uint64_t key = ((uint64_t)settings.streamingMethod & 0xFFFF) << 48
+        | ((uint64_t)settings.streamType & 0xFFFF) << 32
+        | ((uint64_t)settings.quality & 0xFFFF) << 16
+        | (settings.DRM ? 1 : 0);
+    return @(key);
+}
+
+SRGResource *SRGPreferredResource(NSArray<SRGResource *> *resources, SRGPlaybackSettings *settings)
+{
+    SRGResourceRanking ranking = SRGResourceRankingMake(settings);
+    
+    SRGResource *preferredResource = nil;
+    NSUInteger preferredRankKey = 0;
+    for (SRGResource *resource in resources) {
+        // Strict comparison so that the first resource wins among equally ranked ones
+        NSUInteger rankKey = SRGResourceRankKey(resource, &ranking);
+        if (! preferredResource || rankKey > preferredRankKey) {
+            preferredResource = resource;
+            preferredRankKey = rankKey;
+        }
+    }
+    return preferredResource;
+}
+
+@implementation SRGChapter (SRGAnalytics_DataProvider)
+
+- (SRGResource *)srg_preferredResourceWithSettings:(SRGPlaybackSettings *)settings
+{
+    NSNumber *cacheKey = SRGPreferredResourceCacheKey(settings);
+    @synchronized(self) {
+        NSDictionary<NSNumber *, SRGResource *> *preferredResources = objc_getAssociatedObject(self, s_preferredResourcesKey);
+        SRGResource *preferredResource = preferredResources[cacheKey];
+        if (preferredResource) {
+            return preferredResource;
+        }
+    }
+    
+    SRGStreamingMethod streamingMethod = settings.streamingMethod;
+    if (streamingMethod == SRGStreamingMethodNone) {
+        streamingMethod = self.recommendedStreamingMethod;
+    }
+    
+    NSArray<SRGResource *> *resources = [self resourcesForStreamingMethod:streamingMethod];
+    if (resources.count == 0) {
+        resources = [self resourcesForStreamingMethod:self.recommendedStreamingMethod];
+    }
+    
+    SRGResource *preferredResource = SRGPreferredResource(resources, settings);
+    if (! preferredResource) {
+        return nil;
+    }
+    
+    // Chapters are immutable, so that cached results never need to be invalidated. Settings combinations used in
+    // practice are few, the cache does not need to be bounded.
+    @synchronized(self) {
+        NSMutableDictionary<NSNumber *, SRGResource *> *preferredResources = objc_getAssociatedObject(self, s_preferredResourcesKey);
+        if (! preferredResources) {
+            preferredResources = [NSMutableDictionary dictionary];
+            objc_setAssociatedObject(self, s_preferredResourcesKey, preferredResources, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        }
+        preferredResources[cacheKey] = preferredResource;
+    }
+    return preferredResource;
+}
+
+@end
@@ -7,17 +7,52 @@
 #import "SRGMediaComposition+SRGAnalytics_DataProvider.h"
 
 #import "SRGAnalyticsMediaPlayerLogger.h"
-#import "SRGResource+SRGAnalytics_DataProvider.h"
+#import "SRGChapter+SRGAnalytics_DataProvider.h"
 #import "SRGSegment+SRGAnalytics_DataProvider.h"
 
-#import <libextobjc/libextobjc.h>
+#import <objc/runtime.h>
+
+static void *s_resourceAnalyticsLabelsKey = &s_resourceAnalyticsLabelsKey;
+
+// Missing and empty label dictionaries are equivalent.
+static BOOL SRGAnalyticsLabelsEqual(NSDictionary<NSString *, NSString *> *labels1, NSDictionary<NSString *, NSString *> *labels2)
+{
+    if (labels1 == labels2 || (labels1.count == 0 && labels2.count == 0)) {
+        return YES;
+    }
+    return [labels1 isEqualToDictionary:labels2];
+}
 
 @implementation SRGMediaComposition (SRGAnalytics_DataProvider)
 
+#pragma mark Analytics labels
+
 - (SRGAnalyticsStreamLabels *)analyticsLabelsForResource:(SRGResource *)resource sourceUid:(NSString *)sourceUid
 {
     NSAssert([self.mainChapter.resources containsObject:resource], @"The specified resource must be associated with the current context");
     
+    // Return a copy, as labels are mutable
+    SRGAnalyticsStreamLabels *labels = [[self resourceAnalyticsLabelsForResource:resource] copy];
+    if (sourceUid) {
+        NSMutableDictionary<NSString *, NSString *> *customInfo = [labels.customInfo mutableCopy];
+        customInfo[@"source_id"] = sourceUid;
+        labels.customInfo = [customInfo copy];
+    }
+    return labels;
+}
+
+// Labels for a resource, without source information. Media compositions are immutable, so that labels are built once
+// per resource.
+- (SRGAnalyticsStreamLabels *)resourceAnalyticsLabelsForResource:(SRGResource *)resource
+{
+    @synchronized(self) {
+        NSMapTable<SRGResource *, SRGAnalyticsStreamLabels *> *resourceAnalyticsLabels = objc_getAssociatedObject(self, s_resourceAnalyticsLabelsKey);
+        SRGAnalyticsStreamLabels *labels = [resourceAnalyticsLabels objectForKey:resource];
+        if (labels) {
+            return labels;
+        }
+    }
+    
     SRGAnalyticsStreamLabels *labels = [[SRGAnalyticsStreamLabels alloc] init];
     
     NSMutableDictionary<NSString *, NSString *> *customInfo = [NSMutableDictionary dictionary];
@@ -30,7 +65,6 @@
     if (resource.analyticsLabels) {
         [customInfo addEntriesFromDictionary:resource.analyticsLabels];
     }
-    customInfo[@"source_id"] = sourceUid;
     labels.customInfo = [customInfo copy];
     
     NSMutableDictionary<NSString *, NSString *> *comScoreCustomInfo = [NSMutableDictionary dictionary];
@@ -45,114 +79,42 @@
     }
     labels.comScoreCustomInfo = [comScoreCustomInfo copy];
     
+    // Resources are compared by identity, since they belong to the receiver
+    if (resource) {
+        @synchronized(self) {
+            NSMapTable<SRGResource *, SRGAnalyticsStreamLabels *> *resourceAnalyticsLabels = objc_getAssociatedObject(self, s_resourceAnalyticsLabelsKey);
+            if (! resourceAnalyticsLabels) {
+                resourceAnalyticsLabels = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                                valueOptions:NSPointerFunctionsStrongMemory];
+                objc_setAssociatedObject(self, s_resourceAnalyticsLabelsKey, resourceAnalyticsLabels, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+            }
+            [resourceAnalyticsLabels setObject:labels forKey:resource];
+        }
+    }
     return labels;
 }
 
+- (BOOL)hasSameAnalyticsLabelsForResource:(SRGResource *)resource asMediaComposition:(SRGMediaComposition *)mediaComposition resource:(SRGResource *)otherResource
+{
+    if (self == mediaComposition && resource == otherResource) {
+        return YES;
+    }
+    
+    return SRGAnalyticsLabelsEqual(self.analyticsLabels, mediaComposition.analyticsLabels)
+        && SRGAnalyticsLabelsEqual(self.comScoreAnalyticsLabels, mediaComposition.comScoreAnalyticsLabels)
+        && SRGAnalyticsLabelsEqual(self.mainChapter.analyticsLabels, mediaComposition.mainChapter.analyticsLabels)
+        && SRGAnalyticsLabelsEqual(self.mainChapter.comScoreAnalyticsLabels, mediaComposition.mainChapter.comScoreAnalyticsLabels)
+        && SRGAnalyticsLabelsEqual(resource.analyticsLabels, otherResource.analyticsLabels)
+        && SRGAnalyticsLabelsEqual(resource.comScoreAnalyticsLabels, otherResource.comScoreAnalyticsLabels);
+}
+
+#pragma mark Playback context
+
 - (BOOL)playbackContextWithPreferredSettings:(SRGPlaybackSettings *)preferredSettings
                                 contextBlock:(NS_NOESCAPE SRGPlaybackContextBlock)contextBlock
 {
     SRGChapter *chapter = self.mainChapter;
-    
-    SRGStreamingMethod streamingMethod = preferredSettings.streamingMethod;
-    if (streamingMethod == SRGStreamingMethodNone) {
-        streamingMethod = chapter.recommendedStreamingMethod;
-    }
-    
-    NSArray<SRGResource *> *resources = [chapter resourcesForStreamingMethod:streamingMethod];
-    if (resources.count == 0) {
-        resources = [chapter resourcesForStreamingMethod:chapter.recommendedStreamingMethod];
-    }
-    
-    NSSortDescriptor *URLSchemeSortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGResource.new, URL) ascending:NO comparator:^NSComparisonResult(NSURL * _Nonnull URL1, NSURL * _Nonnull URL2) {
-        // Only declare ordering for important URL schemes. For other schemes the initial order will be preserved
-        NSArray<NSString *> *orderedURLSchemes = @[@"http", @"https"];
-        
-        NSUInteger index1 = [orderedURLSchemes indexOfObject:URL1.scheme];
-        NSUInteger index2 = [orderedURLSchemes indexOfObject:URL2.scheme];
-        if (index1 == index2) {
-            return NSOrderedSame;
-        }
-        // Unknown scheme < known scheme
-        else if (index1 == NSNotFound) {
-            return NSOrderedAscending;
-        }
-        // Known scheme > unknown scheme
-        else if (index2 == NSNotFound) {
-            return NSOrderedDescending;
-        }
-        else if (index1 < index2) {
-            return NSOrderedAscending;
-        }
-        else {
-            return NSOrderedDescending;
-        }
-    }];
-    
-    // Determine the stream type order to use (start with a default setup, overridden if a preferred value has been set).
-    NSArray<NSNumber *> *orderedStreamTypes = @[@(SRGStreamTypeOnDemand), @(SRGStreamTypeLive), @(SRGStreamTypeDVR)];
-    SRGStreamType streamType = preferredSettings.streamType;
-    if (streamType != SRGStreamTypeNone) {
-        orderedStreamTypes = [[orderedStreamTypes mtl_arrayByRemovingObject:@(streamType)] arrayByAddingObject:@(streamType)];
-    }
-    
-    NSSortDescriptor *streamTypeSortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGResource.new, streamType) ascending:NO comparator:^(NSNumber * _Nonnull streamType1, NSNumber * _Nonnull streamType2) {
-        // Don't simply compare enum values as integers since their order might change.
-        NSUInteger index1 = [orderedStreamTypes indexOfObject:streamType1];
-        NSUInteger index2 = [orderedStreamTypes indexOfObject:streamType2];
-        if (index1 == index2) {
-            return NSOrderedSame;
-        }
-        else if (index1 < index2) {
-            return NSOrderedAscending;
-        }
-        else {
-            return NSOrderedDescending;
-        }
-    }];
-    
-    // Determine the quality to use (start with a default setup, overridden if a preferred value has been set).
-    NSArray<NSNumber *> *orderedQualities = @[@(SRGQualitySD), @(SRGQualityHD), @(SRGQualityHQ)];
-    SRGQuality quality = preferredSettings.quality;
-    if (quality != SRGQualityNone) {
-        orderedQualities = [[orderedQualities mtl_arrayByRemovingObject:@(quality)] arrayByAddingObject:@(quality)];
-    }
-    
-    NSSortDescriptor *qualitySortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGResource.new, quality) ascending:NO comparator:^(NSNumber * _Nonnull quality1, NSNumber * _Nonnull quality2) {
-        // Don't simply compare enum values as integers since their order might change.
-        NSUInteger index1 = [orderedQualities indexOfObject:quality1];
-        NSUInteger index2 = [orderedQualities indexOfObject:quality2];
-        if (index1 == index2) {
-            return NSOrderedSame;
-        }
-        else if (index1 < index2) {
-            return NSOrderedAscending;
-        }
-        else {
-            return NSOrderedDescending;
-        }
-    }];
-    
-    NSMutableArray<NSSortDescriptor *> *sortDescriptors = [@[URLSchemeSortDescriptor, streamTypeSortDescriptor, qualitySortDescriptor] mutableCopy];
-    
-    // Favor DRM resources if desired, otherwise preserve the original order
-    BOOL DRM = preferredSettings.DRM;
-    if (DRM) {
-        NSSortDescriptor *DRMSortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGResource.new, srg_requiresDRM) ascending:! DRM comparator:^NSComparisonResult(NSNumber * _Nonnull requiresDRM1, NSNumber * _Nonnull requiresDRM2) {
-            if (requiresDRM1.boolValue == requiresDRM2.boolValue) {
-                return NSOrderedSame;
-            }
-            else if (requiresDRM2.boolValue) {
-                return NSOrderedAscending;
-            }
-            else {
-                return NSOrderedDescending;
-            }
-        }];
-        [sortDescriptors addObject:DRMSortDescriptor];
-    }
-    resources = [resources sortedArrayUsingDescriptors:sortDescriptors];
-    
-    SRGResource *resource = resources.firstObject;
+    SRGResource *resource = [chapter srg_preferredResourceWithSettings:preferredSettings];
     if (! resource) {
         return NO;
     }
@@ -14,10 +14,19 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  *  Return the consolidated analytics stream labels associated with the specified resource of the receiver.
  *
- *  @discussion An exception is thrown in debug builds if the resource is not associated with the receiver.
+ *  @discussion An exception is thrown in debug builds if the resource is not associated with the receiver. Labels are
+ *              built once per resource and cached.
  */
 - (SRGAnalyticsStreamLabels *)analyticsLabelsForResource:(SRGResource *)resource sourceUid:(nullable NSString *)sourceUid;
 
+/**
+ *  Return `YES` iff the labels of the specified resource of the receiver are the same as those of a resource of another
+ *  media composition (without building them).
+ */
+- (BOOL)hasSameAnalyticsLabelsForResource:(nullable SRGResource *)resource
+                       asMediaComposition:(SRGMediaComposition *)mediaComposition
+                                 resource:(nullable SRGResource *)otherResource;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -6,17 +6,28 @@
 
 #import "SRGMediaPlayerController+SRGAnalytics_DataProvider.h"
 
+#import "SRGAnalyticsSegmentIndex.h"
 #import "SRGMediaComposition+SRGAnalytics_DataProvider.h"
 #import "SRGMediaComposition+SRGAnalytics_DataProvider_Private.h"
 #import "SRGSegment+SRGAnalytics_DataProvider.h"
 
-#import <libextobjc/libextobjc.h>
 #import <SRGContentProtection/SRGContentProtection.h>
 
 static NSString * const SRGAnalyticsMediaPlayerMediaCompositionKey = @"SRGAnalyticsMediaPlayerMediaComposition";
 static NSString * const SRGAnalyticsMediaPlayerResourceKey = @"SRGAnalyticsMediaPlayerResource";
 static NSString * const SRGAnalyticsMediaPlayerSourceUidKey = @"SRGAnalyticsMediaPlayerSourceUid";
 
+// Return the first resource of the chapter with the same streaming method and quality as the specified one.
+static SRGResource *SRGAnalyticsMatchingResource(SRGChapter *chapter, SRGResource *resource)
+{
+    for (SRGResource *chapterResource in [chapter resourcesForStreamingMethod:resource.streamingMethod]) {
+        if (chapterResource.quality == resource.quality) {
+            return chapterResource;
+        }
+    }
+    return nil;
+}
+
 @implementation SRGMediaPlayerController (SRGAnalytics_DataProvider)
 
 #pragma mark Playback methods
@@ -84,7 +95,7 @@ static NSString * const SRGAnalyticsMediaPlayerSourceUidKey = @"SRGAnalyticsMedi
 - (void)setMediaComposition:(SRGMediaComposition *)mediaComposition
 {
     SRGMediaComposition *currentMediaComposition = self.userInfo[SRGAnalyticsMediaPlayerMediaCompositionKey];
-    if (! currentMediaComposition || ! mediaComposition) {
+    if (! currentMediaComposition || ! mediaComposition || mediaComposition == currentMediaComposition) {
         return;
     }
     
@@ -92,16 +103,29 @@ static NSString * const SRGAnalyticsMediaPlayerSourceUidKey = @"SRGAnalyticsMedi
         return;
     }
     
+    SRGResource *currentResource = self.resource;
+    SRGResource *resource = SRGAnalyticsMatchingResource(mediaComposition.mainChapter, currentResource);
+    
     NSMutableDictionary *userInfo = [self.userInfo mutableCopy];
     userInfo[SRGAnalyticsMediaPlayerMediaCompositionKey] = mediaComposition;
+    if (resource) {
+        userInfo[SRGAnalyticsMediaPlayerResourceKey] = resource;
+    }
     self.userInfo = [userInfo copy];
     
-    // Synchronize analytics labels
-    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGResource.new, quality), @(self.resource.quality)];
-    SRGResource *resource = [[mediaComposition.mainChapter resourcesForStreamingMethod:self.resource.streamingMethod] filteredArrayUsingPredicate:predicate].firstObject;
-    self.analyticsLabels = [mediaComposition analyticsLabelsForResource:resource sourceUid:self.userInfo[SRGAnalyticsMediaPlayerSourceUidKey]];
+    // Media compositions are periodically refreshed (e.g. for livestreams), most of the time without relevant changes.
+    // Only update what has changed
+    if (! resource || ! [currentMediaComposition hasSameAnalyticsLabelsForResource:currentResource asMediaComposition:mediaComposition resource:resource]) {
+        self.analyticsLabels = [mediaComposition analyticsLabelsForResource:resource sourceUid:self.userInfo[SRGAnalyticsMediaPlayerSourceUidKey]];
+    }
     
-    self.segments = mediaComposition.mainChapter.segments;
+    // Segment indexes are cached per segment list, so that live compositions with many segments are compared cheaply. Any
+    // content change (e.g. labels or blocking dates) requires the new segments to be assigned
+    NSArray<SRGSegment *> *segments = mediaComposition.mainChapter.segments;
+    SRGAnalyticsSegmentIndex *currentSegmentIndex = [SRGAnalyticsSegmentIndex indexForSegments:self.segments ?: @[]];
+    if (! [currentSegmentIndex isEquivalentToIndex:[SRGAnalyticsSegmentIndex indexForSegments:segments ?: @[]]]) {
+        self.segments = segments;
+    }
 }
 
 - (SRGMediaComposition *)mediaComposition
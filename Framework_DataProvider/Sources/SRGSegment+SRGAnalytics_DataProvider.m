@@ -6,19 +6,22 @@
 
 #import "SRGSegment+SRGAnalytics_DataProvider.h"
 
+#import "SRGAnalyticsSegmentCache.h"
+
 @implementation SRGSegment (SRGAnalytics_DataProvider)
 
 #pragma mark SRGAnalyticsSegment protocol
 
+// Players query the time range and blocking status of all segments each time the playback position is updated. Values
+// are therefore cached
 - (CMTimeRange)srg_timeRange
 {
-    return CMTimeRangeMake(CMTimeMakeWithSeconds(self.markIn / 1000., NSEC_PER_SEC),
-                           CMTimeMakeWithSeconds(self.duration / 1000., NSEC_PER_SEC));
+    return [SRGAnalyticsSegmentCache cacheForSegment:self].timeRange;
 }
 
 - (BOOL)srg_isBlocked
 {
-    return [self blockingReasonAtDate:NSDate.date] != SRGBlockingReasonNone;
+    return [[SRGAnalyticsSegmentCache cacheForSegment:self] isBlockedAtTime:CFAbsoluteTimeGetCurrent()];
 }
 
 - (BOOL)srg_isHidden
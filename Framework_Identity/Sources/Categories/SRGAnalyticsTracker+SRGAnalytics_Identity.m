@@ -55,10 +55,13 @@ static void *s_analyticsIdentityServiceKey = &s_analyticsIdentityServiceKey;
 
 - (void)updateWithAccount:(SRGAccount *)account
 {
-    NSMutableDictionary<NSString *, NSString *> *globalLabels = [self.globalLabels mutableCopy] ?: [NSMutableDictionary dictionary];
-    globalLabels[@"user_id"] = account.uid;
-    globalLabels[@"user_is_logged"] = account.uid ? @"true" : @"false";
-    self.globalLabels = [globalLabels copy];
+    NSString *uid = account.uid;
+    [self updateGlobalLabelsWithBlock:^NSDictionary<NSString *,NSString *> * _Nullable(NSDictionary<NSString *,NSString *> * _Nonnull globalLabels) {
+        NSMutableDictionary<NSString *, NSString *> *updatedGlobalLabels = [globalLabels mutableCopy];
+        updatedGlobalLabels[@"user_id"] = uid;
+        updatedGlobalLabels[@"user_is_logged"] = uid ? @"true" : @"false";
+        return [updatedGlobalLabels copy];
+    }];
 }
 
 #pragma mark Notifications
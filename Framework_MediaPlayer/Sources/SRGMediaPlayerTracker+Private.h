@@ -0,0 +1,27 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsHeartbeatScheduler.h"
+#import "SRGMediaPlayerTracker.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SRGMediaPlayerTracker (Private)
+
+/**
+ *  The scheduler with which heartbeats are sent by trackers created afterwards. If `nil`, the shared heartbeat scheduler
+ *  is used. Must be accessed from the main thread.
+ */
+@property (class, nonatomic, nullable) SRGAnalyticsHeartbeatScheduler *heartbeatScheduler;
+
+/**
+ *  The number of media player controllers currently tracked. Can be read from any thread.
+ */
+@property (class, nonatomic, readonly) NSUInteger trackedMediaPlayerControllerCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
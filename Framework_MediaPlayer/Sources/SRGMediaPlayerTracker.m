@@ -6,9 +6,12 @@
 
 #import "SRGMediaPlayerTracker.h"
 
-#import "NSMutableDictionary+SRGAnalytics.h"
 #import "SRGAnalyticsLogger.h"
 #import "SRGAnalyticsSegment.h"
+#import "SRGAnalyticsStreamTracker+Private.h"
+#import "SRGMediaPlayerTracker+Private.h"
+#import "SRGMediaPlayerTrackerContext.h"
+#import "SRGMediaPlayerTrackerRegistry.h"
 #import "SRGMediaPlayerController+SRGAnalytics_MediaPlayer.h"
 
 #import <ComScore/ComScore.h>
@@ -26,19 +29,25 @@ static long SRGAnalyticsCMTimeToMilliseconds(CMTime time)
 
 static SRGAnalyticsStreamState SRGAnalyticsStreamStateForPlaybackState(SRGMediaPlayerPlaybackState playbackState)
 {
-    static dispatch_once_t s_onceToken;
-    static NSDictionary<NSNumber *, NSNumber *> *s_playerStates;
-    dispatch_once(&s_onceToken, ^{
-        s_playerStates = @{ @(SRGMediaPlayerPlaybackStateIdle) : @(SRGAnalyticsStreamStateStopped),
-                            @(SRGMediaPlayerPlaybackStatePlaying) : @(SRGAnalyticsStreamStatePlaying),
-                            @(SRGMediaPlayerPlaybackStateSeeking) : @(SRGAnalyticsStreamStateSeeking),
-                            @(SRGMediaPlayerPlaybackStatePaused) : @(SRGAnalyticsStreamStatePaused),
-                            @(SRGMediaPlayerPlaybackStateEnded) : @(SRGAnalyticsStreamStateEnded) };
-    });
-    return s_playerStates[@(playbackState)].integerValue;
+    switch (playbackState) {
+        case SRGMediaPlayerPlaybackStateIdle:
+            return SRGAnalyticsStreamStateStopped;
+        case SRGMediaPlayerPlaybackStatePlaying:
+            return SRGAnalyticsStreamStatePlaying;
+        case SRGMediaPlayerPlaybackStateSeeking:
+            return SRGAnalyticsStreamStateSeeking;
+        case SRGMediaPlayerPlaybackStatePaused:
+            return SRGAnalyticsStreamStatePaused;
+        case SRGMediaPlayerPlaybackStateEnded:
+            return SRGAnalyticsStreamStateEnded;
+        default:
+            // Other states are not tracked, and ignored by stream trackers
+            return 0;
+    }
 }
 
-static NSMutableDictionary *s_trackers = nil;
+static SRGMediaPlayerTrackerRegistry<SRGMediaPlayerTracker *> *s_registry = nil;
+static SRGAnalyticsHeartbeatScheduler *s_heartbeatScheduler = nil;
 
 @interface SRGMediaPlayerTracker () {
 @private
@@ -46,6 +55,7 @@ static NSMutableDictionary *s_trackers = nil;
 }
 
 @property (nonatomic) SRGAnalyticsStreamTracker *streamTracker;
+@property (nonatomic) SRGMediaPlayerTrackerContext *context;
 
 // We must not retain the controller, so that its deallocation is not prevented (deallocation will ensure the idle state
 // is always reached before the player gets destroyed, and our tracker is removed when this state is reached). Since
@@ -57,12 +67,30 @@ static NSMutableDictionary *s_trackers = nil;
 
 @implementation SRGMediaPlayerTracker
 
+#pragma mark Class methods
+
++ (SRGAnalyticsHeartbeatScheduler *)heartbeatScheduler
+{
+    return s_heartbeatScheduler;
+}
+
++ (void)setHeartbeatScheduler:(SRGAnalyticsHeartbeatScheduler *)heartbeatScheduler
+{
+    s_heartbeatScheduler = heartbeatScheduler;
+}
+
++ (NSUInteger)trackedMediaPlayerControllerCount
+{
+    return s_registry.count;
+}
+
 #pragma mark Object lifecycle
 
 - (id)initWithMediaPlayerController:(SRGMediaPlayerController *)mediaPlayerController
 {
     if (self = [super init]) {
         self.mediaPlayerController = mediaPlayerController;
+        self.context = [[SRGMediaPlayerTrackerContext alloc] initWithMediaPlayerController:mediaPlayerController];
     }
     return self;
 }
@@ -82,6 +110,8 @@ static NSMutableDictionary *s_trackers = nil;
 
 - (void)start
 {
+    [self.context start];
+    
     [NSNotificationCenter.defaultCenter addObserver:self
                                            selector:@selector(playbackStateDidChange:)
                                                name:SRGMediaPlayerPlaybackStateDidChangeNotification
@@ -120,6 +150,8 @@ static NSMutableDictionary *s_trackers = nil;
                                                 object:self.mediaPlayerController];
     
     [self.mediaPlayerController removeObserver:self keyPath:@keypath(SRGMediaPlayerController.new, tracked)];
+    
+    [self.context stop];
 }
 
 - (void)updateWithState:(SRGAnalyticsStreamState)state position:(NSTimeInterval)position segment:(id<SRGSegment>)segment userInfo:(NSDictionary *)userInfo
@@ -127,12 +159,7 @@ static NSMutableDictionary *s_trackers = nil;
     SRGAnalyticsStreamLabels *fullLabels = [self labelsWithSegment:segment userInfo:userInfo];
     
     if (self.mediaPlayerController.tracked && state != SRGAnalyticsStreamStateStopped) {
-        if (! self.streamTracker) {
-            BOOL isLivestream = (self.mediaPlayerController.streamType == SRGMediaPlayerStreamTypeLive || self.mediaPlayerController.streamType == SRGMediaPlayerStreamTypeDVR);
-            self.streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:isLivestream];
-            self.streamTracker.delegate = self;
-        }
-        
+        [self prepareStreamTracker];
         [self.streamTracker updateWithStreamState:state position:position labels:fullLabels];
     }
     else {
@@ -141,16 +168,61 @@ static NSMutableDictionary *s_trackers = nil;
     }
 }
 
+// Same rules as for `-updateWithState:position:segment:userInfo:` apply to each update. Consecutive updates are sent to
+// the stream tracker at once, except that a stopped state still closes the stream tracker session.
+- (void)updateWithStreamUpdates:(NSArray<SRGAnalyticsStreamUpdate *> *)updates
+{
+    if (! self.mediaPlayerController.tracked) {
+        SRGAnalyticsStreamUpdate *update = updates.firstObject;
+        [self.streamTracker updateWithStreamState:SRGAnalyticsStreamStateStopped position:update.position labels:update.labels];
+        self.streamTracker = nil;
+        return;
+    }
+    
+    NSMutableArray<SRGAnalyticsStreamUpdate *> *pendingUpdates = [NSMutableArray arrayWithCapacity:updates.count];
+    for (SRGAnalyticsStreamUpdate *update in updates) {
+        if (update.state != SRGAnalyticsStreamStateStopped) {
+            [self prepareStreamTracker];
+            [pendingUpdates addObject:update];
+        }
+        else {
+            [pendingUpdates addObject:update];
+            [self.streamTracker updateWithStreamUpdates:pendingUpdates];
+            [pendingUpdates removeAllObjects];
+            self.streamTracker = nil;
+        }
+    }
+    
+    if (pendingUpdates.count != 0) {
+        [self.streamTracker updateWithStreamUpdates:pendingUpdates];
+    }
+}
+
+- (void)prepareStreamTracker
+{
+    if (self.streamTracker) {
+        return;
+    }
+    
+    BOOL isLivestream = (self.mediaPlayerController.streamType == SRGMediaPlayerStreamTypeLive || self.mediaPlayerController.streamType == SRGMediaPlayerStreamTypeDVR);
+    SRGAnalyticsHeartbeatScheduler *heartbeatScheduler = SRGMediaPlayerTracker.heartbeatScheduler ?: SRGAnalyticsHeartbeatScheduler.sharedScheduler;
+    self.streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:isLivestream heartbeatScheduler:heartbeatScheduler];
+    self.streamTracker.delegate = self;
+}
+
 - (SRGAnalyticsStreamLabels *)labelsWithSegment:(id<SRGSegment>)segment userInfo:(NSDictionary *)userInfo
+{
+    SRGAnalyticsStreamLabels *playerLabels = [self playerLabelsWithUserInfo:userInfo];
+    return [self labelsWithPlayerLabels:playerLabels segment:segment userInfo:userInfo];
+}
+
+// Labels describing the current player context, which can be shared by several updates made at the same time
+- (SRGAnalyticsStreamLabels *)playerLabelsWithUserInfo:(NSDictionary *)userInfo
 {
     SRGAnalyticsStreamLabels *playerLabels = [[SRGAnalyticsStreamLabels alloc] init];
     playerLabels.playerName = self.mediaPlayerController.analyticsPlayerName;
     playerLabels.playerVersion = self.mediaPlayerController.analyticsPlayerVersion;
-    
-    AVPlayerItem *playerItem = self.mediaPlayerController.player.currentItem;
-    AVMediaSelectionGroup *legibleGroup = [playerItem.asset mediaSelectionGroupForMediaCharacteristic:AVMediaCharacteristicLegible];
-    AVMediaSelectionOption *currentLegibleOption = [playerItem selectedMediaOptionInMediaSelectionGroup:legibleGroup];
-    playerLabels.subtitlesEnabled = @(currentLegibleOption != nil);
+    playerLabels.subtitlesEnabled = self.context.subtitlesEnabled;
     
     if (userInfo) {
         playerLabels.timeshiftInMilliseconds = [self timeshiftInMillisecondsForStreamType:[userInfo[SRGMediaPlayerPreviousStreamTypeKey] integerValue]
@@ -160,22 +232,18 @@ static NSMutableDictionary *s_trackers = nil;
     else {
         playerLabels.timeshiftInMilliseconds = [self timeshiftInMilliseconds];
     }
-    playerLabels.bandwidthInBitsPerSecond = [self bandwidthInBitsPerSecond];
-    playerLabels.playerVolumeInPercent = [self playerVolumeInPercent];
-    
-    // comScore-only labels
-    NSMutableDictionary<NSString *, NSString *> *comScoreCustomInfo = [NSMutableDictionary dictionary];
-    [comScoreCustomInfo srg_safelySetString:[self windowState] forKey:@"ns_st_ws"];
-    [comScoreCustomInfo srg_safelySetString:[self scalingMode] forKey:@"ns_st_sg"];
-    [comScoreCustomInfo srg_safelySetString:[self orientation] forKey:@"ns_ap_ot"];
-    playerLabels.comScoreCustomInfo = [comScoreCustomInfo copy];
+    playerLabels.bandwidthInBitsPerSecond = self.context.bandwidthInBitsPerSecond;
+    playerLabels.playerVolumeInPercent = self.context.playerVolumeInPercent;
     
-    // comScore-only clip labels
-    NSMutableDictionary<NSString *, NSString *> *comScoreCustomSegmentInfo = [NSMutableDictionary dictionary];
-    [comScoreCustomSegmentInfo srg_safelySetString:[self dimensions] forKey:@"ns_st_cs"];
-    [comScoreCustomSegmentInfo srg_safelySetString:[self screenType] forKey:@"srg_screen_type"];
-    playerLabels.comScoreCustomSegmentInfo = [comScoreCustomSegmentInfo copy];
+    // comScore-only labels, reused as long as they do not change
+    playerLabels.comScoreCustomInfo = self.context.comScoreCustomInfo;
+    playerLabels.comScoreCustomSegmentInfo = self.context.comScoreCustomSegmentInfo;
     
+    return playerLabels;
+}
+
+- (SRGAnalyticsStreamLabels *)labelsWithPlayerLabels:(SRGAnalyticsStreamLabels *)playerLabels segment:(id<SRGSegment>)segment userInfo:(NSDictionary *)userInfo
+{
     SRGAnalyticsStreamLabels *originalLabels = nil;
     if (userInfo) {
         NSDictionary *previousUserInfo = userInfo[SRGMediaPlayerPreviousUserInfoKey];
@@ -197,78 +265,6 @@ static NSMutableDictionary *s_trackers = nil;
 
 #pragma mark Playback information
 
-- (NSNumber *)bandwidthInBitsPerSecond
-{
-    AVPlayerItem *currentItem = self.mediaPlayerController.player.currentItem;
-    if (! currentItem) {
-        return nil;
-    }
-    
-    NSArray<AVPlayerItemAccessLogEvent *> *events = currentItem.accessLog.events;
-    if (! events.lastObject) {
-        return nil;
-    }
-    
-    double observedBitrate = events.lastObject.observedBitrate;
-    return @(observedBitrate);
-}
-
-- (NSString *)windowState
-{
-    CGSize size = self.mediaPlayerController.playerLayer.videoRect.size;
-    CGRect screenRect = UIScreen.mainScreen.bounds;
-    return roundf(size.width) == roundf(screenRect.size.width) && roundf(size.height) == roundf(screenRect.size.height) ? @"full" : @"norm";
-}
-
-- (NSNumber *)playerVolumeInPercent
-{
-    // AVPlayer has a volume property, but its purpose is NOT end-user volume control (see documentation). This volume is
-    // therefore not relevant for our calculations.
-    AVPlayer *player = self.mediaPlayerController.player;
-    if (! player || player.muted) {
-        return nil;
-    }
-    // When we have a non-muted player, its volume is simply the system volume (note that this volume does not take
-    // into account the ringer status).
-    else {
-        NSInteger volume = [AVAudioSession sharedInstance].outputVolume * 100;
-        return @(volume);
-    }
-}
-
-- (NSString *)scalingMode
-{
-    static NSDictionary<NSString *, NSString *> *s_gravities;
-    static dispatch_once_t s_onceToken;
-    dispatch_once(&s_onceToken, ^{
-        s_gravities = @{ AVLayerVideoGravityResize: @"fill",
-                         AVLayerVideoGravityResizeAspect : @"fit-a",
-                         AVLayerVideoGravityResizeAspectFill : @"fill-a" };
-    });
-    return s_gravities[self.mediaPlayerController.playerLayer.videoGravity] ?: @"no";
-}
-
-- (NSString *)orientation
-{
-    static NSDictionary<NSNumber *, NSString *> *s_orientations;
-    static dispatch_once_t s_onceToken;
-    dispatch_once(&s_onceToken, ^{
-        s_orientations = @{ @(UIDeviceOrientationFaceDown) : @"facedown",
-                            @(UIDeviceOrientationFaceUp) : @"faceup",
-                            @(UIDeviceOrientationPortrait) : @"pt",
-                            @(UIDeviceOrientationPortraitUpsideDown) : @"updown",
-                            @(UIDeviceOrientationLandscapeLeft) : @"left",
-                            @(UIDeviceOrientationLandscapeRight) : @"right" };
-    });
-    return s_orientations[@(UIDevice.currentDevice.orientation)];
-}
-
-- (NSString *)dimensions
-{
-    CGSize size = self.mediaPlayerController.playerLayer.videoRect.size;
-    return [NSString stringWithFormat:@"%0.fx%0.f", size.width, size.height];
-}
-
 - (NSNumber *)timeshiftInMilliseconds
 {
     return [self timeshiftInMillisecondsForStreamType:self.mediaPlayerController.streamType
@@ -304,19 +300,6 @@ static NSMutableDictionary *s_trackers = nil;
     return self.mediaPlayerController.player.isExternalPlaybackActive ? @"1" : @"0";
 }
 
-- (NSString *)screenType
-{
-    if (self.mediaPlayerController.pictureInPictureController.pictureInPictureActive) {
-        return @"pip";
-    }
-    else if (self.mediaPlayerController.player.isExternalPlaybackActive) {
-        return @"airplay";
-    }
-    else {
-        return @"default";
-    }
-}
-
 - (long)currentPositionInMilliseconds
 {
     CMTime currentTime = [self.mediaPlayerController.player.currentItem currentTime];
@@ -355,35 +338,26 @@ static NSMutableDictionary *s_trackers = nil;
     
     SRGMediaPlayerController *mediaPlayerController = notification.object;
     
-    NSValue *key = [NSValue valueWithNonretainedObject:mediaPlayerController];
     if (mediaPlayerController.playbackState == SRGMediaPlayerPlaybackStatePreparing) {
         SRGMediaPlayerTracker *tracker = [[SRGMediaPlayerTracker alloc] initWithMediaPlayerController:mediaPlayerController];
-        
-        s_trackers[key] = tracker;
-        if (s_trackers.count == 1) {
-            [CSComScore onUxActive];
+        BOOL registered = [s_registry registerTracker:tracker forObject:mediaPlayerController withBlock:^(SRGMediaPlayerTracker *tracker) {
+            [tracker start];
+        }];
+        if (registered) {
+            SRGAnalyticsLogInfo(@"PlayerTracker", @"Started tracking for %p", mediaPlayerController);
         }
-        
-        [tracker start];
-        
-        SRGAnalyticsLogInfo(@"PlayerTracker", @"Started tracking for %@", key);
     }
     else if (mediaPlayerController.playbackState == SRGMediaPlayerPlaybackStateIdle) {
-        SRGMediaPlayerTracker *tracker = s_trackers[key];
-        if (tracker) {
+        SRGMediaPlayerTracker *tracker = [s_registry unregisterTrackerForObject:mediaPlayerController withBlock:^(SRGMediaPlayerTracker *tracker) {
             NSTimeInterval lastPosition = SRGAnalyticsCMTimeToMilliseconds([notification.userInfo[SRGMediaPlayerLastPlaybackTimeKey] CMTimeValue]);
             [tracker updateWithState:SRGAnalyticsStreamStateStopped
                             position:lastPosition
                              segment:mediaPlayerController.selectedSegment
                             userInfo:notification.userInfo];
             [tracker stop];
-            
-            [s_trackers removeObjectForKey:key];
-            if (s_trackers.count == 0) {
-                [CSComScore onUxInactive];
-            }
-            
-            SRGAnalyticsLogInfo(@"PlayerTracker", @"Stopped tracking for %@", key);
+        }];
+        if (tracker) {
+            SRGAnalyticsLogInfo(@"PlayerTracker", @"Stopped tracking for %p", mediaPlayerController);
         }
     }
 }
@@ -415,16 +389,22 @@ static NSMutableDictionary *s_trackers = nil;
         id<SRGSegment> previousSegment = notification.userInfo[SRGMediaPlayerPreviousSegmentKey];
         if (! previousSegment && self.mediaPlayerController.playbackState != SRGMediaPlayerPlaybackStatePreparing) {
             NSTimeInterval lastPosition = SRGAnalyticsCMTimeToMilliseconds([notification.userInfo[SRGMediaPlayerLastPlaybackTimeKey] CMTimeValue]);
-            [self updateWithState:SRGAnalyticsStreamStateStopped
-                         position:lastPosition
-                          segment:nil
+            
+            // Both updates share the same player context
+            SRGAnalyticsStreamLabels *playerLabels = [self playerLabelsWithUserInfo:nil];
+            [self updateWithStreamUpdates:@[ [SRGAnalyticsStreamUpdate updateWithStreamState:SRGAnalyticsStreamStateStopped
+                                                                                    position:lastPosition
+                                                                                      labels:[self labelsWithPlayerLabels:playerLabels segment:nil userInfo:nil]],
+                                             [SRGAnalyticsStreamUpdate updateWithStreamState:SRGAnalyticsStreamStatePlaying
+                                                                                    position:[self currentPositionInMilliseconds]
+                                                                                      labels:[self labelsWithPlayerLabels:playerLabels segment:segment userInfo:nil]] ]];
+        }
+        else {
+            [self updateWithState:SRGAnalyticsStreamStatePlaying
+                         position:[self currentPositionInMilliseconds]
+                          segment:segment
                          userInfo:nil];
         }
-        
-        [self updateWithState:SRGAnalyticsStreamStatePlaying
-                     position:[self currentPositionInMilliseconds]
-                      segment:segment
-                     userInfo:nil];
     }
 }
 
@@ -439,16 +419,17 @@ static NSMutableDictionary *s_trackers = nil;
         // Notify full-length start if the transition was not due to another segment being selected
         if (! [notification.userInfo[SRGMediaPlayerSelectionKey] boolValue] && self.mediaPlayerController.playbackState != SRGMediaPlayerPlaybackStateEnded) {
             SRGAnalyticsStreamState endState = [notification.userInfo[SRGMediaPlayerInterruptionKey] boolValue] ? SRGAnalyticsStreamStateStopped : SRGAnalyticsStreamStateEnded;
-            NSTimeInterval endPosition = (endState == SRGAnalyticsStreamStateStopped) ? lastPositionInMilliseconds : [self currentPositionInMilliseconds];
+            NSTimeInterval currentPosition = [self currentPositionInMilliseconds];
+            NSTimeInterval endPosition = (endState == SRGAnalyticsStreamStateStopped) ? lastPositionInMilliseconds : currentPosition;
             
-            [self updateWithState:endState
-                         position:endPosition
-                          segment:segment
-                         userInfo:nil];
-            [self updateWithState:SRGAnalyticsStreamStatePlaying
-                         position:[self currentPositionInMilliseconds]
-                          segment:nil
-                         userInfo:nil];
+            // Both updates share the same player context
+            SRGAnalyticsStreamLabels *playerLabels = [self playerLabelsWithUserInfo:nil];
+            [self updateWithStreamUpdates:@[ [SRGAnalyticsStreamUpdate updateWithStreamState:endState
+                                                                                    position:endPosition
+                                                                                      labels:[self labelsWithPlayerLabels:playerLabels segment:segment userInfo:nil]],
+                                             [SRGAnalyticsStreamUpdate updateWithStreamState:SRGAnalyticsStreamStatePlaying
+                                                                                    position:currentPosition
+                                                                                      labels:[self labelsWithPlayerLabels:playerLabels segment:nil userInfo:nil]] ]];
         }
         else {
             [self updateWithState:SRGAnalyticsStreamStateStopped
@@ -471,5 +452,12 @@ __attribute__((constructor)) static void SRGMediaPlayerTrackerInit(void)
                                                name:SRGMediaPlayerPlaybackStateDidChangeNotification
                                              object:nil];
     
-    s_trackers = [NSMutableDictionary dictionary];
+    s_registry = [[SRGMediaPlayerTrackerRegistry alloc] initWithActivityBlock:^(BOOL active) {
+        if (active) {
+            [CSComScore onUxActive];
+        }
+        else {
+            [CSComScore onUxInactive];
+        }
+    }];
 }
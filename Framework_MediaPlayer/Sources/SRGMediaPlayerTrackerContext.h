@@ -0,0 +1,54 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <SRGMediaPlayer/SRGMediaPlayer.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Snapshot of the player context information sent with media player events (volume, subtitles, bandwidth, layer
+ *  geometry, orientation, screen type).
+ *
+ *  Each piece of information is computed lazily, then kept until one of the observed changes it depends on occurs
+ *  (KVO or notification). Events sent while nothing changed (e.g. heartbeats) therefore reuse the previous values.
+ *  Information whose changes cannot be observed (observed bitrate, selected subtitles, screen type) is read again
+ *  each time, reusing cached intermediate results where possible.
+ *
+ *  Observations are made while the context is started. Information must be read from the main thread, but can be
+ *  invalidated from any thread.
+ */
+@interface SRGMediaPlayerTrackerContext : NSObject
+
+/**
+ *  Create a context for the specified controller, which is not retained.
+ */
+- (instancetype)initWithMediaPlayerController:(SRGMediaPlayerController *)mediaPlayerController;
+
+/**
+ *  Start or stop observing changes. All information is invalidated when starting.
+ */
+- (void)start;
+- (void)stop;
+
+@property (nonatomic, readonly, nullable) NSNumber *subtitlesEnabled;
+@property (nonatomic, readonly, nullable) NSNumber *bandwidthInBitsPerSecond;
+@property (nonatomic, readonly, nullable) NSNumber *playerVolumeInPercent;
+
+/**
+ *  comScore-only stream and clip labels.
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *comScoreCustomInfo;
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *comScoreCustomSegmentInfo;
+
+@end
+
+@interface SRGMediaPlayerTrackerContext (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
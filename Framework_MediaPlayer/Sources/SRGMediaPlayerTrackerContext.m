@@ -0,0 +1,261 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGMediaPlayerTrackerContext.h"
+
+#import "NSMutableDictionary+SRGAnalytics.h"
+
+#import <libextobjc/libextobjc.h>
+#import <MAKVONotificationCenter/MAKVONotificationCenter.h>
+#import <stdatomic.h>
+
+typedef NS_OPTIONS(NSUInteger, SRGMediaPlayerTrackerContextComponents) {
+    SRGMediaPlayerTrackerContextComponentLegibleGroup = 1 << 0,
+    SRGMediaPlayerTrackerContextComponentVolume = 1 << 1,
+    SRGMediaPlayerTrackerContextComponentComScoreCustomInfo = 1 << 2,
+    SRGMediaPlayerTrackerContextComponentDimensions = 1 << 3,
+    SRGMediaPlayerTrackerContextComponentAll = NSUIntegerMax
+};
+
+@interface SRGMediaPlayerTrackerContext () {
+@private
+    atomic_uint _invalidComponents;
+}
+
+// See `SRGMediaPlayerTracker` for why the controller is not weakly referenced
+@property (nonatomic, unsafe_unretained) SRGMediaPlayerController *mediaPlayerController;
+
+@property (nonatomic) AVMediaSelectionGroup *legibleGroup;
+
+@property (nonatomic, copy) NSString *dimensions;
+@property (nonatomic, copy) NSString *screenType;
+
+@end
+
+@implementation SRGMediaPlayerTrackerContext
+
+@synthesize playerVolumeInPercent = _playerVolumeInPercent;
+@synthesize comScoreCustomInfo = _comScoreCustomInfo;
+@synthesize comScoreCustomSegmentInfo = _comScoreCustomSegmentInfo;
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithMediaPlayerController:(SRGMediaPlayerController *)mediaPlayerController
+{
+    if (self = [super init]) {
+        self.mediaPlayerController = mediaPlayerController;
+        atomic_init(&_invalidComponents, (unsigned int)SRGMediaPlayerTrackerContextComponentAll);
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithMediaPlayerController:nil];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Observation
+
+- (void)start
+{
+    [self invalidateComponents:SRGMediaPlayerTrackerContextComponentAll];
+    
+    [NSNotificationCenter.defaultCenter addObserver:self
+                                           selector:@selector(deviceOrientationDidChange:)
+                                               name:UIDeviceOrientationDidChangeNotification
+                                             object:nil];
+    
+    [self observeKeyPath:@keypath(SRGMediaPlayerController.new, player) invalidatingComponents:SRGMediaPlayerTrackerContextComponentAll];
+    [self observeKeyPath:@keypath(SRGMediaPlayerController.new, player.currentItem) invalidatingComponents:SRGMediaPlayerTrackerContextComponentLegibleGroup];
+    [self observeKeyPath:@keypath(SRGMediaPlayerController.new, player.muted) invalidatingComponents:SRGMediaPlayerTrackerContextComponentVolume];
+    [self observeKeyPath:@keypath(SRGMediaPlayerController.new, playerLayer.videoRect) invalidatingComponents:SRGMediaPlayerTrackerContextComponentComScoreCustomInfo | SRGMediaPlayerTrackerContextComponentDimensions];
+    [self observeKeyPath:@keypath(SRGMediaPlayerController.new, playerLayer.videoGravity) invalidatingComponents:SRGMediaPlayerTrackerContextComponentComScoreCustomInfo];
+    
+    @weakify(self)
+    [AVAudioSession.sharedInstance addObserver:self keyPath:@keypath(AVAudioSession.new, outputVolume) options:0 block:^(MAKVONotification *notification) {
+        @strongify(self)
+        [self invalidateComponents:SRGMediaPlayerTrackerContextComponentVolume];
+    }];
+}
+
+- (void)stop
+{
+    [NSNotificationCenter.defaultCenter removeObserver:self name:UIDeviceOrientationDidChangeNotification object:nil];
+    
+    [self.mediaPlayerController removeObserver:self keyPath:@keypath(SRGMediaPlayerController.new, player)];
+    [self.mediaPlayerController removeObserver:self keyPath:@keypath(SRGMediaPlayerController.new, player.currentItem)];
+    [self.mediaPlayerController removeObserver:self keyPath:@keypath(SRGMediaPlayerController.new, player.muted)];
+    [self.mediaPlayerController removeObserver:self keyPath:@keypath(SRGMediaPlayerController.new, playerLayer.videoRect)];
+    [self.mediaPlayerController removeObserver:self keyPath:@keypath(SRGMediaPlayerController.new, playerLayer.videoGravity)];
+    
+    [AVAudioSession.sharedInstance removeObserver:self keyPath:@keypath(AVAudioSession.new, outputVolume)];
+}
+
+- (void)observeKeyPath:(NSString *)keyPath invalidatingComponents:(SRGMediaPlayerTrackerContextComponents)components
+{
+    @weakify(self)
+    [self.mediaPlayerController addObserver:self keyPath:keyPath options:0 block:^(MAKVONotification *notification) {
+        @strongify(self)
+        [self invalidateComponents:components];
+    }];
+}
+
+#pragma mark Invalidation
+
+- (void)invalidateComponents:(SRGMediaPlayerTrackerContextComponents)components
+{
+    atomic_fetch_or(&_invalidComponents, (unsigned int)components);
+}
+
+// Return `YES` iff the specified component must be computed again. The component is considered valid afterwards,
+// except if invalidated again in the meantime
+- (BOOL)refreshComponent:(SRGMediaPlayerTrackerContextComponents)component
+{
+    return (atomic_fetch_and(&_invalidComponents, ~(unsigned int)component) & component) != 0;
+}
+
+#pragma mark Getters
+
+- (NSNumber *)subtitlesEnabled
+{
+    // Selection changes are not observable on iOS 9. Only the legible group lookup, which depends on the asset, is cached
+    // (the group might not be available until the asset has been loaded)
+    AVPlayerItem *playerItem = self.mediaPlayerController.player.currentItem;
+    if ([self refreshComponent:SRGMediaPlayerTrackerContextComponentLegibleGroup] || ! self.legibleGroup) {
+        self.legibleGroup = [playerItem.asset mediaSelectionGroupForMediaCharacteristic:AVMediaCharacteristicLegible];
+    }
+    AVMediaSelectionOption *currentLegibleOption = [playerItem selectedMediaOptionInMediaSelectionGroup:self.legibleGroup];
+    return @(currentLegibleOption != nil);
+}
+
+- (NSNumber *)bandwidthInBitsPerSecond
+{
+    // The observed bitrate of the current access log event is continuously updated, and therefore never cached
+    AVPlayerItemAccessLogEvent *event = self.mediaPlayerController.player.currentItem.accessLog.events.lastObject;
+    return event ? @(event.observedBitrate) : nil;
+}
+
+- (NSNumber *)playerVolumeInPercent
+{
+    if ([self refreshComponent:SRGMediaPlayerTrackerContextComponentVolume]) {
+        // AVPlayer has a volume property, but its purpose is NOT end-user volume control (see documentation). This volume is
+        // therefore not relevant for our calculations.
+        AVPlayer *player = self.mediaPlayerController.player;
+        if (! player || player.muted) {
+            _playerVolumeInPercent = nil;
+        }
+        // When we have a non-muted player, its volume is simply the system volume (note that this volume does not take
+        // into account the ringer status).
+        else {
+            NSInteger volume = [AVAudioSession sharedInstance].outputVolume * 100;
+            _playerVolumeInPercent = @(volume);
+        }
+    }
+    return _playerVolumeInPercent;
+}
+
+- (NSDictionary<NSString *, NSString *> *)comScoreCustomInfo
+{
+    if ([self refreshComponent:SRGMediaPlayerTrackerContextComponentComScoreCustomInfo]) {
+        NSMutableDictionary<NSString *, NSString *> *comScoreCustomInfo = [NSMutableDictionary dictionary];
+        [comScoreCustomInfo srg_safelySetString:[self windowState] forKey:@"ns_st_ws"];
+        [comScoreCustomInfo srg_safelySetString:[self scalingMode] forKey:@"ns_st_sg"];
+        [comScoreCustomInfo srg_safelySetString:[self orientation] forKey:@"ns_ap_ot"];
+        _comScoreCustomInfo = [comScoreCustomInfo copy];
+    }
+    return _comScoreCustomInfo;
+}
+
+- (NSDictionary<NSString *, NSString *> *)comScoreCustomSegmentInfo
+{
+    // The screen type is cheap to read, but its changes are not all observable. Read it each time, and only build the
+    // labels again if it changed
+    NSString *screenType = [self currentScreenType];
+    BOOL dimensionsChanged = [self refreshComponent:SRGMediaPlayerTrackerContextComponentDimensions];
+    if (dimensionsChanged || ! _comScoreCustomSegmentInfo || ! [screenType isEqualToString:self.screenType]) {
+        if (dimensionsChanged || ! self.dimensions) {
+            self.dimensions = [self currentDimensions];
+        }
+        self.screenType = screenType;
+        
+        NSMutableDictionary<NSString *, NSString *> *comScoreCustomSegmentInfo = [NSMutableDictionary dictionary];
+        [comScoreCustomSegmentInfo srg_safelySetString:self.dimensions forKey:@"ns_st_cs"];
+        [comScoreCustomSegmentInfo srg_safelySetString:screenType forKey:@"srg_screen_type"];
+        _comScoreCustomSegmentInfo = [comScoreCustomSegmentInfo copy];
+    }
+    return _comScoreCustomSegmentInfo;
+}
+
+#pragma mark Playback information
+
+- (NSString *)windowState
+{
+    CGSize size = self.mediaPlayerController.playerLayer.videoRect.size;
+    CGRect screenRect = UIScreen.mainScreen.bounds;
+    return roundf(size.width) == roundf(screenRect.size.width) && roundf(size.height) == roundf(screenRect.size.height) ? @"full" : @"norm";
+}
+
+- (NSString *)scalingMode
+{
+    static NSDictionary<NSString *, NSString *> *s_gravities;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_gravities = @{ AVLayerVideoGravityResize: @"fill",
+                         AVLayerVideoGravityResizeAspect : @"fit-a",
+                         AVLayerVideoGravityResizeAspectFill : @"fill-a" };
+    });
+    return s_gravities[self.mediaPlayerController.playerLayer.videoGravity] ?: @"no";
+}
+
+- (NSString *)orientation
+{
+    static NSDictionary<NSNumber *, NSString *> *s_orientations;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_orientations = @{ @(UIDeviceOrientationFaceDown) : @"facedown",
+                            @(UIDeviceOrientationFaceUp) : @"faceup",
+                            @(UIDeviceOrientationPortrait) : @"pt",
+                            @(UIDeviceOrientationPortraitUpsideDown) : @"updown",
+                            @(UIDeviceOrientationLandscapeLeft) : @"left",
+                            @(UIDeviceOrientationLandscapeRight) : @"right" };
+    });
+    return s_orientations[@(UIDevice.currentDevice.orientation)];
+}
+
+- (NSString *)currentDimensions
+{
+    CGSize size = self.mediaPlayerController.playerLayer.videoRect.size;
+    return [NSString stringWithFormat:@"%0.fx%0.f", size.width, size.height];
+}
+
+- (NSString *)currentScreenType
+{
+    if (self.mediaPlayerController.pictureInPictureController.pictureInPictureActive) {
+        return @"pip";
+    }
+    else if (self.mediaPlayerController.player.isExternalPlaybackActive) {
+        return @"airplay";
+    }
+    else {
+        return @"default";
+    }
+}
+
+#pragma mark Notifications
+
+- (void)deviceOrientationDidChange:(NSNotification *)notification
+{
+    // Screen bounds might change as well
+    [self invalidateComponents:SRGMediaPlayerTrackerContextComponentComScoreCustomInfo | SRGMediaPlayerTrackerContextComponentDimensions];
+}
+
+@end
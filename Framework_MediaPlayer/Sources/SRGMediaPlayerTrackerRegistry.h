@@ -0,0 +1,62 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Block called when the registry becomes active (first tracker registered) or inactive (last tracker unregistered).
+ */
+typedef void (^SRGMediaPlayerTrackerRegistryActivityBlock)(BOOL active);
+
+/**
+ *  Registry of the trackers associated with objects (usually media player controllers). Each tracker is stored in a
+ *  slot associated with its object, objects themselves are not retained by the registry. The number of registered
+ *  trackers is maintained so that activity changes can be reported.
+ *
+ *  The registry is thread-safe. Registrations, unregistrations and their associated blocks are performed atomically
+ *  with respect to each other. The activity block is called in order, while registration or unregistration is
+ *  performed.
+ */
+@interface SRGMediaPlayerTrackerRegistry<TrackerType> : NSObject
+
+/**
+ *  Create a registry, calling the specified block when its activity changes.
+ */
+- (instancetype)initWithActivityBlock:(SRGMediaPlayerTrackerRegistryActivityBlock)activityBlock;
+
+/**
+ *  Register a tracker for the specified object, calling the block after it has been registered. Returns `NO` and
+ *  does nothing if a tracker is already registered for the object.
+ */
+- (BOOL)registerTracker:(TrackerType)tracker forObject:(id)object withBlock:(nullable void (NS_NOESCAPE ^)(TrackerType tracker))block;
+
+/**
+ *  Unregister the tracker registered for the specified object, if any, calling the block before it is unregistered.
+ *  Returns the unregistered tracker, if any.
+ */
+- (nullable TrackerType)unregisterTrackerForObject:(id)object withBlock:(nullable void (NS_NOESCAPE ^)(TrackerType tracker))block;
+
+/**
+ *  The tracker registered for the specified object, if any.
+ */
+- (nullable TrackerType)trackerForObject:(id)object;
+
+/**
+ *  The number of registered trackers. Can be read without blocking.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+@end
+
+@interface SRGMediaPlayerTrackerRegistry (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,111 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGMediaPlayerTrackerRegistry.h"
+
+#import <objc/runtime.h>
+#import <stdatomic.h>
+
+@interface SRGMediaPlayerTrackerRegistry () {
+@private
+    _Atomic(NSUInteger) _count;
+}
+
+@property (nonatomic, copy) SRGMediaPlayerTrackerRegistryActivityBlock activityBlock;
+
+@end
+
+@implementation SRGMediaPlayerTrackerRegistry
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithActivityBlock:(SRGMediaPlayerTrackerRegistryActivityBlock)activityBlock
+{
+    if (self = [super init]) {
+        self.activityBlock = activityBlock;
+        atomic_init(&_count, 0);
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    [self doesNotRecognizeSelector:_cmd];
+    return [self initWithActivityBlock:^(BOOL active) {}];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Getters and setters
+
+- (NSUInteger)count
+{
+    return atomic_load_explicit(&_count, memory_order_relaxed);
+}
+
+#pragma mark Registration
+
+// The registry itself is used as association key, so that several registries can coexist
+- (id)trackerForObject:(id)object
+{
+    @synchronized(self) {
+        return objc_getAssociatedObject(object, (__bridge const void *)self);
+    }
+}
+
+- (BOOL)registerTracker:(id)tracker forObject:(id)object withBlock:(void (NS_NOESCAPE ^)(id))block
+{
+    @synchronized(self) {
+        if (objc_getAssociatedObject(object, (__bridge const void *)self)) {
+            return NO;
+        }
+        
+        objc_setAssociatedObject(object, (__bridge const void *)self, tracker, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        if (atomic_fetch_add_explicit(&_count, 1, memory_order_relaxed) == 0) {
+            self.activityBlock(YES);
+        }
+        
+        if (block) {
+            block(tracker);
+        }
+        return YES;
+    }
+}
+
+- (id)unregisterTrackerForObject:(id)object withBlock:(void (NS_NOESCAPE ^)(id))block
+{
+    @synchronized(self) {
+        id tracker = objc_getAssociatedObject(object, (__bridge const void *)self);
+        if (! tracker) {
+            return nil;
+        }
+        
+        if (block) {
+            block(tracker);
+        }
+        
+        objc_setAssociatedObject(object, (__bridge const void *)self, nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        if (atomic_fetch_sub_explicit(&_count, 1, memory_order_relaxed) == 1) {
+            self.activityBlock(NO);
+        }
+        return tracker;
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; count = %@>",
+            self.class,
+            self,
+            @(self.count)];
+}
+
+@end
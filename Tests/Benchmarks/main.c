@@ -0,0 +1,14 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#include "PortableBenchmarks.h"
+
+// Driver for running portable benchmarks off-device (see the `benchmark` Makefile target)
+int main(void)
+{
+    PortableBenchmarksRun(stdout);
+    return 0;
+}
@@ -0,0 +1,15 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#include "PortableTests.h"
+
+#include <stdlib.h>
+
+// Driver for running portable tests off-device (see the `test` Makefile target)
+int main(void)
+{
+    return (PortableTestsRun(stdout) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,217 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+#import "SRGAnalyticsApplicationListMeasurement.h"
+
+static NSURL *TestApplicationListURL(void)
+{
+    return [NSURL URLWithString:@"https://applications.test/list.json"];
+}
+
+static NSData *TestApplicationListData(NSArray<NSString *> *codes)
+{
+    NSMutableArray<NSDictionary *> *applicationDictionaries = [NSMutableArray array];
+    for (NSString *code in codes) {
+        [applicationDictionaries addObject:@{ @"code" : code, @"ios" : code.lowercaseString }];
+    }
+    return [NSJSONSerialization dataWithJSONObject:applicationDictionaries options:0 error:NULL];
+}
+
+// Fetcher replying with fixtures, in order. Replies with an error when no fixture is left.
+@interface TestApplicationListFetcher : NSObject <SRGAnalyticsApplicationListFetcher>
+
+@property (nonatomic, readonly) NSMutableArray<NSURLRequest *> *requests;
+
+- (void)addResponseWithStatusCode:(NSInteger)statusCode headers:(NSDictionary<NSString *, NSString *> *)headers data:(NSData *)data;
+
+@end
+
+@interface TestApplicationListFetcher ()
+
+@property (nonatomic) NSMutableArray<NSURLRequest *> *requests;
+@property (nonatomic) NSMutableArray<NSArray *> *responses;
+
+@end
+
+@implementation TestApplicationListFetcher
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.requests = [NSMutableArray array];
+        self.responses = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)addResponseWithStatusCode:(NSInteger)statusCode headers:(NSDictionary<NSString *,NSString *> *)headers data:(NSData *)data
+{
+    NSHTTPURLResponse *HTTPResponse = [[NSHTTPURLResponse alloc] initWithURL:TestApplicationListURL() statusCode:statusCode HTTPVersion:@"HTTP/1.1" headerFields:headers];
+    [self.responses addObject:@[ HTTPResponse, data ?: [NSData data] ]];
+}
+
+- (void)fetchApplicationListWithRequest:(NSURLRequest *)request completionBlock:(SRGAnalyticsApplicationListFetchCompletionBlock)completionBlock
+{
+    [self.requests addObject:request];
+    
+    NSArray *response = self.responses.firstObject;
+    if (response) {
+        [self.responses removeObjectAtIndex:0];
+    }
+    
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        if (response) {
+            completionBlock(response[1], response[0], nil);
+        }
+        else {
+            completionBlock(nil, nil, [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil]);
+        }
+    });
+}
+
+@end
+
+@interface ApplicationListMeasurementTestCase : AnalyticsTestCase
+
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) TestApplicationListFetcher *fetcher;
+
+@property (nonatomic) NSSet<NSString *> *installedURLSchemes;
+@property (nonatomic) NSUInteger probeCount;
+
+@end
+
+@implementation ApplicationListMeasurementTestCase
+
+#pragma mark Helpers
+
+- (NSArray<NSString *> *)measureWithProbeValidityInterval:(NSTimeInterval)probeValidityInterval
+{
+    SRGAnalyticsApplicationListMeasurement *measurement = [[SRGAnalyticsApplicationListMeasurement alloc] initWithURL:TestApplicationListURL()
+                                                                                                              fetcher:self.fetcher
+                                                                                                              fileURL:self.fileURL
+                                                                                                probeValidityInterval:probeValidityInterval
+                                                                                                           probeBlock:^BOOL(NSString *URLScheme) {
+        XCTAssertTrue(NSThread.isMainThread);
+        self.probeCount += 1;
+        return [self.installedURLSchemes containsObject:URLScheme];
+    }];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Measurement completed"];
+    
+    __block NSArray<NSString *> *installedApplications = nil;
+    [measurement measureWithCompletionBlock:^(NSArray<NSString *> * _Nullable applications) {
+        XCTAssertTrue(NSThread.isMainThread);
+        installedApplications = applications;
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    return installedApplications;
+}
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    NSString *fileName = [NSString stringWithFormat:@"ApplicationList-%@.plist", NSUUID.UUID.UUIDString];
+    self.fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    self.fetcher = [[TestApplicationListFetcher alloc] init];
+    self.installedURLSchemes = [NSSet setWithObjects:@"rts", @"srf", nil];
+    self.probeCount = 0;
+}
+
+- (void)tearDown
+{
+    [NSFileManager.defaultManager removeItemAtURL:self.fileURL error:NULL];
+}
+
+#pragma mark Tests
+
+- (void)testMeasurement
+{
+    [self.fetcher addResponseWithStatusCode:200 headers:@{ @"ETag" : @"\"v1\"", @"Cache-Control" : @"max-age=3600" } data:TestApplicationListData(@[ @"SRF", @"RTS", @"RSI" ])];
+    
+    XCTAssertEqualObjects([self measureWithProbeValidityInterval:3600.], (@[ @"RTS", @"SRF" ]));
+    XCTAssertEqual(self.fetcher.requests.count, 1);
+    XCTAssertNil([self.fetcher.requests.firstObject valueForHTTPHeaderField:@"If-None-Match"]);
+    XCTAssertEqual(self.probeCount, 3);
+}
+
+- (void)testFreshList
+{
+    [self.fetcher addResponseWithStatusCode:200 headers:@{ @"ETag" : @"\"v1\"", @"Cache-Control" : @"public, max-age=3600" } data:TestApplicationListData(@[ @"SRF", @"RTS", @"RSI" ])];
+    [self measureWithProbeValidityInterval:3600.];
+    
+    // Neither requested nor probed again
+    XCTAssertEqualObjects([self measureWithProbeValidityInterval:3600.], (@[ @"RTS", @"SRF" ]));
+    XCTAssertEqual(self.fetcher.requests.count, 1);
+    XCTAssertEqual(self.probeCount, 3);
+}
+
+- (void)testUnchangedList
+{
+    [self.fetcher addResponseWithStatusCode:200 headers:@{ @"ETag" : @"\"v1\"", @"Cache-Control" : @"max-age=0" } data:TestApplicationListData(@[ @"SRF", @"RTS", @"RSI" ])];
+    [self measureWithProbeValidityInterval:3600.];
+    
+    // Revalidated, but not probed again
+    [self.fetcher addResponseWithStatusCode:304 headers:@{ @"ETag" : @"\"v1\"" } data:nil];
+    XCTAssertEqualObjects([self measureWithProbeValidityInterval:3600.], (@[ @"RTS", @"SRF" ]));
+    XCTAssertEqual(self.fetcher.requests.count, 2);
+    XCTAssertEqualObjects([self.fetcher.requests.lastObject valueForHTTPHeaderField:@"If-None-Match"], @"\"v1\"");
+    XCTAssertEqual(self.probeCount, 3);
+}
+
+- (void)testChangedList
+{
+    [self.fetcher addResponseWithStatusCode:200 headers:@{ @"ETag" : @"\"v1\"" } data:TestApplicationListData(@[ @"SRF", @"RTS", @"RSI" ])];
+    [self measureWithProbeValidityInterval:3600.];
+    
+    [self.fetcher addResponseWithStatusCode:200 headers:@{ @"ETag" : @"\"v2\"" } data:TestApplicationListData(@[ @"SRF", @"RTS", @"RSI", @"RTR" ])];
+    self.installedURLSchemes = [NSSet setWithObjects:@"rts", @"rtr", nil];
+    XCTAssertEqualObjects([self measureWithProbeValidityInterval:3600.], (@[ @"RTR", @"RTS" ]));
+    XCTAssertEqual(self.fetcher.requests.count, 2);
+    XCTAssertEqual(self.probeCount, 7);
+}
+
+- (void)testExpiredProbeResults
+{
+    [self.fetcher addResponseWithStatusCode:200 headers:@{ @"ETag" : @"\"v1\"", @"Cache-Control" : @"max-age=3600" } data:TestApplicationListData(@[ @"SRF", @"RTS", @"RSI" ])];
+    [self measureWithProbeValidityInterval:0.];
+    
+    // Probed again with the cached list
+    self.installedURLSchemes = [NSSet setWithObject:@"rsi"];
+    XCTAssertEqualObjects([self measureWithProbeValidityInterval:0.], @[ @"RSI" ]);
+    XCTAssertEqual(self.fetcher.requests.count, 1);
+    XCTAssertEqual(self.probeCount, 6);
+}
+
+- (void)testUnavailableList
+{
+    XCTAssertNil([self measureWithProbeValidityInterval:3600.]);
+    XCTAssertEqual(self.fetcher.requests.count, 1);
+    XCTAssertEqual(self.probeCount, 0);
+}
+
+- (void)testUnavailableListWithStaleCache
+{
+    [self.fetcher addResponseWithStatusCode:200 headers:@{ @"ETag" : @"\"v1\"" } data:TestApplicationListData(@[ @"SRF", @"RTS", @"RSI" ])];
+    [self measureWithProbeValidityInterval:3600.];
+    
+    // The stale list and its probe results are used
+    XCTAssertEqualObjects([self measureWithProbeValidityInterval:3600.], (@[ @"RTS", @"SRF" ]));
+    XCTAssertEqual(self.fetcher.requests.count, 2);
+    XCTAssertEqual(self.probeCount, 3);
+}
+
+- (void)testIncorrectList
+{
+    [self.fetcher addResponseWithStatusCode:200 headers:nil data:[@"{}" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertNil([self measureWithProbeValidityInterval:3600.]);
+}
+
+@end
@@ -0,0 +1,432 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+#import "Benchmark.h"
+#import "NSString+SRGAnalytics.h"
+#import "PortableBenchmarks.h"
+#import "Segment.h"
+#import "SRGAnalyticsEvent+Private.h"
+#import "SRGAnalyticsLabels+Private.h"
+#import "SRGAnalyticsLabelSet.h"
+#import "SRGAnalyticsSegmentCache.h"
+#import "SRGAnalyticsSegmentIndex.h"
+#import "SRGAnalyticsStreamSensePool.h"
+#import "SRGAnalyticsStreamTracker+Private.h"
+#import "SRGAnalyticsTracker+Private.h"
+#import "SRGAnalyticsViewTrackingCapabilities.h"
+#import "SRGChapter+SRGAnalytics_DataProvider.h"
+#import "SRGSegment+SRGAnalytics_DataProvider.h"
+
+#import <libextobjc/libextobjc.h>
+
+// View controller tracked automatically, as most tracked view controllers are.
+@interface BenchmarkViewController : UIViewController <SRGAnalyticsViewTracking>
+
+@end
+
+@implementation BenchmarkViewController
+
+- (NSString *)srg_pageViewTitle
+{
+    return @"Benchmark";
+}
+
+- (NSArray<NSString *> *)srg_pageViewLevels
+{
+    return @[ @"benchmark" ];
+}
+
+@end
+
+static void BlockBenchmark(void *context, size_t iterations)
+{
+    void (^block)(size_t) = (__bridge void (^)(size_t))context;
+    block(iterations);
+}
+
+// Benchmarks for the tracking pipeline. Results are printed to the standard output as JSON lines (see `BenchmarkResultPrint()`),
+// and can be extracted from test logs with `grep '^{"name"'`. Portable benchmarks can also be run off-device with
+// `make benchmark`.
+@interface BenchmarkTestCase : AnalyticsTestCase <SRGAnalyticsStreamTrackerDelegate>
+
+@property (nonatomic) SRGAnalyticsStreamLabels *streamLabels;
+
+@end
+
+@implementation BenchmarkTestCase
+
+#pragma mark Helpers
+
+- (void)runBenchmarkWithName:(NSString *)name block:(void (^)(void))block
+{
+    void (^benchmarkBlock)(size_t) = ^(size_t iterations) {
+        for (size_t i = 0; i < iterations; ++i) {
+            @autoreleasepool {
+                block();
+            }
+        }
+    };
+    BenchmarkResult result = BenchmarkRun(name.UTF8String, BlockBenchmark, (__bridge void *)benchmarkBlock);
+    BenchmarkResultPrint(&result, stdout);
+    XCTAssertGreaterThan(result.iterations, 0);
+}
+
+- (SRGAnalyticsStreamLabels *)streamLabelsWithIndex:(NSInteger)index
+{
+    SRGAnalyticsStreamLabels *labels = [[SRGAnalyticsStreamLabels alloc] init];
+    labels.playerName = @"SRGMediaPlayer";
+    labels.playerVersion = @"2.5.1";
+    labels.playerVolumeInPercent = @80;
+    labels.subtitlesEnabled = @NO;
+    labels.bandwidthInBitsPerSecond = @(1000000 * index);
+    labels.customInfo = @{ @"media_urn" : [NSString stringWithFormat:@"urn:rts:video:%@", @(index)],
+                           @"media_title" : @"19h30" };
+    labels.comScoreCustomInfo = @{ @"ns_st_ep" : @"19h30" };
+    labels.comScoreCustomSegmentInfo = @{ @"ns_st_cs" : @"1920x1080" };
+    return labels;
+}
+
+- (NSArray<SRGResource *> *)resourcesWithCount:(NSInteger)count
+{
+    // Resources for all combinations of scheme, stream type, quality and DRM, repeated if needed
+    NSArray<NSString *> *schemes = @[ @"http", @"https", @"rtmp" ];
+    NSArray<NSNumber *> *streamTypes = @[ @(SRGStreamTypeOnDemand), @(SRGStreamTypeLive), @(SRGStreamTypeDVR) ];
+    NSArray<NSNumber *> *qualities = @[ @(SRGQualitySD), @(SRGQualityHD), @(SRGQualityHQ) ];
+    SRGDRM *DRM = [[SRGDRM alloc] initWithDictionary:@{ @keypath(SRGDRM.new, type) : @(SRGDRMTypeFairPlay) } error:NULL];
+    
+    NSMutableArray<SRGResource *> *resources = [NSMutableArray array];
+    for (NSInteger i = 0; i < count; ++i) {
+        NSString *URLString = [NSString stringWithFormat:@"%@://srgssr.akamaized.net/%@/master.m3u8", schemes[i % schemes.count], @(i)];
+        NSDictionary *dictionary = @{ @keypath(SRGResource.new, URL) : [NSURL URLWithString:URLString],
+                                      @keypath(SRGResource.new, streamingMethod) : @(SRGStreamingMethodHLS),
+                                      @keypath(SRGResource.new, streamType) : streamTypes[(i / 3) % streamTypes.count],
+                                      @keypath(SRGResource.new, quality) : qualities[(i / 9) % qualities.count],
+                                      @keypath(SRGResource.new, DRMs) : (i / 27) % 2 == 0 ? @[] : @[ DRM ] };
+        [resources addObject:[[SRGResource alloc] initWithDictionary:dictionary error:NULL]];
+    }
+    return [resources copy];
+}
+
+#pragma mark Benchmarks
+
+- (void)testPortableBenchmarks
+{
+    PortableBenchmarksRun(stdout);
+}
+
+- (void)testLabelMerging
+{
+    SRGAnalyticsStreamLabels *labels = [self streamLabelsWithIndex:1];
+    SRGAnalyticsStreamLabels *otherLabels = [self streamLabelsWithIndex:2];
+    [self runBenchmarkWithName:@"labels/merge" block:^{
+        SRGAnalyticsStreamLabels *mergedLabels = [labels copy];
+        [mergedLabels mergeWithLabels:otherLabels];
+    }];
+}
+
+- (void)testNameNormalization
+{
+    // Formatted names are cached. Measure both a cached name and names never seen before
+    [self runBenchmarkWithName:@"comscore_format/cached" block:^{
+        __unused NSString *formattedString = @"Le 19h30 - Edition spéciale".srg_comScoreFormattedString;
+    }];
+    
+    __block NSUInteger index = 0;
+    [self runBenchmarkWithName:@"comscore_format/uncached" block:^{
+        NSString *string = [NSString stringWithFormat:@"Le 19h30 - Edition spéciale %@", @(index++)];
+        __unused NSString *formattedString = string.srg_comScoreFormattedString;
+    }];
+}
+
+- (void)testPageViewLabelAssembly
+{
+    SRGAnalyticsTracker *tracker = SRGAnalyticsTracker.sharedTracker;
+    
+    SRGAnalyticsPageViewLabels *labels = [[SRGAnalyticsPageViewLabels alloc] init];
+    labels.customInfo = @{ @"custom_label" : @"custom_value" };
+    
+    NSMutableArray<NSString *> *levels = [NSMutableArray array];
+    for (NSInteger levelCount = 1; levelCount <= 10; ++levelCount) {
+        [levels addObject:[NSString stringWithFormat:@"Level %@", @(levelCount)]];
+        NSArray<NSString *> *pageViewLevels = [levels copy];
+        
+        NSString *name = [NSString stringWithFormat:@"page_view_labels/levels_%@", @(levelCount)];
+        [self runBenchmarkWithName:name block:^{
+            SRGAnalyticsLabelSet *labelSet = [tracker tagCommanderEventLabelSet];
+            [tracker fillTagCommanderPageViewLabelSet:labelSet withTitle:@"Page view" levels:pageViewLevels labels:labels fromPushNotification:NO];
+            __unused NSDictionary<NSString *, NSString *> *tagCommanderLabels = labelSet.dictionary;
+            __unused NSDictionary<NSString *, NSString *> *comScoreLabels = [tracker comScorePageViewLabelSetWithTitle:@"Page view" levels:pageViewLevels labels:labels fromPushNotification:NO].dictionary;
+        }];
+    }
+}
+
+- (void)testHeartbeatPayload
+{
+    self.streamLabels = [self streamLabelsWithIndex:1];
+    
+    SRGAnalyticsManualClock *clock = [[SRGAnalyticsManualClock alloc] init];
+    SRGAnalyticsHeartbeatScheduler *heartbeatScheduler = [[SRGAnalyticsHeartbeatScheduler alloc] initWithClock:clock interval:30. tolerance:3. sendBlock:^(NSArray<SRGAnalyticsLabelSet *> * _Nonnull labelSets) {}];
+    SRGAnalyticsStreamTracker *streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:NO heartbeatScheduler:heartbeatScheduler];
+    streamTracker.delegate = self;
+    [streamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:self.streamLabels];
+    
+    id<SRGAnalyticsHeartbeatSchedulerClient> client = (id<SRGAnalyticsHeartbeatSchedulerClient>)streamTracker;
+    [self runBenchmarkWithName:@"heartbeat_payload" block:^{
+        for (SRGAnalyticsLabelSet *labelSet in [client heartbeatLabelSetsForScheduler:heartbeatScheduler]) {
+            __unused NSDictionary<NSString *, NSString *> *labels = labelSet.dictionary;
+        }
+    }];
+}
+
+- (void)testSegmentTransitions
+{
+    // Segment switches, as for chapter-heavy streams (end of a segment immediately followed by full-length playback)
+    SRGAnalyticsStreamLabels *segmentLabels = [self streamLabelsWithIndex:1];
+    SRGAnalyticsStreamLabels *fullLengthLabels = [self streamLabelsWithIndex:2];
+    
+    SRGAnalyticsManualClock *clock = [[SRGAnalyticsManualClock alloc] init];
+    SRGAnalyticsHeartbeatScheduler *heartbeatScheduler = [[SRGAnalyticsHeartbeatScheduler alloc] initWithClock:clock interval:30. tolerance:3. sendBlock:^(NSArray<SRGAnalyticsLabelSet *> * _Nonnull labelSets) {}];
+    
+    SRGAnalyticsStreamTracker *sequentialStreamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:NO heartbeatScheduler:heartbeatScheduler];
+    [sequentialStreamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:segmentLabels];
+    [self runBenchmarkWithName:@"segment_transition/sequential" block:^{
+        [sequentialStreamTracker updateWithStreamState:SRGAnalyticsStreamStateEnded position:1000. labels:segmentLabels];
+        [sequentialStreamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:1000. labels:fullLengthLabels];
+    }];
+    
+    SRGAnalyticsStreamTracker *batchedStreamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:NO heartbeatScheduler:heartbeatScheduler];
+    [batchedStreamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:segmentLabels];
+    [self runBenchmarkWithName:@"segment_transition/batched" block:^{
+        [batchedStreamTracker updateWithStreamUpdates:@[ [SRGAnalyticsStreamUpdate updateWithStreamState:SRGAnalyticsStreamStateEnded position:1000. labels:segmentLabels],
+                                                         [SRGAnalyticsStreamUpdate updateWithStreamState:SRGAnalyticsStreamStatePlaying position:1000. labels:fullLengthLabels] ]];
+    }];
+}
+
+- (void)testStreamSenseLabelUpdates
+{
+    // Stream labels only differing by their bandwidth, as when seeking or switching between variants
+    NSArray<SRGAnalyticsStreamLabels *> *labelsArray = @[ [self streamLabelsWithIndex:1], [self streamLabelsWithIndex:2] ];
+    
+    __block NSInteger updateCount = 0;
+    NSMutableDictionary<NSString *, NSString *> *resetLabels = [NSMutableDictionary dictionary];
+    [self runBenchmarkWithName:@"streamsense_labels/reset" block:^{
+        SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+        [labelsArray[++updateCount % 2] fillComScoreLabelSet:labelSet];
+        [resetLabels removeAllObjects];
+        [labelSet enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
+            resetLabels[key] = object;
+        }];
+    }];
+    
+    NSMutableDictionary<NSString *, NSString *> *diffedLabels = [NSMutableDictionary dictionary];
+    [self runBenchmarkWithName:@"streamsense_labels/diff" block:^{
+        SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+        [labelsArray[++updateCount % 2] fillComScoreLabelSet:labelSet];
+        [labelSet enumerateChangesFromDictionary:diffedLabels usingBlock:^(NSString * _Nonnull key, NSString * _Nullable object) {
+            diffedLabels[key] = object;
+        }];
+    }];
+}
+
+- (void)testReplay
+{
+    // Replay into a brand new tracker, synchronously. Labels are built again from recorded inputs, and delivered to sinks
+    // only (none here)
+    SRGAnalyticsTracker *tracker = [SRGAnalyticsTracker new];
+    [tracker startWithConfiguration:SRGAnalyticsTracker.sharedTracker.configuration];
+    
+    NSMutableArray<SRGAnalyticsEvent *> *events = [NSMutableArray array];
+    for (NSInteger i = 0; i < 100; ++i) {
+        NSString *name = [NSString stringWithFormat:@"Event %@", @(i)];
+        NSDictionary<NSString *, NSString *> *labels = @{ @"event_id" : @"hidden_event",
+                                                          @"event_name" : name,
+                                                          @"event_type" : @"toggle",
+                                                          @"event_source" : @"favorite_list",
+                                                          @"event_value" : @"true",
+                                                          @"navigation_app_site_name" : @"rts-app-test-v",
+                                                          @"navigation_environment" : @"preprod",
+                                                          @"navigation_device" : @"phone" };
+        NSDictionary<NSString *, id> *input = @{ @"name" : name,
+                                                 @"labels" : @{ @"event_type" : @"toggle",
+                                                                @"event_source" : @"favorite_list",
+                                                                @"event_value" : @"true" },
+                                                 @"comscore_labels" : @{ @"srg_evgroup" : @"toggle",
+                                                                         @"srg_evsource" : @"favorite_list",
+                                                                         @"srg_evvalue" : @"true" } };
+        [events addObject:[[SRGAnalyticsEvent alloc] initWithType:SRGAnalyticsEventTypeHiddenEvent name:@"hidden_event" labels:labels URL:nil input:input timestamp:i]];
+    }
+    
+    [self runBenchmarkWithName:@"replay/hidden_events_100" block:^{
+        dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+        [tracker replayEvents:events withCompletionBlock:^{
+            dispatch_semaphore_signal(semaphore);
+        }];
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    }];
+}
+
+- (void)testStreamSenseSessions
+{
+    // Short playback sessions, as for autoplayed previews
+    [self runBenchmarkWithName:@"streamsense_sessions/allocation" block:^{
+        CSStreamSense *streamSense = [[CSStreamSense alloc] init];
+        [streamSense setKeepAliveInterval:9 * 60];
+    }];
+    
+    SRGAnalyticsStreamSensePool *pool = [[SRGAnalyticsStreamSensePool alloc] initWithCapacity:1];
+    [self runBenchmarkWithName:@"streamsense_sessions/pooled" block:^{
+        CSStreamSense *streamSense = [pool dequeueStreamSense];
+        [pool recycleStreamSense:streamSense];
+    }];
+    XCTAssertEqual(pool.allocationCount, 1);
+}
+
+- (void)testResourceSelection
+{
+    SRGPlaybackSettings *settings = [[SRGPlaybackSettings alloc] init];
+    settings.streamType = SRGStreamTypeLive;
+    settings.quality = SRGQualityHD;
+    settings.DRM = YES;
+    
+    for (NSNumber *count in @[ @4, @16, @64, @256 ]) {
+        NSArray<SRGResource *> *resources = [self resourcesWithCount:count.integerValue];
+        NSString *name = [NSString stringWithFormat:@"resource_selection/resources_%@", count];
+        [self runBenchmarkWithName:name block:^{
+            __unused SRGResource *resource = SRGPreferredResource(resources, settings);
+        }];
+        
+        SRGChapter *chapter = [[SRGChapter alloc] initWithDictionary:@{ @keypath(SRGChapter.new, resources) : resources } error:NULL];
+        NSString *cachedName = [NSString stringWithFormat:@"resource_selection/cached_resources_%@", count];
+        [self runBenchmarkWithName:cachedName block:^{
+            __unused SRGResource *resource = [chapter srg_preferredResourceWithSettings:settings];
+        }];
+    }
+}
+
+- (void)testSegmentIndex
+{
+    for (NSNumber *count in @[ @10, @100, @1000, @10000 ]) {
+        NSMutableArray<Segment *> *segments = [NSMutableArray array];
+        for (NSInteger i = 0; i < count.integerValue; ++i) {
+            CMTimeRange timeRange = CMTimeRangeMake(CMTimeMakeWithSeconds(10. * i, NSEC_PER_SEC), CMTimeMakeWithSeconds(8., NSEC_PER_SEC));
+            [segments addObject:[Segment segmentWithName:[NSString stringWithFormat:@"segment%@", @(i)] timeRange:timeRange]];
+        }
+        NSArray<Segment *> *segmentList = [segments copy];
+        
+        NSString *buildName = [NSString stringWithFormat:@"segment_index/build_%@", count];
+        [self runBenchmarkWithName:buildName block:^{
+            __unused SRGAnalyticsSegmentIndex *index = [[SRGAnalyticsSegmentIndex alloc] initWithSegments:segmentList];
+        }];
+        
+        SRGAnalyticsSegmentIndex *index = [[SRGAnalyticsSegmentIndex alloc] initWithSegments:segmentList];
+        SRGAnalyticsSegmentIndex *otherIndex = [[SRGAnalyticsSegmentIndex alloc] initWithSegments:segmentList];
+        NSString *equivalenceName = [NSString stringWithFormat:@"segment_index/equivalence_%@", count];
+        [self runBenchmarkWithName:equivalenceName block:^{
+            __unused BOOL equivalent = [index isEquivalentToIndex:otherIndex];
+        }];
+    }
+}
+
+- (void)testSegmentCache
+{
+    NSDate *date = NSDate.date;
+    for (NSNumber *count in @[ @10, @100, @1000, @10000 ]) {
+        NSMutableArray<SRGSegment *> *segments = [NSMutableArray array];
+        for (NSInteger i = 0; i < count.integerValue; ++i) {
+            NSDictionary *dictionary = @{ @keypath(SRGSegment.new, URN) : [NSString stringWithFormat:@"urn:rts:video:%@", @(i)],
+                                          @keypath(SRGSegment.new, markIn) : @(10000 * i),
+                                          @keypath(SRGSegment.new, duration) : @8000,
+                                          @keypath(SRGSegment.new, startDate) : [date dateByAddingTimeInterval:-3600.],
+                                          @keypath(SRGSegment.new, endDate) : [date dateByAddingTimeInterval:3600.] };
+            [segments addObject:[[SRGSegment alloc] initWithDictionary:dictionary error:NULL]];
+        }
+        NSArray<SRGSegment *> *segmentList = [segments copy];
+        
+        // Scan performed by players when looking up the segment at the current playback position
+        CMTime time = CMTimeMakeWithSeconds(10. * count.integerValue, NSEC_PER_SEC);
+        NSString *uncachedName = [NSString stringWithFormat:@"segment_cache/uncached_scan_%@", count];
+        [self runBenchmarkWithName:uncachedName block:^{
+            NSDate *now = NSDate.date;
+            for (SRGSegment *segment in segmentList) {
+                CMTimeRange timeRange = CMTimeRangeMake(CMTimeMakeWithSeconds(segment.markIn / 1000., NSEC_PER_SEC),
+                                                        CMTimeMakeWithSeconds(segment.duration / 1000., NSEC_PER_SEC));
+                if (CMTimeRangeContainsTime(timeRange, time) && [segment blockingReasonAtDate:now] == SRGBlockingReasonNone) {
+                    break;
+                }
+            }
+        }];
+        
+        NSString *cachedName = [NSString stringWithFormat:@"segment_cache/cached_scan_%@", count];
+        [self runBenchmarkWithName:cachedName block:^{
+            for (SRGSegment *segment in segmentList) {
+                if (CMTimeRangeContainsTime(segment.srg_timeRange, time) && ! segment.srg_blocked) {
+                    break;
+                }
+            }
+        }];
+    }
+}
+
+- (void)testViewControllerAppearance
+{
+    [self runBenchmarkWithName:@"view_tracking_capabilities/uncached" block:^{
+        __unused SRGAnalyticsViewTrackingCapabilities untrackedCapabilities = SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(UINavigationController.class);
+        __unused SRGAnalyticsViewTrackingCapabilities trackedCapabilities = SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(BenchmarkViewController.class);
+    }];
+    [self runBenchmarkWithName:@"view_tracking_capabilities/cached" block:^{
+        __unused SRGAnalyticsViewTrackingCapabilities untrackedCapabilities = SRGAnalyticsViewTrackingCapabilitiesForClass(UINavigationController.class);
+        __unused SRGAnalyticsViewTrackingCapabilities trackedCapabilities = SRGAnalyticsViewTrackingCapabilitiesForClass(BenchmarkViewController.class);
+    }];
+    
+    // Push and pop view controllers which have already appeared once, so that no page views are sent. Only the swizzled
+    // appearance methods are measured.
+    for (NSNumber *count in @[ @1000, @5000 ]) {
+        NSMutableArray<UIViewController *> *untrackedViewControllers = [NSMutableArray array];
+        NSMutableArray<UIViewController *> *trackedViewControllers = [NSMutableArray array];
+        for (NSInteger i = 0; i < count.integerValue; ++i) {
+            [untrackedViewControllers addObject:[[UIViewController alloc] init]];
+            
+            BenchmarkViewController *viewController = [[BenchmarkViewController alloc] init];
+            [viewController viewDidAppear:NO];
+            [viewController viewWillDisappear:NO];
+            [trackedViewControllers addObject:viewController];
+        }
+        
+        NSDictionary<NSString *, NSArray<UIViewController *> *> *viewControllersByKind = @{ @"untracked" : untrackedViewControllers,
+                                                                                          @"tracked" : trackedViewControllers };
+        [viewControllersByKind enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull kind, NSArray<UIViewController *> * _Nonnull viewControllers, BOOL * _Nonnull stop) {
+            NSString *name = [NSString stringWithFormat:@"view_controllers/push_pop_%@_%@", kind, count];
+            [self runBenchmarkWithName:name block:^{
+                for (UIViewController *viewController in viewControllers) {
+                    [viewController viewDidAppear:NO];
+                }
+                for (UIViewController *viewController in viewControllers.reverseObjectEnumerator) {
+                    [viewController viewWillDisappear:NO];
+                }
+            }];
+        }];
+    }
+}
+
+#pragma mark SRGAnalyticsStreamTrackerDelegate protocol
+
+- (BOOL)streamTrackerIsPlayingLive:(SRGAnalyticsStreamTracker *)tracker
+{
+    return NO;
+}
+
+- (NSTimeInterval)positionForStreamTracker:(SRGAnalyticsStreamTracker *)tracker
+{
+    return 60000.;
+}
+
+- (SRGAnalyticsStreamLabels *)labelsForStreamTracker:(SRGAnalyticsStreamTracker *)tracker
+{
+    return self.streamLabels;
+}
+
+@end
@@ -27,6 +27,9 @@
     XCTAssertEqual(configuration.container, 7);
     XCTAssertEqualObjects(configuration.comScoreVirtualSite, @"comscore-vsite");
     XCTAssertEqualObjects(configuration.netMetrixIdentifier, @"netmetrix-identifier");
+    XCTAssertEqual(configuration.tagCommanderBatchSize, 1);
+    XCTAssertEqual(configuration.tagCommanderBatchInterval, 30.);
+    XCTAssertFalse(configuration.startupStaged);
 }
 
 - (void)testBusinessUnitSpecificConfiguration
@@ -71,6 +74,9 @@
                                                                                              netMetrixIdentifier:@"netmetrix-identifier"];
     configuration.centralized = YES;
     configuration.unitTesting = YES;
+    configuration.tagCommanderBatchSize = 10;
+    configuration.tagCommanderBatchInterval = 60.;
+    configuration.startupStaged = YES;
     
     SRGAnalyticsConfiguration *configurationCopy = [configuration copy];
     XCTAssertEqual(configuration.centralized, configurationCopy.centralized);
@@ -80,6 +86,9 @@
     XCTAssertEqual(configuration.container, configurationCopy.container);
     XCTAssertEqualObjects(configuration.comScoreVirtualSite, configurationCopy.comScoreVirtualSite);
     XCTAssertEqualObjects(configuration.netMetrixIdentifier, configurationCopy.netMetrixIdentifier);
+    XCTAssertEqual(configuration.tagCommanderBatchSize, configurationCopy.tagCommanderBatchSize);
+    XCTAssertEqual(configuration.tagCommanderBatchInterval, configurationCopy.tagCommanderBatchInterval);
+    XCTAssertEqual(configuration.startupStaged, configurationCopy.startupStaged);
 }
 
 @end
@@ -6,7 +6,9 @@
 
 #import "AnalyticsTestCase.h"
 
-// Private header
+// Private headers
+#import "SRGChapter+SRGAnalytics_DataProvider.h"
+#import "SRGMediaComposition+SRGAnalytics_DataProvider_Private.h"
 #import "SRGResource+SRGAnalytics_DataProvider.h"
 
 #import <libextobjc/libextobjc.h>
@@ -22,6 +24,28 @@ static NSURL *MMFTestURL(void)
     return [NSURL URLWithString:@"https://play-mmf.herokuapp.com/integrationlayer"];
 }
 
+static SRGResource *TestResource(NSString *URLString, SRGStreamType streamType, SRGQuality quality, BOOL DRM)
+{
+    SRGDRM *fairPlayDRM = [[SRGDRM alloc] initWithDictionary:@{ @keypath(SRGDRM.new, type) : @(SRGDRMTypeFairPlay) } error:NULL];
+    NSDictionary *dictionary = @{ @keypath(SRGResource.new, URL) : [NSURL URLWithString:URLString],
+                                  @keypath(SRGResource.new, streamingMethod) : @(SRGStreamingMethodHLS),
+                                  @keypath(SRGResource.new, streamType) : @(streamType),
+                                  @keypath(SRGResource.new, quality) : @(quality),
+                                  @keypath(SRGResource.new, DRMs) : DRM ? @[ fairPlayDRM ] : @[] };
+    return [[SRGResource alloc] initWithDictionary:dictionary error:NULL];
+}
+
+static SRGMediaComposition *TestMediaComposition(NSArray<SRGResource *> *resources, NSDictionary<NSString *, NSString *> *analyticsLabels)
+{
+    NSString *URN = @"urn:rts:video:1234";
+    SRGChapter *chapter = [[SRGChapter alloc] initWithDictionary:@{ @keypath(SRGChapter.new, URN) : URN,
+                                                                    @keypath(SRGChapter.new, resources) : resources } error:NULL];
+    NSDictionary *dictionary = @{ @keypath(SRGMediaComposition.new, chapterURN) : URN,
+                                  @keypath(SRGMediaComposition.new, chapters) : @[ chapter ],
+                                  @keypath(SRGMediaComposition.new, analyticsLabels) : analyticsLabels };
+    return [[SRGMediaComposition alloc] initWithDictionary:dictionary error:NULL];
+}
+
 @interface DataProviderTestCase : AnalyticsTestCase
 
 @property (nonatomic) SRGMediaPlayerController *mediaPlayerController;
@@ -801,6 +825,74 @@ static NSURL *MMFTestURL(void)
     [self waitForExpectationsWithTimeout:20. handler:nil];
 }
 
+- (void)testPreferredResourceRanking
+{
+    SRGResource *resource1 = TestResource(@"http://host/1.m3u8", SRGStreamTypeOnDemand, SRGQualityHD, NO);
+    SRGResource *resource2 = TestResource(@"https://host/2.m3u8", SRGStreamTypeOnDemand, SRGQualitySD, YES);
+    SRGResource *resource3 = TestResource(@"https://host/3.m3u8", SRGStreamTypeDVR, SRGQualitySD, NO);
+    SRGResource *resource4 = TestResource(@"https://host/4.m3u8", SRGStreamTypeDVR, SRGQualitySD, NO);
+    SRGResource *resource5 = TestResource(@"https://host/5.m3u8", SRGStreamTypeDVR, SRGQualitySD, YES);
+    NSArray<SRGResource *> *resources = @[ resource1, resource2, resource3, resource4, resource5 ];
+    
+    // Scheme first, then stream type. The first resource is used among equivalent ones
+    XCTAssertEqual(SRGPreferredResource(resources, nil), resource3);
+    
+    SRGPlaybackSettings *settings = [[SRGPlaybackSettings alloc] init];
+    settings.DRM = YES;
+    XCTAssertEqual(SRGPreferredResource(resources, settings), resource5);
+    
+    settings.streamType = SRGStreamTypeOnDemand;
+    XCTAssertEqual(SRGPreferredResource(resources, settings), resource2);
+    
+    settings.quality = SRGQualityHD;
+    XCTAssertEqual(SRGPreferredResource(resources, settings), resource2);
+    
+    XCTAssertEqual(SRGPreferredResource(@[ resource1, resource4 ], settings), resource4);
+    XCTAssertNil(SRGPreferredResource(@[], settings));
+}
+
+- (void)testPreferredResourceCache
+{
+    SRGResource *resource1 = TestResource(@"https://host/1.m3u8", SRGStreamTypeOnDemand, SRGQualitySD, NO);
+    SRGResource *resource2 = TestResource(@"https://host/2.m3u8", SRGStreamTypeOnDemand, SRGQualityHD, NO);
+    SRGChapter *chapter = [[SRGChapter alloc] initWithDictionary:@{ @keypath(SRGChapter.new, resources) : @[ resource1, resource2 ] } error:NULL];
+    
+    SRGPlaybackSettings *settings = [[SRGPlaybackSettings alloc] init];
+    settings.quality = SRGQualitySD;
+    XCTAssertEqual([chapter srg_preferredResourceWithSettings:settings], resource1);
+    XCTAssertEqual([chapter srg_preferredResourceWithSettings:settings], resource1);
+    
+    // Settings which do not affect resource selection share the cached result
+    settings.sourceUid = @"source";
+    XCTAssertEqual([chapter srg_preferredResourceWithSettings:settings], resource1);
+    
+    settings.quality = SRGQualityHD;
+    XCTAssertEqual([chapter srg_preferredResourceWithSettings:settings], resource2);
+    XCTAssertEqual([chapter srg_preferredResourceWithSettings:nil], resource2);
+}
+
+- (void)testAnalyticsLabelsForResource
+{
+    SRGResource *resource = TestResource(@"https://host/1.m3u8", SRGStreamTypeOnDemand, SRGQualitySD, NO);
+    SRGMediaComposition *mediaComposition = TestMediaComposition(@[ resource ], @{ @"media_urn" : @"urn:rts:video:1234" });
+    SRGResource *mainResource = mediaComposition.mainChapter.resources.firstObject;
+    
+    SRGAnalyticsStreamLabels *labels1 = [mediaComposition analyticsLabelsForResource:mainResource sourceUid:@"source"];
+    XCTAssertEqualObjects(labels1.customInfo, (@{ @"media_urn" : @"urn:rts:video:1234", @"source_id" : @"source" }));
+    
+    // Returned labels can be safely altered
+    labels1.customInfo = @{};
+    
+    SRGAnalyticsStreamLabels *labels2 = [mediaComposition analyticsLabelsForResource:mainResource sourceUid:nil];
+    XCTAssertEqualObjects(labels2.customInfo, @{ @"media_urn" : @"urn:rts:video:1234" });
+    
+    SRGMediaComposition *sameMediaComposition = TestMediaComposition(@[ resource ], @{ @"media_urn" : @"urn:rts:video:1234" });
+    XCTAssertTrue([mediaComposition hasSameAnalyticsLabelsForResource:mainResource asMediaComposition:sameMediaComposition resource:sameMediaComposition.mainChapter.resources.firstObject]);
+    
+    SRGMediaComposition *otherMediaComposition = TestMediaComposition(@[ resource ], @{ @"media_urn" : @"urn:rts:video:5678" });
+    XCTAssertFalse([mediaComposition hasSameAnalyticsLabelsForResource:mainResource asMediaComposition:otherMediaComposition resource:otherMediaComposition.mainChapter.resources.firstObject]);
+}
+
 - (void)testPlayMediaCompositionWithSourceUid
 {
     [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
@@ -0,0 +1,186 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsEventJournal.h"
+
+#import <XCTest/XCTest.h>
+
+@interface EventJournalTestCase : XCTestCase
+
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) dispatch_queue_t queue;
+
+@end
+
+@implementation EventJournalTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    NSString *fileName = [NSString stringWithFormat:@"EventJournal-%@", NSUUID.UUID.UUIDString];
+    self.fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    self.queue = dispatch_queue_create("ch.srgssr.analytics.tests.journal", DISPATCH_QUEUE_SERIAL);
+}
+
+- (void)tearDown
+{
+    [NSFileManager.defaultManager removeItemAtURL:self.fileURL error:NULL];
+}
+
+#pragma mark Tests
+
+- (void)testFlushWhenBatchSizeIsReached
+{
+    XCTestExpectation *flushExpectation = [self expectationWithDescription:@"Flush"];
+    
+    __block SRGAnalyticsEventJournal *journal = nil;
+    dispatch_sync(self.queue, ^{
+        journal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:self.fileURL queue:self.queue batchSize:3 flushInterval:60. flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> * _Nonnull labelsArray) {
+            NSArray<NSDictionary<NSString *, NSString *> *> *expectedLabelsArray = @[ @{ @"event_id" : @"1" },
+                                                                                      @{ @"event_id" : @"2" },
+                                                                                      @{ @"event_id" : @"3" } ];
+            XCTAssertEqualObjects(labelsArray, expectedLabelsArray);
+            [flushExpectation fulfill];
+        }];
+        
+        [journal appendLabels:@{ @"event_id" : @"1" }];
+        [journal appendLabels:@{ @"event_id" : @"2" }];
+        XCTAssertEqual(journal.count, 2);
+        
+        [journal appendLabels:@{ @"event_id" : @"3" }];
+        XCTAssertEqual(journal.count, 0);
+    });
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testFlushWhenIntervalHasElapsed
+{
+    XCTestExpectation *flushExpectation = [self expectationWithDescription:@"Flush"];
+    
+    __block SRGAnalyticsEventJournal *journal = nil;
+    dispatch_sync(self.queue, ^{
+        journal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:self.fileURL queue:self.queue batchSize:10 flushInterval:1. flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> * _Nonnull labelsArray) {
+            XCTAssertEqualObjects(labelsArray, @[ @{ @"event_id" : @"1" } ]);
+            [flushExpectation fulfill];
+        }];
+        [journal appendLabels:@{ @"event_id" : @"1" }];
+    });
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    dispatch_sync(self.queue, ^{
+        XCTAssertEqual(journal.count, 0);
+    });
+}
+
+- (void)testExplicitFlush
+{
+    __block NSArray<NSDictionary<NSString *, NSString *> *> *flushedLabelsArray = nil;
+    dispatch_sync(self.queue, ^{
+        SRGAnalyticsEventJournal *journal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:self.fileURL queue:self.queue batchSize:10 flushInterval:60. flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> * _Nonnull labelsArray) {
+            flushedLabelsArray = labelsArray;
+        }];
+        [journal appendLabels:@{ @"event_id" : @"1" }];
+        [journal appendLabels:@{ @"event_id" : @"2" }];
+        [journal flush];
+        XCTAssertEqual(journal.count, 0);
+    });
+    
+    NSArray<NSDictionary<NSString *, NSString *> *> *expectedLabelsArray = @[ @{ @"event_id" : @"1" },
+                                                                              @{ @"event_id" : @"2" } ];
+    XCTAssertEqualObjects(flushedLabelsArray, expectedLabelsArray);
+}
+
+- (void)testFlushOfEntriesFromPreviousSession
+{
+    // Entries left by a previous session (e.g. the application was terminated before the journal could be flushed)
+    dispatch_sync(self.queue, ^{
+        SRGAnalyticsEventJournal *journal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:self.fileURL queue:self.queue batchSize:10 flushInterval:60. flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> * _Nonnull labelsArray) {
+            XCTFail(@"No flush is expected");
+        }];
+        [journal appendLabels:@{ @"event_id" : @"1" }];
+        [journal appendLabels:@{ @"event_id" : @"2" }];
+    });
+    
+    XCTestExpectation *flushExpectation = [self expectationWithDescription:@"Flush"];
+    
+    __block SRGAnalyticsEventJournal *journal = nil;
+    dispatch_sync(self.queue, ^{
+        journal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:self.fileURL queue:self.queue batchSize:10 flushInterval:60. flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> * _Nonnull labelsArray) {
+            NSArray<NSDictionary<NSString *, NSString *> *> *expectedLabelsArray = @[ @{ @"event_id" : @"1" },
+                                                                                      @{ @"event_id" : @"2" } ];
+            XCTAssertEqualObjects(labelsArray, expectedLabelsArray);
+            [flushExpectation fulfill];
+        }];
+        XCTAssertEqual(journal.count, 2);
+    });
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testAppendBeforeFlushOfEntriesFromPreviousSession
+{
+    dispatch_sync(self.queue, ^{
+        SRGAnalyticsEventJournal *journal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:self.fileURL queue:self.queue batchSize:10 flushInterval:60. flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> * _Nonnull labelsArray) {
+            XCTFail(@"No flush is expected");
+        }];
+        [journal appendLabels:@{ @"event_id" : @"1" }];
+        [journal appendLabels:@{ @"event_id" : @"2" }];
+    });
+    
+    // Entries appended before entries from the previous session have been read are flushed after them, each only once
+    __block NSMutableArray<NSDictionary<NSString *, NSString *> *> *flushedLabelsArray = [NSMutableArray array];
+    __block SRGAnalyticsEventJournal *journal = nil;
+    dispatch_sync(self.queue, ^{
+        journal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:self.fileURL queue:self.queue batchSize:3 flushInterval:60. flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> * _Nonnull labelsArray) {
+            [flushedLabelsArray addObjectsFromArray:labelsArray];
+        }];
+        [journal appendLabels:@{ @"event_id" : @"3" }];
+    });
+    
+    dispatch_sync(self.queue, ^{
+        XCTAssertEqual(journal.count, 0);
+    });
+    
+    NSArray<NSDictionary<NSString *, NSString *> *> *expectedLabelsArray = @[ @{ @"event_id" : @"1" },
+                                                                              @{ @"event_id" : @"2" },
+                                                                              @{ @"event_id" : @"3" } ];
+    XCTAssertEqualObjects(flushedLabelsArray, expectedLabelsArray);
+}
+
+- (void)testTruncatedEntry
+{
+    dispatch_sync(self.queue, ^{
+        SRGAnalyticsEventJournal *journal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:self.fileURL queue:self.queue batchSize:10 flushInterval:60. flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> * _Nonnull labelsArray) {
+            XCTFail(@"No flush is expected");
+        }];
+        [journal appendLabels:@{ @"event_id" : @"1" }];
+    });
+    
+    // Simulate an entry interrupted while being written
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:self.fileURL error:NULL];
+    [fileHandle seekToEndOfFile];
+    uint8_t bytes[] = { 0x00, 0x00, 0x01, 0x00, '{', '"' };
+    [fileHandle writeData:[NSData dataWithBytes:bytes length:sizeof(bytes)]];
+    [fileHandle closeFile];
+    
+    XCTestExpectation *flushExpectation = [self expectationWithDescription:@"Flush"];
+    
+    __block SRGAnalyticsEventJournal *journal = nil;
+    dispatch_sync(self.queue, ^{
+        journal = [[SRGAnalyticsEventJournal alloc] initWithFileURL:self.fileURL queue:self.queue batchSize:10 flushInterval:60. flushBlock:^(NSArray<NSDictionary<NSString *,NSString *> *> * _Nonnull labelsArray) {
+            XCTAssertEqualObjects(labelsArray, @[ @{ @"event_id" : @"1" } ]);
+            [flushExpectation fulfill];
+        }];
+        XCTAssertEqual(journal.count, 1);
+    });
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+@end
@@ -0,0 +1,224 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+#import "SRGAnalyticsEvent+Private.h"
+#import "TestEventSink.h"
+
+@interface EventRecorderTestCase : AnalyticsTestCase
+
+@property (nonatomic) NSURL *fileURL;
+
+@end
+
+@implementation EventRecorderTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    NSString *fileName = [NSString stringWithFormat:@"Recording-%@.jsonl", NSUUID.UUID.UUIDString];
+    self.fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+}
+
+- (void)tearDown
+{
+    [SRGAnalyticsTracker.sharedTracker stopRecording];
+    [NSFileManager.defaultManager removeItemAtURL:self.fileURL error:NULL];
+}
+
+#pragma mark Tests
+
+- (void)testRecording
+{
+    [SRGAnalyticsTracker.sharedTracker startRecordingToFileURL:self.fileURL];
+    XCTAssertTrue(SRGAnalyticsTracker.sharedTracker.recording);
+    
+    [self expectationForPageViewEventNotificationWithHandler:^BOOL(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
+        return YES;
+    }];
+    
+    // Let the NetMetrix view be recorded as well
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    
+    SRGAnalyticsHiddenEventLabels *labels = [[SRGAnalyticsHiddenEventLabels alloc] init];
+    labels.customInfo = @{ @"custom_label" : @"custom_value" };
+    [SRGAnalyticsTracker.sharedTracker trackHiddenEventWithName:@"Hidden event" labels:labels];
+    [SRGAnalyticsTracker.sharedTracker trackPageViewWithTitle:@"Page view" levels:nil];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    [SRGAnalyticsTracker.sharedTracker stopRecording];
+    XCTAssertFalse(SRGAnalyticsTracker.sharedTracker.recording);
+    
+    NSArray<SRGAnalyticsEvent *> *events = [SRGAnalyticsEventRecorder eventsWithContentsOfFileURL:self.fileURL];
+    XCTAssertEqualObjects([events valueForKey:@"type"], (@[ @(SRGAnalyticsEventTypeHiddenEvent), @(SRGAnalyticsEventTypePageView), @(SRGAnalyticsEventTypeNetMetrixView) ]));
+    
+    SRGAnalyticsEvent *hiddenEvent = events[0];
+    XCTAssertEqualObjects(hiddenEvent.name, @"hidden_event");
+    XCTAssertEqualObjects(hiddenEvent.labels[@"event_name"], @"Hidden event");
+    XCTAssertEqualObjects(hiddenEvent.labels[@"custom_label"], @"custom_value");
+    
+    SRGAnalyticsEvent *netMetrixEvent = events[2];
+    XCTAssertNotNil(netMetrixEvent.URL);
+    XCTAssertEqual(netMetrixEvent.labels.count, 0);
+    
+    // Times are relative to the start of the recording
+    XCTAssertGreaterThanOrEqual(events[0].timestamp, 0.);
+    XCTAssertGreaterThanOrEqual(events[1].timestamp, events[0].timestamp);
+    XCTAssertGreaterThanOrEqual(events[2].timestamp, events[1].timestamp);
+    XCTAssertLessThan(events[2].timestamp, 5.);
+}
+
+- (void)testReplay
+{
+    [SRGAnalyticsTracker.sharedTracker startRecordingToFileURL:self.fileURL];
+    
+    [self expectationForPageViewEventNotificationWithHandler:^BOOL(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
+        return YES;
+    }];
+    
+    // Let the NetMetrix view be recorded as well
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    
+    SRGAnalyticsHiddenEventLabels *labels = [[SRGAnalyticsHiddenEventLabels alloc] init];
+    labels.source = @"favorite_list";
+    labels.customInfo = @{ @"custom_label" : @"custom_value" };
+    [SRGAnalyticsTracker.sharedTracker trackHiddenEventWithName:@"Hidden event" labels:labels];
+    [SRGAnalyticsTracker.sharedTracker trackPageViewWithTitle:@"Page view" levels:@[ @"level1", @"level2" ]];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    [SRGAnalyticsTracker.sharedTracker stopRecording];
+    
+    NSArray<SRGAnalyticsEvent *> *recordedEvents = [SRGAnalyticsEventRecorder eventsWithContentsOfFileURL:self.fileURL];
+    XCTAssertEqualObjects([recordedEvents valueForKey:@"type"], (@[ @(SRGAnalyticsEventTypeHiddenEvent), @(SRGAnalyticsEventTypePageView), @(SRGAnalyticsEventTypeNetMetrixView) ]));
+    
+    // Inputs are recorded with the events they result from
+    XCTAssertEqualObjects(recordedEvents[0].input[@"name"], @"Hidden event");
+    XCTAssertEqualObjects(recordedEvents[1].input[@"title"], @"Page view");
+    XCTAssertEqualObjects(recordedEvents[1].input[@"levels"], (@[ @"level1", @"level2" ]));
+    XCTAssertNil(recordedEvents[2].input);
+    
+    SRGAnalyticsEvent *streamEvent = [[SRGAnalyticsEvent alloc] initWithType:SRGAnalyticsEventTypeComScoreStreamEvent
+                                                                        name:@"play"
+                                                                      labels:@{ @"ns_st_ev" : @"play" }
+                                                                         URL:nil
+                                                                   timestamp:2.];
+    NSArray<SRGAnalyticsEvent *> *events = [recordedEvents arrayByAddingObject:streamEvent];
+    
+    // Replayed events must never reach the analytics SDKs or the network
+    NSArray<NSString *> *notificationNames = @[ SRGAnalyticsRequestNotification, SRGAnalyticsComScoreRequestNotification, SRGAnalyticsNetmetrixRequestNotification ];
+    NSMutableArray<id> *observers = [NSMutableArray array];
+    for (NSString *notificationName in notificationNames) {
+        [observers addObject:[NSNotificationCenter.defaultCenter addObserverForName:notificationName object:nil queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
+            XCTFail(@"No request must be made during a replay. Received %@", notification);
+        }]];
+    }
+    
+    NSMutableArray<SRGAnalyticsEvent *> *replayedEvents = [NSMutableArray array];
+    TestEventSink *sink = [[TestEventSink alloc] initWithBlock:^(SRGAnalyticsEvent *event) {
+        @synchronized(replayedEvents) {
+            [replayedEvents addObject:event];
+        }
+    }];
+    [SRGAnalyticsTracker.sharedTracker addEventSink:sink forEventTypes:SRGAnalyticsEventTypeAll];
+    
+    XCTestExpectation *completionExpectation = [self expectationWithDescription:@"Replay completed"];
+    [SRGAnalyticsTracker.sharedTracker replayEvents:events withCompletionBlock:^{
+        [completionExpectation fulfill];
+    }];
+    
+    // Let requests which would have been made be noticed
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    
+    [self waitForExpectationsWithTimeout:5. handler:^(NSError * _Nullable error) {
+        [SRGAnalyticsTracker.sharedTracker removeEventSink:sink];
+        for (id observer in observers) {
+            [NSNotificationCenter.defaultCenter removeObserver:observer];
+        }
+    }];
+    
+    // Page views and hidden events are built again, for TagCommander and comScore. Other events are replayed as recorded
+    XCTAssertEqualObjects([replayedEvents valueForKey:@"type"], (@[ @(SRGAnalyticsEventTypeHiddenEvent),
+                                                                   @(SRGAnalyticsEventTypeComScoreHiddenEvent),
+                                                                   @(SRGAnalyticsEventTypePageView),
+                                                                   @(SRGAnalyticsEventTypeComScorePageView),
+                                                                   @(SRGAnalyticsEventTypeNetMetrixView),
+                                                                   @(SRGAnalyticsEventTypeComScoreStreamEvent) ]));
+    
+    XCTAssertEqualObjects(replayedEvents[0].labels, recordedEvents[0].labels);
+    XCTAssertEqualObjects(replayedEvents[0].labels[@"event_source"], @"favorite_list");
+    XCTAssertEqualObjects(replayedEvents[0].input, recordedEvents[0].input);
+    XCTAssertEqualObjects(replayedEvents[1].name, @"app.hidden-event");
+    XCTAssertEqualObjects(replayedEvents[1].labels[@"srg_evsource"], @"favorite_list");
+    XCTAssertEqualObjects(replayedEvents[2].labels, recordedEvents[1].labels);
+    XCTAssertEqualObjects(replayedEvents[3].name, @"level1.level2.page-view");
+    XCTAssertEqualObjects(replayedEvents[4].URL, recordedEvents[2].URL);
+    XCTAssertEqualObjects(replayedEvents[5].labels, streamEvent.labels);
+}
+
+- (void)testRecorder
+{
+    SRGAnalyticsEventRecorder *recorder = [[SRGAnalyticsEventRecorder alloc] initWithFileURL:self.fileURL];
+    
+    NSTimeInterval timestamp = SRGAnalyticsEventCurrentTimestamp();
+    [recorder tracker:SRGAnalyticsTracker.sharedTracker didSendEvent:[[SRGAnalyticsEvent alloc] initWithType:SRGAnalyticsEventTypeComScoreStreamEvent
+                                                                                                        name:@"play"
+                                                                                                      labels:@{ @"ns_st_ev" : @"play" }
+                                                                                                         URL:nil
+                                                                                                   timestamp:timestamp + 1.]];
+    [recorder tracker:SRGAnalyticsTracker.sharedTracker didSendEvent:[[SRGAnalyticsEvent alloc] initWithType:SRGAnalyticsEventTypeNetMetrixView
+                                                                                                        name:nil
+                                                                                                      labels:nil
+                                                                                                         URL:[NSURL URLWithString:@"https://netmetrix.test/view"]
+                                                                                                   timestamp:timestamp + 2.]];
+    [recorder close];
+    
+    // Discarded once closed
+    [recorder tracker:SRGAnalyticsTracker.sharedTracker didSendEvent:[[SRGAnalyticsEvent alloc] initWithType:SRGAnalyticsEventTypeHiddenEvent
+                                                                                                        name:@"hidden_event"
+                                                                                                      labels:nil
+                                                                                                         URL:nil
+                                                                                                   timestamp:timestamp + 3.]];
+    
+    NSArray<SRGAnalyticsEvent *> *events = [SRGAnalyticsEventRecorder eventsWithContentsOfFileURL:self.fileURL];
+    XCTAssertEqual(events.count, 2);
+    
+    XCTAssertEqual(events[0].type, SRGAnalyticsEventTypeComScoreStreamEvent);
+    XCTAssertEqualObjects(events[0].name, @"play");
+    XCTAssertEqualObjects(events[0].labels, @{ @"ns_st_ev" : @"play" });
+    XCTAssertNil(events[0].URL);
+    XCTAssertEqualWithAccuracy(events[0].timestamp, 1., 0.1);
+    
+    XCTAssertEqual(events[1].type, SRGAnalyticsEventTypeNetMetrixView);
+    XCTAssertNil(events[1].name);
+    XCTAssertEqual(events[1].labels.count, 0);
+    XCTAssertEqualObjects(events[1].URL, [NSURL URLWithString:@"https://netmetrix.test/view"]);
+    XCTAssertEqualWithAccuracy(events[1].timestamp, 2., 0.1);
+}
+
+- (void)testInvalidLines
+{
+    NSString *contents = @"{\"time\":0.5,\"type\":\"hidden_event\",\"name\":\"hidden_event\",\"labels\":{\"event_id\":\"hidden_event\"}}\n"
+                         @"not json\n"
+                         @"{\"time\":0.6,\"type\":\"unknown\"}\n"
+                         @"\n"
+                         @"{\"time\":0.7,\"type\":\"page_view\",\"name\":\"screen\",\"labels\":{\"event_id\":\"scr";
+    [contents writeToURL:self.fileURL atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+    
+    NSArray<SRGAnalyticsEvent *> *events = [SRGAnalyticsEventRecorder eventsWithContentsOfFileURL:self.fileURL];
+    XCTAssertEqual(events.count, 1);
+    XCTAssertEqual(events.firstObject.type, SRGAnalyticsEventTypeHiddenEvent);
+    XCTAssertEqualObjects(events.firstObject.labels, @{ @"event_id" : @"hidden_event" });
+}
+
+- (void)testMissingFile
+{
+    XCTAssertNil([SRGAnalyticsEventRecorder eventsWithContentsOfFileURL:self.fileURL]);
+}
+
+@end
@@ -0,0 +1,113 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+#import "TestEventSink.h"
+
+@interface EventSinkTestCase : AnalyticsTestCase
+
+@end
+
+@implementation EventSinkTestCase
+
+#pragma mark Tests
+
+- (void)testHiddenEvent
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Hidden event received"];
+    
+    TestEventSink *sink = [[TestEventSink alloc] initWithBlock:^(SRGAnalyticsEvent *event) {
+        XCTAssertEqual(event.type, SRGAnalyticsEventTypeHiddenEvent);
+        XCTAssertEqualObjects(event.name, @"hidden_event");
+        XCTAssertEqualObjects(event.labels[@"event_name"], @"Hidden event");
+        XCTAssertNil(event.URL);
+        [expectation fulfill];
+    }];
+    [SRGAnalyticsTracker.sharedTracker addEventSink:sink forEventTypes:SRGAnalyticsEventTypeHiddenEvent];
+    
+    [SRGAnalyticsTracker.sharedTracker trackHiddenEventWithName:@"Hidden event"];
+    
+    [self waitForExpectationsWithTimeout:5. handler:^(NSError * _Nullable error) {
+        [SRGAnalyticsTracker.sharedTracker removeEventSink:sink];
+    }];
+}
+
+- (void)testPageView
+{
+    XCTestExpectation *tagCommanderExpectation = [self expectationWithDescription:@"TagCommander page view received"];
+    XCTestExpectation *netMetrixExpectation = [self expectationWithDescription:@"NetMetrix view received"];
+    
+    TestEventSink *sink = [[TestEventSink alloc] initWithBlock:^(SRGAnalyticsEvent *event) {
+        if (event.type == SRGAnalyticsEventTypePageView) {
+            XCTAssertEqualObjects(event.name, @"screen");
+            XCTAssertEqualObjects(event.labels[@"content_title"], @"Page view");
+            [tagCommanderExpectation fulfill];
+        }
+        else if (event.type == SRGAnalyticsEventTypeNetMetrixView) {
+            XCTAssertNotNil(event.URL);
+            XCTAssertEqual(event.labels.count, 0);
+            [netMetrixExpectation fulfill];
+        }
+    }];
+    
+    // comScore page views are not sent in unit testing mode
+    [SRGAnalyticsTracker.sharedTracker addEventSink:sink forEventTypes:SRGAnalyticsEventTypeAll];
+    
+    [SRGAnalyticsTracker.sharedTracker trackPageViewWithTitle:@"Page view" levels:nil];
+    
+    [self waitForExpectationsWithTimeout:5. handler:^(NSError * _Nullable error) {
+        [SRGAnalyticsTracker.sharedTracker removeEventSink:sink];
+    }];
+}
+
+- (void)testEventTypeFilter
+{
+    TestEventSink *sink = [[TestEventSink alloc] initWithBlock:^(SRGAnalyticsEvent *event) {
+        XCTAssertEqual(event.type, SRGAnalyticsEventTypePageView);
+    }];
+    [SRGAnalyticsTracker.sharedTracker addEventSink:sink forEventTypes:SRGAnalyticsEventTypePageView];
+    
+    [self expectationForPageViewEventNotificationWithHandler:^BOOL(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
+        return YES;
+    }];
+    
+    [SRGAnalyticsTracker.sharedTracker trackHiddenEventWithName:@"Hidden event"];
+    [SRGAnalyticsTracker.sharedTracker trackPageViewWithTitle:@"Page view" levels:nil];
+    
+    [self waitForExpectationsWithTimeout:5. handler:^(NSError * _Nullable error) {
+        [SRGAnalyticsTracker.sharedTracker removeEventSink:sink];
+    }];
+}
+
+- (void)testRemovedSink
+{
+    TestEventSink *sink = [[TestEventSink alloc] initWithBlock:^(SRGAnalyticsEvent *event) {
+        XCTFail(@"Removed sinks must not receive events");
+    }];
+    [SRGAnalyticsTracker.sharedTracker addEventSink:sink forEventTypes:SRGAnalyticsEventTypeAll];
+    [SRGAnalyticsTracker.sharedTracker removeEventSink:sink];
+    
+    [self expectationForHiddenEventNotificationWithHandler:^BOOL(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
+        return YES;
+    }];
+    
+    [SRGAnalyticsTracker.sharedTracker trackHiddenEventWithName:@"Hidden event"];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testSinkIsNotRetained
+{
+    __weak TestEventSink *weakSink = nil;
+    @autoreleasepool {
+        TestEventSink *sink = [[TestEventSink alloc] initWithBlock:^(SRGAnalyticsEvent *event) {}];
+        weakSink = sink;
+        [SRGAnalyticsTracker.sharedTracker addEventSink:sink forEventTypes:SRGAnalyticsEventTypeAll];
+    }
+    XCTAssertNil(weakSink);
+}
+
+@end
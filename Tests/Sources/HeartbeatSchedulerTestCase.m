@@ -0,0 +1,232 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsHeartbeatScheduler.h"
+
+#import <XCTest/XCTest.h>
+
+@interface HeartbeatTestClient : NSObject <SRGAnalyticsHeartbeatSchedulerClient>
+
+@property (nonatomic, copy) NSString *name;
+
+@end
+
+@implementation HeartbeatTestClient
+
+- (instancetype)initWithName:(NSString *)name
+{
+    if (self = [super init]) {
+        self.name = name;
+    }
+    return self;
+}
+
+- (NSArray<SRGAnalyticsLabelSet *> *)heartbeatLabelSetsForScheduler:(SRGAnalyticsHeartbeatScheduler *)scheduler
+{
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [labelSet setString:self.name forKey:@"client"];
+    return @[ labelSet ];
+}
+
+@end
+
+@interface HeartbeatSchedulerTestCase : XCTestCase
+
+@property (nonatomic) SRGAnalyticsManualClock *clock;
+@property (nonatomic) SRGAnalyticsHeartbeatScheduler *scheduler;
+
+// Client names, for each batch of heartbeats sent
+@property (nonatomic) NSMutableArray<NSArray<NSString *> *> *batches;
+
+@end
+
+@implementation HeartbeatSchedulerTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.clock = [[SRGAnalyticsManualClock alloc] init];
+    self.batches = [NSMutableArray array];
+    
+    __weak __typeof(self) weakSelf = self;
+    self.scheduler = [[SRGAnalyticsHeartbeatScheduler alloc] initWithClock:self.clock interval:30. tolerance:3. sendBlock:^(NSArray<SRGAnalyticsLabelSet *> * _Nonnull labelSets) {
+        [weakSelf.batches addObject:[labelSets valueForKeyPath:@"dictionary.client"]];
+    }];
+}
+
+#pragma mark Tests
+
+- (void)testSingleClient
+{
+    HeartbeatTestClient *client = [[HeartbeatTestClient alloc] initWithName:@"A"];
+    
+    XCTAssertTrue(self.scheduler.suspended);
+    [self.scheduler addClient:client];
+    XCTAssertFalse(self.scheduler.suspended);
+    
+    [self.clock advanceBy:29.];
+    XCTAssertEqual(self.batches.count, 0);
+    
+    [self.clock advanceBy:1.];
+    XCTAssertEqualObjects(self.batches, @[ @[ @"A" ] ]);
+    
+    [self.clock advanceBy:60.];
+    XCTAssertEqual(self.batches.count, 3);
+    
+    [self.scheduler removeClient:client];
+    XCTAssertTrue(self.scheduler.suspended);
+    
+    [self.clock advanceBy:120.];
+    XCTAssertEqual(self.batches.count, 3);
+}
+
+- (void)testClientReAddition
+{
+    HeartbeatTestClient *client = [[HeartbeatTestClient alloc] initWithName:@"A"];
+    [self.scheduler addClient:client];
+    
+    [self.clock advanceBy:20.];
+    [self.scheduler removeClient:client];
+    
+    // The first heartbeat is due one interval after the client has been added again
+    [self.clock advanceBy:5.];
+    [self.scheduler addClient:client];
+    
+    [self.clock advanceBy:29.];
+    XCTAssertEqual(self.batches.count, 0);
+    
+    [self.clock advanceBy:1.];
+    XCTAssertEqual(self.batches.count, 1);
+}
+
+- (void)testIntervalChange
+{
+    HeartbeatTestClient *client = [[HeartbeatTestClient alloc] initWithName:@"A"];
+    [self.scheduler addClient:client];
+    
+    // The pending heartbeat is brought forward
+    [self.clock advanceBy:1.];
+    [self.scheduler setInterval:3. tolerance:0.3];
+    XCTAssertEqual(self.scheduler.interval, 3.);
+    XCTAssertEqual(self.scheduler.tolerance, 0.3);
+    
+    [self.clock advanceBy:3.];
+    XCTAssertEqual(self.batches.count, 1);
+    
+    [self.clock advanceBy:3.];
+    XCTAssertEqual(self.batches.count, 2);
+    
+    // Subsequent heartbeats are sent with the new interval
+    [self.scheduler setInterval:30. tolerance:3.];
+    [self.clock advanceBy:3.];
+    XCTAssertEqual(self.batches.count, 3);
+    
+    [self.clock advanceBy:29.];
+    XCTAssertEqual(self.batches.count, 3);
+    
+    [self.clock advanceBy:1.];
+    XCTAssertEqual(self.batches.count, 4);
+}
+
+- (void)testClientsWithinTolerance
+{
+    HeartbeatTestClient *client1 = [[HeartbeatTestClient alloc] initWithName:@"A"];
+    [self.scheduler addClient:client1];
+    
+    [self.clock advanceBy:2.];
+    
+    HeartbeatTestClient *client2 = [[HeartbeatTestClient alloc] initWithName:@"B"];
+    [self.scheduler addClient:client2];
+    
+    // Heartbeats are sent together, in a single batch
+    [self.clock advanceBy:28.];
+    XCTAssertEqual(self.batches.count, 1);
+    XCTAssertEqualObjects([NSSet setWithArray:self.batches.firstObject], ([NSSet setWithObjects:@"A", @"B", nil]));
+    
+    [self.clock advanceBy:30.];
+    XCTAssertEqual(self.batches.count, 2);
+    XCTAssertEqual(self.batches.lastObject.count, 2);
+}
+
+- (void)testProgressiveAlignment
+{
+    HeartbeatTestClient *client1 = [[HeartbeatTestClient alloc] initWithName:@"A"];
+    [self.scheduler addClient:client1];
+    
+    [self.clock advanceBy:10.];
+    
+    HeartbeatTestClient *client2 = [[HeartbeatTestClient alloc] initWithName:@"B"];
+    [self.scheduler addClient:client2];
+    
+    // Heartbeats are shifted by at most the tolerance at each tick, and end up being sent together
+    [self.clock advanceBy:300.];
+    
+    NSArray<NSString *> *lastBatch = self.batches.lastObject;
+    XCTAssertEqual(lastBatch.count, 2);
+    
+    // Each heartbeat is sent at each interval (within tolerance)
+    NSUInteger heartbeatCount = 0;
+    for (NSArray<NSString *> *batch in self.batches) {
+        heartbeatCount += batch.count;
+    }
+    XCTAssertGreaterThanOrEqual(heartbeatCount, 19);
+    XCTAssertLessThanOrEqual(heartbeatCount, 21);
+}
+
+- (void)testLateTick
+{
+    HeartbeatTestClient *client1 = [[HeartbeatTestClient alloc] initWithName:@"A"];
+    [self.scheduler addClient:client1];
+    
+    [self.clock advanceBy:10.];
+    
+    HeartbeatTestClient *client2 = [[HeartbeatTestClient alloc] initWithName:@"B"];
+    [self.scheduler addClient:client2];
+    
+    // Missed ticks are skipped. Overdue clients are served once, together
+    [self.clock jumpBy:290.];
+    XCTAssertEqual(self.batches.count, 1);
+    XCTAssertEqualObjects([NSSet setWithArray:self.batches.firstObject], ([NSSet setWithObjects:@"A", @"B", nil]));
+    
+    // Next heartbeats are sent one interval later
+    [self.clock advanceBy:29.];
+    XCTAssertEqual(self.batches.count, 1);
+    
+    [self.clock advanceBy:1.];
+    XCTAssertEqual(self.batches.count, 2);
+    XCTAssertEqual(self.batches.lastObject.count, 2);
+}
+
+- (void)testLateTickWithinTolerance
+{
+    HeartbeatTestClient *client = [[HeartbeatTestClient alloc] initWithName:@"A"];
+    [self.scheduler addClient:client];
+    
+    [self.clock jumpBy:32.];
+    XCTAssertEqual(self.batches.count, 1);
+    
+    // The next tick is computed from the scheduled tick time, so that delays do not accumulate
+    [self.clock advanceBy:27.];
+    XCTAssertEqual(self.batches.count, 1);
+    
+    [self.clock advanceBy:1.];
+    XCTAssertEqual(self.batches.count, 2);
+}
+
+- (void)testDeallocatedClient
+{
+    @autoreleasepool {
+        HeartbeatTestClient *client = [[HeartbeatTestClient alloc] initWithName:@"A"];
+        [self.scheduler addClient:client];
+    }
+    
+    [self.clock advanceBy:30.];
+    XCTAssertEqual(self.batches.count, 0);
+    XCTAssertTrue(self.scheduler.suspended);
+}
+
+@end
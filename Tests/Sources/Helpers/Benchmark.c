@@ -0,0 +1,156 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "Benchmark.h"
+
+#include <stdint.h>
+
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#include <pthread.h>
+#else
+#include <time.h>
+#endif
+
+// Minimum duration of the measured run
+static const uint64_t BenchmarkMinimumDuration = 100000000;
+
+#ifdef BENCHMARK_WRAP_MALLOC
+
+static size_t s_allocationCount;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    ++s_allocationCount;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    ++s_allocationCount;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+    ++s_allocationCount;
+    return __real_realloc(pointer, size);
+}
+
+#elif defined(__APPLE__)
+
+#define BENCHMARK_MALLOC_LOGGER
+
+// Allocation logger hook exported by the system allocator (used by malloc stack logging), called for each allocation
+// and deallocation made in any zone. Zone statistics (`malloc_zone_statistics()`) cannot be used instead, as they only
+// report blocks currently in use.
+typedef void (BenchmarkMallocLogger)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfFramesToSkip);
+extern BenchmarkMallocLogger *malloc_logger;
+
+// See `MALLOC_LOG_TYPE_ALLOCATE` in the system allocator sources. Reallocations are logged as allocations as well
+static const uint32_t BenchmarkMallocLogTypeAllocate = 2;
+
+static size_t s_allocationCount;
+static pthread_t s_benchmarkThread;
+static BenchmarkMallocLogger *s_previousMallocLogger;
+
+static void BenchmarkLogMalloc(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfFramesToSkip)
+{
+    // Only count allocations made by the benchmark thread, ignoring unrelated system activity
+    if ((type & BenchmarkMallocLogTypeAllocate) && pthread_equal(pthread_self(), s_benchmarkThread)) {
+        ++s_allocationCount;
+    }
+    if (s_previousMallocLogger) {
+        s_previousMallocLogger(type, arg1, arg2, arg3, result, numberOfFramesToSkip + 1);
+    }
+}
+
+#endif
+
+#if defined(BENCHMARK_WRAP_MALLOC) || defined(BENCHMARK_MALLOC_LOGGER)
+#define BENCHMARK_COUNT_ALLOCATIONS
+#endif
+
+static uint64_t BenchmarkTime(void)
+{
+#ifdef __APPLE__
+    static mach_timebase_info_data_t s_timebaseInfo;
+    if (s_timebaseInfo.denom == 0) {
+        mach_timebase_info(&s_timebaseInfo);
+    }
+    return mach_absolute_time() * s_timebaseInfo.numer / s_timebaseInfo.denom;
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+#endif
+}
+
+BenchmarkResult BenchmarkRun(const char *name, BenchmarkFunction function, void *context)
+{
+#ifdef BENCHMARK_MALLOC_LOGGER
+    s_benchmarkThread = pthread_self();
+    s_previousMallocLogger = malloc_logger;
+    malloc_logger = BenchmarkLogMalloc;
+#endif
+    
+    // Warm up caches
+    function(context, 1);
+    
+    size_t iterations = 1;
+    uint64_t duration = 0;
+    size_t allocationCount = 0;
+    while (1) {
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+        size_t initialAllocationCount = s_allocationCount;
+#endif
+        uint64_t startTime = BenchmarkTime();
+        function(context, iterations);
+        duration = BenchmarkTime() - startTime;
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+        allocationCount = s_allocationCount - initialAllocationCount;
+#endif
+        
+        if (duration >= BenchmarkMinimumDuration || iterations > SIZE_MAX / 2) {
+            break;
+        }
+        iterations *= 2;
+    }
+    
+#ifdef BENCHMARK_MALLOC_LOGGER
+    malloc_logger = s_previousMallocLogger;
+#endif
+    
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nanosecondsPerOperation = (double)duration / iterations;
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+    result.allocationsPerOperation = (double)allocationCount / iterations;
+#else
+    (void)allocationCount;
+    result.allocationsPerOperation = -1.;
+#endif
+    return result;
+}
+
+void BenchmarkResultPrint(const BenchmarkResult *result, FILE *file)
+{
+    fprintf(file, "{\"name\":\"%s\",\"iterations\":%zu,\"ns_per_op\":%.3f,", result->name, result->iterations, result->nanosecondsPerOperation);
+    if (result->allocationsPerOperation >= 0.) {
+        fprintf(file, "\"allocs_per_op\":%.3f}\n", result->allocationsPerOperation);
+    }
+    else {
+        fprintf(file, "\"allocs_per_op\":null}\n");
+    }
+    fflush(file);
+}
@@ -0,0 +1,52 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#ifndef Benchmark_h
+#define Benchmark_h
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Function running the measured operation the specified number of times.
+ */
+typedef void (*BenchmarkFunction)(void *context, size_t iterations);
+
+/**
+ *  Benchmark result.
+ */
+typedef struct {
+    const char *name;
+    size_t iterations;
+    double nanosecondsPerOperation;
+    double allocationsPerOperation;             // Negative if allocations cannot be counted on the current platform
+} BenchmarkResult;
+
+/**
+ *  Run a benchmark. The number of iterations is doubled until the measurement lasts long enough to be meaningful.
+ *
+ *  @discussion On Apple platforms, allocations made by the calling thread are counted with the system allocator logger
+ *              hook. Elsewhere, allocations are counted for code compiled with `BENCHMARK_WRAP_MALLOC` and linked with the
+ *              GNU linker `--wrap` option for `malloc`, `calloc` and `realloc` (see the `benchmark` Makefile target).
+ *              Benchmarks must not run concurrently.
+ */
+BenchmarkResult BenchmarkRun(const char *name, BenchmarkFunction function, void *context);
+
+/**
+ *  Print a result as a single-line JSON object, e.g.
+ *    {"name":"state_machine/replay","iterations":1024,"ns_per_op":12.5,"allocs_per_op":0}
+ */
+void BenchmarkResultPrint(const BenchmarkResult *result, FILE *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Benchmark_h */
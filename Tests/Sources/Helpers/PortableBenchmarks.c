@@ -0,0 +1,93 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#include "PortableBenchmarks.h"
+
+#include "Benchmark.h"
+#include "SRGAnalyticsComScoreFormatting.h"
+#include "SRGAnalyticsStreamStateMachine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PortableBenchmarksStateCount 1000
+
+typedef struct {
+    const char *input;
+    size_t length;
+    char *output;
+} ComScoreFormattingContext;
+
+typedef struct {
+    SRGAnalyticsStreamMachineState states[PortableBenchmarksStateCount];
+    SRGAnalyticsStreamMachineTagCommanderEvent tagCommanderEvents[SRGAnalyticsStreamMachineEventCountMax * PortableBenchmarksStateCount];
+    SRGAnalyticsStreamMachineComScoreEvent comScoreEvents[SRGAnalyticsStreamMachineEventCountMax * PortableBenchmarksStateCount];
+} StateMachineContext;
+
+// Prevent the compiler from optimizing measured work away
+static volatile size_t s_sink;
+
+static void ComScoreFormattingBenchmark(void *context, size_t iterations)
+{
+    ComScoreFormattingContext *formattingContext = context;
+    for (size_t i = 0; i < iterations; ++i) {
+        s_sink = SRGAnalyticsComScoreFormatBytes(formattingContext->input, formattingContext->length, formattingContext->output);
+    }
+}
+
+static void StateMachineReplayBenchmark(void *context, size_t iterations)
+{
+    StateMachineContext *stateMachineContext = context;
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t tagCommanderCount = 0;
+        size_t comScoreCount = 0;
+        SRGAnalyticsStreamMachineReplay(stateMachineContext->states, PortableBenchmarksStateCount,
+                                        stateMachineContext->tagCommanderEvents, &tagCommanderCount,
+                                        stateMachineContext->comScoreEvents, &comScoreCount);
+        s_sink = tagCommanderCount + comScoreCount;
+    }
+}
+
+static void PortableBenchmarksRunComScoreFormatting(const char *name, const char *input, FILE *file)
+{
+    size_t length = strlen(input);
+    ComScoreFormattingContext context = { input, length, malloc(SRGAnalyticsComScoreFormattedLengthMax(length)) };
+    BenchmarkResult result = BenchmarkRun(name, ComScoreFormattingBenchmark, &context);
+    BenchmarkResultPrint(&result, file);
+    free(context.output);
+}
+
+static void PortableBenchmarksRunStateMachineReplay(const char *name, const SRGAnalyticsStreamMachineState *pattern, size_t patternLength, FILE *file)
+{
+    StateMachineContext *context = malloc(sizeof(StateMachineContext));
+    for (size_t i = 0; i < PortableBenchmarksStateCount; ++i) {
+        context->states[i] = pattern[i % patternLength];
+    }
+    BenchmarkResult result = BenchmarkRun(name, StateMachineReplayBenchmark, context);
+    BenchmarkResultPrint(&result, file);
+    free(context);
+}
+
+void PortableBenchmarksRun(FILE *file)
+{
+    PortableBenchmarksRunComScoreFormatting("comscore_format/short", "Page view", file);
+    PortableBenchmarksRunComScoreFormatting("comscore_format/long", "Le 19h30 - Edition spéciale: élections fédérales + débat & résultats (2019)", file);
+    
+    static const SRGAnalyticsStreamMachineState PlaybackPattern[] = {
+        SRGAnalyticsStreamMachineStatePlaying,
+        SRGAnalyticsStreamMachineStatePaused,
+        SRGAnalyticsStreamMachineStatePlaying,
+        SRGAnalyticsStreamMachineStateStopped
+    };
+    PortableBenchmarksRunStateMachineReplay("state_machine/replay_playback", PlaybackPattern, sizeof(PlaybackPattern) / sizeof(PlaybackPattern[0]), file);
+    
+    static const SRGAnalyticsStreamMachineState SeekPattern[] = {
+        SRGAnalyticsStreamMachineStatePlaying,
+        SRGAnalyticsStreamMachineStateSeeking,
+        SRGAnalyticsStreamMachineStateSeeking
+    };
+    PortableBenchmarksRunStateMachineReplay("state_machine/replay_seeks", SeekPattern, sizeof(SeekPattern) / sizeof(SeekPattern[0]), file);
+}
@@ -0,0 +1,26 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#ifndef PortableBenchmarks_h
+#define PortableBenchmarks_h
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Run benchmarks for the portable (C) parts of the tracking pipeline, printing results to the specified file as JSON
+ *  lines (see `BenchmarkResultPrint()`).
+ */
+void PortableBenchmarksRun(FILE *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PortableBenchmarks_h */
@@ -0,0 +1,762 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#include "PortableTests.h"
+
+#include "SRGAnalyticsComScoreFormatting.h"
+#include "SRGAnalyticsStreamStateMachine.h"
+#include "SRGAnalyticsStringCache.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PortableTestsCheck(condition) PortableTestsRecordCheck((condition), #condition, __FILE__, __LINE__)
+
+#define PortableTestsFuzzIterationCount 20000
+#define PortableTestsFuzzLengthMax 64
+
+#define PortableTestsCacheCapacity 256
+
+#define PortableTestsStateMachineSequenceLengthMax 32
+
+static FILE *s_file;
+static size_t s_checkCount;
+static size_t s_failureCount;
+
+static uint64_t s_randomState;
+
+static size_t s_releasedValueCount;
+
+static bool PortableTestsRecordCheck(bool condition, const char *expression, const char *fileName, int line)
+{
+    s_checkCount += 1;
+    if (! condition) {
+        s_failureCount += 1;
+        fprintf(s_file, "%s:%d: check failed: %s\n", fileName, line, expression);
+    }
+    return condition;
+}
+
+// Deterministic pseudo-random numbers (xorshift64*), so that failures can be reproduced
+static void PortableTestsSeedRandom(uint64_t seed)
+{
+    s_randomState = seed != 0 ? seed : 1;
+}
+
+static uint32_t PortableTestsRandom(uint32_t upperBound)
+{
+    s_randomState ^= s_randomState >> 12;
+    s_randomState ^= s_randomState << 25;
+    s_randomState ^= s_randomState >> 27;
+    return (uint32_t)((s_randomState * 2685821657736338717ull) >> 32) % upperBound;
+}
+
+static void PortableTestsPrintBytes(const char *label, const char *bytes, size_t length)
+{
+    fprintf(s_file, "    %s: ", label);
+    for (size_t i = 0; i < length; ++i) {
+        fprintf(s_file, "%02x", (unsigned char)bytes[i]);
+    }
+    fprintf(s_file, "\n");
+}
+
+static bool PortableTestsIsAlphanumeric(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+}
+
+// Reference implementation, made of the same successive passes as the original Foundation-based implementation (with
+// diacritics already removed), see `NSString_AnalyticsTestCase`
+static size_t PortableTestsReferenceComScoreFormatBytes(const char *input, size_t length, char *output)
+{
+    char *lowercaseString = malloc(length + 1);
+    for (size_t i = 0; i < length; ++i) {
+        char c = input[i];
+        lowercaseString[i] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+    }
+    
+    char *andString = malloc(3 * length + 1);
+    size_t andLength = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (lowercaseString[i] == '+' || lowercaseString[i] == '&') {
+            memcpy(&andString[andLength], "and", 3);
+            andLength += 3;
+        }
+        else {
+            andString[andLength++] = lowercaseString[i];
+        }
+    }
+    
+    // Replace runs of characters other than `a-z` and `0-9` with a single hyphen
+    char *hyphenatedString = malloc(andLength + 1);
+    size_t hyphenatedLength = 0;
+    for (size_t i = 0; i < andLength; ++i) {
+        if (PortableTestsIsAlphanumeric(andString[i])) {
+            hyphenatedString[hyphenatedLength++] = andString[i];
+        }
+        else if (i == 0 || PortableTestsIsAlphanumeric(andString[i - 1])) {
+            hyphenatedString[hyphenatedLength++] = '-';
+        }
+    }
+    
+    size_t start = 0;
+    while (start < hyphenatedLength && hyphenatedString[start] == '-') {
+        ++start;
+    }
+    size_t end = hyphenatedLength;
+    while (end > start && hyphenatedString[end - 1] == '-') {
+        --end;
+    }
+    
+    memcpy(output, &hyphenatedString[start], end - start);
+    output[end - start] = '\0';
+    
+    free(lowercaseString);
+    free(andString);
+    free(hyphenatedString);
+    return end - start;
+}
+
+static void PortableTestsCheckComScoreFormatting(const char *input, size_t length)
+{
+    size_t outputLength = SRGAnalyticsComScoreFormattedLengthMax(length);
+    char *output = malloc(outputLength);
+    char *referenceOutput = malloc(outputLength);
+    
+    size_t formattedLength = SRGAnalyticsComScoreFormatBytes(input, length, output);
+    size_t referenceFormattedLength = PortableTestsReferenceComScoreFormatBytes(input, length, referenceOutput);
+    
+    bool matching = PortableTestsCheck(formattedLength == referenceFormattedLength && memcmp(output, referenceOutput, formattedLength + 1) == 0);
+    if (! matching) {
+        PortableTestsPrintBytes("input", input, length);
+        PortableTestsPrintBytes("output", output, formattedLength);
+        PortableTestsPrintBytes("expected", referenceOutput, referenceFormattedLength);
+    }
+    
+    // Results only contain hyphen-separated runs of lowercase ASCII letters and digits
+    PortableTestsCheck(formattedLength < outputLength);
+    PortableTestsCheck(formattedLength == 0 || (output[0] != '-' && output[formattedLength - 1] != '-'));
+    for (size_t i = 0; i < formattedLength; ++i) {
+        PortableTestsCheck(PortableTestsIsAlphanumeric(output[i]) || (output[i] == '-' && output[i + 1] != '-'));
+    }
+    
+    free(output);
+    free(referenceOutput);
+}
+
+static void PortableTestsComScoreFormattingSamples(void)
+{
+    static const struct {
+        const char *input;
+        const char *expected;
+    } samples[] = {
+        { "", "" },
+        { "-", "" },
+        { "+", "and" },
+        { "a+b&c", "aandbandc" },
+        { "Ganz & Gloria", "ganz-and-gloria" },
+        { "Hello, world!", "hello-world" },
+        { "Strom: So speichern Akkus (7/8)", "strom-so-speichern-akkus-7-8" },
+        { "     trimmed!   ", "trimmed" },
+        { "News: \"Hello\"", "news-hello" },
+        { "Z\xc3\xbcrich \xe2\x80\x93 Gen\xc3\xa8ve", "z-rich-gen-ve" },                     // Diacritics not removed by the caller
+        { "emoji \xf0\x9f\x8e\x89 party", "emoji-party" },
+        { "\xff\xfe invalid \xc3", "invalid" }
+    };
+    
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); ++i) {
+        size_t length = strlen(samples[i].input);
+        char output[SRGAnalyticsComScoreFormattedLengthMax(64)];
+        size_t formattedLength = SRGAnalyticsComScoreFormatBytes(samples[i].input, length, output);
+        PortableTestsCheck(formattedLength == strlen(samples[i].expected) && strcmp(output, samples[i].expected) == 0);
+        PortableTestsCheckComScoreFormatting(samples[i].input, length);
+    }
+}
+
+// Append a random code point (U+0080 to U+10FFFF, surrogates excluded) encoded as UTF-8, and return the number of bytes written
+static size_t PortableTestsAppendRandomNonASCIICharacter(char *bytes)
+{
+    uint32_t codePoint;
+    do {
+        codePoint = 0x80 + PortableTestsRandom(0x110000 - 0x80);
+    } while (codePoint >= 0xd800 && codePoint <= 0xdfff);
+    
+    if (codePoint < 0x800) {
+        bytes[0] = (char)(0xc0 | (codePoint >> 6));
+        bytes[1] = (char)(0x80 | (codePoint & 0x3f));
+        return 2;
+    }
+    else if (codePoint < 0x10000) {
+        bytes[0] = (char)(0xe0 | (codePoint >> 12));
+        bytes[1] = (char)(0x80 | ((codePoint >> 6) & 0x3f));
+        bytes[2] = (char)(0x80 | (codePoint & 0x3f));
+        return 3;
+    }
+    else {
+        bytes[0] = (char)(0xf0 | (codePoint >> 18));
+        bytes[1] = (char)(0x80 | ((codePoint >> 12) & 0x3f));
+        bytes[2] = (char)(0x80 | ((codePoint >> 6) & 0x3f));
+        bytes[3] = (char)(0x80 | (codePoint & 0x3f));
+        return 4;
+    }
+}
+
+// Append an invalid UTF-8 sequence (stray continuation byte, truncated sequence, overlong encoding or invalid byte)
+static size_t PortableTestsAppendRandomInvalidSequence(char *bytes)
+{
+    switch (PortableTestsRandom(4)) {
+        case 0: {
+            bytes[0] = (char)(0x80 + PortableTestsRandom(0x40));
+            return 1;
+        }
+        case 1: {
+            bytes[0] = (char)(0xe0 + PortableTestsRandom(0x10));
+            bytes[1] = (char)(0x80 + PortableTestsRandom(0x40));
+            return 2;
+        }
+        case 2: {
+            bytes[0] = (char)0xc0;
+            bytes[1] = (char)(0x80 | ('A' & 0x3f));
+            return 2;
+        }
+        default: {
+            bytes[0] = (char)(0xf8 + PortableTestsRandom(0x08));
+            return 1;
+        }
+    }
+}
+
+typedef enum {
+    PortableTestsInputKindASCII = 0,
+    PortableTestsInputKindNonASCII,
+    PortableTestsInputKindInvalidUTF8
+} PortableTestsInputKind;
+
+static void PortableTestsComScoreFormattingFuzz(PortableTestsInputKind kind)
+{
+    // Room for the last character appended
+    char input[PortableTestsFuzzLengthMax + 4];
+    
+    PortableTestsSeedRandom(42 + kind);
+    for (size_t iteration = 0; iteration < PortableTestsFuzzIterationCount; ++iteration) {
+        size_t targetLength = PortableTestsRandom(PortableTestsFuzzLengthMax + 1);
+        size_t length = 0;
+        while (length < targetLength) {
+            // Mostly ASCII (including control characters and NUL), as titles are
+            uint32_t choice = PortableTestsRandom(4);
+            if (kind == PortableTestsInputKindNonASCII && choice == 0) {
+                length += PortableTestsAppendRandomNonASCIICharacter(&input[length]);
+            }
+            else if (kind == PortableTestsInputKindInvalidUTF8 && choice == 0) {
+                length += PortableTestsAppendRandomInvalidSequence(&input[length]);
+            }
+            else {
+                input[length++] = (char)PortableTestsRandom(0x80);
+            }
+        }
+        PortableTestsCheckComScoreFormatting(input, length);
+    }
+}
+
+static void PortableTestsReleaseValue(void *value)
+{
+    (void)value;
+    s_releasedValueCount += 1;
+}
+
+static void *PortableTestsCacheValue(size_t i)
+{
+    return (void *)(uintptr_t)(i + 1);
+}
+
+static size_t PortableTestsCacheKey(size_t i, char *key)
+{
+    return (size_t)sprintf(key, "key-%zu", i);
+}
+
+static SRGAnalyticsStringCache *PortableTestsFilledCache(size_t count)
+{
+    SRGAnalyticsStringCache *cache = SRGAnalyticsStringCacheCreate(PortableTestsCacheCapacity, PortableTestsReleaseValue);
+    for (size_t i = 0; i < count; ++i) {
+        char key[32];
+        size_t length = PortableTestsCacheKey(i, key);
+        SRGAnalyticsStringCacheSet(cache, key, length, PortableTestsCacheValue(i));
+    }
+    return cache;
+}
+
+static bool PortableTestsCacheContains(SRGAnalyticsStringCache *cache, size_t i)
+{
+    char key[32];
+    size_t length = PortableTestsCacheKey(i, key);
+    return SRGAnalyticsStringCacheGet(cache, key, length) == PortableTestsCacheValue(i);
+}
+
+static void PortableTestsStringCacheCapacity(void)
+{
+    s_releasedValueCount = 0;
+    
+    // Full cache: nothing evicted
+    SRGAnalyticsStringCache *cache = PortableTestsFilledCache(PortableTestsCacheCapacity);
+    PortableTestsCheck(SRGAnalyticsStringCacheCount(cache) == PortableTestsCacheCapacity);
+    PortableTestsCheck(s_releasedValueCount == 0);
+    SRGAnalyticsStringCacheDestroy(cache);
+    PortableTestsCheck(s_releasedValueCount == PortableTestsCacheCapacity);
+    
+    // One entry more: the least recently used one is evicted
+    s_releasedValueCount = 0;
+    cache = PortableTestsFilledCache(PortableTestsCacheCapacity + 1);
+    PortableTestsCheck(SRGAnalyticsStringCacheCount(cache) == PortableTestsCacheCapacity);
+    PortableTestsCheck(s_releasedValueCount == 1);
+    PortableTestsCheck(! PortableTestsCacheContains(cache, 0));
+    for (size_t i = 1; i <= PortableTestsCacheCapacity; ++i) {
+        PortableTestsCheck(PortableTestsCacheContains(cache, i));
+    }
+    SRGAnalyticsStringCacheDestroy(cache);
+    
+    // Looking up an entry makes it the most recently used one
+    cache = PortableTestsFilledCache(PortableTestsCacheCapacity);
+    PortableTestsCheck(PortableTestsCacheContains(cache, 0));
+    
+    char key[32];
+    size_t length = PortableTestsCacheKey(PortableTestsCacheCapacity, key);
+    SRGAnalyticsStringCacheSet(cache, key, length, PortableTestsCacheValue(PortableTestsCacheCapacity));
+    PortableTestsCheck(PortableTestsCacheContains(cache, 0));
+    PortableTestsCheck(! PortableTestsCacheContains(cache, 1));
+    PortableTestsCheck(PortableTestsCacheContains(cache, 2));
+    SRGAnalyticsStringCacheDestroy(cache);
+}
+
+static void PortableTestsStringCacheKeys(void)
+{
+    s_releasedValueCount = 0;
+    
+    SRGAnalyticsStringCache *cache = SRGAnalyticsStringCacheCreate(4, PortableTestsReleaseValue);
+    PortableTestsCheck(SRGAnalyticsStringCacheGet(cache, "", 0) == NULL);
+    
+    // Empty keys, prefixes and keys containing NUL bytes are distinct
+    SRGAnalyticsStringCacheSet(cache, "", 0, PortableTestsCacheValue(0));
+    SRGAnalyticsStringCacheSet(cache, "a", 1, PortableTestsCacheValue(1));
+    SRGAnalyticsStringCacheSet(cache, "a\0b", 3, PortableTestsCacheValue(2));
+    PortableTestsCheck(SRGAnalyticsStringCacheGet(cache, "", 0) == PortableTestsCacheValue(0));
+    PortableTestsCheck(SRGAnalyticsStringCacheGet(cache, "a", 1) == PortableTestsCacheValue(1));
+    PortableTestsCheck(SRGAnalyticsStringCacheGet(cache, "a\0b", 3) == PortableTestsCacheValue(2));
+    PortableTestsCheck(SRGAnalyticsStringCacheGet(cache, "a\0", 2) == NULL);
+    
+    // Replacing a value releases the previous one
+    SRGAnalyticsStringCacheSet(cache, "a", 1, PortableTestsCacheValue(3));
+    PortableTestsCheck(SRGAnalyticsStringCacheGet(cache, "a", 1) == PortableTestsCacheValue(3));
+    PortableTestsCheck(SRGAnalyticsStringCacheCount(cache) == 3);
+    PortableTestsCheck(s_releasedValueCount == 1);
+    
+    SRGAnalyticsStringCacheDestroy(cache);
+    PortableTestsCheck(s_releasedValueCount == 4);
+    
+    PortableTestsCheck(SRGAnalyticsStringCacheCreate(0, NULL) == NULL);
+}
+
+// Compare the cache with a naive model (keys ordered from the most to the least recently used) for random operations
+static void PortableTestsStringCacheFuzz(size_t capacity)
+{
+    size_t *model = malloc(capacity * sizeof(size_t));
+    size_t modelCount = 0;
+    size_t modelEvictionCount = 0;
+    
+    s_releasedValueCount = 0;
+    SRGAnalyticsStringCache *cache = SRGAnalyticsStringCacheCreate(capacity, PortableTestsReleaseValue);
+    
+    PortableTestsSeedRandom(capacity);
+    for (size_t iteration = 0; iteration < PortableTestsFuzzIterationCount; ++iteration) {
+        size_t i = PortableTestsRandom((uint32_t)(3 * capacity));
+        char key[32];
+        size_t length = PortableTestsCacheKey(i, key);
+        
+        size_t position = 0;
+        while (position < modelCount && model[position] != i) {
+            ++position;
+        }
+        bool found = (position < modelCount);
+        
+        if (PortableTestsRandom(2) == 0) {
+            void *value = SRGAnalyticsStringCacheGet(cache, key, length);
+            if (! PortableTestsCheck(value == (found ? PortableTestsCacheValue(i) : NULL))) {
+                break;
+            }
+            if (! found) {
+                continue;
+            }
+        }
+        else {
+            SRGAnalyticsStringCacheSet(cache, key, length, PortableTestsCacheValue(i));
+            if (! found) {
+                if (modelCount == capacity) {
+                    modelEvictionCount += 1;
+                    position = capacity - 1;
+                }
+                else {
+                    position = modelCount++;
+                }
+            }
+        }
+        
+        // Move to the front
+        memmove(&model[1], &model[0], position * sizeof(size_t));
+        model[0] = i;
+    }
+    
+    PortableTestsCheck(SRGAnalyticsStringCacheCount(cache) == modelCount);
+    PortableTestsCheck(s_releasedValueCount == modelEvictionCount);
+    for (size_t position = 0; position < modelCount; ++position) {
+        char key[32];
+        size_t length = PortableTestsCacheKey(model[position], key);
+        PortableTestsCheck(SRGAnalyticsStringCacheGet(cache, key, length) == PortableTestsCacheValue(model[position]));
+    }
+    
+    SRGAnalyticsStringCacheDestroy(cache);
+    free(model);
+}
+
+// Reference implementation of the stream decisions, written like the original Objective-C implementation (implicit play
+// made by a recursive update, allowed transitions listed for each state)
+typedef struct {
+    SRGAnalyticsStreamMachineState tagCommanderState;
+    bool comScoreSessionAlive;
+    
+    const char *tagCommanderEventNames[PortableTestsStateMachineSequenceLengthMax * SRGAnalyticsStreamMachineEventCountMax];
+    size_t tagCommanderCount;
+    SRGAnalyticsStreamMachineComScoreEvent comScoreEvents[PortableTestsStateMachineSequenceLengthMax * SRGAnalyticsStreamMachineEventCountMax];
+    size_t comScoreCount;
+} PortableTestsReferenceMachine;
+
+static const char *PortableTestsReferenceTagCommanderEventName(SRGAnalyticsStreamMachineState state)
+{
+    switch (state) {
+        case SRGAnalyticsStreamMachineStatePlaying: {
+            return "play";
+        }
+        case SRGAnalyticsStreamMachineStatePaused: {
+            return "pause";
+        }
+        case SRGAnalyticsStreamMachineStateSeeking: {
+            return "seek";
+        }
+        case SRGAnalyticsStreamMachineStateStopped: {
+            return "stop";
+        }
+        case SRGAnalyticsStreamMachineStateEnded: {
+            return "eof";
+        }
+        default: {
+            return NULL;
+        }
+    }
+}
+
+static bool PortableTestsReferenceTagCommanderTransitionAllowed(SRGAnalyticsStreamMachineState previousState, SRGAnalyticsStreamMachineState state)
+{
+    switch (previousState) {
+        case SRGAnalyticsStreamMachineStatePlaying: {
+            return state == SRGAnalyticsStreamMachineStatePaused || state == SRGAnalyticsStreamMachineStateSeeking
+                || state == SRGAnalyticsStreamMachineStateStopped || state == SRGAnalyticsStreamMachineStateEnded;
+        }
+        case SRGAnalyticsStreamMachineStatePaused: {
+            return state == SRGAnalyticsStreamMachineStatePlaying || state == SRGAnalyticsStreamMachineStateSeeking
+                || state == SRGAnalyticsStreamMachineStateStopped || state == SRGAnalyticsStreamMachineStateEnded;
+        }
+        case SRGAnalyticsStreamMachineStateSeeking: {
+            return state == SRGAnalyticsStreamMachineStatePlaying || state == SRGAnalyticsStreamMachineStatePaused
+                || state == SRGAnalyticsStreamMachineStateStopped || state == SRGAnalyticsStreamMachineStateEnded;
+        }
+        case SRGAnalyticsStreamMachineStateStopped:
+        case SRGAnalyticsStreamMachineStateEnded: {
+            return state == SRGAnalyticsStreamMachineStatePlaying;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+static void PortableTestsReferenceUpdateTagCommander(PortableTestsReferenceMachine *machine, SRGAnalyticsStreamMachineState state)
+{
+    if (machine->tagCommanderState == SRGAnalyticsStreamMachineStateEnded
+            && (state == SRGAnalyticsStreamMachineStatePaused || state == SRGAnalyticsStreamMachineStateSeeking)) {
+        PortableTestsReferenceUpdateTagCommander(machine, SRGAnalyticsStreamMachineStatePlaying);
+    }
+    
+    const char *name = PortableTestsReferenceTagCommanderEventName(state);
+    if (! name) {
+        return;
+    }
+    
+    if (! PortableTestsReferenceTagCommanderTransitionAllowed(machine->tagCommanderState, state)) {
+        return;
+    }
+    
+    machine->tagCommanderState = state;
+    machine->tagCommanderEventNames[machine->tagCommanderCount++] = name;
+}
+
+static void PortableTestsReferenceUpdateComScore(PortableTestsReferenceMachine *machine, SRGAnalyticsStreamMachineState state)
+{
+    if (! machine->comScoreSessionAlive
+            && (state == SRGAnalyticsStreamMachineStatePaused || state == SRGAnalyticsStreamMachineStateSeeking)) {
+        PortableTestsReferenceUpdateComScore(machine, SRGAnalyticsStreamMachineStatePlaying);
+    }
+    
+    switch (state) {
+        case SRGAnalyticsStreamMachineStatePlaying: {
+            machine->comScoreEvents[machine->comScoreCount++] = SRGAnalyticsStreamMachineComScoreEventPlay;
+            machine->comScoreSessionAlive = true;
+            break;
+        }
+        case SRGAnalyticsStreamMachineStatePaused:
+        case SRGAnalyticsStreamMachineStateSeeking: {
+            machine->comScoreEvents[machine->comScoreCount++] = SRGAnalyticsStreamMachineComScoreEventPause;
+            break;
+        }
+        case SRGAnalyticsStreamMachineStateStopped:
+        case SRGAnalyticsStreamMachineStateEnded: {
+            machine->comScoreEvents[machine->comScoreCount++] = SRGAnalyticsStreamMachineComScoreEventEnd;
+            machine->comScoreSessionAlive = false;
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+// Update a machine and a reference machine with the same configuration, and check that they make the same decisions
+static void PortableTestsCheckStateMachineUpdate(SRGAnalyticsStreamMachineState initialState, bool comScoreSessionAlive, SRGAnalyticsStreamMachineState state)
+{
+    SRGAnalyticsStreamMachine machine = { initialState, comScoreSessionAlive };
+    PortableTestsReferenceMachine referenceMachine = { initialState, comScoreSessionAlive };
+    
+    SRGAnalyticsStreamMachineState states[SRGAnalyticsStreamMachineEventCountMax];
+    size_t tagCommanderCount = SRGAnalyticsStreamMachineUpdateTagCommander(&machine, state, states);
+    PortableTestsReferenceUpdateTagCommander(&referenceMachine, state);
+    
+    SRGAnalyticsStreamMachineComScoreEvent events[SRGAnalyticsStreamMachineEventCountMax];
+    size_t comScoreCount = SRGAnalyticsStreamMachineUpdateComScore(&machine, state, events);
+    PortableTestsReferenceUpdateComScore(&referenceMachine, state);
+    
+    bool success = PortableTestsCheck(tagCommanderCount == referenceMachine.tagCommanderCount)
+        & PortableTestsCheck(comScoreCount == referenceMachine.comScoreCount)
+        & PortableTestsCheck(machine.tagCommanderState == referenceMachine.tagCommanderState)
+        & PortableTestsCheck(machine.comScoreSessionAlive == referenceMachine.comScoreSessionAlive);
+    if (success) {
+        for (size_t i = 0; i < tagCommanderCount; ++i) {
+            const char *name = SRGAnalyticsStreamMachineTagCommanderEventName(SRGAnalyticsStreamMachineTagCommanderEventForState(states[i]));
+            success &= PortableTestsCheck(strcmp(name, referenceMachine.tagCommanderEventNames[i]) == 0);
+        }
+        for (size_t i = 0; i < comScoreCount; ++i) {
+            success &= PortableTestsCheck(events[i] == referenceMachine.comScoreEvents[i]);
+        }
+    }
+    
+    if (! success) {
+        fprintf(s_file, "    from TagCommander state %d, comScore session %s, to state %d\n", initialState, comScoreSessionAlive ? "alive" : "closed", state);
+    }
+}
+
+// Every (TagCommander state, comScore session) configuration, updated with every state, invalid ones included
+static void PortableTestsStateMachineTable(void)
+{
+    for (int initialState = SRGAnalyticsStreamMachineStatePlaying; initialState < SRGAnalyticsStreamMachineStateCount; ++initialState) {
+        for (int alive = 0; alive < 2; ++alive) {
+            for (int state = SRGAnalyticsStreamMachineStateNone; state <= SRGAnalyticsStreamMachineStateCount; ++state) {
+                PortableTestsCheckStateMachineUpdate(initialState, alive, state);
+            }
+        }
+    }
+}
+
+static void PortableTestsStateMachineImplicitPlay(void)
+{
+    SRGAnalyticsStreamMachineState states[SRGAnalyticsStreamMachineEventCountMax];
+    SRGAnalyticsStreamMachineComScoreEvent events[SRGAnalyticsStreamMachineEventCountMax];
+    
+    // Pausing or seeking before playing opens both sessions first
+    SRGAnalyticsStreamMachineState implicitStates[] = { SRGAnalyticsStreamMachineStatePaused, SRGAnalyticsStreamMachineStateSeeking };
+    for (size_t i = 0; i < sizeof(implicitStates) / sizeof(implicitStates[0]); ++i) {
+        SRGAnalyticsStreamMachine machine;
+        SRGAnalyticsStreamMachineInit(&machine);
+        PortableTestsCheck(machine.tagCommanderState == SRGAnalyticsStreamMachineStateEnded);
+        PortableTestsCheck(! machine.comScoreSessionAlive);
+        
+        PortableTestsCheck(SRGAnalyticsStreamMachineUpdateTagCommander(&machine, implicitStates[i], states) == 2);
+        PortableTestsCheck(states[0] == SRGAnalyticsStreamMachineStatePlaying);
+        PortableTestsCheck(states[1] == implicitStates[i]);
+        PortableTestsCheck(machine.tagCommanderState == implicitStates[i]);
+        
+        PortableTestsCheck(SRGAnalyticsStreamMachineUpdateComScore(&machine, implicitStates[i], events) == 2);
+        PortableTestsCheck(events[0] == SRGAnalyticsStreamMachineComScoreEventPlay);
+        PortableTestsCheck(events[1] == SRGAnalyticsStreamMachineComScoreEventPause);
+        PortableTestsCheck(machine.comScoreSessionAlive);
+    }
+    
+    // Same after a stream has ended
+    SRGAnalyticsStreamMachine machine = { SRGAnalyticsStreamMachineStateEnded, false };
+    PortableTestsCheck(SRGAnalyticsStreamMachineUpdateTagCommander(&machine, SRGAnalyticsStreamMachineStateSeeking, states) == 2);
+    PortableTestsCheck(states[0] == SRGAnalyticsStreamMachineStatePlaying);
+    PortableTestsCheck(states[1] == SRGAnalyticsStreamMachineStateSeeking);
+    
+    // No implicit TagCommander play after a stop (the pause is rejected), but comScore opens a new session
+    machine = (SRGAnalyticsStreamMachine){ SRGAnalyticsStreamMachineStateStopped, false };
+    PortableTestsCheck(SRGAnalyticsStreamMachineUpdateTagCommander(&machine, SRGAnalyticsStreamMachineStatePaused, states) == 0);
+    PortableTestsCheck(machine.tagCommanderState == SRGAnalyticsStreamMachineStateStopped);
+    PortableTestsCheck(SRGAnalyticsStreamMachineUpdateComScore(&machine, SRGAnalyticsStreamMachineStatePaused, events) == 2);
+    PortableTestsCheck(events[0] == SRGAnalyticsStreamMachineComScoreEventPlay);
+    PortableTestsCheck(events[1] == SRGAnalyticsStreamMachineComScoreEventPause);
+    
+    // No implicit play when a session is already open
+    machine = (SRGAnalyticsStreamMachine){ SRGAnalyticsStreamMachineStatePlaying, true };
+    PortableTestsCheck(SRGAnalyticsStreamMachineUpdateTagCommander(&machine, SRGAnalyticsStreamMachineStatePaused, states) == 1);
+    PortableTestsCheck(states[0] == SRGAnalyticsStreamMachineStatePaused);
+    PortableTestsCheck(SRGAnalyticsStreamMachineUpdateComScore(&machine, SRGAnalyticsStreamMachineStatePaused, events) == 1);
+    PortableTestsCheck(events[0] == SRGAnalyticsStreamMachineComScoreEventPause);
+}
+
+static void PortableTestsStateMachineRejectedTransitions(void)
+{
+    struct {
+        SRGAnalyticsStreamMachineState previousState;
+        SRGAnalyticsStreamMachineState state;
+    } rejectedTransitions[] = {
+        { SRGAnalyticsStreamMachineStatePlaying, SRGAnalyticsStreamMachineStatePlaying },
+        { SRGAnalyticsStreamMachineStatePaused, SRGAnalyticsStreamMachineStatePaused },
+        { SRGAnalyticsStreamMachineStateSeeking, SRGAnalyticsStreamMachineStateSeeking },
+        { SRGAnalyticsStreamMachineStateStopped, SRGAnalyticsStreamMachineStatePaused },
+        { SRGAnalyticsStreamMachineStateStopped, SRGAnalyticsStreamMachineStateSeeking },
+        { SRGAnalyticsStreamMachineStateStopped, SRGAnalyticsStreamMachineStateStopped },
+        { SRGAnalyticsStreamMachineStateStopped, SRGAnalyticsStreamMachineStateEnded },
+        { SRGAnalyticsStreamMachineStateEnded, SRGAnalyticsStreamMachineStateStopped },
+        { SRGAnalyticsStreamMachineStateEnded, SRGAnalyticsStreamMachineStateEnded }
+    };
+    
+    SRGAnalyticsStreamMachineState states[SRGAnalyticsStreamMachineEventCountMax];
+    for (size_t i = 0; i < sizeof(rejectedTransitions) / sizeof(rejectedTransitions[0]); ++i) {
+        SRGAnalyticsStreamMachine machine = { rejectedTransitions[i].previousState, true };
+        PortableTestsCheck(SRGAnalyticsStreamMachineUpdateTagCommander(&machine, rejectedTransitions[i].state, states) == 0);
+        PortableTestsCheck(machine.tagCommanderState == rejectedTransitions[i].previousState);
+    }
+    
+    // Invalid states are ignored by both backends
+    SRGAnalyticsStreamMachineState invalidStates[] = { SRGAnalyticsStreamMachineStateNone, SRGAnalyticsStreamMachineStateCount };
+    for (size_t i = 0; i < sizeof(invalidStates) / sizeof(invalidStates[0]); ++i) {
+        for (int alive = 0; alive < 2; ++alive) {
+            SRGAnalyticsStreamMachine machine = { SRGAnalyticsStreamMachineStatePlaying, alive };
+            SRGAnalyticsStreamMachineComScoreEvent events[SRGAnalyticsStreamMachineEventCountMax];
+            PortableTestsCheck(SRGAnalyticsStreamMachineUpdateTagCommander(&machine, invalidStates[i], states) == 0);
+            PortableTestsCheck(SRGAnalyticsStreamMachineUpdateComScore(&machine, invalidStates[i], events) == 0);
+            PortableTestsCheck(machine.tagCommanderState == SRGAnalyticsStreamMachineStatePlaying);
+            PortableTestsCheck(machine.comScoreSessionAlive == alive);
+        }
+    }
+}
+
+// Compare replays of random state sequences with the reference implementation
+static void PortableTestsStateMachineFuzz(void)
+{
+    SRGAnalyticsStreamMachineState sequence[PortableTestsStateMachineSequenceLengthMax];
+    SRGAnalyticsStreamMachineTagCommanderEvent tagCommanderEvents[PortableTestsStateMachineSequenceLengthMax * SRGAnalyticsStreamMachineEventCountMax];
+    SRGAnalyticsStreamMachineComScoreEvent comScoreEvents[PortableTestsStateMachineSequenceLengthMax * SRGAnalyticsStreamMachineEventCountMax];
+    
+    PortableTestsSeedRandom(5);
+    for (size_t iteration = 0; iteration < PortableTestsFuzzIterationCount; ++iteration) {
+        size_t length = 1 + PortableTestsRandom(PortableTestsStateMachineSequenceLengthMax);
+        
+        PortableTestsReferenceMachine referenceMachine = { SRGAnalyticsStreamMachineStateEnded, false };
+        for (size_t i = 0; i < length; ++i) {
+            sequence[i] = PortableTestsRandom(SRGAnalyticsStreamMachineStateCount + 1);
+            PortableTestsReferenceUpdateTagCommander(&referenceMachine, sequence[i]);
+            PortableTestsReferenceUpdateComScore(&referenceMachine, sequence[i]);
+        }
+        
+        size_t tagCommanderCount = 0;
+        size_t comScoreCount = 0;
+        SRGAnalyticsStreamMachineReplay(sequence, length, tagCommanderEvents, &tagCommanderCount, comScoreEvents, &comScoreCount);
+        
+        bool success = PortableTestsCheck(tagCommanderCount == referenceMachine.tagCommanderCount)
+            & PortableTestsCheck(comScoreCount == referenceMachine.comScoreCount);
+        if (success) {
+            for (size_t i = 0; i < tagCommanderCount; ++i) {
+                success &= PortableTestsCheck(strcmp(SRGAnalyticsStreamMachineTagCommanderEventName(tagCommanderEvents[i]), referenceMachine.tagCommanderEventNames[i]) == 0);
+            }
+            success &= PortableTestsCheck(memcmp(comScoreEvents, referenceMachine.comScoreEvents, comScoreCount * sizeof(SRGAnalyticsStreamMachineComScoreEvent)) == 0);
+        }
+        
+        if (! success) {
+            fprintf(s_file, "    sequence:");
+            for (size_t i = 0; i < length; ++i) {
+                fprintf(s_file, " %d", sequence[i]);
+            }
+            fprintf(s_file, "\n");
+            break;
+        }
+    }
+}
+
+static void PortableTestsRunTest(const char *name, void (*test)(void))
+{
+    size_t failureCount = s_failureCount;
+    size_t checkCount = s_checkCount;
+    test();
+    fprintf(s_file, "%s %s (%zu checks)\n", (s_failureCount == failureCount) ? "PASS" : "FAIL", name, s_checkCount - checkCount);
+}
+
+static void PortableTestsComScoreFormattingASCIIFuzz(void)
+{
+    PortableTestsComScoreFormattingFuzz(PortableTestsInputKindASCII);
+}
+
+static void PortableTestsComScoreFormattingNonASCIIFuzz(void)
+{
+    PortableTestsComScoreFormattingFuzz(PortableTestsInputKindNonASCII);
+}
+
+static void PortableTestsComScoreFormattingInvalidUTF8Fuzz(void)
+{
+    PortableTestsComScoreFormattingFuzz(PortableTestsInputKindInvalidUTF8);
+}
+
+static void PortableTestsStringCacheSmallFuzz(void)
+{
+    PortableTestsStringCacheFuzz(8);
+}
+
+static void PortableTestsStringCacheLargeFuzz(void)
+{
+    PortableTestsStringCacheFuzz(PortableTestsCacheCapacity);
+}
+
+size_t PortableTestsRun(FILE *file)
+{
+    s_file = file;
+    s_checkCount = 0;
+    s_failureCount = 0;
+    
+    PortableTestsRunTest("comscore_format/samples", PortableTestsComScoreFormattingSamples);
+    PortableTestsRunTest("comscore_format/fuzz_ascii", PortableTestsComScoreFormattingASCIIFuzz);
+    PortableTestsRunTest("comscore_format/fuzz_non_ascii", PortableTestsComScoreFormattingNonASCIIFuzz);
+    PortableTestsRunTest("comscore_format/fuzz_invalid_utf8", PortableTestsComScoreFormattingInvalidUTF8Fuzz);
+    
+    PortableTestsRunTest("string_cache/capacity", PortableTestsStringCacheCapacity);
+    PortableTestsRunTest("string_cache/keys", PortableTestsStringCacheKeys);
+    PortableTestsRunTest("string_cache/fuzz_small", PortableTestsStringCacheSmallFuzz);
+    PortableTestsRunTest("string_cache/fuzz_large", PortableTestsStringCacheLargeFuzz);
+    
+    PortableTestsRunTest("state_machine/table", PortableTestsStateMachineTable);
+    PortableTestsRunTest("state_machine/implicit_play", PortableTestsStateMachineImplicitPlay);
+    PortableTestsRunTest("state_machine/rejected_transitions", PortableTestsStateMachineRejectedTransitions);
+    PortableTestsRunTest("state_machine/fuzz", PortableTestsStateMachineFuzz);
+    
+    fprintf(file, "%zu checks, %zu failures\n", s_checkCount, s_failureCount);
+    return s_failureCount;
+}
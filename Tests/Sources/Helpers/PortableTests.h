@@ -0,0 +1,28 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#ifndef PortableTests_h
+#define PortableTests_h
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Run tests for the portable (C) parts of the tracking pipeline, printing failures and a summary to the specified file.
+ *
+ *  @return The number of failed checks.
+ */
+size_t PortableTestsRun(FILE *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PortableTests_h */
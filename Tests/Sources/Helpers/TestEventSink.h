@@ -0,0 +1,20 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <SRGAnalytics/SRGAnalytics.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Sink calling a block for each event received.
+@interface TestEventSink : NSObject <SRGAnalyticsEventSink>
+
+- (instancetype)initWithBlock:(void (^)(SRGAnalyticsEvent *event))block;
+
+@property (nonatomic, copy) void (^block)(SRGAnalyticsEvent *event);
+
+@end
+
+NS_ASSUME_NONNULL_END
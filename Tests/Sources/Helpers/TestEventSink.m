@@ -0,0 +1,24 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "TestEventSink.h"
+
+@implementation TestEventSink
+
+- (instancetype)initWithBlock:(void (^)(SRGAnalyticsEvent *))block
+{
+    if (self = [super init]) {
+        self.block = block;
+    }
+    return self;
+}
+
+- (void)tracker:(SRGAnalyticsTracker *)tracker didSendEvent:(SRGAnalyticsEvent *)event
+{
+    self.block(event);
+}
+
+@end
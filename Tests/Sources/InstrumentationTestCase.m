@@ -0,0 +1,223 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+#import "SRGAnalyticsInstrumentation+Private.h"
+#import "SRGAnalyticsStreamTracker+Private.h"
+#import "SRGAnalyticsTracker+Private.h"
+
+@interface InstrumentationTestCase : AnalyticsTestCase
+
+@end
+
+@implementation InstrumentationTestCase
+
+#if SRG_ANALYTICS_INSTRUMENTATION
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    [SRGAnalyticsTracker.sharedTracker resetInstrumentation];
+}
+
+#pragma mark Tests
+
+- (void)testPageView
+{
+    [self expectationForPageViewEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        return YES;
+    }];
+    
+    [SRGAnalyticsTracker.sharedTracker trackPageViewWithTitle:@"Page view" levels:@[ @"Level 1" ]];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    SRGAnalyticsInstrumentationSnapshot *snapshot = SRGAnalyticsTracker.sharedTracker.instrumentationSnapshot;
+    XCTAssertEqual([snapshot valueForCounter:SRGAnalyticsInstrumentationCounterPageViews], 1);
+    XCTAssertEqual([snapshot valueForCounter:SRGAnalyticsInstrumentationCounterDroppedEvents], 0);
+    XCTAssertGreaterThanOrEqual([snapshot sampleCountForStage:SRGAnalyticsInstrumentationStageLabelBuilding], 1);
+    XCTAssertGreaterThan([snapshot totalDurationForStage:SRGAnalyticsInstrumentationStageLabelBuilding], 0.);
+}
+
+- (void)testDroppedEvents
+{
+    // Events with missing titles or names are dropped synchronously
+    [SRGAnalyticsTracker.sharedTracker trackPageViewWithTitle:@"" levels:nil];
+    [SRGAnalyticsTracker.sharedTracker trackHiddenEventWithName:@""];
+    
+    SRGAnalyticsInstrumentationSnapshot *snapshot = SRGAnalyticsTracker.sharedTracker.instrumentationSnapshot;
+    XCTAssertEqual([snapshot valueForCounter:SRGAnalyticsInstrumentationCounterDroppedEvents], 2);
+    XCTAssertEqual([snapshot valueForCounter:SRGAnalyticsInstrumentationCounterPageViews], 0);
+    XCTAssertEqual([snapshot valueForCounter:SRGAnalyticsInstrumentationCounterHiddenEvents], 0);
+}
+
+- (void)testSaturatedEventQueue
+{
+    SRGAnalyticsTracker *tracker = SRGAnalyticsTracker.sharedTracker;
+    
+    // Block the event queue so that events pile up
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [tracker performEventBlock:^{
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    }];
+    
+    // The caller is never blocked. Events in excess are dropped
+    for (NSInteger i = 0; i < 200; ++i) {
+        [tracker trackHiddenEventWithName:@"Hidden event"];
+    }
+    
+    SRGAnalyticsInstrumentationSnapshot *snapshot = tracker.instrumentationSnapshot;
+    XCTAssertGreaterThanOrEqual([snapshot valueForCounter:SRGAnalyticsInstrumentationCounterDroppedEvents], 200 - 127);
+    
+    // Let pending events be processed so that they do not interfere with other tests
+    dispatch_semaphore_signal(semaphore);
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testSaturatedEventQueueStreamEvents
+{
+    SRGAnalyticsTracker *tracker = SRGAnalyticsTracker.sharedTracker;
+    
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [tracker performEventBlock:^{
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    }];
+    
+    for (NSInteger i = 0; i < 200; ++i) {
+        [tracker trackHiddenEventWithName:@"Hidden event"];
+    }
+    
+    // Stream events are never dropped, even when the event queue is saturated
+    __block BOOL playReceived = NO;
+    [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        if ([event isEqualToString:@"play"]) {
+            playReceived = YES;
+            return NO;
+        }
+        else {
+            XCTAssertTrue(playReceived);
+            return [event isEqualToString:@"stop"];
+        }
+    }];
+    [self expectationForComScoreHiddenEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        return [labels[@"ns_st_ev"] isEqualToString:@"end"];
+    }];
+    
+    SRGAnalyticsStreamTracker *streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:NO];
+    [streamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:nil];
+    [streamTracker updateWithStreamState:SRGAnalyticsStreamStateStopped position:0. labels:nil];
+    
+    dispatch_semaphore_signal(semaphore);
+    [self waitForExpectationsWithTimeout:20. handler:nil];
+}
+
+- (void)testStagedStartup
+{
+    SRGAnalyticsConfiguration *configuration = [SRGAnalyticsTracker.sharedTracker.configuration copy];
+    configuration.startupStaged = YES;
+    
+    [self expectationForHiddenEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        return [labels[@"event_name"] isEqualToString:@"Hidden event"];
+    }];
+    
+    // This test requires a brand new analytics tracker
+    SRGAnalyticsTracker *analyticsTracker = [SRGAnalyticsTracker new];
+    [analyticsTracker startWithConfiguration:configuration];
+    [analyticsTracker trackHiddenEventWithName:@"Hidden event"];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    SRGAnalyticsInstrumentationSnapshot *snapshot = analyticsTracker.instrumentationSnapshot;
+    XCTAssertEqual([snapshot sampleCountForStage:SRGAnalyticsInstrumentationStageStartup], 1);
+    XCTAssertEqual([snapshot sampleCountForStage:SRGAnalyticsInstrumentationStageTagCommanderStartup], 1);
+    XCTAssertEqual([snapshot sampleCountForStage:SRGAnalyticsInstrumentationStageComScoreStartup], 1);
+    XCTAssertEqual([snapshot sampleCountForStage:SRGAnalyticsInstrumentationStageNetMetrixStartup], 1);
+    XCTAssertEqual([snapshot sampleCountForStage:SRGAnalyticsInstrumentationStageApplicationListStartup], 1);
+}
+
+- (void)testRejectedStreamTransitions
+{
+    SRGAnalyticsManualClock *clock = [[SRGAnalyticsManualClock alloc] init];
+    SRGAnalyticsHeartbeatScheduler *heartbeatScheduler = [[SRGAnalyticsHeartbeatScheduler alloc] initWithClock:clock interval:30. tolerance:3. sendBlock:^(NSArray<SRGAnalyticsLabelSet *> * _Nonnull labelSets) {}];
+    SRGAnalyticsStreamTracker *streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:NO heartbeatScheduler:heartbeatScheduler];
+    
+    [streamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:nil];
+    [streamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:nil];
+    [streamTracker updateWithStreamState:SRGAnalyticsStreamStateStopped position:0. labels:nil];
+    [streamTracker updateWithStreamState:SRGAnalyticsStreamStatePaused position:0. labels:nil];
+    
+    SRGAnalyticsInstrumentationSnapshot *snapshot = SRGAnalyticsTracker.sharedTracker.instrumentationSnapshot;
+    XCTAssertEqual([snapshot valueForCounter:SRGAnalyticsInstrumentationCounterStreamEvents], 2);
+    XCTAssertEqual([snapshot valueForCounter:SRGAnalyticsInstrumentationCounterRejectedStreamTransitions], 2);
+}
+
+- (void)testConcurrentAccumulation
+{
+    static const size_t kThreadCount = 8;
+    static const size_t kIterationCount = 10000;
+    
+    dispatch_apply(kThreadCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        for (size_t i = 0; i < kIterationCount; ++i) {
+            SRGAnalyticsInstrumentationAddToCounter(SRGAnalyticsInstrumentationCounterHeartbeats, 1);
+            SRGAnalyticsInstrumentationRecordDuration(SRGAnalyticsInstrumentationStageNetMetrixRequest, 1000);
+        }
+    });
+    
+    SRGAnalyticsInstrumentationSnapshot *snapshot = [SRGAnalyticsTracker.sharedTracker resetInstrumentation];
+    XCTAssertEqual([snapshot valueForCounter:SRGAnalyticsInstrumentationCounterHeartbeats], kThreadCount * kIterationCount);
+    XCTAssertEqual([snapshot sampleCountForStage:SRGAnalyticsInstrumentationStageNetMetrixRequest], kThreadCount * kIterationCount);
+    XCTAssertEqualWithAccuracy([snapshot totalDurationForStage:SRGAnalyticsInstrumentationStageNetMetrixRequest], kThreadCount * kIterationCount * 1e-6, 1e-9);
+    
+    // Values have been reset
+    SRGAnalyticsInstrumentationSnapshot *resetSnapshot = SRGAnalyticsTracker.sharedTracker.instrumentationSnapshot;
+    XCTAssertEqual([resetSnapshot valueForCounter:SRGAnalyticsInstrumentationCounterHeartbeats], 0);
+    XCTAssertEqual([resetSnapshot sampleCountForStage:SRGAnalyticsInstrumentationStageNetMetrixRequest], 0);
+}
+
+- (void)testHistogram
+{
+    for (NSInteger i = 0; i < 90; ++i) {
+        SRGAnalyticsInstrumentationRecordDuration(SRGAnalyticsInstrumentationStageNetMetrixRequest, 500);
+    }
+    for (NSInteger i = 0; i < 10; ++i) {
+        SRGAnalyticsInstrumentationRecordDuration(SRGAnalyticsInstrumentationStageNetMetrixRequest, 3000000);
+    }
+    
+    SRGAnalyticsInstrumentationSnapshot *snapshot = SRGAnalyticsTracker.sharedTracker.instrumentationSnapshot;
+    NSArray<NSNumber *> *histogram = [snapshot histogramForStage:SRGAnalyticsInstrumentationStageNetMetrixRequest];
+    XCTAssertEqual(histogram.count, SRGAnalyticsInstrumentationSnapshot.histogramBucketCount);
+    XCTAssertEqualObjects(histogram[0], @90);
+    XCTAssertEqualObjects(histogram[12], @10);
+    
+    XCTAssertEqual([snapshot durationAtPercentile:0.5 forStage:SRGAnalyticsInstrumentationStageNetMetrixRequest], 1e-6);
+    XCTAssertEqual([snapshot durationAtPercentile:0.99 forStage:SRGAnalyticsInstrumentationStageNetMetrixRequest], 4096e-6);
+    XCTAssertEqual([snapshot durationAtPercentile:0.5 forStage:SRGAnalyticsInstrumentationStageComScore], 0.);
+}
+
+#pragma mark Benchmarks
+
+- (void)testRecordingPerformance
+{
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < 100000; ++i) {
+            SRGAnalyticsInstrumentationMeasure(SRGAnalyticsInstrumentationStageLabelBuilding, SRGAnalyticsInstrumentationAddToCounter(SRGAnalyticsInstrumentationCounterHeartbeats, 1));
+        }
+    }];
+}
+
+#else
+
+- (void)testUnavailable
+{
+    XCTAssertNil(SRGAnalyticsTracker.sharedTracker.instrumentationSnapshot);
+    XCTAssertNil([SRGAnalyticsTracker.sharedTracker resetInstrumentation]);
+}
+
+#endif
+
+@end
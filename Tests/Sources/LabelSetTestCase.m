@@ -0,0 +1,376 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "Benchmark.h"
+#import "NSMutableDictionary+SRGAnalytics.h"
+#import "SRGAnalyticsLabels+Private.h"
+#import "SRGAnalyticsLabelSet.h"
+
+#import <SRGAnalytics/SRGAnalytics.h>
+#import <XCTest/XCTest.h>
+
+static const NSUInteger BenchmarkEventCount = 10000;
+
+static void BlockBenchmark(void *context, size_t iterations)
+{
+    void (^block)(size_t) = (__bridge void (^)(size_t))context;
+    block(iterations);
+}
+
+@interface LabelSetTestCase : XCTestCase
+
+@end
+
+@implementation LabelSetTestCase
+
+#pragma mark Helpers
+
+- (NSDictionary<NSString *, NSString *> *)globalLabels
+{
+    return @{ @"navigation_app_site_name" : @"rts-app-test-v",
+              @"navigation_environment" : @"preprod",
+              @"navigation_device" : @"phone",
+              @"user_id" : @"1234",
+              @"user_is_logged" : @"true" };
+}
+
+- (SRGAnalyticsStreamLabels *)streamLabels
+{
+    SRGAnalyticsStreamLabels *labels = [[SRGAnalyticsStreamLabels alloc] init];
+    labels.playerName = @"SRGMediaPlayer";
+    labels.playerVersion = @"2.5.6";
+    labels.playerVolumeInPercent = @80;
+    labels.subtitlesEnabled = @NO;
+    labels.bandwidthInBitsPerSecond = @3000000;
+    labels.customInfo = @{ @"media_urn" : @"urn:rts:video:1234",
+                           @"media_title" : @"Title",
+                           @"media_type" : @"Video" };
+    return labels;
+}
+
+// Stream labels dictionary, as built before label sets were introduced
+- (NSDictionary<NSString *, NSString *> *)dictionaryWithStreamLabels:(SRGAnalyticsStreamLabels *)labels
+{
+    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
+    
+    [dictionary srg_safelySetString:@"preprod" forKey:@"media_embedding_environment"];
+    
+    [dictionary srg_safelySetString:labels.playerName forKey:@"media_player_display"];
+    [dictionary srg_safelySetString:labels.playerVersion forKey:@"media_player_version"];
+    [dictionary srg_safelySetString:labels.playerVolumeInPercent.stringValue ?: @"0" forKey:@"media_volume"];
+    
+    [dictionary srg_safelySetString:labels.subtitlesEnabled.boolValue ? @"true" : @"false" forKey:@"media_subtitles_on"];
+    [dictionary srg_safelySetString:labels.timeshiftInMilliseconds ? @(labels.timeshiftInMilliseconds.integerValue / 1000).stringValue : nil forKey:@"media_timeshift"];
+    [dictionary srg_safelySetString:labels.bandwidthInBitsPerSecond.stringValue forKey:@"media_bandwidth"];
+    
+    NSMutableDictionary<NSString *, NSString *> *customDictionary = [NSMutableDictionary dictionary];
+    if (labels.customInfo) {
+        [customDictionary addEntriesFromDictionary:labels.customInfo];
+    }
+    [dictionary addEntriesFromDictionary:[customDictionary copy]];
+    
+    return [dictionary copy];
+}
+
+- (BenchmarkResult)runBenchmarkWithName:(NSString *)name block:(void (^)(NSUInteger index))block
+{
+    __block NSUInteger index = 0;
+    void (^benchmarkBlock)(size_t) = ^(size_t iterations) {
+        for (size_t i = 0; i < iterations; ++i) {
+            @autoreleasepool {
+                block(index++);
+            }
+        }
+    };
+    BenchmarkResult result = BenchmarkRun(name.UTF8String, BlockBenchmark, (__bridge void *)benchmarkBlock);
+    BenchmarkResultPrint(&result, stdout);
+    return result;
+}
+
+#pragma mark Tests
+
+- (void)testEmptyLabelSet
+{
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    XCTAssertEqual(labelSet.count, 0);
+    XCTAssertEqualObjects(labelSet.dictionary, @{});
+    XCTAssertNil(labelSet[@"key"]);
+}
+
+- (void)testEntries
+{
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [labelSet setString:@"value1" forKey:@"key1"];
+    [labelSet setString:@"value2" forKey:@"key2"];
+    [labelSet setString:nil forKey:@"key3"];
+    XCTAssertEqualObjects(labelSet[@"key1"], @"value1");
+    XCTAssertEqualObjects(labelSet[@"key2"], @"value2");
+    XCTAssertNil(labelSet[@"key3"]);
+    XCTAssertEqual(labelSet.count, 2);
+    
+    // Keys are compared by value, not only by pointer
+    NSString *key = [NSString stringWithFormat:@"key%@", @1];
+    [labelSet setString:@"overridden_value1" forKey:key];
+    XCTAssertEqualObjects(labelSet[@"key1"], @"overridden_value1");
+    XCTAssertEqual(labelSet.count, 2);
+    
+    [labelSet setString:nil forKey:@"key1"];
+    XCTAssertNil(labelSet[@"key1"]);
+    XCTAssertEqualObjects(labelSet.dictionary, @{ @"key2" : @"value2" });
+}
+
+- (void)testLargeNumberOfEntries
+{
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < 100; ++i) {
+        NSString *key = [NSString stringWithFormat:@"key%@", @(i)];
+        NSString *value = [NSString stringWithFormat:@"value%@", @(i)];
+        [labelSet setString:value forKey:key];
+        dictionary[key] = value;
+    }
+    XCTAssertEqual(labelSet.count, 100);
+    XCTAssertEqualObjects(labelSet.dictionary, dictionary);
+    
+    // Keys are found after removals, which shift entries
+    for (NSUInteger i = 0; i < 100; i += 2) {
+        NSString *key = [NSString stringWithFormat:@"key%@", @(i)];
+        [labelSet setString:nil forKey:key];
+        dictionary[key] = nil;
+    }
+    for (NSUInteger i = 0; i < 100; ++i) {
+        NSString *key = [NSString stringWithFormat:@"key%@", @(i)];
+        XCTAssertEqualObjects(labelSet[key], dictionary[key]);
+    }
+    XCTAssertEqual(labelSet.count, 50);
+    XCTAssertEqualObjects(labelSet.dictionary, dictionary);
+    
+    [labelSet addEntriesFromDictionary:@{ @"key0" : @"new_value0", @"key1" : @"new_value1" }];
+    XCTAssertEqualObjects(labelSet[@"key0"], @"new_value0");
+    XCTAssertEqualObjects(labelSet[@"key1"], @"new_value1");
+    XCTAssertEqual(labelSet.count, 51);
+}
+
+- (void)testOverlays
+{
+    SRGAnalyticsLabelSet *globalLabelSet = [SRGAnalyticsLabelSet labelSetWithDictionary:@{ @"global_key" : @"global_value",
+                                                                                           @"shared_key" : @"global_value" } parent:nil];
+    
+    SRGAnalyticsLabelSet *mediaLabelSet = [SRGAnalyticsLabelSet labelSetWithDictionary:@{ @"media_key" : @"media_value",
+                                                                                          @"shared_key" : @"media_dictionary_value" } parent:globalLabelSet];
+    [mediaLabelSet setString:@"media_value" forKey:@"shared_key"];
+    
+    SRGAnalyticsLabelSet *eventLabelSet = [SRGAnalyticsLabelSet labelSetWithParent:mediaLabelSet];
+    [eventLabelSet setString:@"event_value" forKey:@"event_key"];
+    
+    NSDictionary<NSString *, NSString *> *expectedDictionary = @{ @"global_key" : @"global_value",
+                                                                  @"media_key" : @"media_value",
+                                                                  @"shared_key" : @"media_value",
+                                                                  @"event_key" : @"event_value" };
+    XCTAssertEqualObjects(eventLabelSet.dictionary, expectedDictionary);
+    XCTAssertEqual(eventLabelSet.count, 4);
+    XCTAssertEqualObjects(eventLabelSet[@"shared_key"], @"media_value");
+    
+    [eventLabelSet setString:@"event_value" forKey:@"shared_key"];
+    XCTAssertEqualObjects(eventLabelSet[@"shared_key"], @"event_value");
+    XCTAssertEqualObjects(mediaLabelSet[@"shared_key"], @"media_value");
+    XCTAssertEqual(eventLabelSet.count, 4);
+    
+    // Removing an entry does not affect lower layers
+    [eventLabelSet setString:nil forKey:@"shared_key"];
+    XCTAssertEqualObjects(eventLabelSet[@"shared_key"], @"media_value");
+}
+
+- (void)testReferencedDictionary
+{
+    NSDictionary<NSString *, NSString *> *dictionary = @{ @"key" : @"value" };
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithDictionary:dictionary parent:nil];
+    XCTAssertEqual(labelSet.dictionary, dictionary);
+}
+
+- (void)testEnumerationStop
+{
+    SRGAnalyticsLabelSet *parentLabelSet = [SRGAnalyticsLabelSet labelSetWithDictionary:@{ @"key1" : @"value1",
+                                                                                           @"key2" : @"value2" } parent:nil];
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:parentLabelSet];
+    [labelSet setString:@"value3" forKey:@"key3"];
+    
+    __block NSUInteger count = 0;
+    [labelSet enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
+        ++count;
+        if (count == 2) {
+            *stop = YES;
+        }
+    }];
+    XCTAssertEqual(count, 2);
+}
+
+- (void)testChanges
+{
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithDictionary:@{ @"key1" : @"value1", @"key2" : @"value2" } parent:nil];
+    [labelSet setString:@"new_value3" forKey:@"key3"];
+    
+    NSMutableDictionary<NSString *, NSString *> *dictionary = [@{ @"key1" : @"value1",
+                                                                  @"key3" : @"value3",
+                                                                  @"key4" : @"value4" } mutableCopy];
+    NSMutableArray<NSString *> *changedKeys = [NSMutableArray array];
+    [labelSet enumerateChangesFromDictionary:dictionary usingBlock:^(NSString * _Nonnull key, NSString * _Nullable object) {
+        [changedKeys addObject:key];
+        dictionary[key] = object;
+    }];
+    
+    // Removals first, unchanged keys are not enumerated
+    XCTAssertEqualObjects(changedKeys.firstObject, @"key4");
+    XCTAssertEqualObjects([NSSet setWithArray:changedKeys], ([NSSet setWithObjects:@"key2", @"key3", @"key4", nil]));
+    XCTAssertEqualObjects(dictionary, labelSet.dictionary);
+    
+    // No changes anymore
+    [labelSet enumerateChangesFromDictionary:dictionary usingBlock:^(NSString * _Nonnull key, NSString * _Nullable object) {
+        XCTFail(@"No change expected");
+    }];
+    
+    // All entries are new when starting from scratch
+    __block NSUInteger count = 0;
+    [labelSet enumerateChangesFromDictionary:nil usingBlock:^(NSString * _Nonnull key, NSString * _Nullable object) {
+        XCTAssertNotNil(object);
+        ++count;
+    }];
+    XCTAssertEqual(count, 3);
+}
+
+- (void)testLabelsFilling
+{
+    SRGAnalyticsStreamLabels *labels = [self streamLabels];
+    
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [labels fillLabelSet:labelSet];
+    XCTAssertEqualObjects(labelSet.dictionary, labels.labelsDictionary);
+    
+    SRGAnalyticsLabelSet *comScoreLabelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [labels fillComScoreLabelSet:comScoreLabelSet];
+    XCTAssertEqualObjects(comScoreLabelSet.dictionary, labels.comScoreLabelsDictionary);
+}
+
+#pragma mark Benchmarks
+
+// Heartbeat label assembly with dictionaries, as made before label sets were introduced
+- (void)testDictionaryHeartbeatLabelsPerformance
+{
+    NSDictionary<NSString *, NSString *> *globalLabels = [self globalLabels];
+    SRGAnalyticsStreamLabels *labels = [self streamLabels];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < BenchmarkEventCount; ++i) {
+            @autoreleasepool {
+                NSMutableDictionary<NSString *, NSString *> *fullLabelsDictionary = [NSMutableDictionary dictionary];
+                fullLabelsDictionary[@"event_id"] = @"pos";
+                fullLabelsDictionary[@"media_position"] = @(i).stringValue;
+                [fullLabelsDictionary addEntriesFromDictionary:[self dictionaryWithStreamLabels:labels]];
+                
+                NSMutableDictionary<NSString *, NSString *> *allLabels = [globalLabels mutableCopy];
+                [allLabels addEntriesFromDictionary:[fullLabelsDictionary copy]];
+                
+                __block NSUInteger count = 0;
+                [allLabels enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
+                    ++count;
+                }];
+                XCTAssertEqual(count, 16);
+            }
+        }
+    }];
+}
+
+// Allocations made to assemble heartbeat labels with dictionaries (before) and with label sets (after). Allocations
+// cannot be counted on all platforms, in which case only durations are reported.
+- (void)testHeartbeatLabelsAllocations
+{
+    NSDictionary<NSString *, NSString *> *globalLabels = [self globalLabels];
+    SRGAnalyticsStreamLabels *labels = [self streamLabels];
+    
+    BenchmarkResult dictionaryResult = [self runBenchmarkWithName:@"label_set/heartbeat_dictionary" block:^(NSUInteger index) {
+        NSMutableDictionary<NSString *, NSString *> *fullLabelsDictionary = [NSMutableDictionary dictionary];
+        fullLabelsDictionary[@"event_id"] = @"pos";
+        fullLabelsDictionary[@"media_position"] = @(index).stringValue;
+        [fullLabelsDictionary addEntriesFromDictionary:[self dictionaryWithStreamLabels:labels]];
+        
+        NSMutableDictionary<NSString *, NSString *> *allLabels = [globalLabels mutableCopy];
+        [allLabels addEntriesFromDictionary:[fullLabelsDictionary copy]];
+        [allLabels enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {}];
+    }];
+    
+    BenchmarkResult labelSetResult = [self runBenchmarkWithName:@"label_set/heartbeat_label_set" block:^(NSUInteger index) {
+        SRGAnalyticsLabelSet *globalLabelSet = [SRGAnalyticsLabelSet labelSetWithDictionary:globalLabels parent:nil];
+        SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:globalLabelSet];
+        [labelSet setString:@"pos" forKey:@"event_id"];
+        [labelSet setString:@(index).stringValue forKey:@"media_position"];
+        [labels fillLabelSet:labelSet];
+        [labelSet enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {}];
+    }];
+    
+    if (dictionaryResult.allocationsPerOperation >= 0. && labelSetResult.allocationsPerOperation >= 0.) {
+        XCTAssertLessThan(labelSetResult.allocationsPerOperation, dictionaryResult.allocationsPerOperation);
+    }
+}
+
+// Lookups in a large label set, mostly for keys which are missing
+- (void)testLargeLabelSetLookups
+{
+    NSMutableDictionary<NSString *, NSString *> *dictionary = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < 256; ++i) {
+        dictionary[[NSString stringWithFormat:@"key%@", @(i)]] = [NSString stringWithFormat:@"value%@", @(i)];
+    }
+    NSMutableArray<NSString *> *lookupKeys = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 1024; ++i) {
+        [lookupKeys addObject:[NSString stringWithFormat:@"key%@", @(i)]];
+    }
+    
+    [self runBenchmarkWithName:@"label_set/fill_256" block:^(NSUInteger index) {
+        SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+        [labelSet addEntriesFromDictionary:dictionary];
+    }];
+    
+    SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:nil];
+    [labelSet addEntriesFromDictionary:dictionary];
+    [self runBenchmarkWithName:@"label_set/lookup_1024" block:^(NSUInteger index) {
+        for (NSString *key in lookupKeys) {
+            __unused NSString *object = labelSet[key];
+        }
+    }];
+    
+    __block NSUInteger count = 0;
+    for (NSString *key in lookupKeys) {
+        if (labelSet[key]) {
+            ++count;
+        }
+    }
+    XCTAssertEqual(count, 256);
+}
+
+- (void)testLabelSetHeartbeatLabelsPerformance
+{
+    NSDictionary<NSString *, NSString *> *globalLabels = [self globalLabels];
+    SRGAnalyticsStreamLabels *labels = [self streamLabels];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < BenchmarkEventCount; ++i) {
+            @autoreleasepool {
+                SRGAnalyticsLabelSet *globalLabelSet = [SRGAnalyticsLabelSet labelSetWithDictionary:globalLabels parent:nil];
+                SRGAnalyticsLabelSet *labelSet = [SRGAnalyticsLabelSet labelSetWithParent:globalLabelSet];
+                [labelSet setString:@"pos" forKey:@"event_id"];
+                [labelSet setString:@(i).stringValue forKey:@"media_position"];
+                [labels fillLabelSet:labelSet];
+                
+                __block NSUInteger count = 0;
+                [labelSet enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSString * _Nonnull object, BOOL * _Nonnull stop) {
+                    ++count;
+                }];
+                XCTAssertEqual(count, 16);
+            }
+        }
+    }];
+}
+
+@end
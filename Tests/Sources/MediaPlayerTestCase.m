@@ -7,6 +7,8 @@
 #import "AnalyticsTestCase.h"
 #import "NSNotificationCenter+Tests.h"
 #import "Segment.h"
+#import "SRGAnalyticsTracker+Private.h"
+#import "SRGMediaPlayerTracker+Private.h"
 
 #import <SRGAnalytics_MediaPlayer/SRGAnalytics_MediaPlayer.h>
 
@@ -31,6 +33,10 @@ static NSURL *DVRTestURL(void)
 
 @property (nonatomic) SRGMediaPlayerController *mediaPlayerController;
 
+@property (nonatomic) SRGAnalyticsManualClock *heartbeatClock;
+@property (nonatomic) NSMutableArray<NSDictionary<NSString *, NSString *> *> *heartbeatLabelsArray;
+@property (nonatomic) id heartbeatObserver;
+
 @end
 
 @implementation MediaPlayerTestCase
@@ -46,6 +52,50 @@ static NSURL *DVRTestURL(void)
 {
     [self.mediaPlayerController reset];
     self.mediaPlayerController = nil;
+    
+    SRGMediaPlayerTracker.heartbeatScheduler = nil;
+    
+    if (self.heartbeatObserver) {
+        [NSNotificationCenter.defaultCenter removeObserver:self.heartbeatObserver];
+        self.heartbeatObserver = nil;
+    }
+}
+
+#pragma mark Helpers
+
+// Send heartbeats of trackers created afterwards according to a manual clock. Heartbeats are sent through the shared
+// tracker, as in production, and collected from the notifications it posts
+- (void)useManualHeartbeatClock
+{
+    self.heartbeatClock = [[SRGAnalyticsManualClock alloc] init];
+    self.heartbeatLabelsArray = [NSMutableArray array];
+    
+    SRGAnalyticsTracker *tracker = SRGAnalyticsTracker.sharedTracker;
+    SRGMediaPlayerTracker.heartbeatScheduler = [[SRGAnalyticsHeartbeatScheduler alloc] initWithClock:self.heartbeatClock interval:3. tolerance:0.3 sendBlock:^(NSArray<SRGAnalyticsLabelSet *> * _Nonnull labelSets) {
+        [tracker trackTagCommanderEventsWithLabelSets:labelSets];
+    }];
+    
+    __weak __typeof(self) weakSelf = self;
+    self.heartbeatObserver = [NSNotificationCenter.defaultCenter addObserverForHiddenEventNotificationUsingBlock:^(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
+        if ([event isEqualToString:@"pos"] || [event isEqualToString:@"uptime"]) {
+            [weakSelf.heartbeatLabelsArray addObject:labels];
+        }
+    }];
+}
+
+// Advance the manual heartbeat clock, waiting until notifications for all heartbeats sent in the meantime have been received
+- (void)advanceHeartbeatClockBy:(NSTimeInterval)timeInterval
+{
+    [self.heartbeatClock advanceBy:timeInterval];
+    
+    // Events are sent in order on the tracker event queue, and notifications posted on the main thread afterwards
+    XCTestExpectation *heartbeatsExpectation = [self expectationWithDescription:@"Heartbeats received"];
+    [SRGAnalyticsTracker.sharedTracker performRequiredEventBlock:^{
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [heartbeatsExpectation fulfill];
+        });
+    }];
+    [self waitForExpectationsWithTimeout:20. handler:nil];
 }
 
 #pragma mark Tests
@@ -793,6 +843,31 @@ static NSURL *DVRTestURL(void)
     [self waitForExpectationsWithTimeout:20. handler:nil];
 }
 
+- (void)testVolumeLabelAfterMuting
+{
+    [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        XCTAssertEqualObjects(labels[@"event_id"], @"play");
+        XCTAssertNotNil(labels[@"media_volume"]);
+        return YES;
+    }];
+    
+    [self.mediaPlayerController playURL:OnDemandTestURL()];
+    
+    [self waitForExpectationsWithTimeout:20. handler:nil];
+    
+    // The volume is cached between events. Check that muting the player is taken into account
+    [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        XCTAssertEqualObjects(labels[@"event_id"], @"pause");
+        XCTAssertEqualObjects(labels[@"media_volume"], @"0");
+        return YES;
+    }];
+    
+    self.mediaPlayerController.player.muted = YES;
+    [self.mediaPlayerController pause];
+    
+    [self waitForExpectationsWithTimeout:20. handler:nil];
+}
+
 - (void)testBandwidthLabel
 {
     [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
@@ -2348,6 +2423,8 @@ static NSURL *DVRTestURL(void)
 
 - (void)testOnDemandHeartbeatPlayPausePlay
 {
+    [self useManualHeartbeatClock];
+    
     [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
         XCTAssertEqualObjects(labels[@"event_id"], @"play");
         XCTAssertEqualObjects(labels[@"stream_name"], @"full");
@@ -2361,26 +2438,10 @@ static NSURL *DVRTestURL(void)
     
     [self waitForExpectationsWithTimeout:20. handler:nil];
     
-    // For tests, heartbeat interval is set to 3 seconds.
-    
-    __block NSInteger heartbeatCount = 0;
-    id heartbeatEventObserver = [NSNotificationCenter.defaultCenter addObserverForHiddenEventNotificationUsingBlock:^(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
-        if ([event isEqualToString:@"pos"]) {
-            XCTAssertEqualObjects(labels[@"stream_name"], @"full");
-            ++heartbeatCount;
-        }
-        else if ([event isEqualToString:@"uptime"]) {
-            XCTFail(@"No uptime expected for on-demand streams");
-        }
-    }];
-    
-    // Wait a little bit to collect potential events
-    [self expectationForElapsedTimeInterval:7. withHandler:nil];
-    [self waitForExpectationsWithTimeout:20. handler:^(NSError * _Nullable error) {
-        [NSNotificationCenter.defaultCenter removeObserver:heartbeatEventObserver];
-    }];
-    
-    XCTAssertEqual(heartbeatCount, 2);
+    // No uptime expected for on-demand streams
+    [self advanceHeartbeatClockBy:7.];
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"event_id"], (@[ @"pos", @"pos" ]));
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"stream_name"], (@[ @"full", @"full" ]));
     
     [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
         XCTAssertEqualObjects(labels[@"event_id"], @"pause");
@@ -2392,24 +2453,9 @@ static NSURL *DVRTestURL(void)
     
     [self waitForExpectationsWithTimeout:20. handler:nil];
     
-    heartbeatCount = 0;
-    heartbeatEventObserver = [NSNotificationCenter.defaultCenter addObserverForHiddenEventNotificationUsingBlock:^(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
-        if ([event isEqualToString:@"pos"]) {
-            XCTAssertEqualObjects(labels[@"stream_name"], @"full");
-            ++heartbeatCount;
-        }
-        else if ([event isEqualToString:@"uptime"]) {
-            XCTFail(@"No uptime expected for on-demand streams");
-        }
-    }];
-    
-    // Wait a little bit to collect potential events
-    [self expectationForElapsedTimeInterval:4. withHandler:nil];
-    [self waitForExpectationsWithTimeout:20. handler:^(NSError * _Nullable error) {
-        [NSNotificationCenter.defaultCenter removeObserver:heartbeatEventObserver];
-    }];
-    
-    XCTAssertEqual(heartbeatCount, 0);
+    [self.heartbeatLabelsArray removeAllObjects];
+    [self advanceHeartbeatClockBy:4.];
+    XCTAssertEqual(self.heartbeatLabelsArray.count, 0);
     
     [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
         XCTAssertEqualObjects(labels[@"event_id"], @"play");
@@ -2420,28 +2466,15 @@ static NSURL *DVRTestURL(void)
     
     [self waitForExpectationsWithTimeout:20. handler:nil];
     
-    heartbeatCount = 0;
-    heartbeatEventObserver = [NSNotificationCenter.defaultCenter addObserverForHiddenEventNotificationUsingBlock:^(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
-        if ([event isEqualToString:@"pos"]) {
-            XCTAssertEqualObjects(labels[@"stream_name"], @"full");
-            ++heartbeatCount;
-        }
-        else if ([event isEqualToString:@"uptime"]) {
-            XCTFail(@"No uptime expected for on-demand streams");
-        }
-    }];
-    
-    // Wait a little bit to collect potential events
-    [self expectationForElapsedTimeInterval:7. withHandler:nil];
-    [self waitForExpectationsWithTimeout:20. handler:^(NSError * _Nullable error) {
-        [NSNotificationCenter.defaultCenter removeObserver:heartbeatEventObserver];
-    }];
-    
-    XCTAssertEqual(heartbeatCount, 2);
+    [self advanceHeartbeatClockBy:7.];
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"event_id"], (@[ @"pos", @"pos" ]));
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"stream_name"], (@[ @"full", @"full" ]));
 }
 
 - (void)testLivestreamHeartbeatPlay
 {
+    [self useManualHeartbeatClock];
+    
     [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
         XCTAssertEqualObjects(labels[@"event_id"], @"play");
         XCTAssertEqualObjects(labels[@"stream_name"], @"full");
@@ -2457,33 +2490,15 @@ static NSURL *DVRTestURL(void)
     
     [self waitForExpectationsWithTimeout:20. handler:nil];
     
-    // For tests, heartbeat interval is set to 3 seconds.
-    
-    __block NSInteger heartbeatCount = 0;
-    __block NSInteger liveHeartbeatCount = 0;
-    id heartbeatEventObserver = [NSNotificationCenter.defaultCenter addObserverForHiddenEventNotificationUsingBlock:^(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
-        if ([event isEqualToString:@"pos"]) {
-            XCTAssertEqualObjects(labels[@"stream_name"], @"full");
-            XCTAssertTrue(([labels[@"media_position"] integerValue] % 3) == 0);
-            XCTAssertEqualObjects(labels[@"media_timeshift"], @"0");
-            ++heartbeatCount;
-        }
-        else if ([event isEqualToString:@"uptime"]) {
-            XCTAssertEqualObjects(labels[@"stream_name"], @"full");
-            XCTAssertTrue(([labels[@"media_position"] integerValue] % 6) == 0);
-            XCTAssertEqualObjects(labels[@"media_timeshift"], @"0");
-            ++liveHeartbeatCount;
-        }
-    }];
+    // The position of livestream heartbeats is the playback duration
+    [self advanceHeartbeatClockBy:14.];
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"event_id"], (@[ @"pos", @"pos", @"uptime", @"pos", @"pos", @"uptime" ]));
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"media_position"], (@[ @"3", @"6", @"6", @"9", @"12", @"12" ]));
     
-    // Wait a little bit to collect potential events
-    [self expectationForElapsedTimeInterval:14. withHandler:nil];
-    [self waitForExpectationsWithTimeout:20. handler:^(NSError * _Nullable error) {
-        [NSNotificationCenter.defaultCenter removeObserver:heartbeatEventObserver];
-    }];
-    
-    XCTAssertEqual(heartbeatCount, 4);
-    XCTAssertEqual(liveHeartbeatCount, 2);
+    for (NSDictionary<NSString *, NSString *> *heartbeatLabels in self.heartbeatLabelsArray) {
+        XCTAssertEqualObjects(heartbeatLabels[@"stream_name"], @"full");
+        XCTAssertEqualObjects(heartbeatLabels[@"media_timeshift"], @"0");
+    }
 }
 
 - (void)testHeartbeatWithInitialSegmentSelectionAndPlaythrough
@@ -2618,6 +2633,8 @@ static NSURL *DVRTestURL(void)
 
 - (void)testDVRLiveHeartbeats
 {
+    [self useManualHeartbeatClock];
+    
     [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
         XCTAssertEqualObjects(labels[@"event_id"], @"play");
         XCTAssertEqualObjects(labels[@"stream_name"], @"full");
@@ -2631,33 +2648,15 @@ static NSURL *DVRTestURL(void)
     
     [self waitForExpectationsWithTimeout:20. handler:nil];
     
-    // For tests, heartbeat interval is set to 3 seconds.
-    
-    __block NSInteger heartbeatCount = 0;
-    __block NSInteger liveHeartbeatCount = 0;
-    id heartbeatEventObserver = [NSNotificationCenter.defaultCenter addObserverForHiddenEventNotificationUsingBlock:^(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
-        if ([event isEqualToString:@"pos"]) {
-            XCTAssertEqualObjects(labels[@"stream_name"], @"full");
-            ++heartbeatCount;
-        }
-        else if ([event isEqualToString:@"uptime"]) {
-            XCTAssertEqualObjects(labels[@"stream_name"], @"full");
-            ++liveHeartbeatCount;
-        }
-    }];
-    
-    // Wait a little bit to collect potential events
-    [self expectationForElapsedTimeInterval:14. withHandler:nil];
-    [self waitForExpectationsWithTimeout:20. handler:^(NSError * _Nullable error) {
-        [NSNotificationCenter.defaultCenter removeObserver:heartbeatEventObserver];
-    }];
-    
-    XCTAssertEqual(heartbeatCount, 4);
-    XCTAssertEqual(liveHeartbeatCount, 2);
+    [self advanceHeartbeatClockBy:14.];
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"event_id"], (@[ @"pos", @"pos", @"uptime", @"pos", @"pos", @"uptime" ]));
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"stream_name"], (@[ @"full", @"full", @"full", @"full", @"full", @"full" ]));
 }
 
 - (void)testDVRTimeshiftHeartbeats
 {
+    [self useManualHeartbeatClock];
+    
     [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
         XCTAssertEqualObjects(labels[@"event_id"], @"play");
         XCTAssertEqualObjects(labels[@"stream_name"], @"full");
@@ -2682,29 +2681,10 @@ static NSURL *DVRTestURL(void)
     
     [self waitForExpectationsWithTimeout:20. handler:nil];
     
-    // For tests, heartbeat interval is set to 3 seconds.
-    
-    __block NSInteger heartbeatCount = 0;
-    __block NSInteger liveHeartbeatCount = 0;
-    id heartbeatEventObserver = [NSNotificationCenter.defaultCenter addObserverForHiddenEventNotificationUsingBlock:^(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
-        if ([event isEqualToString:@"pos"]) {
-            XCTAssertEqualObjects(labels[@"stream_name"], @"full");
-            ++heartbeatCount;
-        }
-        else if ([event isEqualToString:@"uptime"]) {
-            XCTAssertEqualObjects(labels[@"stream_name"], @"full");
-            ++liveHeartbeatCount;
-        }
-    }];
-    
-    // Wait a little bit to collect potential events
-    [self expectationForElapsedTimeInterval:14. withHandler:nil];
-    [self waitForExpectationsWithTimeout:20. handler:^(NSError * _Nullable error) {
-        [NSNotificationCenter.defaultCenter removeObserver:heartbeatEventObserver];
-    }];
-    
-    XCTAssertEqual(heartbeatCount, 4);
-    XCTAssertEqual(liveHeartbeatCount, 0);
+    // No uptime expected when not playing in live conditions
+    [self advanceHeartbeatClockBy:14.];
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"event_id"], (@[ @"pos", @"pos", @"pos", @"pos" ]));
+    XCTAssertEqualObjects([self.heartbeatLabelsArray valueForKey:@"stream_name"], (@[ @"full", @"full", @"full", @"full" ]));
 }
 
 - (void)testHeartbeatAfterDisablingTracking
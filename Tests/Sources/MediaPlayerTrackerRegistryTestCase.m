@@ -0,0 +1,130 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+#import "SRGMediaPlayerTrackerRegistry.h"
+
+@interface MediaPlayerTrackerRegistryTestCase : AnalyticsTestCase
+
+@end
+
+@implementation MediaPlayerTrackerRegistryTestCase
+
+#pragma mark Tests
+
+- (void)testRegistration
+{
+    NSMutableArray<NSNumber *> *activities = [NSMutableArray array];
+    SRGMediaPlayerTrackerRegistry<NSString *> *registry = [[SRGMediaPlayerTrackerRegistry alloc] initWithActivityBlock:^(BOOL active) {
+        [activities addObject:@(active)];
+    }];
+    
+    NSObject *object1 = [[NSObject alloc] init];
+    NSObject *object2 = [[NSObject alloc] init];
+    
+    __block NSString *startedTracker = nil;
+    XCTAssertTrue([registry registerTracker:@"tracker1" forObject:object1 withBlock:^(NSString *tracker) {
+        startedTracker = tracker;
+    }]);
+    XCTAssertEqualObjects(startedTracker, @"tracker1");
+    XCTAssertEqualObjects([registry trackerForObject:object1], @"tracker1");
+    XCTAssertNil([registry trackerForObject:object2]);
+    XCTAssertEqual(registry.count, 1);
+    
+    // Only one tracker per object
+    XCTAssertFalse([registry registerTracker:@"tracker1bis" forObject:object1 withBlock:^(NSString *tracker) {
+        XCTFail(@"The block must not be called if the tracker is not registered");
+    }]);
+    XCTAssertEqualObjects([registry trackerForObject:object1], @"tracker1");
+    
+    XCTAssertTrue([registry registerTracker:@"tracker2" forObject:object2 withBlock:nil]);
+    XCTAssertEqual(registry.count, 2);
+    
+    __block NSString *stoppedTracker = nil;
+    XCTAssertEqualObjects([registry unregisterTrackerForObject:object1 withBlock:^(NSString *tracker) {
+        stoppedTracker = tracker;
+    }], @"tracker1");
+    XCTAssertEqualObjects(stoppedTracker, @"tracker1");
+    XCTAssertNil([registry trackerForObject:object1]);
+    XCTAssertEqual(registry.count, 1);
+    
+    XCTAssertNil([registry unregisterTrackerForObject:object1 withBlock:^(NSString *tracker) {
+        XCTFail(@"The block must not be called if no tracker is registered");
+    }]);
+    
+    XCTAssertEqualObjects([registry unregisterTrackerForObject:object2 withBlock:nil], @"tracker2");
+    XCTAssertEqual(registry.count, 0);
+    
+    XCTAssertEqualObjects(activities, (@[ @YES, @NO ]));
+}
+
+- (void)testObjectIsNotRetained
+{
+    SRGMediaPlayerTrackerRegistry<NSString *> *registry = [[SRGMediaPlayerTrackerRegistry alloc] initWithActivityBlock:^(BOOL active) {}];
+    
+    __weak NSObject *weakObject = nil;
+    @autoreleasepool {
+        NSObject *object = [[NSObject alloc] init];
+        weakObject = object;
+        [registry registerTracker:@"tracker" forObject:object withBlock:nil];
+    }
+    XCTAssertNil(weakObject);
+}
+
+- (void)testConcurrentRegistrations
+{
+    static const NSInteger kObjectCount = 64;
+    static const NSInteger kIterationCount = 500;
+    
+    // Activity must strictly alternate between active and inactive. Blocks are called while the registry is updated,
+    // no additional synchronization is required
+    __block NSInteger activityLevel = 0;
+    __block NSInteger activationCount = 0;
+    SRGMediaPlayerTrackerRegistry<NSObject *> *registry = [[SRGMediaPlayerTrackerRegistry alloc] initWithActivityBlock:^(BOOL active) {
+        activityLevel += active ? 1 : -1;
+        XCTAssertTrue(activityLevel == 0 || activityLevel == 1);
+        if (active) {
+            activationCount += 1;
+        }
+    }];
+    
+    NSMutableArray<NSObject *> *objects = [NSMutableArray array];
+    for (NSInteger i = 0; i < kObjectCount; ++i) {
+        [objects addObject:[[NSObject alloc] init]];
+    }
+    
+    // Simulate players being started and stopped from several queues, each player being possibly started or stopped
+    // by several queues at the same time
+    __block NSInteger balance = 0;
+    dispatch_apply(kObjectCount * 4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        NSObject *object = objects[index % kObjectCount];
+        for (NSInteger i = 0; i < kIterationCount; ++i) {
+            if ((i + index) % 2 == 0) {
+                [registry registerTracker:[[NSObject alloc] init] forObject:object withBlock:^(NSObject *tracker) {
+                    balance += 1;
+                }];
+            }
+            else {
+                [registry unregisterTrackerForObject:object withBlock:^(NSObject *tracker) {
+                    balance -= 1;
+                }];
+            }
+            XCTAssertLessThanOrEqual(registry.count, kObjectCount);
+        }
+    });
+    
+    XCTAssertEqual(registry.count, balance);
+    
+    for (NSObject *object in objects) {
+        [registry unregisterTrackerForObject:object withBlock:nil];
+    }
+    
+    XCTAssertEqual(registry.count, 0);
+    XCTAssertEqual(activityLevel, 0);
+    XCTAssertGreaterThan(activationCount, 0);
+}
+
+@end
@@ -14,6 +14,59 @@
 
 @implementation NSString_AnalyticsTestCase
 
+#pragma mark Helpers
+
+// Reference implementation, as made before the single-pass formatter was introduced
+- (NSString *)referenceComScoreFormattedStringWithString:(NSString *)string
+{
+    NSLocale *posixLocale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    NSString *normalizedString = [string.lowercaseString stringByFoldingWithOptions:NSDiacriticInsensitiveSearch locale:posixLocale];
+    
+    NSCharacterSet *andSet = [NSCharacterSet characterSetWithCharactersInString:@"+&"];
+    normalizedString = [[normalizedString componentsSeparatedByCharactersInSet:andSet] componentsJoinedByString:@"and"];
+    
+    NSRegularExpression *regularExpression = [NSRegularExpression regularExpressionWithPattern:@"[^a-z0-9]+" options:0 error:NULL];
+    normalizedString = [regularExpression stringByReplacingMatchesInString:normalizedString options:0 range:NSMakeRange(0, normalizedString.length) withTemplate:@"-"];
+    
+    return [normalizedString stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"-"]];
+}
+
+- (NSArray<NSString *> *)sampleStrings
+{
+    NSMutableArray<NSString *> *strings = [@[ @"",
+                                              @"-",
+                                              @"+",
+                                              @"a+b&c",
+                                              @"Ganz & Gloria",
+                                              @"Tagesschau",
+                                              @"Sport",
+                                              @"Hello, world!",
+                                              @"Vue aérienne de la zone de la \"potentielle attaque terroriste\" à Londres",
+                                              @"Zürich – Genève",
+                                              @"Straße",
+                                              @"ÉCOLE ÇA",
+                                              @"Ｆｕｌｌｗｉｄｔｈ",
+                                              @"日本語 text",
+                                              @"emoji 🎉 party",
+                                              @"tab\tand\nnewline",
+                                              [@"Mutable string" mutableCopy],
+                                              [@"" stringByPaddingToLength:300 withString:@"Long title with spaces & symbols! " startingAtIndex:0],
+                                              [@"" stringByPaddingToLength:300 withString:@"Très long titre accentué " startingAtIndex:0] ] mutableCopy];
+    
+    // Random ASCII strings, with a fixed seed for reproducibility
+    srand48(42);
+    for (NSUInteger i = 0; i < 500; ++i) {
+        NSUInteger length = lrand48() % 40;
+        NSMutableString *string = [NSMutableString stringWithCapacity:length];
+        for (NSUInteger j = 0; j < length; ++j) {
+            [string appendFormat:@"%c", (char)(0x20 + lrand48() % 0x5f)];
+        }
+        [strings addObject:[string copy]];
+    }
+    
+    return [strings copy];
+}
+
 #pragma mark Tests
 
 - (void)testFormattedStrings
@@ -28,4 +81,49 @@
     XCTAssertEqualObjects(@"News: \"Hello\"".srg_comScoreFormattedString, @"news-hello");
 }
 
+- (void)testFormattedStringsMatchReferenceImplementation
+{
+    for (NSString *string in [self sampleStrings]) {
+        NSString *referenceFormattedString = [self referenceComScoreFormattedStringWithString:string];
+        XCTAssertEqualObjects(string.srg_uncachedComScoreFormattedString, referenceFormattedString, @"Uncached formatting of '%@'", string);
+        XCTAssertEqualObjects(string.srg_comScoreFormattedString, referenceFormattedString, @"Formatting of '%@'", string);
+        
+        // Cached value
+        XCTAssertEqualObjects(string.srg_comScoreFormattedString, referenceFormattedString, @"Cached formatting of '%@'", string);
+    }
+}
+
+- (void)testReferenceFormattingPerformance
+{
+    NSArray<NSString *> *strings = [self sampleStrings];
+    [self measureBlock:^{
+        for (NSString *string in strings) {
+            [self referenceComScoreFormattedStringWithString:string];
+        }
+    }];
+}
+
+- (void)testUncachedFormattingPerformance
+{
+    NSArray<NSString *> *strings = [self sampleStrings];
+    [self measureBlock:^{
+        for (NSString *string in strings) {
+            (void)string.srg_uncachedComScoreFormattedString;
+        }
+    }];
+}
+
+- (void)testCachedFormattingPerformance
+{
+    // Page titles and levels are a small set of strings formatted over and over
+    NSArray<NSString *> *strings = [[self sampleStrings] subarrayWithRange:NSMakeRange(0, 20)];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 25; ++i) {
+            for (NSString *string in strings) {
+                (void)string.srg_comScoreFormattedString;
+            }
+        }
+    }];
+}
+
 @end
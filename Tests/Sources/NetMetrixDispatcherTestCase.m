@@ -0,0 +1,223 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+#import "SRGAnalyticsNetMetrixDispatcher.h"
+
+#import <OHHTTPStubs/OHHTTPStubs.h>
+
+static NSString * const TestNetMetrixHost = @"netmetrix.test";
+
+static NSURL *TestNetMetrixURL(void)
+{
+    return [NSURL URLWithString:[NSString stringWithFormat:@"https://%@/cgi-bin/ivw/CP/apps/test/ios/phone", TestNetMetrixHost]];
+}
+
+@interface NetMetrixDispatcherTestCase : AnalyticsTestCase
+
+@property (nonatomic) NSURL *fileURL;
+
+@property (nonatomic) NSMutableArray<NSURLRequest *> *requests;
+@property (nonatomic) NSMutableArray<NSNumber *> *statusCodes;                 // Status codes to respond with, in order. 200 when empty
+
+@property (nonatomic, weak) id<OHHTTPStubsDescriptor> requestStub;
+
+@end
+
+@implementation NetMetrixDispatcherTestCase
+
+#pragma mark Helpers
+
+- (SRGAnalyticsNetMetrixDispatcher *)dispatcherWithCoalescingInterval:(NSTimeInterval)coalescingInterval maximumPendingHitCount:(NSUInteger)maximumPendingHitCount
+{
+    NSMutableURLRequest *requestTemplate = [NSMutableURLRequest requestWithURL:TestNetMetrixURL()];
+    [requestTemplate setValue:@"Mozilla/5.0 (iOS-phone; U; CPU iPhone OS like Mac OS X)" forHTTPHeaderField:@"User-Agent"];
+    return [[SRGAnalyticsNetMetrixDispatcher alloc] initWithRequestTemplate:requestTemplate
+                                                                    fileURL:self.fileURL
+                                                       sessionConfiguration:NSURLSessionConfiguration.ephemeralSessionConfiguration
+                                                         coalescingInterval:coalescingInterval
+                                                       minimumRetryInterval:0.1
+                                                       maximumRetryInterval:0.4
+                                                     maximumPendingHitCount:maximumPendingHitCount];
+}
+
+- (XCTestExpectation *)expectationForRequestCount:(NSUInteger)requestCount
+{
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(NetMetrixDispatcherTestCase * _Nullable testCase, NSDictionary<NSString *,id> * _Nullable bindings) {
+        @synchronized(testCase) {
+            return testCase.requests.count == requestCount;
+        }
+    }];
+    return [self expectationForPredicate:predicate evaluatedWithObject:self handler:nil];
+}
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    NSString *fileName = [NSString stringWithFormat:@"NetMetrixPendingHits-%@.plist", NSUUID.UUID.UUIDString];
+    self.fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    
+    self.requests = [NSMutableArray array];
+    self.statusCodes = [NSMutableArray array];
+    
+    self.requestStub = [OHHTTPStubs stubRequestsPassingTest:^BOOL(NSURLRequest *request) {
+        return [request.URL.host isEqualToString:TestNetMetrixHost];
+    } withStubResponse:^OHHTTPStubsResponse *(NSURLRequest *request) {
+        int statusCode = 200;
+        @synchronized(self) {
+            [self.requests addObject:request];
+            if (self.statusCodes.count != 0) {
+                statusCode = self.statusCodes.firstObject.intValue;
+                [self.statusCodes removeObjectAtIndex:0];
+            }
+        }
+        return [OHHTTPStubsResponse responseWithData:[NSData data] statusCode:statusCode headers:nil];
+    }];
+    self.requestStub.name = @"NetMetrix";
+}
+
+- (void)tearDown
+{
+    [OHHTTPStubs removeStub:self.requestStub];
+    [NSFileManager.defaultManager removeItemAtURL:self.fileURL error:NULL];
+}
+
+#pragma mark Tests
+
+- (void)testHit
+{
+    SRGAnalyticsNetMetrixDispatcher *dispatcher = [self dispatcherWithCoalescingInterval:0. maximumPendingHitCount:10];
+    
+    [self expectationForRequestCount:1];
+    
+    [dispatcher sendHit];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    NSURLRequest *request = self.requests.firstObject;
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"User-Agent"], @"Mozilla/5.0 (iOS-phone; U; CPU iPhone OS like Mac OS X)");
+    
+    NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:NO];
+    XCTAssertEqualObjects(URLComponents.path, TestNetMetrixURL().path);
+    XCTAssertEqualObjects(URLComponents.queryItems.firstObject.name, @"d");
+    XCTAssertNotNil(URLComponents.queryItems.firstObject.value);
+}
+
+- (void)testSuccessiveHits
+{
+    SRGAnalyticsNetMetrixDispatcher *dispatcher = [self dispatcherWithCoalescingInterval:0. maximumPendingHitCount:10];
+    
+    [self expectationForRequestCount:3];
+    
+    [dispatcher sendHit];
+    [dispatcher sendHit];
+    [dispatcher sendHit];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    // Cache-busting parameters differ
+    NSSet<NSURL *> *URLs = [NSSet setWithArray:[self.requests valueForKeyPath:@"URL"]];
+    XCTAssertEqual(URLs.count, 3);
+}
+
+- (void)testCoalescing
+{
+    SRGAnalyticsNetMetrixDispatcher *dispatcher = [self dispatcherWithCoalescingInterval:10. maximumPendingHitCount:10];
+    
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    
+    for (NSInteger i = 0; i < 5; ++i) {
+        [dispatcher sendHit];
+    }
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertEqual(self.requests.count, 1);
+    XCTAssertEqual(dispatcher.pendingHitCount, 0);
+}
+
+- (void)testRetry
+{
+    [self.statusCodes addObjectsFromArray:@[ @500, @503 ]];
+    
+    SRGAnalyticsNetMetrixDispatcher *dispatcher = [self dispatcherWithCoalescingInterval:0. maximumPendingHitCount:10];
+    
+    [self expectationForRequestCount:3];
+    
+    [dispatcher sendHit];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    // Let the last response be processed
+    [self expectationForElapsedTimeInterval:0.5 withHandler:nil];
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertEqual(dispatcher.pendingHitCount, 0);
+}
+
+- (void)testClientErrorIsNotRetried
+{
+    [self.statusCodes addObject:@404];
+    
+    SRGAnalyticsNetMetrixDispatcher *dispatcher = [self dispatcherWithCoalescingInterval:0. maximumPendingHitCount:10];
+    
+    [self expectationForElapsedTimeInterval:2. withHandler:nil];
+    
+    [dispatcher sendHit];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertEqual(self.requests.count, 1);
+    XCTAssertEqual(dispatcher.pendingHitCount, 0);
+}
+
+- (void)testBoundedQueue
+{
+    // Fail long enough for all hits to be received while the first one is being retried
+    for (NSInteger i = 0; i < 100; ++i) {
+        [self.statusCodes addObject:@500];
+    }
+    
+    SRGAnalyticsNetMetrixDispatcher *dispatcher = [self dispatcherWithCoalescingInterval:0. maximumPendingHitCount:3];
+    for (NSInteger i = 0; i < 10; ++i) {
+        [dispatcher sendHit];
+    }
+    XCTAssertEqual(dispatcher.pendingHitCount, 3);
+}
+
+- (void)testPersistence
+{
+    for (NSInteger i = 0; i < 100; ++i) {
+        [self.statusCodes addObject:@500];
+    }
+    
+    @autoreleasepool {
+        SRGAnalyticsNetMetrixDispatcher *dispatcher = [self dispatcherWithCoalescingInterval:0. maximumPendingHitCount:10];
+        [dispatcher sendHit];
+        [dispatcher sendHit];
+        XCTAssertEqual(dispatcher.pendingHitCount, 2);
+    }
+    
+    @synchronized(self) {
+        [self.requests removeAllObjects];
+        [self.statusCodes removeAllObjects];
+    }
+    
+    // Pending hits are sent by a new dispatcher using the same file. Requests from the previous dispatcher might still
+    // be running, only check that the queue is emptied
+    SRGAnalyticsNetMetrixDispatcher *dispatcher = [self dispatcherWithCoalescingInterval:0. maximumPendingHitCount:10];
+    
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(SRGAnalyticsNetMetrixDispatcher * _Nullable dispatcher, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return dispatcher.pendingHitCount == 0;
+    }];
+    [self expectationForPredicate:predicate evaluatedWithObject:dispatcher handler:nil];
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertNotEqual(self.requests.count, 0);
+}
+
+@end
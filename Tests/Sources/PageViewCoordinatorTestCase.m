@@ -0,0 +1,144 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+
+// Private header
+#import "SRGAnalyticsPageViewCoordinator.h"
+
+// View controller tracked with its title.
+@interface TrackedViewController : UIViewController <SRGAnalyticsViewTracking>
+
+- (instancetype)initWithTitle:(NSString *)title;
+
+@property (nonatomic, getter=srg_isTrackedAutomatically) BOOL srg_trackedAutomatically;
+
+@end
+
+@implementation TrackedViewController
+
+- (instancetype)initWithTitle:(NSString *)title
+{
+    if (self = [super initWithNibName:nil bundle:nil]) {
+        self.title = title;
+        self.srg_trackedAutomatically = YES;
+    }
+    return self;
+}
+
+- (NSString *)srg_pageViewTitle
+{
+    return self.title;
+}
+
+@end
+
+@interface PageViewCoordinatorTestCase : AnalyticsTestCase
+
+@property (nonatomic) SRGAnalyticsPageViewCoordinator *coordinator;
+
+@end
+
+@implementation PageViewCoordinatorTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.coordinator = [[SRGAnalyticsPageViewCoordinator alloc] init];
+}
+
+- (void)tearDown
+{
+    self.coordinator = nil;
+}
+
+#pragma mark Tests
+
+- (void)testUntrackedViewController
+{
+    UIViewController *viewController = [[UIViewController alloc] init];
+    [self.coordinator viewControllerDidAppear:viewController];
+    XCTAssertEqualObjects(self.coordinator.trackedViewControllers, @[]);
+}
+
+- (void)testNestedViewControllers
+{
+    TrackedViewController *containerViewController = [[TrackedViewController alloc] initWithTitle:@"Container"];
+    UINavigationController *navigationController = [[UINavigationController alloc] init];
+    [containerViewController addChildViewController:navigationController];
+    [navigationController didMoveToParentViewController:containerViewController];
+    
+    TrackedViewController *viewController1 = [[TrackedViewController alloc] initWithTitle:@"Page 1"];
+    TrackedViewController *viewController2 = [[TrackedViewController alloc] initWithTitle:@"Page 2"];
+    [containerViewController addChildViewController:viewController2];
+    [viewController2 didMoveToParentViewController:containerViewController];
+    [navigationController addChildViewController:viewController1];
+    [viewController1 didMoveToParentViewController:navigationController];
+    
+    [self.coordinator viewControllerDidAppear:containerViewController];
+    XCTAssertEqualObjects(self.coordinator.trackedViewControllers, @[ containerViewController ]);
+    
+    [self.coordinator viewControllerDidAppear:navigationController];
+    [self.coordinator viewControllerDidAppear:viewController2];
+    [self.coordinator viewControllerDidAppear:viewController1];
+    XCTAssertEqualObjects(self.coordinator.trackedViewControllers, (@[ viewController2, viewController1 ]));
+    
+    [self.coordinator viewControllerWillDisappear:viewController1];
+    XCTAssertEqualObjects(self.coordinator.trackedViewControllers, @[ viewController2 ]);
+    
+    // View controllers which are not tracked automatically do not hide their containers
+    viewController2.srg_trackedAutomatically = NO;
+    XCTAssertEqualObjects(self.coordinator.trackedViewControllers, @[ containerViewController ]);
+}
+
+- (void)testViewControllersAreNotRetained
+{
+    __weak TrackedViewController *weakViewController = nil;
+    @autoreleasepool {
+        TrackedViewController *viewController = [[TrackedViewController alloc] initWithTitle:@"Page"];
+        [self.coordinator viewControllerDidAppear:viewController];
+        weakViewController = viewController;
+    }
+    XCTAssertNil(weakViewController);
+    XCTAssertEqualObjects(self.coordinator.trackedViewControllers, @[]);
+}
+
+- (void)testForegroundTracking
+{
+    TrackedViewController *containerViewController = [[TrackedViewController alloc] initWithTitle:@"Container"];
+    TrackedViewController *viewController = [[TrackedViewController alloc] initWithTitle:@"Page"];
+    [containerViewController addChildViewController:viewController];
+    [viewController didMoveToParentViewController:containerViewController];
+    
+    [self.coordinator viewControllerDidAppear:containerViewController];
+    [self.coordinator viewControllerDidAppear:viewController];
+    
+    [self expectationForPageViewEventNotificationWithHandler:^BOOL(NSString * _Nonnull event, NSDictionary * _Nonnull labels) {
+        XCTAssertEqualObjects(labels[@"content_title"], @"Page");
+        return YES;
+    }];
+    
+    [NSNotificationCenter.defaultCenter postNotificationName:UIApplicationWillEnterForegroundNotification object:nil];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    // No other page view must be sent
+    id pageViewObserver = [NSNotificationCenter.defaultCenter addObserverForName:SRGAnalyticsRequestNotification object:nil queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
+        NSDictionary *labels = notification.userInfo[SRGAnalyticsLabelsKey];
+        if ([labels[@"event_id"] isEqualToString:@"screen"]) {
+            XCTFail(@"No other page view must be sent. Received %@", labels[@"content_title"]);
+        }
+    }];
+    
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    
+    [self waitForExpectationsWithTimeout:5. handler:^(NSError * _Nullable error) {
+        [NSNotificationCenter.defaultCenter removeObserver:pageViewObserver];
+    }];
+}
+
+@end
@@ -0,0 +1,25 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "PortableTests.h"
+
+#import <XCTest/XCTest.h>
+
+// Portable tests can also be run off-device with `make test`.
+@interface PortableTestCase : XCTestCase
+
+@end
+
+@implementation PortableTestCase
+
+#pragma mark Tests
+
+- (void)testPortableTests
+{
+    XCTAssertEqual(PortableTestsRun(stdout), 0);
+}
+
+@end
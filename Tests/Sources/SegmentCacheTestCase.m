@@ -0,0 +1,116 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+
+// Private header
+#import "SRGAnalyticsSegmentCache.h"
+
+#import <libextobjc/libextobjc.h>
+#import <SRGAnalytics_DataProvider/SRGAnalytics_DataProvider.h>
+
+static SRGSegment *TestSegment(NSDate *startDate, NSDate *endDate)
+{
+    NSMutableDictionary *dictionary = [@{ @keypath(SRGSegment.new, URN) : @"urn:rts:video:1234",
+                                          @keypath(SRGSegment.new, markIn) : @10000,
+                                          @keypath(SRGSegment.new, duration) : @5000 } mutableCopy];
+    dictionary[@keypath(SRGSegment.new, startDate)] = startDate;
+    dictionary[@keypath(SRGSegment.new, endDate)] = endDate;
+    return [[SRGSegment alloc] initWithDictionary:dictionary error:NULL];
+}
+
+@interface SegmentCacheTestCase : AnalyticsTestCase
+
+@end
+
+@implementation SegmentCacheTestCase
+
+#pragma mark Tests
+
+- (void)testTimeRange
+{
+    SRGSegment *segment = TestSegment(nil, nil);
+    SRGAnalyticsSegmentCache *cache = [SRGAnalyticsSegmentCache cacheForSegment:segment];
+    
+    CMTimeRange expectedTimeRange = CMTimeRangeMake(CMTimeMakeWithSeconds(10., NSEC_PER_SEC), CMTimeMakeWithSeconds(5., NSEC_PER_SEC));
+    XCTAssertTrue(CMTimeRangeEqual(cache.timeRange, expectedTimeRange));
+    XCTAssertTrue(CMTimeRangeEqual(segment.srg_timeRange, expectedTimeRange));
+}
+
+- (void)testSharedCache
+{
+    SRGSegment *segment = TestSegment(nil, nil);
+    SRGAnalyticsSegmentCache *cache = [SRGAnalyticsSegmentCache cacheForSegment:segment];
+    XCTAssertEqual([SRGAnalyticsSegmentCache cacheForSegment:segment], cache);
+    
+    // Equal segments are distinct objects with distinct caches
+    SRGSegment *otherSegment = TestSegment(nil, nil);
+    XCTAssertEqualObjects(otherSegment, segment);
+    XCTAssertNotEqual([SRGAnalyticsSegmentCache cacheForSegment:otherSegment], cache);
+}
+
+- (void)testNoBlockingWindow
+{
+    SRGSegment *segment = TestSegment(nil, nil);
+    SRGAnalyticsSegmentCache *cache = [SRGAnalyticsSegmentCache cacheForSegment:segment];
+    
+    NSDate *date = NSDate.date;
+    XCTAssertFalse([cache isBlockedAtDate:date]);
+    XCTAssertFalse([cache isBlockedAtDate:[date dateByAddingTimeInterval:-1000000.]]);
+    XCTAssertFalse([cache isBlockedAtDate:[date dateByAddingTimeInterval:1000000.]]);
+    XCTAssertFalse(segment.srg_blocked);
+}
+
+- (void)testBlockingWindow
+{
+    NSDate *date = NSDate.date;
+    SRGSegment *segment = TestSegment([date dateByAddingTimeInterval:100.], [date dateByAddingTimeInterval:200.]);
+    SRGAnalyticsSegmentCache *cache = [SRGAnalyticsSegmentCache cacheForSegment:segment];
+    
+    for (NSNumber *interval in @[ @0., @50., @150., @199., @250. ]) {
+        NSDate *checkDate = [date dateByAddingTimeInterval:interval.doubleValue];
+        XCTAssertEqual([cache isBlockedAtDate:checkDate], [segment blockingReasonAtDate:checkDate] != SRGBlockingReasonNone);
+    }
+    XCTAssertEqual(segment.srg_blocked, [segment blockingReasonAtDate:NSDate.date] != SRGBlockingReasonNone);
+}
+
+- (void)testBlockingWindowBoundaries
+{
+    NSDate *date = NSDate.date;
+    NSDate *startDate = [date dateByAddingTimeInterval:100.];
+    NSDate *endDate = [date dateByAddingTimeInterval:200.];
+    SRGSegment *segment = TestSegment(startDate, endDate);
+    SRGAnalyticsSegmentCache *cache = [SRGAnalyticsSegmentCache cacheForSegment:segment];
+    
+    XCTAssertEqual([cache isBlockedAtDate:startDate], [segment blockingReasonAtDate:startDate] != SRGBlockingReasonNone);
+    XCTAssertEqual([cache isBlockedAtDate:endDate], [segment blockingReasonAtDate:endDate] != SRGBlockingReasonNone);
+}
+
+- (void)testStartDateOnly
+{
+    NSDate *date = NSDate.date;
+    SRGSegment *segment = TestSegment([date dateByAddingTimeInterval:100.], nil);
+    SRGAnalyticsSegmentCache *cache = [SRGAnalyticsSegmentCache cacheForSegment:segment];
+    
+    for (NSNumber *interval in @[ @0., @99., @101., @1000. ]) {
+        NSDate *checkDate = [date dateByAddingTimeInterval:interval.doubleValue];
+        XCTAssertEqual([cache isBlockedAtDate:checkDate], [segment blockingReasonAtDate:checkDate] != SRGBlockingReasonNone);
+    }
+}
+
+- (void)testEndDateOnly
+{
+    NSDate *date = NSDate.date;
+    SRGSegment *segment = TestSegment(nil, [date dateByAddingTimeInterval:100.]);
+    SRGAnalyticsSegmentCache *cache = [SRGAnalyticsSegmentCache cacheForSegment:segment];
+    
+    for (NSNumber *interval in @[ @0., @99., @101., @1000. ]) {
+        NSDate *checkDate = [date dateByAddingTimeInterval:interval.doubleValue];
+        XCTAssertEqual([cache isBlockedAtDate:checkDate], [segment blockingReasonAtDate:checkDate] != SRGBlockingReasonNone);
+    }
+}
+
+@end
@@ -0,0 +1,123 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+#import "Segment.h"
+
+// Private header
+#import "SRGAnalyticsSegmentIndex.h"
+
+#import <libextobjc/libextobjc.h>
+#import <SRGAnalytics_DataProvider/SRGAnalytics_DataProvider.h>
+
+static CMTimeRange TestTimeRange(NSTimeInterval start, NSTimeInterval duration)
+{
+    return CMTimeRangeMake(CMTimeMakeWithSeconds(start, NSEC_PER_SEC), CMTimeMakeWithSeconds(duration, NSEC_PER_SEC));
+}
+
+@interface SegmentIndexTestCase : AnalyticsTestCase
+
+@end
+
+@implementation SegmentIndexTestCase
+
+#pragma mark Tests
+
+- (void)testAccessors
+{
+    Segment *segment1 = [Segment segmentWithName:@"segment1" timeRange:TestTimeRange(20., 10.)];
+    Segment *segment2 = [Segment segmentWithName:@"segment2" timeRange:TestTimeRange(0., 10.)];
+    Segment *blockedSegment3 = [Segment blockedSegmentWithName:@"segment3" timeRange:TestTimeRange(10., 5.)];
+    SRGAnalyticsSegmentIndex *index = [[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ segment1, segment2, blockedSegment3 ]];
+    
+    // Segments are kept in their original order
+    NSArray<Segment *> *segments = @[ segment1, segment2, blockedSegment3 ];
+    XCTAssertEqualObjects(index.segments, segments);
+    
+    for (NSUInteger i = 0; i < segments.count; ++i) {
+        XCTAssertTrue(CMTimeRangeEqual([index timeRangeAtIndex:i], segments[i].srg_timeRange));
+        XCTAssertEqual([index isHiddenAtIndex:i], segments[i].srg_hidden);
+    }
+}
+
+- (void)testEmptyIndex
+{
+    SRGAnalyticsSegmentIndex *index = [[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[]];
+    XCTAssertEqualObjects(index.segments, @[]);
+    XCTAssertTrue([index isEquivalentToIndex:[[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[]]]);
+}
+
+- (void)testCachedIndex
+{
+    NSArray<Segment *> *segments = @[ [Segment segmentWithName:@"segment" timeRange:TestTimeRange(0., 10.)] ];
+    XCTAssertEqual([SRGAnalyticsSegmentIndex indexForSegments:segments], [SRGAnalyticsSegmentIndex indexForSegments:segments]);
+    
+    NSMutableArray<Segment *> *mutableSegments = [segments mutableCopy];
+    XCTAssertNotEqual([SRGAnalyticsSegmentIndex indexForSegments:mutableSegments], [SRGAnalyticsSegmentIndex indexForSegments:mutableSegments]);
+}
+
+- (void)testCachedIndexRelease
+{
+    __weak NSArray<Segment *> *weakSegments = nil;
+    @autoreleasepool {
+        NSArray<Segment *> *segments = [NSArray arrayWithObject:[Segment segmentWithName:@"segment" timeRange:TestTimeRange(0., 10.)]];
+        weakSegments = segments;
+        XCTAssertNotNil([SRGAnalyticsSegmentIndex indexForSegments:segments]);
+    }
+    
+    // The cached index must not keep its segment list alive
+    XCTAssertNil(weakSegments);
+}
+
+- (void)testEquivalence
+{
+    Segment *segment1 = [Segment segmentWithName:@"segment1" timeRange:TestTimeRange(0., 10.)];
+    Segment *segment2 = [Segment segmentWithName:@"segment2" timeRange:TestTimeRange(10., 10.)];
+    Segment *blockedSegment2 = [Segment blockedSegmentWithName:@"segment2" timeRange:TestTimeRange(10., 10.)];
+    
+    SRGAnalyticsSegmentIndex *index = [[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ segment1, segment2 ]];
+    XCTAssertTrue([index isEquivalentToIndex:[[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ segment1, segment2 ]]]);
+    XCTAssertFalse([index isEquivalentToIndex:[[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ segment1 ]]]);
+    XCTAssertFalse([index isEquivalentToIndex:[[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ segment2, segment1 ]]]);
+    XCTAssertFalse([index isEquivalentToIndex:[[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ segment1, blockedSegment2 ]]]);
+}
+
+- (void)testContentChanges
+{
+    NSDate *date = NSDate.date;
+    NSDictionary *dictionary = @{ @keypath(SRGSegment.new, URN) : @"urn:rts:video:1234",
+                                  @keypath(SRGSegment.new, markIn) : @0,
+                                  @keypath(SRGSegment.new, duration) : @10000,
+                                  @keypath(SRGSegment.new, analyticsLabels) : @{ @"segment_label" : @"value" },
+                                  @keypath(SRGSegment.new, startDate) : [date dateByAddingTimeInterval:100.],
+                                  @keypath(SRGSegment.new, endDate) : [date dateByAddingTimeInterval:200.] };
+    SRGSegment *segment = [[SRGSegment alloc] initWithDictionary:dictionary error:NULL];
+    SRGAnalyticsSegmentIndex *index = [[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ segment ]];
+    
+    // A refreshed segment with the same contents is equivalent
+    SRGSegment *refreshedSegment = [[SRGSegment alloc] initWithDictionary:dictionary error:NULL];
+    XCTAssertTrue([index isEquivalentToIndex:[[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ refreshedSegment ]]]);
+    
+    // Changes must be detected even if the segment is otherwise the same at the current date
+    NSMutableDictionary *labelsDictionary = [dictionary mutableCopy];
+    labelsDictionary[@keypath(SRGSegment.new, analyticsLabels)] = @{ @"segment_label" : @"other_value" };
+    SRGSegment *labelsSegment = [[SRGSegment alloc] initWithDictionary:labelsDictionary error:NULL];
+    XCTAssertEqualObjects(labelsSegment, segment);
+    XCTAssertFalse([index isEquivalentToIndex:[[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ labelsSegment ]]]);
+    
+    NSMutableDictionary *comScoreLabelsDictionary = [dictionary mutableCopy];
+    comScoreLabelsDictionary[@keypath(SRGSegment.new, comScoreAnalyticsLabels)] = @{ @"ns_st_ep" : @"19h30" };
+    SRGSegment *comScoreLabelsSegment = [[SRGSegment alloc] initWithDictionary:comScoreLabelsDictionary error:NULL];
+    XCTAssertFalse([index isEquivalentToIndex:[[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ comScoreLabelsSegment ]]]);
+    
+    NSMutableDictionary *endDateDictionary = [dictionary mutableCopy];
+    endDateDictionary[@keypath(SRGSegment.new, endDate)] = [date dateByAddingTimeInterval:300.];
+    SRGSegment *endDateSegment = [[SRGSegment alloc] initWithDictionary:endDateDictionary error:NULL];
+    XCTAssertEqual([endDateSegment blockingReasonAtDate:date], [segment blockingReasonAtDate:date]);
+    XCTAssertFalse([index isEquivalentToIndex:[[SRGAnalyticsSegmentIndex alloc] initWithSegments:@[ endDateSegment ]]]);
+}
+
+@end
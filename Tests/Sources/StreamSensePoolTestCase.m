@@ -0,0 +1,177 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+
+// Private headers
+#import "SRGAnalyticsStreamSensePool.h"
+#import "SRGAnalyticsStreamTracker+Private.h"
+#import "SRGAnalyticsTracker+Private.h"
+
+@interface StreamSensePoolTestCase : AnalyticsTestCase
+
+@end
+
+@implementation StreamSensePoolTestCase
+
+#pragma mark Helpers
+
+// StreamSense objects are dequeued and recycled asynchronously, in order with other comScore calls
+- (void)waitForComScoreCalls
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"comScore calls made"];
+    [SRGAnalyticsTracker.sharedTracker performRequiredComScoreBlock:^{
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+#pragma mark Tests
+
+- (void)testReuse
+{
+    SRGAnalyticsStreamSensePool *pool = [[SRGAnalyticsStreamSensePool alloc] initWithCapacity:2];
+    
+    CSStreamSense *streamSense1 = [pool dequeueStreamSense];
+    XCTAssertNotNil(streamSense1);
+    
+    CSStreamSensePlaybackSession *playbackSession1 = [streamSense1 playbackSession];
+    XCTAssertEqual(pool.allocationCount, 1);
+    XCTAssertEqual(pool.reuseCount, 0);
+    XCTAssertEqual(pool.idleCount, 0);
+    
+    [pool recycleStreamSense:streamSense1];
+    XCTAssertEqual(pool.idleCount, 1);
+    
+    // Recycling the same object twice has no effect
+    [pool recycleStreamSense:streamSense1];
+    XCTAssertEqual(pool.idleCount, 1);
+    
+    CSStreamSense *streamSense2 = [pool dequeueStreamSense];
+    XCTAssertEqual(streamSense2, streamSense1);
+    XCTAssertEqual(pool.allocationCount, 1);
+    XCTAssertEqual(pool.reuseCount, 1);
+    XCTAssertEqual(pool.idleCount, 0);
+    
+    // Reused objects start a new playback session
+    XCTAssertNotEqual([streamSense2 playbackSession], playbackSession1);
+}
+
+- (void)testCapacity
+{
+    SRGAnalyticsStreamSensePool *pool = [[SRGAnalyticsStreamSensePool alloc] initWithCapacity:2];
+    
+    NSArray<CSStreamSense *> *streamSenses = @[ [pool dequeueStreamSense], [pool dequeueStreamSense], [pool dequeueStreamSense] ];
+    XCTAssertEqual(pool.allocationCount, 3);
+    
+    for (CSStreamSense *streamSense in streamSenses) {
+        [pool recycleStreamSense:streamSense];
+    }
+    XCTAssertEqual(pool.idleCount, 2);
+}
+
+- (void)testPreparation
+{
+    SRGAnalyticsStreamSensePool *pool = [[SRGAnalyticsStreamSensePool alloc] initWithCapacity:2];
+    
+    [pool prepareStreamSensesWithCount:1];
+    XCTAssertEqual(pool.idleCount, 1);
+    XCTAssertEqual(pool.allocationCount, 1);
+    
+    // Already prepared objects are taken into account, and the capacity is never exceeded
+    [pool prepareStreamSensesWithCount:5];
+    XCTAssertEqual(pool.idleCount, 2);
+    XCTAssertEqual(pool.allocationCount, 2);
+    
+    [pool dequeueStreamSense];
+    XCTAssertEqual(pool.reuseCount, 1);
+    XCTAssertEqual(pool.allocationCount, 2);
+}
+
+- (void)testLabelsReset
+{
+    SRGAnalyticsStreamSensePool *pool = [[SRGAnalyticsStreamSensePool alloc] initWithCapacity:1];
+    
+    CSStreamSense *streamSense = [pool dequeueStreamSense];
+    [streamSense setLabel:@"ns_st_ep" value:@"19h30"];
+    [[streamSense clip] setLabel:@"ns_st_cs" value:@"1920x1080"];
+    [pool recycleStreamSense:streamSense];
+    
+    CSStreamSense *reusedStreamSense = [pool dequeueStreamSense];
+    XCTAssertEqual(reusedStreamSense, streamSense);
+    XCTAssertEqual([reusedStreamSense labels].count, 0);
+    XCTAssertEqual([[reusedStreamSense clip] labels].count, 0);
+}
+
+- (void)testStreamTrackerSessions
+{
+    SRGAnalyticsStreamSensePool *pool = SRGAnalyticsStreamSensePool.sharedPool;
+    
+    // Warm up the shared pool, then check that successive playback sessions do not create any new object
+    @autoreleasepool {
+        __unused SRGAnalyticsStreamTracker *streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:NO];
+    }
+    [self waitForComScoreCalls];
+    
+    NSUInteger allocationCount = pool.allocationCount;
+    for (NSInteger i = 0; i < 10; ++i) {
+        @autoreleasepool {
+            SRGAnalyticsStreamTracker *streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:NO];
+            [streamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:nil];
+            [streamTracker updateWithStreamState:SRGAnalyticsStreamStateStopped position:0. labels:nil];
+        }
+        [self waitForComScoreCalls];
+    }
+    XCTAssertEqual(pool.allocationCount, allocationCount);
+}
+
+- (void)testConsecutiveStreamTrackerSessions
+{
+    SRGAnalyticsStreamSensePool *pool = SRGAnalyticsStreamSensePool.sharedPool;
+    
+    __block NSString *playbackSessionId1 = nil;
+    [self expectationForComScoreHiddenEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        if (! [labels[@"ns_st_ev"] isEqualToString:@"play"]) {
+            return NO;
+        }
+        playbackSessionId1 = labels[@"ns_st_id"];
+        return YES;
+    }];
+    
+    @autoreleasepool {
+        SRGAnalyticsStreamTracker *streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:NO];
+        [streamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:nil];
+        [streamTracker updateWithStreamState:SRGAnalyticsStreamStateStopped position:0. labels:nil];
+    }
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    [self waitForComScoreCalls];
+    
+    XCTAssertNotNil(playbackSessionId1);
+    
+    // The next tracker reuses the recycled StreamSense object, but must report a different playback session
+    NSUInteger reuseCount = pool.reuseCount;
+    
+    [self expectationForComScoreHiddenEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        if (! [labels[@"ns_st_ev"] isEqualToString:@"play"]) {
+            return NO;
+        }
+        XCTAssertNotNil(labels[@"ns_st_id"]);
+        XCTAssertNotEqualObjects(labels[@"ns_st_id"], playbackSessionId1);
+        return YES;
+    }];
+    
+    SRGAnalyticsStreamTracker *streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:NO];
+    [streamTracker updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:nil];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    XCTAssertEqual(pool.reuseCount, reuseCount + 1);
+    
+    [streamTracker updateWithStreamState:SRGAnalyticsStreamStateStopped position:0. labels:nil];
+}
+
+@end
@@ -0,0 +1,170 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGAnalyticsStreamStateMachine.h"
+
+#import <XCTest/XCTest.h>
+
+static const size_t RandomSequenceLength = 100000;
+
+@interface StreamStateMachineTestCase : XCTestCase
+
+@end
+
+@implementation StreamStateMachineTestCase
+
+#pragma mark Helpers
+
+// Replay states, returning TagCommander event names and comScore event names
+- (NSArray<NSArray<NSString *> *> *)replayStates:(NSArray<NSNumber *> *)states
+{
+    size_t count = states.count;
+    SRGAnalyticsStreamMachineState *stateBuffer = malloc(count * sizeof(SRGAnalyticsStreamMachineState));
+    for (size_t i = 0; i < count; ++i) {
+        stateBuffer[i] = (SRGAnalyticsStreamMachineState)states[i].intValue;
+    }
+    
+    SRGAnalyticsStreamMachineTagCommanderEvent *tagCommanderEvents = malloc(SRGAnalyticsStreamMachineEventCountMax * count * sizeof(SRGAnalyticsStreamMachineTagCommanderEvent));
+    SRGAnalyticsStreamMachineComScoreEvent *comScoreEvents = malloc(SRGAnalyticsStreamMachineEventCountMax * count * sizeof(SRGAnalyticsStreamMachineComScoreEvent));
+    size_t tagCommanderCount = 0;
+    size_t comScoreCount = 0;
+    SRGAnalyticsStreamMachineReplay(stateBuffer, count, tagCommanderEvents, &tagCommanderCount, comScoreEvents, &comScoreCount);
+    
+    NSMutableArray<NSString *> *tagCommanderEventNames = [NSMutableArray array];
+    for (size_t i = 0; i < tagCommanderCount; ++i) {
+        [tagCommanderEventNames addObject:@(SRGAnalyticsStreamMachineTagCommanderEventName(tagCommanderEvents[i]))];
+    }
+    
+    NSArray<NSString *> *comScoreNames = @[ @"play", @"pause", @"end" ];
+    NSMutableArray<NSString *> *comScoreEventNames = [NSMutableArray array];
+    for (size_t i = 0; i < comScoreCount; ++i) {
+        [comScoreEventNames addObject:comScoreNames[comScoreEvents[i]]];
+    }
+    
+    free(stateBuffer);
+    free(tagCommanderEvents);
+    free(comScoreEvents);
+    
+    return @[ [tagCommanderEventNames copy], [comScoreEventNames copy] ];
+}
+
+#pragma mark Tests
+
+- (void)testPlayPausePlayStop
+{
+    NSArray<NSArray<NSString *> *> *events = [self replayStates:@[ @(SRGAnalyticsStreamMachineStatePlaying),
+                                                                   @(SRGAnalyticsStreamMachineStatePaused),
+                                                                   @(SRGAnalyticsStreamMachineStatePlaying),
+                                                                   @(SRGAnalyticsStreamMachineStateStopped) ]];
+    XCTAssertEqualObjects(events[0], (@[ @"play", @"pause", @"play", @"stop" ]));
+    XCTAssertEqualObjects(events[1], (@[ @"play", @"pause", @"play", @"end" ]));
+}
+
+- (void)testSessionOpening
+{
+    // A play is emitted first when seeking or pausing without any session opened
+    NSArray<NSArray<NSString *> *> *events = [self replayStates:@[ @(SRGAnalyticsStreamMachineStateSeeking),
+                                                                   @(SRGAnalyticsStreamMachineStatePaused),
+                                                                   @(SRGAnalyticsStreamMachineStateEnded),
+                                                                   @(SRGAnalyticsStreamMachineStatePaused) ]];
+    XCTAssertEqualObjects(events[0], (@[ @"play", @"seek", @"pause", @"eof", @"play", @"pause" ]));
+    XCTAssertEqualObjects(events[1], (@[ @"play", @"pause", @"pause", @"end", @"play", @"pause" ]));
+}
+
+- (void)testUnallowedTransitions
+{
+    // Repeated states and pauses after a stop are discarded by TagCommander, not by comScore
+    NSArray<NSArray<NSString *> *> *events = [self replayStates:@[ @(SRGAnalyticsStreamMachineStatePlaying),
+                                                                   @(SRGAnalyticsStreamMachineStatePlaying),
+                                                                   @(SRGAnalyticsStreamMachineStateStopped),
+                                                                   @(SRGAnalyticsStreamMachineStatePaused),
+                                                                   @(SRGAnalyticsStreamMachineStateEnded),
+                                                                   @(SRGAnalyticsStreamMachineStatePlaying) ]];
+    XCTAssertEqualObjects(events[0], (@[ @"play", @"stop", @"play" ]));
+    XCTAssertEqualObjects(events[1], (@[ @"play", @"play", @"end", @"play", @"pause", @"end", @"play" ]));
+}
+
+- (void)testUnknownStates
+{
+    NSArray<NSArray<NSString *> *> *events = [self replayStates:@[ @(SRGAnalyticsStreamMachineStateNone),
+                                                                   @(SRGAnalyticsStreamMachineStateCount),
+                                                                   @(-1),
+                                                                   @(SRGAnalyticsStreamMachineStatePlaying) ]];
+    XCTAssertEqualObjects(events[0], @[ @"play" ]);
+    XCTAssertEqualObjects(events[1], @[ @"play" ]);
+}
+
+- (void)testRandomSequenceInvariants
+{
+    srand48(42);
+    
+    SRGAnalyticsStreamMachine machine;
+    SRGAnalyticsStreamMachineInit(&machine);
+    
+    BOOL tagCommanderSessionOpened = NO;
+    BOOL comScoreSessionOpened = NO;
+    for (size_t i = 0; i < RandomSequenceLength; ++i) {
+        SRGAnalyticsStreamMachineState state = (SRGAnalyticsStreamMachineState)(lrand48() % (SRGAnalyticsStreamMachineStateCount + 1));
+        
+        SRGAnalyticsStreamMachineState acceptedStates[SRGAnalyticsStreamMachineEventCountMax];
+        size_t acceptedCount = SRGAnalyticsStreamMachineUpdateTagCommander(&machine, state, acceptedStates);
+        XCTAssertLessThanOrEqual(acceptedCount, SRGAnalyticsStreamMachineEventCountMax);
+        for (size_t j = 0; j < acceptedCount; ++j) {
+            SRGAnalyticsStreamMachineState acceptedState = acceptedStates[j];
+            if (acceptedState == SRGAnalyticsStreamMachineStatePaused || acceptedState == SRGAnalyticsStreamMachineStateSeeking) {
+                XCTAssertTrue(tagCommanderSessionOpened);
+            }
+            
+            if (acceptedState == SRGAnalyticsStreamMachineStatePlaying) {
+                tagCommanderSessionOpened = YES;
+            }
+            else if (acceptedState == SRGAnalyticsStreamMachineStateEnded) {
+                tagCommanderSessionOpened = NO;
+            }
+        }
+        if (acceptedCount != 0) {
+            XCTAssertEqual(machine.tagCommanderState, acceptedStates[acceptedCount - 1]);
+        }
+        
+        SRGAnalyticsStreamMachineComScoreEvent events[SRGAnalyticsStreamMachineEventCountMax];
+        size_t eventCount = SRGAnalyticsStreamMachineUpdateComScore(&machine, state, events);
+        XCTAssertLessThanOrEqual(eventCount, SRGAnalyticsStreamMachineEventCountMax);
+        for (size_t j = 0; j < eventCount; ++j) {
+            if (events[j] == SRGAnalyticsStreamMachineComScoreEventPause) {
+                XCTAssertTrue(comScoreSessionOpened);
+            }
+            comScoreSessionOpened = (events[j] != SRGAnalyticsStreamMachineComScoreEventEnd);
+        }
+        XCTAssertEqual(machine.comScoreSessionAlive, comScoreSessionOpened);
+    }
+}
+
+#pragma mark Benchmarks
+
+- (void)testReplayPerformance
+{
+    SRGAnalyticsStreamMachineState *states = malloc(RandomSequenceLength * sizeof(SRGAnalyticsStreamMachineState));
+    SRGAnalyticsStreamMachineTagCommanderEvent *tagCommanderEvents = malloc(SRGAnalyticsStreamMachineEventCountMax * RandomSequenceLength * sizeof(SRGAnalyticsStreamMachineTagCommanderEvent));
+    SRGAnalyticsStreamMachineComScoreEvent *comScoreEvents = malloc(SRGAnalyticsStreamMachineEventCountMax * RandomSequenceLength * sizeof(SRGAnalyticsStreamMachineComScoreEvent));
+    
+    // Seek-heavy session
+    for (size_t i = 0; i < RandomSequenceLength; ++i) {
+        states[i] = (i % 3 == 0) ? SRGAnalyticsStreamMachineStatePlaying : SRGAnalyticsStreamMachineStateSeeking;
+    }
+    
+    [self measureBlock:^{
+        size_t tagCommanderCount = 0;
+        size_t comScoreCount = 0;
+        SRGAnalyticsStreamMachineReplay(states, RandomSequenceLength, tagCommanderEvents, &tagCommanderCount, comScoreEvents, &comScoreCount);
+        XCTAssertNotEqual(tagCommanderCount, 0);
+    }];
+    
+    free(states);
+    free(tagCommanderEvents);
+    free(comScoreEvents);
+}
+
+@end
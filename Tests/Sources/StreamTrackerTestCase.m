@@ -0,0 +1,210 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+#import "SRGAnalyticsStreamTracker+Private.h"
+
+// Stream tracker tests driven by a manual clock. Heartbeats are collected as they are produced, no waiting is required
+@interface StreamTrackerTestCase : AnalyticsTestCase <SRGAnalyticsStreamTrackerDelegate>
+
+@property (nonatomic) SRGAnalyticsManualClock *clock;
+@property (nonatomic) SRGAnalyticsHeartbeatScheduler *heartbeatScheduler;
+
+@property (nonatomic) NSMutableArray<NSDictionary<NSString *, NSString *> *> *heartbeatLabelsArray;
+
+@property (nonatomic, getter=isPlayingLive) BOOL playingLive;
+
+@end
+
+@implementation StreamTrackerTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.clock = [[SRGAnalyticsManualClock alloc] init];
+    self.heartbeatLabelsArray = [NSMutableArray array];
+    self.playingLive = NO;
+    
+    __weak __typeof(self) weakSelf = self;
+    self.heartbeatScheduler = [[SRGAnalyticsHeartbeatScheduler alloc] initWithClock:self.clock interval:30. tolerance:3. sendBlock:^(NSArray<SRGAnalyticsLabelSet *> * _Nonnull labelSets) {
+        for (SRGAnalyticsLabelSet *labelSet in labelSets) {
+            [weakSelf.heartbeatLabelsArray addObject:labelSet.dictionary];
+        }
+    }];
+}
+
+#pragma mark Helpers
+
+- (SRGAnalyticsStreamTracker *)streamTrackerForLivestream:(BOOL)livestream
+{
+    SRGAnalyticsStreamTracker *streamTracker = [[SRGAnalyticsStreamTracker alloc] initForLivestream:livestream heartbeatScheduler:self.heartbeatScheduler];
+    streamTracker.delegate = self;
+    return streamTracker;
+}
+
+- (void)updateStreamTracker:(SRGAnalyticsStreamTracker *)streamTracker withStreamState:(SRGAnalyticsStreamState)state expectedEvent:(NSString *)expectedEvent expectedPosition:(NSString *)expectedPosition
+{
+    [self expectationForHiddenPlaybackEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        XCTAssertEqualObjects(event, expectedEvent);
+        XCTAssertEqualObjects(labels[@"media_position"], expectedPosition);
+        return YES;
+    }];
+    
+    [streamTracker updateWithStreamState:state position:0. labels:nil];
+    
+    [self waitForExpectationsWithTimeout:20. handler:nil];
+}
+
+- (NSArray<NSString *> *)heartbeatValuesForKey:(NSString *)key
+{
+    return [self.heartbeatLabelsArray valueForKey:key];
+}
+
+#pragma mark Tests
+
+- (void)testOnDemandHeartbeats
+{
+    SRGAnalyticsStreamTracker *streamTracker = [self streamTrackerForLivestream:NO];
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStatePlaying expectedEvent:@"play" expectedPosition:@"0"];
+    
+    [self.clock advanceBy:70.];
+    XCTAssertEqualObjects([self heartbeatValuesForKey:@"event_id"], (@[ @"pos", @"pos" ]));
+    
+    // No heartbeats while paused
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStatePaused expectedEvent:@"pause" expectedPosition:@"0"];
+    
+    [self.clock advanceBy:120.];
+    XCTAssertEqual(self.heartbeatLabelsArray.count, 2);
+    
+    // The first heartbeat is sent one interval after playback resumes
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStatePlaying expectedEvent:@"play" expectedPosition:@"0"];
+    
+    [self.clock advanceBy:29.];
+    XCTAssertEqual(self.heartbeatLabelsArray.count, 2);
+    
+    [self.clock advanceBy:1.];
+    XCTAssertEqual(self.heartbeatLabelsArray.count, 3);
+    
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStateStopped expectedEvent:@"stop" expectedPosition:@"0"];
+    XCTAssertTrue(self.heartbeatScheduler.suspended);
+}
+
+- (void)testLivestreamHeartbeats
+{
+    self.playingLive = YES;
+    
+    SRGAnalyticsStreamTracker *streamTracker = [self streamTrackerForLivestream:YES];
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStatePlaying expectedEvent:@"play" expectedPosition:@"0"];
+    
+    // An uptime event is sent every other heartbeat, with the playback duration as position
+    [self.clock advanceBy:120.];
+    XCTAssertEqualObjects([self heartbeatValuesForKey:@"event_id"], (@[ @"pos", @"pos", @"uptime", @"pos", @"pos", @"uptime" ]));
+    XCTAssertEqualObjects([self heartbeatValuesForKey:@"media_position"], (@[ @"30", @"60", @"60", @"90", @"120", @"120" ]));
+}
+
+- (void)testTimeshiftedLivestreamHeartbeats
+{
+    self.playingLive = NO;
+    
+    SRGAnalyticsStreamTracker *streamTracker = [self streamTrackerForLivestream:YES];
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStatePlaying expectedEvent:@"play" expectedPosition:@"0"];
+    
+    // No uptime events when not playing in live conditions
+    [self.clock advanceBy:120.];
+    XCTAssertEqualObjects([self heartbeatValuesForKey:@"event_id"], (@[ @"pos", @"pos", @"pos", @"pos" ]));
+}
+
+- (void)testLivestreamPlaybackDuration
+{
+    SRGAnalyticsStreamTracker *streamTracker = [self streamTrackerForLivestream:YES];
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStatePlaying expectedEvent:@"play" expectedPosition:@"0"];
+    
+    [self.clock advanceBy:5.];
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStatePaused expectedEvent:@"pause" expectedPosition:@"5"];
+    
+    // Time spent paused or seeking is not accounted for
+    [self.clock advanceBy:100.];
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStateSeeking expectedEvent:@"seek" expectedPosition:@"5"];
+    
+    [self.clock advanceBy:10.];
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStatePlaying expectedEvent:@"play" expectedPosition:@"5"];
+    
+    [self.clock advanceBy:2.];
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStateStopped expectedEvent:@"stop" expectedPosition:@"7"];
+    
+    // Playback duration is reset when playback is stopped
+    [self.clock advanceBy:10.];
+    [self updateStreamTracker:streamTracker withStreamState:SRGAnalyticsStreamStatePlaying expectedEvent:@"play" expectedPosition:@"0"];
+}
+
+- (void)testConcurrentTrackerHeartbeats
+{
+    SRGAnalyticsStreamTracker *streamTracker1 = [self streamTrackerForLivestream:NO];
+    [self updateStreamTracker:streamTracker1 withStreamState:SRGAnalyticsStreamStatePlaying expectedEvent:@"play" expectedPosition:@"0"];
+    
+    [self.clock advanceBy:2.];
+    
+    SRGAnalyticsStreamTracker *streamTracker2 = [self streamTrackerForLivestream:NO];
+    [self updateStreamTracker:streamTracker2 withStreamState:SRGAnalyticsStreamStatePlaying expectedEvent:@"play" expectedPosition:@"0"];
+    
+    // Heartbeats of both trackers are sent together
+    [self.clock advanceBy:28.];
+    XCTAssertEqual(self.heartbeatLabelsArray.count, 2);
+    
+    [self updateStreamTracker:streamTracker1 withStreamState:SRGAnalyticsStreamStateStopped expectedEvent:@"stop" expectedPosition:@"0"];
+    
+    [self.clock advanceBy:30.];
+    XCTAssertEqual(self.heartbeatLabelsArray.count, 3);
+}
+
+- (void)testTransition
+{
+    SRGAnalyticsStreamTracker *streamTracker = [self streamTrackerForLivestream:NO];
+    
+    NSMutableArray<NSString *> *events = [NSMutableArray array];
+    [self expectationForNotification:SRGAnalyticsRequestNotification object:nil handler:^BOOL(NSNotification * _Nonnull notification) {
+        NSDictionary *labels = notification.userInfo[SRGAnalyticsLabelsKey];
+        NSString *event = labels[@"event_id"];
+        if (! event) {
+            return NO;
+        }
+        
+        [events addObject:event];
+        return events.count == 4;
+    }];
+    
+    // Updates are applied in order. Disallowed transitions (stop after end) are discarded as usual.
+    NSArray<SRGAnalyticsStreamUpdate *> *updates = @[ [SRGAnalyticsStreamUpdate updateWithStreamState:SRGAnalyticsStreamStateSeeking position:0. labels:nil],
+                                                      [SRGAnalyticsStreamUpdate updateWithStreamState:SRGAnalyticsStreamStateEnded position:0. labels:nil],
+                                                      [SRGAnalyticsStreamUpdate updateWithStreamState:SRGAnalyticsStreamStateStopped position:0. labels:nil],
+                                                      [SRGAnalyticsStreamUpdate updateWithStreamState:SRGAnalyticsStreamStatePlaying position:0. labels:nil] ];
+    [streamTracker updateWithStreamUpdates:updates];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+    
+    // A play is implicitly sent first to open the session
+    XCTAssertEqualObjects(events, (@[ @"play", @"seek", @"eof", @"play" ]));
+}
+
+#pragma mark SRGAnalyticsStreamTrackerDelegate protocol
+
+- (BOOL)streamTrackerIsPlayingLive:(SRGAnalyticsStreamTracker *)tracker
+{
+    return self.playingLive;
+}
+
+- (NSTimeInterval)positionForStreamTracker:(SRGAnalyticsStreamTracker *)tracker
+{
+    return 0.;
+}
+
+- (SRGAnalyticsStreamLabels *)labelsForStreamTracker:(SRGAnalyticsStreamTracker *)tracker
+{
+    return nil;
+}
+
+@end
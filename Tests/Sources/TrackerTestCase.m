@@ -6,6 +6,7 @@
 
 #import "AnalyticsTestCase.h"
 #import "NSNotificationCenter+Tests.h"
+#import "SRGAnalyticsTracker+Private.h"
 
 typedef BOOL (^EventExpectationHandler)(NSString *event, NSDictionary *labels);
 
@@ -68,4 +69,157 @@ typedef BOOL (^EventExpectationHandler)(NSString *event, NSDictionary *labels);
     }];
 }
 
+- (void)testStagedStartup
+{
+    SRGAnalyticsConfiguration *configuration = [SRGAnalyticsTracker.sharedTracker.configuration copy];
+    configuration.startupStaged = YES;
+    
+    // This test requires a brand new analytics tracker. Events sent right after startup must be processed once services
+    // are ready, in order
+    SRGAnalyticsTracker *analyticsTracker = [SRGAnalyticsTracker new];
+    [analyticsTracker startWithConfiguration:configuration];
+    
+    XCTAssertTrue(analyticsTracker.configuration.startupStaged);
+    
+    __block BOOL firstEventReceived = NO;
+    [self expectationForHiddenEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        if ([labels[@"event_name"] isEqualToString:@"First event"]) {
+            firstEventReceived = YES;
+            return NO;
+        }
+        else if ([labels[@"event_name"] isEqualToString:@"Second event"]) {
+            XCTAssertTrue(firstEventReceived);
+            return YES;
+        }
+        else {
+            return NO;
+        }
+    }];
+    [self expectationForSingleNotification:SRGAnalyticsNetmetrixRequestNotification object:nil handler:nil];
+    
+    [analyticsTracker trackHiddenEventWithName:@"First event"];
+    [analyticsTracker trackPageViewWithTitle:@"Page view" levels:nil];
+    [analyticsTracker trackHiddenEventWithName:@"Second event"];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testGlobalLabels
+{
+    // This test requires a brand new analytics tracker
+    SRGAnalyticsTracker *analyticsTracker = [SRGAnalyticsTracker new];
+    [analyticsTracker startWithConfiguration:SRGAnalyticsTracker.sharedTracker.configuration];
+    
+    SRGAnalyticsGlobalLabelsSnapshot *initialSnapshot = analyticsTracker.globalLabelsSnapshot;
+    XCTAssertEqual(initialSnapshot.version, 0);
+    XCTAssertEqualObjects(initialSnapshot.labels, @{});
+    
+    [analyticsTracker updateGlobalLabelsWithBlock:^NSDictionary<NSString *,NSString *> * _Nullable(NSDictionary<NSString *,NSString *> * _Nonnull globalLabels) {
+        return @{ @"global_label" : @"global_value" };
+    }];
+    
+    SRGAnalyticsGlobalLabelsSnapshot *snapshot = analyticsTracker.globalLabelsSnapshot;
+    XCTAssertEqual(snapshot.version, 1);
+    XCTAssertEqualObjects(snapshot.labels, @{ @"global_label" : @"global_value" });
+    
+    // Snapshots are immutable
+    XCTAssertEqualObjects(initialSnapshot.labels, @{});
+    
+    // Unchanged labels do not create a new snapshot
+    [analyticsTracker updateGlobalLabelsWithBlock:^NSDictionary<NSString *,NSString *> * _Nullable(NSDictionary<NSString *,NSString *> * _Nonnull globalLabels) {
+        return globalLabels;
+    }];
+    XCTAssertEqual(analyticsTracker.globalLabelsSnapshot, snapshot);
+    
+    [self expectationForHiddenEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        if (! [labels[@"event_name"] isEqualToString:@"Hidden event with global labels"]) {
+            return NO;
+        }
+        XCTAssertEqualObjects(labels[@"global_label"], @"global_value");
+        return YES;
+    }];
+    
+    [analyticsTracker trackHiddenEventWithName:@"Hidden event with global labels"];
+    
+    [self waitForExpectationsWithTimeout:5. handler:nil];
+}
+
+- (void)testGlobalLabelsSnapshotsRelease
+{
+    // This test requires a brand new analytics tracker
+    SRGAnalyticsTracker *analyticsTracker = [SRGAnalyticsTracker new];
+    
+    __weak SRGAnalyticsGlobalLabelsSnapshot *weakSnapshot = nil;
+    @autoreleasepool {
+        weakSnapshot = analyticsTracker.globalLabelsSnapshot;
+        XCTAssertNotNil(weakSnapshot);
+        
+        for (NSInteger i = 0; i < 100; ++i) {
+            [analyticsTracker updateGlobalLabelsWithBlock:^NSDictionary<NSString *,NSString *> * _Nullable(NSDictionary<NSString *,NSString *> * _Nonnull globalLabels) {
+                return @{ @"count" : @(i).stringValue };
+            }];
+        }
+    }
+    
+    // Replaced snapshots are not kept once readers are done with them
+    XCTAssertNil(weakSnapshot);
+    XCTAssertEqual(analyticsTracker.globalLabelsSnapshot.version, 100);
+}
+
+- (void)testConcurrentGlobalLabelsUpdates
+{
+    static const NSInteger kThreadCount = 4;
+    static const NSInteger kIterationCount = 250;
+    
+    // This test requires a brand new analytics tracker
+    SRGAnalyticsTracker *analyticsTracker = [SRGAnalyticsTracker new];
+    
+    dispatch_apply(kThreadCount * 2, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        for (NSInteger i = 0; i < kIterationCount; ++i) {
+            // Half of the threads update labels, the other half reads them
+            if (index % 2 == 0) {
+                [analyticsTracker updateGlobalLabelsWithBlock:^NSDictionary<NSString *,NSString *> * _Nullable(NSDictionary<NSString *,NSString *> * _Nonnull globalLabels) {
+                    NSInteger count = globalLabels[@"count"].integerValue;
+                    return @{ @"count" : @(count + 1).stringValue };
+                }];
+            }
+            else {
+                SRGAnalyticsGlobalLabelsSnapshot *snapshot = analyticsTracker.globalLabelsSnapshot;
+                XCTAssertEqual(snapshot.labels[@"count"].integerValue, snapshot.version);
+                
+                // Labels can only have been updated since the snapshot was read
+                SRGAnalyticsLabelSet *labelSet = [analyticsTracker tagCommanderEventLabelSet];
+                XCTAssertGreaterThanOrEqual(labelSet[@"count"].integerValue, snapshot.version);
+            }
+        }
+    });
+    
+    SRGAnalyticsGlobalLabelsSnapshot *snapshot = analyticsTracker.globalLabelsSnapshot;
+    XCTAssertEqual(snapshot.version, kThreadCount * kIterationCount);
+    XCTAssertEqualObjects(snapshot.labels[@"count"], @(kThreadCount * kIterationCount).stringValue);
+}
+
+- (void)testTrackingCallerLatency
+{
+    // Measure the time spent by the caller (labels are assembled and sent asynchronously)
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < 100; ++i) {
+            SRGAnalyticsPageViewLabels *labels = [[SRGAnalyticsPageViewLabels alloc] init];
+            labels.customInfo = @{ @"custom_label" : @"custom_value" };
+            [SRGAnalyticsTracker.sharedTracker trackPageViewWithTitle:@"Page view" levels:@[ @"Level 1", @"Level 2", @"Level 3" ] labels:labels fromPushNotification:NO];
+            [SRGAnalyticsTracker.sharedTracker trackHiddenEventWithName:@"Hidden event"];
+        }
+    }];
+    
+    // Events are processed in order. Wait until a final event has been received to ensure no event pending processing
+    // interferes with other tests
+    [self expectationForHiddenEventNotificationWithHandler:^BOOL(NSString *event, NSDictionary *labels) {
+        return [labels[@"event_name"] isEqualToString:@"Last event"];
+    }];
+    
+    [SRGAnalyticsTracker.sharedTracker trackHiddenEventWithName:@"Last event"];
+    
+    [self waitForExpectationsWithTimeout:20. handler:nil];
+}
+
 @end
@@ -0,0 +1,146 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "AnalyticsTestCase.h"
+
+// Private header
+#import "SRGAnalyticsViewTrackingCapabilities.h"
+
+#import <objc/runtime.h>
+
+@interface MinimalTrackedViewController : UIViewController <SRGAnalyticsViewTracking>
+
+@end
+
+@implementation MinimalTrackedViewController
+
+- (NSString *)srg_pageViewTitle
+{
+    return @"Minimal";
+}
+
+@end
+
+@interface FullyTrackedViewController : MinimalTrackedViewController
+
+@end
+
+@implementation FullyTrackedViewController
+
+- (NSArray<NSString *> *)srg_pageViewLevels
+{
+    return @[ @"level" ];
+}
+
+- (SRGAnalyticsPageViewLabels *)srg_pageViewLabels
+{
+    return nil;
+}
+
+- (BOOL)srg_isOpenedFromPushNotification
+{
+    return YES;
+}
+
+- (BOOL)srg_isTrackedAutomatically
+{
+    return NO;
+}
+
+@end
+
+@interface ViewTrackingCapabilitiesTestCase : AnalyticsTestCase
+
+@end
+
+@implementation ViewTrackingCapabilitiesTestCase
+
+#pragma mark Tests
+
+- (void)testCapabilities
+{
+    XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(UIViewController.class), 0);
+    XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(UINavigationController.class), 0);
+    XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(MinimalTrackedViewController.class), SRGAnalyticsViewTrackingCapabilityTracked);
+    
+    SRGAnalyticsViewTrackingCapabilities allCapabilities = SRGAnalyticsViewTrackingCapabilityTracked | SRGAnalyticsViewTrackingCapabilityTrackedAutomatically
+        | SRGAnalyticsViewTrackingCapabilityPageViewLevels | SRGAnalyticsViewTrackingCapabilityPageViewLabels | SRGAnalyticsViewTrackingCapabilityOpenedFromPushNotification;
+    XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(FullyTrackedViewController.class), allCapabilities);
+    
+    // Cached values must match uncached ones
+    XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(FullyTrackedViewController.class), SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(FullyTrackedViewController.class));
+}
+
+- (void)testManyClasses
+{
+    // UIKit view controller classes are cached. Some of them might not find a free slot within the probed ones
+    unsigned int classNameCount = 0;
+    const char **classNames = objc_copyClassNamesForImage(class_getImageName(UIViewController.class), &classNameCount);
+    for (unsigned int i = 0; i < classNameCount; ++i) {
+        Class cls = objc_lookUpClass(classNames[i]);
+        for (Class superclass = cls; superclass; superclass = class_getSuperclass(superclass)) {
+            if (superclass == UIViewController.class) {
+                XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(cls), SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(cls));
+                XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(cls), SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(cls));
+                break;
+            }
+        }
+    }
+    free(classNames);
+    
+    // Classes created at runtime are never cached, but must still be reported correctly
+    for (NSInteger i = 0; i < 2000; ++i) {
+        NSString *className = [NSString stringWithFormat:@"ViewTrackingCapabilitiesTestCaseViewController%@", @(i)];
+        Class cls = objc_allocateClassPair(MinimalTrackedViewController.class, className.UTF8String, 0);
+        objc_registerClassPair(cls);
+        XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(cls), SRGAnalyticsViewTrackingCapabilityTracked);
+        XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(cls), SRGAnalyticsViewTrackingCapabilityTracked);
+    }
+}
+
+- (void)testRuntimeClass
+{
+    // Classes created at runtime are not cached, protocols added after a first call must therefore be taken into account
+    Class cls = objc_allocateClassPair(UIViewController.class, "ViewTrackingCapabilitiesTestCaseRuntimeViewController", 0);
+    objc_registerClassPair(cls);
+    XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(cls), 0);
+    
+    class_addProtocol(cls, @protocol(SRGAnalyticsViewTracking));
+    XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(cls), SRGAnalyticsViewTrackingCapabilityTracked);
+    
+    objc_disposeClassPair(cls);
+}
+
+- (void)testConcurrentAccess
+{
+    dispatch_apply(1000, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        Class cls = (iteration % 2 == 0) ? FullyTrackedViewController.class : UITableViewController.class;
+        XCTAssertEqual(SRGAnalyticsViewTrackingCapabilitiesForClass(cls), SRGAnalyticsUncachedViewTrackingCapabilitiesForClass(cls));
+    });
+}
+
+- (void)testNoAutomaticTracking
+{
+    // Opting out of automatic tracking is still honored when capabilities are cached
+    [self expectationForElapsedTimeInterval:1. withHandler:nil];
+    
+    id pageViewObserver = [NSNotificationCenter.defaultCenter addObserverForName:SRGAnalyticsRequestNotification object:nil queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
+        NSDictionary *labels = notification.userInfo[SRGAnalyticsLabelsKey];
+        if ([labels[@"event_id"] isEqualToString:@"screen"]) {
+            XCTFail(@"No page view must be sent");
+        }
+    }];
+    
+    FullyTrackedViewController *viewController = [[FullyTrackedViewController alloc] init];
+    [viewController viewDidAppear:NO];
+    [viewController viewWillDisappear:NO];
+    
+    [self waitForExpectationsWithTimeout:5. handler:^(NSError * _Nullable error) {
+        [NSNotificationCenter.defaultCenter removeObserver:pageViewObserver];
+    }];
+}
+
+@end